@@ -6,8 +6,64 @@
 #include <QSqlDatabase>
 #include <QThread>
 #include <QJsonArray>
+#include <QTimer>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <atomic>
+#include <functional>
+#include "Message.h"
+
+// 消息写入队列的统计
+struct DataBaseWriteStats
+{
+    int queueDepth = 0;          // 当前等待写入的消息数
+    int maxQueueDepth = 0;       // 历史最大等待写入的消息数
+    qint64 commits = 0;          // 已提交的事务数
+    qint64 messagesWritten = 0;  // 已写入的消息数
+    qint64 lastCommitUs = 0;     // 最近一次提交耗时，单位: 微秒(us)
+    qint64 totalCommitUs = 0;    // 累计提交耗时，单位: 微秒(us)
+    qint64 contentBytes = 0;       // 已写入消息内容的原始大小(UTF-8)，单位: 字节
+    qint64 storedContentBytes = 0; // 已写入消息内容压缩后实际保存的大小，单位: 字节
+    qint64 deduplicatedBlobs = 0;  // 与已保存的内容相同、只增加引用的消息数
+};
+
+// 一次数据库维护的结果
+struct DataBaseMaintenanceReport
+{
+    int orphanMessages = 0;      // 删除的孤立消息数(所属对话已不存在)
+    int collectedBlobs = 0;      // 删除的未引用 blobs 数
+    qint64 fileBytesBefore = 0;  // 维护前的数据库大小(page_count * page_size)，单位: 字节
+    qint64 fileBytesAfter = 0;   // 维护后的数据库大小，单位: 字节
+    qint64 freeBytesAfter = 0;   // 维护后仍未归还的空闲页大小，单位: 字节
+    int steps = 0;               // 执行的批次数(每批一个短事务)
+    qint64 longestStepMs = 0;    // 耗时最长的一批，单位: 毫秒(ms)
+    qint64 elapsedMs = 0;        // 从开始到结束的总耗时(包括批次之间处理的其他请求)，单位: 毫秒(ms)
+    bool incrementalVacuum = false; // 是否开启了增量 auto_vacuum(未开启时空闲页不会归还给文件系统)
+};
+Q_DECLARE_METATYPE(DataBaseMaintenanceReport)
+
+// 全文搜索的一条结果
+struct SearchResult
+{
+    QString conversationUuid;
+    QString messageUuid;  // 为空代表匹配的是对话标题
+    qint64 seq = 0;       // 消息在数据库中的序号
+    int role = 0;
+    QString createdTime;
+    QString snippet;      // 匹配位置附近的文本，匹配的词由 HIGHLIGHT_BEGIN 与 HIGHLIGHT_END 包围
+    double score = 0;     // bm25 得分，越小越相关
+
+    static constexpr const char *HIGHLIGHT_BEGIN = "\x01";
+    static constexpr const char *HIGHLIGHT_END = "\x02";
+};
+Q_DECLARE_METATYPE(SearchResult)
 
 class DataBaseWorker;
+class DataBaseReader;
+class QSqlQuery;
 class DataBaseManager : public QObject, public Singleton<DataBaseManager>
 {
     Q_OBJECT
@@ -31,35 +87,128 @@ Q_SIGNALS:
                               const QString &avatarFilePath,
                               const QJsonArray &toolCalls,
                               const QString &toolCallId);
-    // 获取消息列表
-    void sig_getMessageList(const QString &conversationUuid);
+    // 获取用于展示的消息列表，beforeSeq <= 0 时加载最新一页，否则加载 seq < beforeSeq 的 limit 条消息(untilSeq > 0 时至少加载到 untilSeq)
+    void sig_getMessageList(const QString &conversationUuid, qint64 beforeSeq, int limit, qint64 untilSeq);
+    // 获取LLM上下文: 最近一次清除上下文之后的最新 limit 条消息
+    void sig_getContextMessages(const QString &conversationUuid, int limit);
     // 删除对话
     void sig_deleteConversation(const QString &conversationUuid);
+    // 将消息内容按块写入文件，结果通过 DataBaseWorker::sig_messageContentExported 发出
+    void sig_exportMessageContent(const QString &messageUuid, const QString &filePath);
+    // 立即执行一次数据库维护(另外每 MAINTENANCE_INTERVAL_MS 自动执行)，结果通过 DataBaseWorker::sig_maintenanceFinished 发出
+    void sig_runMaintenance();
+    // 将已有数据库转换为增量 auto_vacuum(VACUUM 重写整个文件，期间写入会等待)，结果通过 DataBaseWorker::sig_incrementalVacuumEnabled 发出
+    void sig_enableIncrementalVacuum();
+    // 全文搜索消息内容与对话标题，结果通过 DataBaseWorker::sig_searchFinished 发出
+    void sig_search(const QString &keywords, int limit);
 
 public:
     ~DataBaseManager();
     const DataBaseWorker *getWorkerPtr();
+    // 可在任意线程调用
+    DataBaseWriteStats getWriteStats() const;
+
+    // 数据库中 uuid 保存为16字节BLOB，时间保存为毫秒时间戳，程序中仍使用字符串
+    static QByteArray uuidToBlob(const QString &uuid);
+    static QString uuidFromBlob(const QByteArray &blob);
+    static qint64 timeToEpochMs(const QString &time);
+    static QString timeFromEpochMs(qint64 epochMs);
+
+    // 消息内容的保存格式(messages.content_codec)
+    enum ContentCodec
+    {
+        CodecPlainText = 0, // TEXT 原文
+        CodecZlib = 1,      // BLOB，qCompress 压缩的 UTF-8
+        CodecBlob = 2       // 保存在 blobs 表中(content_blob_id)，content 为空
+    };
+    // 不少于 CONTENT_COMPRESS_THRESHOLD 字节且压缩有收益时返回压缩结果，否则返回空(按原文保存)
+    static QByteArray compressContent(const QByteArray &utf8);
+    static QString decompressContent(const QVariant &value, int codec);
+    // 按块读取 blobs 中的内容，每块为完整的 UTF-8 文本，consumer 返回 false 时停止
+    static bool readBlob(const QSqlDatabase &dataBase, qint64 blobId, const std::function<bool(const QByteArray &utf8)> &consumer);
+    // 读取消息内容(包括保存在 blobs 中的内容)
+    static QString readContent(const QSqlDatabase &dataBase, const QVariant &content, int codec, qint64 blobId);
+    static constexpr int CONTENT_COMPRESS_THRESHOLD = 1024;  // 单位: 字节
+    static constexpr int BLOB_THRESHOLD_CHARS = 8 * 1024;    // 不少于这么多字符的消息内容保存到 blobs 中(按内容去重)
+    static constexpr int BLOB_CHUNK_CHARS = 64 * 1024;       // blobs 中每块的字符数，读写时不需要整块内容的副本
 
 private:
     explicit DataBaseManager(QObject *parent = nullptr);
+    // 按轮询在只读连接中执行查询；needsFlush 为 true 时先经过数据库线程提交写入队列
+    void dispatchRead(bool needsFlush, const std::function<void(DataBaseReader *reader)> &read);
 
 private:
     DataBaseWorker *m_worker;
     QThread m_thread;
+    // 只读连接，每个连接一个线程(WAL模式下读取不会被写入阻塞)
+    QVector<DataBaseReader *> m_readers;
+    std::atomic_int m_nextReader{0};
+    QVector<QThread *> m_readerThreads;
     const QString DATABASE_FILENAME = "xlc_assistant.db";
 };
 
+/**
+ * 只读数据库连接
+ *
+ * 由 DataBaseManager 按轮询分派查询(相关的写入尚未提交时先经过写线程)，结果通过 DataBaseWorker 的同名信号发出。
+ * 连接在第一次查询时于所在线程中打开。
+ */
+class DataBaseReader : public QObject
+{
+    Q_OBJECT
+
+Q_SIGNALS:
+    void sig_allConversationInfoAcquired(bool success, QJsonArray jsonArrayConversationInfo);
+    void sig_messagesAcquired(bool success, const QString &conversationUuid, qint64 beforeSeq, bool hasMore, QVector<Message> messages);
+    void sig_contextMessagesAcquired(bool success, const QString &conversationUuid, QVector<Message> messages);
+    // truncated: 解压的数据量达到 SEARCH_DECODE_BYTES，部分压缩保存的消息没有检查
+    void sig_searchFinished(const QString &keywords, bool success, QVector<SearchResult> results, qint64 elapsedUs, bool truncated);
+    void sig_messageContentExported(const QString &messageUuid, const QString &filePath, bool success, qint64 bytes);
+
+public Q_SLOTS:
+    void slot_getAllConversationInfo();
+    void slot_getMessages(const QString &conversationUuid, qint64 beforeSeq, int limit, qint64 untilSeq);
+    void slot_getContextMessages(const QString &conversationUuid, int limit);
+    void slot_search(const QString &keywords, int limit);
+    void slot_exportMessageContent(const QString &messageUuid, const QString &filePath);
+
+public:
+    DataBaseReader(const QString &dataBaseFile, int index, QObject *parent = nullptr);
+    ~DataBaseReader();
+
+private:
+    bool ensureOpen();
+    // 按 SELECT seq, id, role, content, created_time, avatar_file_path, tool_calls, tool_call_id, content_codec, content_blob_id 的列顺序构造消息
+    Message readMessage(const QSqlQuery &query, const QString &conversationUuid) const;
+    // 在 content 中截取 keyword 附近的文本并标记(不经过全文索引的结果)
+    static QString buildSnippet(const QString &content, const QStringList &keywords);
+
+private:
+    QSqlDatabase m_dataBase;
+    QString m_dataBaseFile;
+    QString m_connectionName;
+    int m_ftsTokenizer = -1; // 全文索引的分词器: -1 未检查，0 不可用，1 unicode61，2 trigram
+    static const int RANK_CANDIDATES = 1000;       // 只在最近的这么多条匹配中按相关度排序，保证查询耗时有上限
+    static const int SHORT_KEYWORD_SCAN = 20000;   // 关键词都短于3个字符时(trigram无法索引)，只扫描最近的这么多条消息
+    static const int SEARCH_DECODE_BYTES = 2 * 1024 * 1024; // 每次搜索最多读取的压缩消息数据量，保证耗时有上限
+    static const int SNIPPET_CHARS = 32;           // 摘要中关键词前后保留的字符数
+};
+
 class DataBaseWorker : public QObject
 {
     Q_OBJECT
 
 Q_SIGNALS:
     void sig_allConversationInfoAcquired(bool success, QJsonArray jsonArrayConversationInfo);
-    void sig_messagesAcquired(bool success, const QString &conversationUuid, QJsonArray jsonArrayMessages);
+    void sig_messagesAcquired(bool success, const QString &conversationUuid, qint64 beforeSeq, bool hasMore, QVector<Message> messages);
+    void sig_contextMessagesAcquired(bool success, const QString &conversationUuid, QVector<Message> messages);
+    void sig_searchFinished(const QString &keywords, bool success, QVector<SearchResult> results, qint64 elapsedUs, bool truncated);
+    void sig_messageContentExported(const QString &messageUuid, const QString &filePath, bool success, qint64 bytes);
+    void sig_maintenanceFinished(DataBaseMaintenanceReport report);
+    void sig_incrementalVacuumEnabled(bool success, qint64 bytesBefore, qint64 bytesAfter);
 
 public Q_SLOTS:
     void slot_initialize();
-    void slot_getAllConversationInfo();
     void slot_insertNewConversation(const QString &agentUuid,
                                     const QString &uuid,
                                     const QString &summary,
@@ -74,20 +223,135 @@ public Q_SLOTS:
                                const QJsonArray &toolCalls,
                                const QString &toolCallId);
     void slot_updateConversationUpdatedTime(const QString &uuid, const QString &newUpdatedTime);
-    void slot_getMessages(const QString &conversationUuid);
     void slot_deleteConversation(const QString &conversationUuid);
+    // 分批删除不再被消息引用的 blobs，每批之间处理其他请求
+    void slot_collectGarbageBlobs();
+    // 后台维护: 分批删除孤立消息与未引用的 blobs，增量归还空闲页，更新统计信息；每批之间处理其他请求
+    void slot_runMaintenance();
+    void slot_enableIncrementalVacuum();
+    // 将等待写入的消息与对话更新时间在一个事务中提交
+    void slot_flushPendingWrites();
 
 public:
     explicit DataBaseWorker(const QString &dataBaseFile, QObject *parent = nullptr);
     ~DataBaseWorker();
+    DataBaseWriteStats getWriteStats() const;
+    // 可在任意线程调用: 记录已发出、尚未提交的写入；conversationUuid 为空时返回是否有任何未提交的写入
+    void beginWrite(const QString &conversationUuid);
+    bool hasPendingWrites(const QString &conversationUuid = QString()) const;
+
+    static constexpr qint64 MMAP_SIZE = 256LL * 1024 * 1024; // 内存映射大小，单位: 字节
+    static constexpr int CACHE_SIZE = -16000;                // 每个连接的页缓存，负数单位为 KiB
+    static constexpr int SCHEMA_VERSION = 6;                 // 当前表结构版本(PRAGMA user_version)
 
 private:
     void initializeDatabase();
+    // 按 PRAGMA user_version 依次执行尚未执行的迁移，新数据库直接创建最新版本的表结构
+    bool migrateSchema();
+    // 最新版本的表、索引与触发器，只用于创建新数据库；迁移使用各自版本固定的语句
+    static QStringList schemaTableStatements();
+    static QStringList schemaIndexStatements();
+    // 最新版本的全文索引表与触发器
+    static QStringList fullTextSchemaStatements(const QString &tokenizer);
+    // 返回可用的 FTS5 分词器，FTS5 不可用时返回空
+    QString probeFullTextTokenizer();
+    bool execStatements(const QStringList &statements);
+    // 迁移1: conversations 中冗余保存消息数量与最后一条消息(由 messages 上的触发器维护)，回填已有数据
+    bool migrateConversationStats();
+    // 迁移2: 角色改为整数、时间改为毫秒时间戳、uuid 改为16字节BLOB，重建表与索引
+    bool migrateCompactColumns();
+    // 迁移3: 消息内容与对话标题的 FTS5 全文索引，由触发器随写入增量维护
+    bool migrateFullTextSearch();
+    // 迁移4: 压缩较大的消息内容(content_codec)，tool_calls 改为紧凑JSON
+    bool migrateContentCompression();
+    // 迁移5: 按内容寻址的 blobs 表(SHA-256 去重，引用计数由触发器维护)，较大的消息内容移入其中
+    bool migrateBlobStore();
+    // 迁移6: 开启外键后删除 blobs 时需要按 content_blob_id 查找引用的消息
+    bool migrateForeignKeyIndexes();
+    // 读取是否已开启增量 auto_vacuum，已有数据库不会自动转换
+    void checkIncrementalVacuum();
+    // 保存内容到 blobs 并返回id(相同内容只增加引用)，失败时返回 0；storedBytes 为新写入的字节数，size 为内容的 UTF-8 字节数
+    qint64 storeBlob(const QString &content, qint64 &storedBytes, qint64 &size);
+    // 按 BLOB_CHUNK_CHARS 个字符分块转换为 UTF-8(不拆分代理对)
+    static void forEachUtf8Chunk(const QString &content, const std::function<void(const QByteArray &utf8)> &consumer);
+    // 删除一批未引用的 blobs，返回删除的数量，失败时返回 -1
+    int collectGarbageBlobs(qint64 &storedBytes);
+    void collectGarbageBlobsStep();
+    // 删除压缩保存的消息(seq <= maxSeq)的全文索引，触发器无法读取这些消息的原文
+    bool unindexCompressedMessages(const QByteArray &conversationId, qint64 maxSeq);
+    // 在一个事务中删除对话最早的 limit 条消息，返回删除的数量，失败时返回 -1
+    int deleteMessagesBatch(const QByteArray &conversationId, int limit);
+    // 执行一批维护任务，未完成时排队执行下一批
+    void runMaintenanceStep();
+    void finishMaintenance();
+    // 数据库总大小与空闲页大小，单位: 字节
+    void queryDataBaseSize(qint64 &totalBytes, qint64 &freeBytes);
+    // 写入提交(或失败)后调用，与 beginWrite 对应
+    void endWrites(const QString &conversationUuid, int count);
+    void endWrites(const QHash<QString, int> &counts);
 
 private:
+    // 等待写入的消息
+    struct PendingMessage
+    {
+        QString conversationUuid;
+        QString uuid;
+        int role;
+        QString content;
+        QString createdTime;
+        QString avatarFilePath;
+        QJsonArray toolCalls;
+        QString toolCallId;
+    };
+
     QSqlDatabase m_dataBase;
     QString m_dataBaseFile;
     const QString DB_CONNECTION_NAME = "databaseworker_connection";
+    // 写入队列(仅在数据库线程访问)，每 FLUSH_INTERVAL_MS 或满 FLUSH_MAX_MESSAGES 条提交一次
+    QVector<PendingMessage> m_pendingMessages;
+    QHash<QString, QString> m_pendingUpdatedTimes; // 对话uuid - 最新更新时间
+    QTimer *m_flushTimer = nullptr;
+    mutable QMutex m_mutexPendingWrites;
+    QHash<QString, int> m_pendingWrites; // 对话uuid - 已发出但尚未提交的写入数量
+    bool m_hasFullTextIndex = false;
+    static const int FLUSH_INTERVAL_MS = 100;
+    static const int GC_BATCH_SIZE = 200; // 每个事务最多删除的 blobs 数量
+    bool m_isCollectingBlobs = false;     // 正在分批回收未引用的 blobs
+    int m_collectedBlobs = 0;             // 本次回收删除的 blobs 数量
+    qint64 m_collectedBlobBytes = 0;      // 本次回收释放的存储字节数
+    static const int FLUSH_MAX_MESSAGES = 64;
+    // 维护任务
+    enum MaintenanceStep
+    {
+        MaintenanceIdle,
+        MaintenanceOrphanMessages,
+        MaintenanceBlobs,
+        MaintenanceVacuum,
+        MaintenanceAnalyze
+    };
+    MaintenanceStep m_maintenanceStep = MaintenanceIdle;
+    DataBaseMaintenanceReport m_maintenanceReport;
+    QElapsedTimer m_maintenanceTimer;
+    QByteArray m_orphanScanAfter;      // 查找孤立消息时已检查到的对话id
+    QByteArray m_orphanConversationId; // 正在删除孤立消息的对话id
+    bool m_incrementalVacuum = false;
+    QTimer *m_maintenanceIntervalTimer = nullptr;
+    static const int MAINTENANCE_DELAY_MS = 2 * 60 * 1000;      // 启动后第一次维护的延迟
+    static const int MAINTENANCE_INTERVAL_MS = 30 * 60 * 1000;  // 维护间隔
+    static const int MAINTENANCE_BATCH_SIZE = 500;              // 每批删除的孤立消息数
+    static const int ORPHAN_SCAN_CONVERSATIONS = 200;           // 每批最多检查的对话数
+    static const int VACUUM_PAGES_PER_STEP = 256;               // 每批归还的空闲页数
+    static const int ANALYSIS_LIMIT = 400;                      // ANALYZE 每个索引最多扫描的行数(近似统计，耗时有上限)
+    // 写入统计(可在任意线程读取)
+    std::atomic_int m_queueDepth{0};
+    std::atomic_int m_maxQueueDepth{0};
+    std::atomic<qint64> m_commits{0};
+    std::atomic<qint64> m_messagesWritten{0};
+    std::atomic<qint64> m_lastCommitUs{0};
+    std::atomic<qint64> m_totalCommitUs{0};
+    std::atomic<qint64> m_contentBytes{0};
+    std::atomic<qint64> m_storedContentBytes{0};
+    std::atomic<qint64> m_deduplicatedBlobs{0};
 };
 
 #endif // DATABASEMANAGER_H
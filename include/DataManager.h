@@ -11,12 +11,12 @@
 #include <QSet>
 #include <QMutex>
 #include "DataBaseManager.h"
+#include "Message.h"
 
 struct CallToolArgs;
 struct LLM;
 struct McpServer;
 struct Agent;
-struct Message;
 struct Conversation;
 class DataManager : public QObject
 {
@@ -27,6 +27,8 @@ Q_SIGNALS:
     void sig_mcpServersLoaded(bool success);
     void sig_agentsLoaded(bool success);
     void sig_messagesLoaded(const QString &conversationUuid);
+    // 向上翻页加载了 count 条更早的消息(已插入到消息列表开头)
+    void sig_olderMessagesLoaded(const QString &conversationUuid, int count);
     void sig_conversationsLoaded(bool success);
     void sig_LLMsFilePathChange(const QString &filePath);
     void sig_mcpServersFilePathChange(const QString &filePath);
@@ -41,7 +43,9 @@ private Q_SLOTS:
     // 处理从数据库获取到所有Conversation数据事件
     void slot_handleAllConversationInfoAcquired(bool success, QJsonArray jsonArrayConversations);
     // 处理从数据库获取到消息列表事件
-    void slot_handleMessagesAcquired(bool success, const QString &conversationUuid, QJsonArray jsonArrayMessages);
+    void slot_handleMessagesAcquired(bool success, const QString &conversationUuid, qint64 beforeSeq, bool hasMore, QVector<Message> messages);
+    // 处理从数据库获取到LLM上下文事件
+    void slot_handleContextMessagesAcquired(bool success, const QString &conversationUuid, QVector<Message> messages);
 
 public:
     static DataManager *getInstance();
@@ -152,11 +156,23 @@ struct McpServer
     QString name;
     QString description;
     Type type;
-    int timeout; // 单位: 秒(s)
+    int timeout;            // 单位: 秒(s)
+    int maxConcurrentCalls; // 同时执行的最大工具调用数量(请求通过JSON-RPC id流水线发送)
+    int resultCacheTtl;               // 工具结果缓存时间，单位: 秒(s)，0 代表不缓存
+    QVector<QString> cacheableTools;  // 用户标记为可缓存的工具(原始工具名)，注解声明只读/幂等的工具自动缓存
     // stdio参数
     QString command;
     QVector<QString> args;
     QMap<QString, QString> envVars;
+    int minReplicas; // 最少进程数，maxReplicas > 1 时启用进程池(仅适用于无状态服务器)
+    int maxReplicas; // 最多进程数
+    int idleTimeout; // 空闲多久后关闭进程(工具列表保留在缓存中，下次调用时重新启动)，单位: 秒(s)，0 代表不关闭
+    // 资源限制(仅Linux生效)，0 代表不限制
+    int cpuQuotaPercent; // CPU配额，100 代表一个核心
+    int memoryLimitMB;   // 内存上限，单位: MB
+    int niceValue;       // 调度优先级(nice)，1~19
+    int ioPriorityClass; // IO优先级类别: 0 不设置，2 best-effort(最低级别)，3 idle
+    int maxOpenFiles;    // 最大打开文件数
     // sse&streambleHttp参数
     QString host;
     int port;
@@ -206,6 +222,9 @@ struct Agent
     double temperature;          // 文档
     double topP;                 // top-P
     int maxTokens;               // 最大tokens
+    int maxToolResultChars;      // 单个工具结果写入上下文的最大字符数，超出部分截断，0 代表不限制
+    bool spillToolResultBlobs;   // 是否将工具结果中的图片、音频等二进制数据保存到磁盘，上下文中只保留引用id
+    int maxToolsPerRequest;      // 每次请求最多发送的工具数量(按与对话的相关性选择，已调用过的工具始终发送)，0 代表发送全部
     QSet<QString> mcpServers;    // 挂载的mcp服务器的uuid
     QSet<QString> conversations; // 使用该agent的对话的uuid
 
@@ -252,14 +271,25 @@ public:
     void resetSystemPrompt();
     // 添加消息
     void addMessage(const Message &newMessage);
-    // 获取所有消息
+    // 获取已加载的消息，首次调用时从数据库加载最新一页(展示)与LLM上下文
     const QVector<Message> getMessages();
+    // 从数据库加载更早的一页消息(untilSeq > 0 时至少加载到该消息)，已在加载或没有更早的消息时忽略
+    void loadOlderMessages(qint64 untilSeq = 0);
+    bool hasOlderMessages() const;
+    bool isMessagesLoaded() const;
     // 获取json格式的messages
     const QJsonArray getCachedMessages();
     // 清除上下文
     void clearContext();
-    // 从[数据库获取的]消息列表中加载
-    void loadMessages(const QList<Message> &messages);
+    // 从[数据库获取的]最新一页消息中加载，只用于展示
+    void loadMessages(const QVector<Message> &messages, bool hasOlderMessages);
+    // 从[数据库获取的]LLM上下文中加载(最近一次清除上下文之后的最新 contextLimit() 条消息)
+    void loadContext(const QVector<Message> &contextMessages);
+    bool isContextLoaded() const;
+    // 上下文最多保留的消息数量(不包括系统提示词)，agent 未设置时为 DEFAULT_CONTEXT_MESSAGES
+    int contextLimit() const;
+    // 在开头插入[数据库获取的]更早的消息，只用于展示，不进入LLM上下文
+    void prependMessages(const QVector<Message> &olderMessages, bool hasOlderMessages);
 
 public:
     QString uuid;             // 对话唯一标识
@@ -268,72 +298,25 @@ public:
     QString createdTime;      // 创建时间
     QString updatedTime;      // 更新时间
     int messageCount = -1;    // 记录消息数量(非缓存消息)，初始化为 -1 代表未同步/同步失败数据库
+    QString lastMessagePreview; // 最后一条消息的前 200 个字符
     int pendingToolCalls = 0; // 待处理的工具调用数量
+    static const int MESSAGE_PAGE_SIZE = 50; // 每次从数据库加载的消息数量
+    static const int DEFAULT_CONTEXT_MESSAGES = 100; // agent 的上下文数量为0时使用
+
+private:
+    // 将消息加入 json messages 缓存，调用方需持有 mutex_jsonArrayCachedMessages
+    void appendCachedMessage(const Message &message);
+    // 缓存超过 contextLimit() 时移除最早的消息，调用方需持有 mutex_jsonArrayCachedMessages
+    void trimCachedMessages();
 
 private:
     QMutex mutex_jsonArrayCachedMessages;
     QJsonArray jsonArrayCachedMessages;
     QVector<Message> messages;
-};
-
-struct Message
-{
-    QString id;
-    QString content;
-    enum Role
-    {
-        USER = 0,
-        ASSISTANT = 1,
-        TOOL = 2,
-        SYSTEM = 3,
-        UNKNOWN = 4
-    };
-    Role role;
-    QString createdTime;
-    QJsonArray toolCalls;
-    QString toolCallId;
-    QString avatarFilePath;
-
-    Message(const QString &id,
-            const QString &content,
-            Role role,
-            const QString &createdTime,
-            const QJsonArray &toolCalls,
-            const QString &toolCallId,
-            const QString &avatarFilePath)
-        : id(id), content(content), role(role), createdTime(createdTime), toolCalls(toolCalls), toolCallId(toolCallId), avatarFilePath(avatarFilePath)
-    {
-    }
-
-    Message(const QString &content,
-            Role role,
-            const QString &createdTime,
-            const QJsonArray &toolCalls = QJsonArray(),
-            const QString &toolCallId = QString())
-        : id(generateUuid()), content(content), role(role), createdTime(createdTime), toolCalls(toolCalls), toolCallId(toolCallId)
-    {
-        if (this->avatarFilePath.isEmpty())
-        {
-            switch (role)
-            {
-            case Role::USER:
-                this->avatarFilePath = QString(DEFAULT_AVATAR_USER);
-                break;
-            case Role::ASSISTANT:
-                this->avatarFilePath = QString(DEFAULT_AVATAR_LLM);
-                break;
-            case Role::TOOL:
-                this->avatarFilePath = QString(AVATAR_TOOL);
-                break;
-            case Role::SYSTEM:
-                this->avatarFilePath = QString(AVATAR_SYSTEM);
-                break;
-            default:
-                this->avatarFilePath = QString(AVATAR_UNKNOW);
-                break;
-            }
-        }
-    }
+    bool messagesLoaded = false;         // 是否已从数据库加载
+    bool contextLoaded = false;          // 是否已从数据库加载LLM上下文
+    bool olderMessagesRemaining = false; // 数据库中是否还有更早的消息未加载
+    bool loadingOlderMessages = false;   // 是否正在加载更早的消息
 };
 
 #endif // DATAMANAGER_H
\ No newline at end of file
@@ -0,0 +1,159 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <QThreadPool>
+#include <QRunnable>
+#include <QFuture>
+#include <QFutureInterface>
+#include <QException>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <functional>
+#include <type_traits>
+#include "Singleton.h"
+
+struct ExecutorPoolMetrics
+{
+    int maxThreadCount = 0;          // 线程池最大线程数
+    int activeThreadCount = 0;       // 正在执行任务的线程数
+    int queuedTasks = 0;             // 排队中的任务数量
+    int peakQueuedTasks = 0;         // 排队任务数量峰值
+    qint64 completedTasks = 0;       // 已完成的任务总数
+    qint64 totalQueueWaitMs = 0;     // 累计排队等待时间，单位: 毫秒(ms)
+    qint64 maxQueueWaitMs = 0;       // 最长排队等待时间，单位: 毫秒(ms)
+
+    // 平均排队等待时间，单位: 毫秒(ms)
+    double averageQueueWaitMs() const;
+    // 所有线程都在忙碌
+    bool isSaturated() const;
+};
+
+/**
+ * 后台任务执行器，替代 QThreadPool::globalInstance
+ *
+ * 按任务类型划分线程池，阻塞的MCP调用不会拖慢配置文件的加载与保存：
+ * - Interactive: 用户等待结果的短任务(启动加载配置等)
+ * - IoBlocking: 可能长时间阻塞的任务(MCP客户端初始化、工具调用等)
+ * - Background: 用户不关心完成时间的任务(保存配置等)
+ * 同一线程池内按优先级执行排队中的任务。
+ */
+class Executor : public Singleton<Executor>
+{
+    friend class Singleton<Executor>;
+
+public:
+    enum class Pool
+    {
+        Interactive = 0,
+        IoBlocking = 1,
+        Background = 2
+    };
+
+    enum class Priority
+    {
+        Low = 0,
+        Normal = 1,
+        High = 2
+    };
+
+public:
+    ~Executor();
+    // 在指定线程池中执行 function，返回的 QFuture 可直接交给 QFutureWatcher
+    template <typename Function>
+    auto run(Pool pool, Function &&function, Priority priority = Priority::Normal) -> QFuture<decltype(function())>;
+    // 获取线程池状态
+    ExecutorPoolMetrics metrics(Pool pool) const;
+    // 线程池名称(用于日志)
+    static const char *poolName(Pool pool);
+
+private:
+    Executor();
+    QThreadPool *threadPool(Pool pool);
+    void onTaskStarted(Pool pool, qint64 queueWaitMs);
+    void onTaskFinished(Pool pool);
+    void onTaskQueued(Pool pool);
+
+    template <typename T>
+    class Task;
+
+private:
+    static constexpr int POOL_COUNT = 3;
+    static constexpr int IO_BLOCKING_THREAD_COUNT = 64;    // 阻塞任务基本不占用CPU，线程数与核数无关
+    static constexpr int BACKGROUND_THREAD_COUNT = 2;      // 后台任务不需要很高的并发
+    static constexpr qint64 SLOW_QUEUE_WAIT_MS = 1000;     // 排队超过该时间视为线程池饱和
+    QThreadPool m_pools[POOL_COUNT];
+    ExecutorPoolMetrics m_metrics[POOL_COUNT];
+    mutable QMutex m_mutexMetrics;
+};
+
+template <typename T>
+class Executor::Task : public QRunnable
+{
+public:
+    Task(Executor *executor, Pool pool, std::function<T()> function)
+        : m_executor(executor), m_pool(pool), m_function(std::move(function))
+    {
+    }
+
+    QFuture<T> start(Priority priority)
+    {
+        QThreadPool *threadPool = m_executor->threadPool(m_pool);
+        // 设置线程池与runnable后，waitForFinished 可以在等待线程中直接执行尚未开始的任务
+        m_futureInterface.setThreadPool(threadPool);
+        m_futureInterface.setRunnable(this);
+        m_futureInterface.reportStarted();
+        QFuture<T> future = m_futureInterface.future();
+        m_queuedTimer.start();
+        m_executor->onTaskQueued(m_pool);
+        threadPool->start(this, static_cast<int>(priority));
+        return future;
+    }
+
+    void run() override
+    {
+        m_executor->onTaskStarted(m_pool, m_queuedTimer.elapsed());
+        if (!m_futureInterface.isCanceled())
+        {
+            try
+            {
+                if constexpr (std::is_void<T>::value)
+                {
+                    m_function();
+                }
+                else
+                {
+                    T result = m_function();
+                    m_futureInterface.reportResult(result);
+                }
+            }
+            catch (const QException &e)
+            {
+                m_futureInterface.reportException(e);
+            }
+            catch (...)
+            {
+                m_futureInterface.reportException(QUnhandledException());
+            }
+        }
+        m_futureInterface.reportFinished();
+        m_executor->onTaskFinished(m_pool);
+    }
+
+private:
+    Executor *m_executor;
+    Pool m_pool;
+    std::function<T()> m_function;
+    QFutureInterface<T> m_futureInterface;
+    QElapsedTimer m_queuedTimer;
+};
+
+template <typename Function>
+auto Executor::run(Pool pool, Function &&function, Priority priority) -> QFuture<decltype(function())>
+{
+    using ResultType = decltype(function());
+    // 任务执行完毕后由线程池自动删除(autoDelete)
+    Task<ResultType> *task = new Task<ResultType>(this, pool, std::forward<Function>(function));
+    return task->start(priority);
+}
+
+#endif // EXECUTOR_H
@@ -9,7 +9,7 @@
 #include <QPainter>
 #include <QTextDocument>
 #include <QListView>
-#include "DataManager.h"
+#include "Message.h"
 
 struct HistoryMessage : public Message
 {
@@ -48,7 +48,11 @@ public:
         AvatarFilePath = Qt::UserRole + 5
     };
     void addMessage(const HistoryMessage &message);
+    // 在开头插入更早的消息
+    void prependMessages(const QVector<HistoryMessage> &messages);
     const HistoryMessage *messageAt(int row) const;
+    // id 对应消息的行号，未找到时返回 -1
+    int rowOf(const QString &id) const;
     void clearCachedSizes();
     void clearAllMessage();
 
@@ -78,9 +82,21 @@ private:
 class HistoryMessageListWidget : public QListView
 {
     Q_OBJECT
+Q_SIGNALS:
+    // 滚动到顶部附近，需要加载更早的消息
+    void sig_reachedTop();
+
 public:
     explicit HistoryMessageListWidget(QWidget *parent = nullptr);
     void addMessage(const HistoryMessage &message);
+    // 在开头插入更早的消息，保持当前滚动位置
+    void prependMessages(const QVector<HistoryMessage> &messages);
+    // 消息是否超过一屏(不足一屏时无法通过滚动触发加载更早的消息)
+    bool isScrollable();
+    // 滚动到 id 对应的消息(居中显示)，未找到时返回 false
+    bool scrollToMessage(const QString &id);
+    // pos 处消息的id，没有消息时返回空字符串
+    QString messageIdAt(const QPoint &pos) const;
     void clearContext();
     // 清除消息
     void clearAllMessage();
@@ -92,6 +108,7 @@ protected:
 private:
     HistoryMessageListModel *m_model;
     CMessageDelegate *m_delegate;
+    const int LOAD_OLDER_THRESHOLD = 200; // 距离顶部多少像素时加载更早的消息
 };
 
 #endif // HISTORYMESSAGELISTWIDGET_H
\ No newline at end of file
@@ -0,0 +1,93 @@
+#ifndef JSONSCHEMAVALIDATOR_H
+#define JSONSCHEMAVALIDATOR_H
+
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QStringList>
+#include <QRegularExpression>
+#include <QHash>
+#include <QMap>
+#include <QVector>
+#include <memory>
+
+/**
+ * JSON Schema 校验器
+ *
+ * 注册工具时将 inputSchema 编译为节点树，之后每次调用只需遍历节点，不再解析schema。
+ * 支持 type、enum、const、properties、required、additionalProperties、items、数值/长度/数量范围、
+ * pattern、uniqueItems、allOf/anyOf/oneOf/not 以及文档内的 $ref；不支持的关键字(如 format)会被忽略，
+ * 只会放过不合法的参数，不会拒绝合法的参数。
+ */
+class JsonSchemaValidator
+{
+public:
+    // 编译schema，编译后的校验器不可修改，可在多个线程中使用
+    static std::shared_ptr<const JsonSchemaValidator> compile(const QJsonObject &jsonObjSchema);
+    // 校验通过返回 true，errors 中为 "路径: 原因" 格式的错误信息(最多 MAX_ERRORS 条)
+    bool validate(const QJsonValue &value, QStringList *errors = nullptr) const;
+
+private:
+    enum Type
+    {
+        Null = 1 << 0,
+        Boolean = 1 << 1,
+        Integer = 1 << 2,
+        Number = 1 << 3,
+        String = 1 << 4,
+        Array = 1 << 5,
+        Object = 1 << 6
+    };
+    struct Node
+    {
+        int types = 0; // Type 的组合，0 代表任意类型
+        QMap<QString, const Node *> properties;
+        QStringList required;
+        bool additionalPropertiesAllowed = true;
+        const Node *additionalProperties = nullptr;
+        const Node *items = nullptr;
+        QVector<const Node *> tupleItems;
+        bool hasEnum = false;
+        QJsonArray enumValues;
+        bool hasConst = false;
+        QJsonValue constValue;
+        bool hasMinimum = false;
+        double minimum = 0;
+        bool exclusiveMinimum = false;
+        bool hasMaximum = false;
+        double maximum = 0;
+        bool exclusiveMaximum = false;
+        int minLength = -1;
+        int maxLength = -1;
+        int minItems = -1;
+        int maxItems = -1;
+        int minProperties = -1;
+        int maxProperties = -1;
+        bool uniqueItems = false;
+        bool hasPattern = false;
+        QRegularExpression pattern;
+        QVector<const Node *> allOf;
+        QVector<const Node *> anyOf;
+        QVector<const Node *> oneOf;
+        const Node *notNode = nullptr;
+        const Node *ref = nullptr; // $ref 指向的节点
+    };
+
+    JsonSchemaValidator() = default;
+    const Node *compileNode(const QJsonValue &jsonValueSchema);
+    const Node *compileRef(const QString &ref);
+    Node *newNode();
+    bool validateNode(const Node *node, const QJsonValue &value, const QString &path, QStringList *errors) const;
+    static bool addError(QStringList *errors, const QString &path, const QString &message);
+    static int typeOf(const QJsonValue &value);
+    static QString typeNames(int types);
+
+private:
+    QVector<std::shared_ptr<Node>> m_nodes; // 所有节点，节点之间使用裸指针引用
+    QHash<QString, const Node *> m_refs;    // $ref - 节点
+    QJsonObject m_jsonObjRoot;              // 用于解析 $ref
+    const Node *m_root = nullptr;
+    static const int MAX_ERRORS = 10;
+};
+
+#endif // JSONSCHEMAVALIDATOR_H
@@ -5,6 +5,7 @@
 #include <mcp_message.h>
 #include <QNetworkAccessManager>
 #include "MCPService.h"
+#include "ToolRetriever.h"
 
 struct Agent;
 struct Conversation;
@@ -33,6 +34,8 @@ public:
      * @param max_retries 失败时最大重试次数（默认为3）.
      */
     void postMessage(std::shared_ptr<Conversation> conversation, std::shared_ptr<Agent> agent, const QJsonArray &tools = QJsonArray(), int max_retries = 3);
+    // 工具筛选的累计统计(仅在主线程调用)
+    ToolSelectionStats getToolSelectionStats() const;
 
 private:
     explicit LLMService(QObject *parent = nullptr);
@@ -40,11 +43,24 @@ private:
     LLMService &operator=(const LLMService &) = delete;
     void handleResponse(QNetworkReply *reply, std::shared_ptr<Conversation> conversation, std::shared_ptr<Agent> agent, std::shared_ptr<LLM> llm, const QJsonArray &tools, int retries_left);
     void handleSuccessfulResponse(const std::shared_ptr<Conversation> &conversation, const QJsonObject &jsonObjMessage);
-    QString formatMcpToolResponse(const QJsonObject &jsonObjToolCallResult, const QString &toolName, bool isVisionModel = false);
+    // 参数不合法时不调用工具，在下一轮事件循环中将错误作为工具结果返回给LLM
+    void rejectToolCall(const CallToolArgs &callToolArgs, const QString &errorMessage, const QStringList &validationErrors);
+    // 按 agent->maxToolsPerRequest 选择与对话最相关的工具，对话中调用过的工具始终保留
+    QJsonArray selectTools(std::shared_ptr<Conversation> conversation, std::shared_ptr<Agent> agent, const QJsonArray &tools);
+    QString formatMcpToolResponse(const QJsonObject &jsonObjToolCallResult, const QString &toolName, std::shared_ptr<Agent> agent, bool isVisionModel = false);
+    // 压缩工具结果: 文本中的JSON去除空白，spillBlobs 为 true 时将base64数据保存到磁盘并替换为引用id
+    static QJsonArray compactToolResultContent(const QJsonArray &jsonArrayContent, bool spillBlobs);
+    // 文本是JSON对象或数组时返回紧凑格式
+    static QString minifyJsonText(const QString &text);
+    // 超过 maxChars 时保留开头和结尾并添加说明，spillFullResult 为 true 时将完整结果保存到磁盘
+    static QString truncateToolResult(const QString &content, int maxChars, bool spillFullResult);
 
 private:
     static LLMService *s_instance;
     QNetworkAccessManager *m_networkManager;
+    ToolSelectionStats m_toolSelectionStats;
+    const int TOOL_SELECTION_CONTEXT_MESSAGES = 4;   // 参与工具筛选的最近消息数量(不包括最新的用户消息)
+    const int TOOL_SELECTION_CONTEXT_CHARS = 2000;   // 每条上下文消息最多使用的字符数
 };
 
 #endif // LLMSERVICE_H
\ No newline at end of file
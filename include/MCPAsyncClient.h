@@ -0,0 +1,95 @@
+#ifndef MCPASYNCCLIENT_H
+#define MCPASYNCCLIENT_H
+
+#include <QObject>
+#include <QHash>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QTimer>
+#include <functional>
+#include <memory>
+
+/**
+ * 基于Qt事件循环的MCP客户端基类
+ *
+ * 负责JSON-RPC请求id分配、响应匹配、超时以及服务器主动发来的请求/通知，具体的传输方式由子类实现。
+ * 所有函数都需要在客户端所在线程(主线程)调用，请求结果通过回调返回，不会占用额外线程。
+ */
+class MCPAsyncClient : public QObject
+{
+    Q_OBJECT
+
+Q_SIGNALS:
+    // 服务器发送的通知
+    void sig_notificationReceived(const QString &method, const QJsonObject &params);
+    // 连接断开(会话过期、进程退出等)，未完成的请求会以失败结束
+    void sig_disconnected(const QString &errorMessage);
+    // 接收服务器主动通知的通道可用或中断，中断期间的通知(如 resources/updated)会丢失
+    void sig_notificationChannelChanged(bool available);
+
+public:
+    using ResponseHandler = std::function<void(bool success, const QJsonObject &result, const QString &errorMessage)>;
+    using InitializeHandler = std::function<void(bool success, const QString &errorMessage)>;
+    using ListHandler = std::function<void(bool success, const QJsonArray &items, const QString &errorMessage)>;
+
+    explicit MCPAsyncClient(QObject *parent = nullptr);
+    virtual ~MCPAsyncClient() = default;
+    // 初始化连接(initialize + notifications/initialized)
+    void initialize(const QString &clientName, const QString &clientVersion, const QJsonObject &capabilities, int timeoutMs, InitializeHandler handler);
+    // 发送请求，返回请求id；timeoutMs <= 0 代表不限时
+    qint64 sendRequest(const QString &method, const QJsonObject &params, ResponseHandler handler, int timeoutMs = 0);
+    // 发送通知
+    void sendNotification(const QString &method, const QJsonObject &params = QJsonObject());
+    // 取消请求并通知服务器(notifications/cancelled)，handler 不再被调用
+    void cancelRequest(qint64 requestId, const QString &reason);
+    // 获取所有工具(自动处理分页)
+    void listTools(int timeoutMs, ListHandler handler);
+    // 获取分页列表的所有项，resultKey 为结果中列表的字段名(如 resources/list 的 resources)
+    void listAll(const QString &method, const QString &resultKey, int timeoutMs, ListHandler handler);
+    const QJsonObject &getServerCapabilities() const;
+    const QString &getProtocolVersion() const;
+    int getPendingRequestCount() const;
+    virtual bool isConnected() const = 0;
+    // 是否能收到服务器主动发送的通知，stdio 随进程一直可用
+    virtual bool hasNotificationChannel() const;
+    // 错误信息是否来自服务器返回的 JSON-RPC error(连接正常)，否则为传输层错误或超时
+    static bool isServerError(const QString &errorMessage);
+
+public:
+    static constexpr const char *MCP_PROTOCOL_VERSION = "2025-03-26";
+    static constexpr const char *SERVER_ERROR_PREFIX = "MCP error";
+    // 客户端声明的能力: 提供 roots 但不向服务器暴露本地目录(roots/list 返回空列表，列表不会变化)
+    static QJsonObject clientCapabilities();
+
+protected:
+    // 发送一条 JSON-RPC 消息，requestId 为 -1 代表通知或响应
+    virtual void writeMessage(const QJsonObject &message, qint64 requestId) = 0;
+    // 请求被取消或超时后，释放传输层为该请求占用的资源
+    virtual void abortRequest(qint64 requestId);
+    // 已发送 notifications/initialized，可以开始接收服务器主动发送的消息
+    virtual void handleInitialized();
+    // 处理收到的一条 JSON-RPC 消息(或批量消息中的一条)
+    void handleMessage(const QJsonObject &message);
+    // 传输层错误导致单个请求失败
+    void failRequest(qint64 requestId, const QString &errorMessage);
+    // 连接断开，所有请求失败
+    void failAllRequests(const QString &errorMessage);
+    bool hasPendingRequest(qint64 requestId) const;
+
+private:
+    void listPage(const QString &method, const QString &resultKey, const QString &cursor, std::shared_ptr<QJsonArray> items, int timeoutMs, ListHandler handler);
+
+private:
+    struct PendingRequest
+    {
+        QString method;
+        ResponseHandler handler;
+        QTimer *timer = nullptr;
+    };
+    QHash<qint64, PendingRequest> m_pendingRequests; // 请求id - 待响应的请求
+    qint64 m_nextRequestId = 1;
+    QJsonObject m_serverCapabilities;
+    QString m_protocolVersion;
+};
+
+#endif // MCPASYNCCLIENT_H
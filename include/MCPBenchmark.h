@@ -0,0 +1,101 @@
+#ifndef MCPBENCHMARK_H
+#define MCPBENCHMARK_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QHash>
+#include <memory>
+#include "MCPService.h"
+
+// 一组调用耗时的统计，单位: 微秒(us)
+struct MCPLatencyStats
+{
+    int count = 0;
+    int failures = 0;
+    double meanUs = 0;
+    qint64 p50Us = 0;
+    qint64 p95Us = 0;
+    qint64 p99Us = 0;
+
+    static MCPLatencyStats fromSamples(QVector<qint64> samplesUs, int failures);
+    QString toString() const;
+};
+
+/**
+ * MCPService 调用开销基准测试(开发调试用)
+ *
+ * 配合模拟MCP服务器 MockMcpServer(tools/MockMcpServer) 使用：对每个已连接、工具名以 mock_tool_ 开头的服务器，
+ * 1. 通过 MCPService::sendRawRequest 直接调用异步客户端，作为传输层与服务器本身的耗时基线；
+ * 2. 通过 MCPService::callTool 顺序调用，两者之差即 MCPService 每次调用增加的开销；
+ * 3. 通过 MCPService::callTool 同时发起大量调用，统计并行吞吐量。
+ * 另外测量转换 1000 个工具的耗时(写入临时的工具表)。结果写入日志，结束后发出 sig_finished。
+ * 仅在主线程使用，只在开启 ENABLE_MCP_BENCHMARK 时编译。
+ */
+class MCPBenchmark : public QObject
+{
+    Q_OBJECT
+Q_SIGNALS:
+    void sig_finished(const QString &report);
+
+private Q_SLOTS:
+    void slot_onToolCallFinished(const CallToolArgs &callToolArgs, bool success, const QJsonObject &jsonObjectToolCallResult, const QString &errorMessage);
+
+public:
+    explicit MCPBenchmark(QObject *parent = nullptr);
+    void start(int sequentialCalls = 200, int parallelCalls = 500);
+
+private:
+    enum Phase
+    {
+        Raw = 0,      // 直接调用异步客户端
+        Service = 1,  // 通过 MCPService 顺序调用
+        Parallel = 2  // 通过 MCPService 并行调用
+    };
+    struct Target
+    {
+        QString serverUuid;
+        QString serverName;
+        QString transport;
+        QString toolName; // 服务器中的工具名称
+        QString toolId;   // MCPService 中的工具id
+        MCPLatencyStats raw;
+        MCPLatencyStats service;
+        double throughput = 0; // 并行调用吞吐量，单位: 次/秒
+        int parallelFailures = 0;
+    };
+
+    // 测量 MCPService::buildTools 转换 TOOL_COUNT 个工具的平均耗时，单位: 毫秒(ms)
+    double benchmarkBuildTools();
+    QVector<Target> findTargets();
+    // 执行当前目标的当前阶段，全部完成后输出报告
+    void runNext();
+    // 先 ping 一次(必要时重新启动进程)，再开始直接调用
+    void warmUp();
+    void runRawCall();
+    void runServiceCall();
+    void runParallelCalls();
+    void finishPhase();
+    CallToolArgs buildCallToolArgs();
+    QString buildReport() const;
+
+private:
+    QVector<Target> m_targets;
+    int m_targetIndex = 0;
+    Phase m_phase = Raw;
+    int m_sequentialCalls = 0;
+    int m_parallelCalls = 0;
+    int m_completedCalls = 0;
+    int m_failedCalls = 0;
+    qint64 m_callSequence = 0;
+    QVector<qint64> m_samplesUs;
+    QHash<QString, qint64> m_pendingCalls; // callId - 开始时间(ns)
+    QElapsedTimer m_clock;
+    double m_buildToolsMs = 0;
+
+    static constexpr const char *TOOL_NAME_PREFIX = "mock_tool_";
+    static constexpr int TOOL_COUNT = 1000;
+    static constexpr int BUILD_TOOLS_ROUNDS = 5;
+};
+
+#endif // MCPBENCHMARK_H
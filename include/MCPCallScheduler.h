@@ -0,0 +1,69 @@
+#ifndef MCPCALLSCHEDULER_H
+#define MCPCALLSCHEDULER_H
+
+#include <QObject>
+#include <QHash>
+#include <QQueue>
+#include <QElapsedTimer>
+#include <functional>
+
+struct MCPCallQueueMetrics
+{
+    int queueLength = 0;        // 排队中的调用数量
+    int inFlight = 0;           // 正在执行的调用数量
+    int maxInFlight = 1;        // 最大并发调用数量
+    qint64 dispatchedCalls = 0; // 已派发的调用总数
+    qint64 totalWaitMs = 0;     // 累计排队等待时间，单位: 毫秒(ms)
+    qint64 maxWaitMs = 0;       // 最长排队等待时间，单位: 毫秒(ms)
+
+    // 平均排队等待时间，单位: 毫秒(ms)
+    double averageWaitMs() const;
+};
+
+/**
+ * 按MCP服务器排队执行工具调用
+ *
+ * 每个服务器一个队列，限制同时执行的调用数量；同一服务器内按对话轮转派发，避免单个对话的大量并行调用饿死其他对话。
+ * 除 release 外，所有函数都需要在主线程调用。
+ */
+class MCPCallScheduler : public QObject
+{
+    Q_OBJECT
+
+Q_SIGNALS:
+    void sig_queueMetricsChanged(const QString &serverUuid);
+
+public:
+    // 在主线程执行，负责启动调用；调用结束后必须调用 release(serverUuid) 归还名额
+    using Task = std::function<void()>;
+
+    explicit MCPCallScheduler(QObject *parent = nullptr);
+    ~MCPCallScheduler() = default;
+    // 设置服务器最大并发调用数量
+    void setMaxInFlight(const QString &serverUuid, int maxInFlight);
+    // 将调用加入服务器队列
+    void enqueue(const QString &serverUuid, const QString &conversationUuid, Task task);
+    // 调用结束，归还名额并派发下一个调用（可在任意线程调用）
+    void release(const QString &serverUuid);
+    // 获取服务器队列状态
+    MCPCallQueueMetrics metrics(const QString &serverUuid) const;
+
+private:
+    void dispatch(const QString &serverUuid);
+
+private:
+    struct PendingCall
+    {
+        Task task;
+        QElapsedTimer waitTimer;
+    };
+    struct ServerQueue
+    {
+        QHash<QString, QQueue<PendingCall>> pendingCalls; // conversationUuid - 待执行的调用
+        QQueue<QString> conversationOrder;                // 有待执行调用的对话的轮转顺序
+        MCPCallQueueMetrics metrics;
+    };
+    QHash<QString, ServerQueue> m_queues; // 服务器uuid - 队列
+};
+
+#endif // MCPCALLSCHEDULER_H
@@ -0,0 +1,57 @@
+#ifndef MCPRESOURCECACHE_H
+#define MCPRESOURCECACHE_H
+
+#include <QCache>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QJsonArray>
+
+// resources/read 返回的一项内容
+struct MCPResourceContent
+{
+    QString uri;
+    QString mimeType;
+    QString text;    // 文本资源的内容
+    QString blobId;  // 二进制资源保存在 ToolResultStore 中的id(不在内存中保留base64数据)
+    qint64 size = 0; // 内容大小，单位: 字节
+
+    bool isBlob() const;
+    // 从 resources/read 结果中的 contents 转换，二进制内容分块解码后写入磁盘
+    static QVector<MCPResourceContent> fromJsonArray(const QJsonArray &jsonArrayContents);
+};
+
+/**
+ * MCP资源内容缓存
+ *
+ * 服务器支持订阅且客户端能收到通知时，缓存一直有效，直到收到 notifications/resources/updated 或通知通道中断；
+ * 否则只在 UNSUBSCRIBED_TTL_MS 内有效。按文本大小计入内存上限(LRU淘汰)。
+ * 仅在主线程使用。
+ */
+class MCPResourceCache
+{
+public:
+    explicit MCPResourceCache(int maxCostBytes = 32 * 1024 * 1024);
+    bool lookup(const QString &serverUuid, const QString &uri, QVector<MCPResourceContent> &contents);
+    void insert(const QString &serverUuid, const QString &uri, const QVector<MCPResourceContent> &contents, bool subscribed);
+    void invalidate(const QString &serverUuid, const QString &uri);
+    void invalidateServer(const QString &serverUuid);
+    qint64 hits() const;
+    qint64 misses() const;
+
+private:
+    static QString buildKey(const QString &serverUuid, const QString &uri);
+
+private:
+    struct Entry
+    {
+        QVector<MCPResourceContent> contents;
+        bool subscribed = false;
+        QElapsedTimer insertedTimer;
+    };
+    QCache<QString, Entry> m_cache; // 服务器uuid + uri - 资源内容
+    qint64 m_hits = 0;
+    qint64 m_misses = 0;
+    const qint64 UNSUBSCRIBED_TTL_MS = 30000; // 未订阅的资源缓存时间
+};
+
+#endif // MCPRESOURCECACHE_H
@@ -5,10 +5,21 @@
 #include <QHash>
 #include <memory>
 #include <mcp_sse_client.h>
-#include <mcp_stdio_client.h>
 #include <QFuture>
 #include "DataManager.h"
 #include <QMutex>
+#include <QDateTime>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <atomic>
+#include <functional>
+#include <QNetworkAccessManager>
+#include "MCPCallScheduler.h"
+#include "MCPAsyncClient.h"
+#include "MCPStdioClient.h"
+#include "MCPToolResultCache.h"
+#include "JsonSchemaValidator.h"
+#include "MCPResourceCache.h"
 
 struct MCPTool
 {
@@ -16,6 +27,8 @@ struct MCPTool
     QString name;            // 工具原有的名字
     QString serverUuid;      // 所在mcp服务器uuid
     QJsonObject jsonObjTool; // 转换为json的工具
+    QJsonObject annotations; // 服务器提供的工具注解(readOnlyHint、idempotentHint等)
+    std::shared_ptr<const JsonSchemaValidator> argumentsValidator; // 注册时由 inputSchema 编译的参数校验器
     MCPTool(const QString &name, const QString &serverUuid, const QJsonObject &jsonObjTool = QJsonObject());
 
 private:
@@ -23,10 +36,26 @@ private:
     QString buildFunctionCallToolName(const QString &serverUuid, const QString &toolName);
 };
 
+// stdio服务器进程池中的一个副本
+struct MCPReplica
+{
+    std::shared_ptr<MCPAsyncClient> client;
+    QElapsedTimer idleTimer; // 最近一次分配调用后计时
+};
+
 struct MCPClient
 {
-    std::unique_ptr<mcp::client> client;
-    QVector<QString> tools; // 缓存该服务器所有工具通过 buildFunctionCallToolName 函数处理后的名字
+    std::unique_ptr<mcp::client> client;          // 阻塞式客户端(cpp-mcp，仅sse)，在线程池中调用
+    std::shared_ptr<MCPAsyncClient> asyncClient; // 基于事件循环的客户端，在主线程调用(与 client 二选一)
+    QVector<QString> tools;                      // 缓存该服务器所有工具通过 buildFunctionCallToolName 函数处理后的名字
+    QVector<MCPReplica> replicas;                // 进程池模式下额外启动的stdio进程(不包括 asyncClient，仅在主线程访问)
+    int startingReplicas = 0;                    // 正在启动的副本数量
+    // 空闲关闭(仅stdio，仅在主线程访问)
+    bool isSuspended = false;                    // 进程已因空闲关闭，工具列表仍然有效
+    bool isResuming = false;                     // 正在重新启动进程
+    QElapsedTimer lastActiveTimer;               // 最近一次调用后计时
+    QVector<std::function<void(bool success, const QString &errorMessage)>> resumeCallbacks; // 等待进程重新启动的调用
+    QSet<QString> subscribedResources;           // 已订阅更新通知的资源uri(仅在主线程访问)
 };
 
 struct CallToolArgs
@@ -38,6 +67,58 @@ struct CallToolArgs
 };
 Q_DECLARE_METATYPE(CallToolArgs)
 
+// 单次工具调用的状态，调用结果与超时只有先到达的一方生效
+struct ToolCallContext
+{
+    CallToolArgs callToolArgs;
+    QString serverUuid;
+    QString toolName;
+    QElapsedTimer elapsedTimer;          // 开始执行后计时
+    std::function<void()> cancelHandler; // 由传输层设置，用于取消正在执行的请求(在主线程调用)，为空代表无法取消
+    std::weak_ptr<MCPAsyncClient> asyncClient; // 执行调用的异步客户端(进程池模式下为选中的副本)
+    QString cacheKey;                    // 结果缓存键，为空代表不缓存
+    int cacheTtlSeconds = 0;             // 结果缓存时间，单位: 秒(s)
+    std::atomic_bool settled{false};
+
+    // 标记调用已结束，返回 false 代表已经被另一方结束
+    bool settle()
+    {
+        return !settled.exchange(true);
+    }
+};
+
+struct MCPServerHealth
+{
+    enum State
+    {
+        Unknown = 0,     // 尚未检测
+        Healthy = 1,     // 正常(熔断器关闭)
+        Unhealthy = 2,   // 不可用(熔断器打开，等待重连)
+        Reconnecting = 3, // 正在重连(熔断器半开)
+        Suspended = 4     // 空闲时已关闭进程，下次调用时重新启动
+    };
+    State state = Unknown;
+    int consecutiveFailures = 0; // 连续失败次数
+    int reconnectAttempts = 0;   // 本轮连续重连失败次数(用于计算退避时间)
+    int reconnectCount = 0;      // 累计重连成功次数
+    bool isChecking = false;     // 是否正在检测连通性
+    qint64 latencyMs = -1;       // 最近一次ping耗时，单位: 毫秒(ms)
+    QDateTime lastCheckedTime;   // 最近一次检测时间
+    QDateTime nextReconnectTime; // 下一次重连时间
+    QString lastError;           // 最近一次错误信息
+    // 空闲关闭统计
+    int idleShutdownCount = 0;          // 空闲关闭次数
+    qint64 reclaimedMemoryBytes = 0;    // 空闲关闭累计回收的内存(RSS)，单位: 字节
+    int relaunchCount = 0;              // 重新启动次数
+    qint64 lastRelaunchLatencyMs = -1;  // 最近一次重新启动耗时，单位: 毫秒(ms)
+    qint64 totalRelaunchLatencyMs = 0;  // 累计重新启动耗时，单位: 毫秒(ms)
+    int rejectedToolCalls = 0;          // 参数校验失败、未发送到服务器的调用数(每次省去一次服务器往返)
+
+    // 熔断器打开期间调用直接失败，不再等待超时
+    bool isCircuitOpen() const;
+    static QString stateName(State state);
+};
+
 class MCPService : public QObject
 {
     Q_OBJECT
@@ -46,16 +127,16 @@ Q_SIGNALS:
     void sig_clientReady(const QString &serverUuid, std::shared_ptr<MCPClient> client);
     void sig_clientError(const QString &serverUuid, const QString &errorMessage);
     void sig_toolCallFinished(const CallToolArgs &callToolArgs, bool success, const QJsonObject &jsonObjectToolCallResult, const QString &errorMessage);
-    // void sig_checkMcpConnectivityFinished(const QString &serverUuid, bool success);
+    void sig_checkMcpConnectivityFinished(const QString &serverUuid, bool success);
+    void sig_serverHealthChanged(const QString &serverUuid);
+
+private Q_SLOTS:
+    // 定时检测所有客户端的连通性
+    void slot_onHealthCheckTimeout();
 
 public:
-    /**
-     *
-        this.listPrompts = this.listPrompts.bind(this)
-        this.getPrompt = this.getPrompt.bind(this)
-        this.listResources = this.listResources.bind(this)
-        this.getResource = this.getResource.bind(this)
-     */
+    using ResourceHandler = std::function<void(bool success, const QVector<MCPResourceContent> &contents, const QString &errorMessage)>;
+
     static MCPService *getInstance();
     ~MCPService() = default;
     void initClient(const QString &serverUuid);
@@ -63,17 +144,97 @@ public:
     void callTool(const CallToolArgs &callToolArgs);
     QJsonArray getToolsFromServer(const QString &serverUuid);
     QJsonArray getToolsFromServers(const QSet<QString> mcpServers);
-    // void checkMcpConnectivity(const QString &serverUuid);
+    // ping 服务器，失败时打开熔断器并自动重连
+    void checkMcpConnectivity(const QString &serverUuid);
     bool isInitialized(const QString &serverUuid);
+    MCPServerHealth getServerHealth(const QString &serverUuid) const;
+    // 正在运行的服务器进程数(stdio)，未初始化时返回 0
+    int getReplicaCount(const QString &serverUuid);
+    // 服务器所有进程(stdio)实际使用的资源
+    MCPProcessUsage getResourceUsage(const QString &serverUuid);
+    // 按工具的 inputSchema 校验参数，工具不存在时返回 true(由 callTool 返回错误)
+    bool validateToolArguments(const QString &toolId, const QJsonObject &arguments, QStringList *errors);
+    // 记录一次在发送前被拒绝的调用(仅在主线程调用)
+    void recordRejectedToolCall(const QString &toolId);
+    // 构建返回给LLM的结构化错误信息
+    static QString buildStructuredError(const QString &code, const QString &message, const QJsonObject &details = QJsonObject());
+    // 资源与提示词(仅在主线程调用，仅支持 stdio 与 streamableHttp)，回调可能在函数返回前执行
+    void listResources(const QString &serverUuid, MCPAsyncClient::ListHandler callback);
+    // 读取资源内容，优先使用缓存；同一资源正在读取时合并为一次请求
+    void readResource(const QString &serverUuid, const QString &uri, ResourceHandler callback);
+    void listPrompts(const QString &serverUuid, MCPAsyncClient::ListHandler callback);
+    void getPrompt(const QString &serverUuid, const QString &name, const QJsonObject &arguments, MCPAsyncClient::ResponseHandler callback);
+    // 服务器工具结果缓存的命中统计
+    MCPToolCacheStats getToolCacheStats(const QString &serverUuid) const;
+    // 服务器工具调用队列的状态(仅在主线程调用)
+    MCPCallQueueMetrics getCallQueueMetrics(const QString &serverUuid) const;
+    // 服务器已注册的工具: (MCPTool)id - 工具原有的名字
+    QHash<QString, QString> getToolNames(const QString &serverUuid);
+    // 直接通过异步客户端发送请求(已休眠时先重新启动)，不经过调用队列、参数校验与结果缓存，用于与 callTool 对照(仅在主线程调用)
+    void sendRawRequest(const QString &serverUuid, const QString &method, const QJsonObject &params, MCPAsyncClient::ResponseHandler callback, int timeoutMs);
+    // 将 tools/list 返回的原始工具转换为 MCPTool(编译参数校验器)并写入 toolTable，返回工具id；registerTools 写入的是 m_tools
+    static QVector<QString> buildTools(const QString &serverUuid, const QJsonArray &jsonArrayTools, QHash<QString, std::shared_ptr<MCPTool>> &toolTable);
 
 private:
     explicit MCPService(QObject *parent = nullptr);
     MCPService(const MCPService &) = delete;
     MCPService &operator=(const MCPService &) = delete;
-    std::shared_ptr<MCPClient> createStdioClient(std::shared_ptr<McpServer> server);
     std::shared_ptr<MCPClient> createSSEClient(std::shared_ptr<McpServer> server);
     std::shared_ptr<MCPClient> createMCPClient(const QString &serverUuid);
+    // 在主线程异步创建 stdio 客户端
+    QFuture<std::shared_ptr<MCPClient>> createStdioClient(std::shared_ptr<McpServer> server);
+    // 在主线程异步创建 Streamable HTTP 客户端
+    QFuture<std::shared_ptr<MCPClient>> createStreamableHttpClient(std::shared_ptr<McpServer> server);
+    // 初始化异步客户端并获取工具列表
+    QFuture<std::shared_ptr<MCPClient>> initializeAsyncClient(const QString &serverUuid, std::shared_ptr<MCPAsyncClient> asyncClient, int timeoutMs);
+    // 根据服务器类型选择创建方式，返回的 QFuture 在客户端创建完成(或失败)后结束
+    QFuture<std::shared_ptr<MCPClient>> startCreateClient(const QString &serverUuid);
     QVector<QString> registerTools(const QString &serverUuid, mcp::client *client);
+    // 注册服务器返回的原始工具列表(tools/list 中的 tools)
+    QVector<QString> registerTools(const QString &serverUuid, const QJsonArray &jsonArrayTools);
+    // 处理异步客户端的通知
+    void handleAsyncClientNotification(const QString &serverUuid, const QString &method, const QJsonObject &params);
+    // 在工具调用线程池中执行调用
+    void executeToolCall(std::shared_ptr<MCPClient> mcpClient, std::shared_ptr<MCPTool> mcpTool, std::shared_ptr<ToolCallContext> context);
+    // 通过异步客户端发起调用(在主线程调用)
+    void executeToolCallAsync(std::shared_ptr<MCPClient> mcpClient, std::shared_ptr<MCPTool> mcpTool, std::shared_ptr<ToolCallContext> context);
+    // 返回调用结果并归还名额，结果与超时只有先到达的一方生效(可在任意线程调用)
+    void finishToolCall(std::shared_ptr<ToolCallContext> context, bool success, const QJsonObject &jsonObjToolCallResult, const QString &errorMessage, bool connectionFailed);
+    // 调用超过截止时间，返回超时错误并归还名额(在主线程调用)
+    void onToolCallTimeout(std::shared_ptr<ToolCallContext> context, int timeoutSeconds);
+    // 在下一轮事件循环中返回调用失败结果(调用方可能在 callTool 返回后才记录待处理的调用)
+    void failToolCallLater(const CallToolArgs &callToolArgs, const QString &errorMessage);
+    // 工具是否可以缓存结果(注解声明只读/幂等，或用户标记为可缓存)
+    static bool isToolCacheable(std::shared_ptr<McpServer> mcpServer, std::shared_ptr<MCPTool> mcpTool);
+    // 健康状态(仅在主线程调用)
+    void recordSuccess(const QString &serverUuid);
+    void recordFailure(const QString &serverUuid, const QString &errorMessage);
+    void openCircuit(const QString &serverUuid, const QString &errorMessage);
+    void scheduleReconnect(const QString &serverUuid);
+    void reconnectClient(const QString &serverUuid);
+    // 在后台线程释放客户端(断开的客户端析构时可能阻塞)
+    void releaseClientLater(std::shared_ptr<MCPClient> client);
+    // 进程池(仅在主线程调用)
+    // 选择负载最低的进程，所有进程都在处理请求时按需启动新副本
+    std::shared_ptr<MCPAsyncClient> selectReplica(const QString &serverUuid, std::shared_ptr<MCPClient> mcpClient);
+    void startReplica(const QString &serverUuid, std::shared_ptr<MCPClient> mcpClient);
+    // 移除副本，返回 false 代表不是该客户端的副本
+    bool retireReplica(const QString &serverUuid, std::shared_ptr<MCPClient> mcpClient, MCPAsyncClient *asyncClient);
+    // 回收空闲副本并补足最少进程数
+    void maintainReplicas(const QString &serverUuid, std::shared_ptr<MCPClient> mcpClient);
+    // 空闲关闭(仅在主线程调用)
+    // 超过空闲时间且没有调用时关闭进程，返回是否已关闭
+    bool suspendIdleClient(const QString &serverUuid, std::shared_ptr<MCPClient> mcpClient);
+    // 重新启动已关闭的进程，callback 为空代表只预热
+    void resumeClient(const QString &serverUuid, std::shared_ptr<MCPClient> mcpClient, std::function<void(bool success, const QString &errorMessage)> callback);
+    // 连接异步客户端的通知与断开信号
+    void connectAsyncClient(const QString &serverUuid, MCPAsyncClient *asyncClient);
+    // 获取可用的异步客户端(已休眠时先重新启动)，失败时 mcpClient 为空
+    void acquireAsyncClient(const QString &serverUuid, std::function<void(std::shared_ptr<MCPClient> mcpClient, const QString &errorMessage)> callback);
+    // 订阅资源的更新通知(服务器支持时)，更新后清除缓存
+    void subscribeResource(const QString &serverUuid, std::shared_ptr<MCPClient> mcpClient, const QString &uri);
+    // 创建stdio客户端并启动进程(应用资源限制)
+    std::shared_ptr<MCPAsyncClient> startStdioProcess(std::shared_ptr<McpServer> server);
 
 private:
     static MCPService *s_instance;
@@ -83,6 +244,18 @@ private:
     QMutex m_mutexPendingClients;
     QHash<QString, std::shared_ptr<MCPTool>> m_tools; // (MCPTool)id - mcpClient
     QMutex m_mutexTools;
+    MCPCallScheduler *m_callScheduler; // 按服务器排队执行工具调用
+    MCPToolResultCache m_toolResultCache; // 只读/幂等工具的调用结果
+    MCPResourceCache m_resourceCache;     // 资源内容(仅在主线程访问)
+    QHash<QString, QVector<ResourceHandler>> m_pendingResourceReads; // 服务器uuid + uri - 等待读取结果的回调
+    QHash<QString, MCPServerHealth> m_health; // 服务器uuid - 健康状态
+    QTimer *m_timerHealthCheck;
+    QNetworkAccessManager *m_networkAccessManager; // 所有HTTP客户端共享，复用连接
+    const int HEALTH_CHECK_INTERVAL_MS = 30000; // 连通性检测间隔
+    const int FAILURE_THRESHOLD = 3;            // 连续失败多少次后打开熔断器
+    const int RECONNECT_BASE_DELAY_MS = 1000;   // 重连初始退避时间
+    const int RECONNECT_MAX_DELAY_MS = 60000;   // 重连最大退避时间
+    const int REPLICA_IDLE_TIMEOUT_MS = 60000;  // 副本空闲多久后回收
 };
 
 #endif // MCPSERVICE_H
\ No newline at end of file
@@ -0,0 +1,87 @@
+#ifndef MCPSTDIOCLIENT_H
+#define MCPSTDIOCLIENT_H
+
+#include "MCPAsyncClient.h"
+#include <QProcess>
+#include <QMap>
+
+// 服务器进程的资源限制(仅Linux生效)，0 代表不限制
+struct MCPProcessLimits
+{
+    int cpuQuotaPercent = 0; // CPU配额，100 代表一个核心(cgroup v2 cpu.max，不可用时不生效)
+    int memoryLimitMB = 0;   // 内存上限(cgroup v2 memory.max，不可用时使用 RLIMIT_AS)
+    int niceValue = 0;       // 调度优先级(nice)，1~19，越大越低
+    int ioPriorityClass = 0; // IO优先级类别: 0 不设置，2 best-effort(最低级别)，3 idle
+    int maxOpenFiles = 0;    // 最大打开文件数(RLIMIT_NOFILE)
+
+    bool isEmpty() const;
+};
+
+// 服务器进程实际使用的资源
+struct MCPProcessUsage
+{
+    qint64 cpuTimeMs = 0;                // 累计CPU时间(用户态+内核态)，单位: 毫秒(ms)
+    qint64 residentMemoryBytes = 0;      // 当前常驻内存，单位: 字节
+    qint64 peakResidentMemoryBytes = 0;  // 常驻内存峰值，单位: 字节
+    int processCount = 0;                // 统计的进程数
+    int cgroupCount = 0;                 // 其中运行在独立cgroup中的进程数
+    QString limitsError;                 // CPU配额或内存上限未能通过cgroup生效的原因，为空代表已生效或未设置
+
+    MCPProcessUsage &operator+=(const MCPProcessUsage &other);
+};
+
+/**
+ * stdio 传输的MCP客户端
+ *
+ * 通过 QProcess 启动服务器，每条 JSON-RPC 消息占一行(以 '\n' 分隔)。
+ * 多个请求通过id在同一个管道上流水线发送，响应在 readyRead 中增量解析，不会为每次调用占用线程。
+ */
+class MCPStdioClient : public MCPAsyncClient
+{
+    Q_OBJECT
+
+public:
+    MCPStdioClient(const QString &command,
+                   const QVector<QString> &args,
+                   const QMap<QString, QString> &envVars,
+                   const MCPProcessLimits &limits = MCPProcessLimits(),
+                   QObject *parent = nullptr);
+    ~MCPStdioClient();
+    // 启动服务器进程，进程启动前写入的消息会在启动后发送
+    void start();
+    bool isConnected() const override;
+    qint64 processId() const;
+    // 服务器进程的常驻内存(RSS)，单位: 字节，无法获取时返回 -1
+    qint64 getResidentMemoryBytes() const;
+    // 服务器进程(使用cgroup时包括子进程)的资源使用情况
+    MCPProcessUsage getResourceUsage() const;
+
+protected:
+    void writeMessage(const QJsonObject &message, qint64 requestId) override;
+
+private:
+    void handleReadyReadStandardOutput();
+    void handleReadyReadStandardError();
+    void handleProcessExited(const QString &errorMessage);
+    void parseLine(const QByteArray &line);
+    // 启动进程前创建cgroup并写入限制，成功返回cgroup目录，失败时返回空并设置原因
+    QString setupCgroup(QString &errorMessage);
+    // 进程启动后检查是否已加入cgroup
+    void checkCgroupMembership();
+    void removeCgroup();
+
+private:
+    QProcess *m_process;
+    QString m_command;
+    MCPProcessLimits m_limits;
+    QString m_cgroupPath;     // 进程所在的cgroup目录，为空代表未使用cgroup
+    QString m_limitsError;    // CPU配额或内存上限未能生效的原因
+    bool m_isConnected = false;
+    QByteArray m_buffer;              // 未处理的标准输出
+    int m_bufferScannedBytes = 0;     // m_buffer 中已确认没有换行的字节数
+    QByteArray m_bufferStandardError; // 未处理的标准错误
+    QList<QByteArray> m_pendingWrites; // 进程启动前写入的消息
+    const int SHUTDOWN_TIMEOUT_MS = 2000; // 关闭标准输入后等待进程退出的时间
+};
+
+#endif // MCPSTDIOCLIENT_H
@@ -0,0 +1,82 @@
+#ifndef MCPSTREAMABLEHTTPCLIENT_H
+#define MCPSTREAMABLEHTTPCLIENT_H
+
+#include "MCPAsyncClient.h"
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QUrl>
+#include <QSet>
+#include <QMap>
+
+/**
+ * Streamable HTTP 传输的MCP客户端
+ *
+ * 每个请求一次POST，服务器可以直接返回JSON，也可以返回SSE流；SSE流中断时通过 Last-Event-ID 恢复。
+ * 初始化后通过GET打开独立的SSE流接收服务器主动发送的通知与请求，服务器返回405时不使用。
+ * 所有客户端共享同一个 QNetworkAccessManager，并发请求复用 keep-alive 连接。
+ * HTTP/2 多路复用只在 https 上通过 ALPN 协商，Qt 不会对明文 http 使用 h2c，此时为 HTTP/1.1(每个主机最多6个并发连接，其中一个被通知流占用)。
+ */
+class MCPStreamableHttpClient : public MCPAsyncClient
+{
+    Q_OBJECT
+
+public:
+    MCPStreamableHttpClient(QNetworkAccessManager *networkAccessManager,
+                            const QUrl &url,
+                            const QMap<QByteArray, QByteArray> &requestHeaders,
+                            QObject *parent = nullptr);
+    ~MCPStreamableHttpClient();
+    bool isConnected() const override;
+    bool hasNotificationChannel() const override;
+    // 解析 "Key=Value" 格式(每行一个)的请求头
+    static QMap<QByteArray, QByteArray> parseRequestHeaders(const QString &requestHeaders);
+
+protected:
+    void writeMessage(const QJsonObject &message, qint64 requestId) override;
+    void abortRequest(qint64 requestId) override;
+    void handleInitialized() override;
+
+private:
+    struct Stream
+    {
+        bool isEventStream = false; // 响应为SSE流
+        bool isResume = false;      // 通过GET恢复的流
+        bool isNotification = false; // 通过GET打开的独立通知流
+        QByteArray buffer;          // 未处理的数据
+        QSet<qint64> requestIds;    // 等待该流返回响应的请求
+        QString lastEventId;        // 最近一次收到的事件id
+        QString eventId;            // 正在解析的事件id
+        QByteArray eventData;       // 正在解析的事件数据
+        int resumeAttempts = 0;     // 已恢复次数
+    };
+    QNetworkRequest buildRequest() const;
+    void trackReply(QNetworkReply *reply, std::shared_ptr<Stream> stream);
+    void handleReadyRead(QNetworkReply *reply);
+    void handleFinished(QNetworkReply *reply);
+    // 解析缓冲区中完整的SSE事件
+    void parseEventStream(Stream &stream);
+    void dispatchPayload(Stream &stream, const QByteArray &payload);
+    void resumeStream(const Stream &stream);
+    // 打开独立的通知流，中断后延迟重新打开
+    void openNotificationStream();
+    void handleNotificationStreamFinished(Stream &stream, int statusCode, QNetworkReply::NetworkError error);
+    void setNotificationChannel(bool available);
+    void disconnectSession(const QString &errorMessage);
+
+private:
+    QNetworkAccessManager *m_networkAccessManager;
+    QUrl m_url;
+    QMap<QByteArray, QByteArray> m_requestHeaders;
+    QByteArray m_sessionId;
+    bool m_isConnected = true;
+    QHash<QNetworkReply *, std::shared_ptr<Stream>> m_streams; // 回调中可能发送新请求，使用指针保证解析期间流对象有效
+    QNetworkReply *m_notificationReply = nullptr;              // 独立的通知流，为空代表未打开
+    bool m_hasNotificationChannel = false;                     // 通知流已建立(200 text/event-stream)
+    QString m_notificationLastEventId;                         // 通知流最近一次收到的事件id，重新打开时用于恢复
+    int m_notificationRetries = 0;                             // 通知流连续重新打开的次数
+    const int MAX_RESUME_ATTEMPTS = 3;
+    const int NOTIFICATION_STREAM_RETRY_MS = 5000;
+    const int MAX_NOTIFICATION_STREAM_RETRIES = 5;
+};
+
+#endif // MCPSTREAMABLEHTTPCLIENT_H
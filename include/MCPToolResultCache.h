@@ -0,0 +1,57 @@
+#ifndef MCPTOOLRESULTCACHE_H
+#define MCPTOOLRESULTCACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QElapsedTimer>
+
+struct MCPToolCacheStats
+{
+    qint64 hits = 0;        // 命中次数
+    qint64 misses = 0;      // 未命中次数(实际调用服务器)
+    qint64 timeSavedMs = 0; // 命中时省去的调用耗时，单位: 毫秒(ms)
+
+    // 命中率(0~1)
+    double hitRate() const;
+    MCPToolCacheStats &operator+=(const MCPToolCacheStats &other);
+};
+
+/**
+ * 只读/幂等MCP工具的调用结果缓存
+ *
+ * 以 服务器uuid + 工具名 + 规范化参数 作为键，按结果大小计入内存上限(LRU淘汰)，每条结果有独立的过期时间。
+ * 线程安全，可在工具调用线程中写入。
+ */
+class MCPToolResultCache
+{
+public:
+    explicit MCPToolResultCache(int maxCostBytes = 8 * 1024 * 1024);
+    // 构建缓存键，参数对象的键已排序，紧凑序列化即为规范形式
+    static QString buildKey(const QString &serverUuid, const QString &toolName, const QJsonObject &arguments);
+    // 查找未过期的结果，toolId 用于统计
+    bool lookup(const QString &key, const QString &toolId, QJsonObject &jsonObjResult);
+    // 写入结果，elapsedMs 为本次调用耗时，ttlSeconds <= 0 时不缓存
+    void insert(const QString &key, const QString &toolId, const QJsonObject &jsonObjResult, qint64 elapsedMs, int ttlSeconds);
+    // 清除服务器的所有缓存(工具列表变化、重连后结果可能失效)
+    void invalidateServer(const QString &serverUuid);
+    MCPToolCacheStats toolStats(const QString &toolId) const;
+    // 服务器所有工具的统计，工具id以服务器uuid前缀区分
+    MCPToolCacheStats serverStats(const QString &serverUuid) const;
+
+private:
+    struct Entry
+    {
+        QJsonObject jsonObjResult;
+        QElapsedTimer insertedTimer; // 写入后计时
+        qint64 ttlMs = 0;
+        qint64 elapsedMs = 0; // 原始调用耗时
+    };
+    QCache<QString, Entry> m_cache;                  // 缓存键 - 结果
+    QHash<QString, MCPToolCacheStats> m_stats;       // 工具id - 统计
+    QHash<QString, QString> m_toolServers;           // 工具id - 服务器uuid
+    mutable QMutex m_mutex;
+};
+
+#endif // MCPTOOLRESULTCACHE_H
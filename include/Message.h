@@ -0,0 +1,77 @@
+#ifndef MESSAGE_H
+#define MESSAGE_H
+
+#include <QString>
+#include <QJsonArray>
+#include <QMetaType>
+#include <global.h>
+
+struct Message
+{
+    QString id;
+    QString content;
+    enum Role
+    {
+        USER = 0,
+        ASSISTANT = 1,
+        TOOL = 2,
+        SYSTEM = 3,
+        UNKNOWN = 4
+    };
+    Role role;
+    QString createdTime;
+    QJsonArray toolCalls;
+    QString toolCallId;
+    QString avatarFilePath;
+    qint64 seq = 0; // 数据库中的序号，0 代表尚未写入数据库
+
+    Message() : role(UNKNOWN) {}
+
+    Message(const QString &id,
+            const QString &content,
+            Role role,
+            const QString &createdTime,
+            const QJsonArray &toolCalls,
+            const QString &toolCallId,
+            const QString &avatarFilePath)
+        : id(id), content(content), role(role), createdTime(createdTime), toolCalls(toolCalls), toolCallId(toolCallId), avatarFilePath(avatarFilePath)
+    {
+    }
+
+    Message(const QString &content,
+            Role role,
+            const QString &createdTime,
+            const QJsonArray &toolCalls = QJsonArray(),
+            const QString &toolCallId = QString())
+        : id(generateUuid()), content(content), role(role), createdTime(createdTime), toolCalls(toolCalls), toolCallId(toolCallId)
+    {
+        if (this->avatarFilePath.isEmpty())
+        {
+            switch (role)
+            {
+            case Role::USER:
+                this->avatarFilePath = QString(DEFAULT_AVATAR_USER);
+                break;
+            case Role::ASSISTANT:
+                this->avatarFilePath = QString(DEFAULT_AVATAR_LLM);
+                break;
+            case Role::TOOL:
+                this->avatarFilePath = QString(AVATAR_TOOL);
+                break;
+            case Role::SYSTEM:
+                this->avatarFilePath = QString(AVATAR_SYSTEM);
+                break;
+            default:
+                this->avatarFilePath = QString(AVATAR_UNKNOW);
+                break;
+            }
+        }
+    }
+
+    // 与数据库中 role 列的文本相互转换
+    static QString roleToString(Role role);
+    static Role roleFromString(const QString &role);
+};
+Q_DECLARE_METATYPE(Message)
+
+#endif // MESSAGE_H
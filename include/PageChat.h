@@ -2,13 +2,22 @@
 #define PAGECHAT_H
 
 #include "BaseWidget.hpp"
+#include "BaseDialog.hpp"
 #include <QListWidget>
 #include <QLabel>
 #include <QPlainTextEdit>
 #include <QPushButton>
 #include <QTabWidget>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QTimer>
+#include <QMenu>
+#include <QJsonObject>
+#include <QSet>
 #include "HistoryMessageListWidget.h"
 #include "AgentListWidget.h"
+#include "MCPResourceCache.h"
+#include "DataBaseManager.h"
 
 class WidgetChat;
 class PageChat : public BaseWidget
@@ -19,6 +28,7 @@ private Q_SLOTS:
     void slot_onAgentUpdated(const QString &agentUuid);
     void slot_onConversationsLoaded(bool success);
     void slot_onMessagesLoaded(const QString &conversationUuid);
+    void slot_onOlderMessagesLoaded(const QString &conversationUuid, int count);
     // 用户点击发送按钮
     void slot_onMessageSent(const QString &message);
     void slot_handlePageSwitched(const QVariant &data);
@@ -26,6 +36,7 @@ private Q_SLOTS:
     void slot_handleResponse(const QString &conversationUuid, const QString &responseMessage);
     void slot_handleToolCalled(const QString &conversationUuid, const QString &message);
     void slot_onBtnClickedCreateNewConversation();
+    void slot_onSearchFinished(const QString &keywords, bool success, QVector<SearchResult> results, qint64 elapsedUs, bool truncated);
 
 public:
     explicit PageChat(QWidget *parent = nullptr);
@@ -40,10 +51,21 @@ private:
     QListWidget *m_listWidgetConversations;
     QTabWidget *m_tabWidgetSiderBar;
     WidgetChat *m_widgetChat;
+    QWidget *m_widgetSearch;
+    QLineEdit *m_lineEditSearch;
+    QListWidget *m_listWidgetSearchResults;
+    QLabel *m_labelSearchStatus;
+    QTimer *m_timerSearch; // 输入停止 SEARCH_DEBOUNCE_MS 后才搜索
 
 private:
     void refreshAgentList();
     void refreshConversationList();
+    // 将搜索结果的摘要转换为富文本(转义后加粗匹配的词)
+    static QString formatSnippet(const QString &snippet);
+
+private:
+    static const int SEARCH_DEBOUNCE_MS = 200;
+    static const int SEARCH_RESULT_LIMIT = 100;
 };
 
 class WidgetChat : public BaseWidget
@@ -59,6 +81,10 @@ public:
     const QString getConversationUuid();
     // 刷新历史消息列表展示 conversationUuid 的消息
     void refreshHistoryMessageList(const QString &conversationUuid);
+    // 在历史消息列表开头插入 conversationUuid 新加载的 count 条更早的消息
+    void prependHistoryMessages(const QString &conversationUuid, int count);
+    // 定位到当前对话中的消息，消息尚未加载时先加载到 seq 为止
+    void locateMessage(const QString &messageUuid, qint64 seq);
     void clearPlainTextEdit();
 
 protected:
@@ -66,8 +92,25 @@ protected:
     void initItems() override;
     void initLayout() override;
 
+private:
+    // 选择MCP资源附加到消息，或选择提示词插入输入框
+    void pickMcpResource();
+    void addAttachment(const QString &name, const QVector<MCPResourceContent> &contents);
+    void clearAttachments();
+    // 将资源内容转换为附加到消息中的文本，二进制内容只附加引用
+    static QString formatAttachment(const QVector<MCPResourceContent> &contents);
+    // 将消息转换为历史消息列表的展示项
+    static QVector<HistoryMessage> toHistoryMessages(const QVector<Message> &messages);
+    // 尝试定位等待中的消息，仍在等待消息加载时返回 false(加载完成后再次尝试)
+    bool locatePendingMessage();
+
 private:
     QString m_conversationUuid;
+    QString m_pendingLocateConversationUuid; // 等待定位的消息所在的对话
+    QString m_pendingLocateMessageUuid;
+    qint64 m_pendingLocateSeq = 0;
+    QVector<QPair<QString, QString>> m_attachments; // 资源名称 - 附加到消息中的文本
+    static const int MAX_ATTACHMENT_CHARS = 20000;  // 单项文本资源附加到消息中的最大字符数
 
 private:
     HistoryMessageListWidget *m_historyMessageList;
@@ -75,6 +118,46 @@ private:
     QPushButton *m_pushButtonSend;
     QPushButton *m_pushButtonClearContext;
     QPushButton *m_pushButtonCreateNewConversation;
+    QPushButton *m_pushButtonAttachResource;
+    QPushButton *m_pushButtonClearAttachments;
+    QLabel *m_labelAttachments;
+    QMenu *m_contextMenuMessages;
+};
+
+// 从智能体挂载的MCP服务器中选择资源或提示词
+class DialogMcpResourcePicker : public BaseDialog
+{
+    Q_OBJECT
+public:
+    DialogMcpResourcePicker(const QSet<QString> &mcpServerUuids, QWidget *parent = nullptr, Qt::WindowFlags f = Qt::WindowFlags());
+    ~DialogMcpResourcePicker() = default;
+    QString getServerUuid() const;
+    // 是否选择了提示词(否则为资源)
+    bool isPromptSelected() const;
+    // 选中的资源: uri - 名称
+    QVector<QPair<QString, QString>> getSelectedResources() const;
+    QString getSelectedPrompt() const;
+    // 提示词参数，每行一个 key=value
+    QJsonObject getPromptArguments() const;
+
+protected:
+    void initWidget() override;
+    void initItems() override;
+    void initLayout() override;
+
+private:
+    // 加载服务器的资源与提示词列表
+    void loadServer(const QString &serverUuid);
+
+private:
+    QSet<QString> m_mcpServerUuids;
+    QComboBox *m_comboBoxServers;
+    QTabWidget *m_tabWidget;
+    QListWidget *m_listWidgetResources;
+    QListWidget *m_listWidgetPrompts;
+    QPlainTextEdit *m_plainTextEditPromptArguments;
+    QPushButton *m_pushButtonOk;
+    QPushButton *m_pushButtonCancel;
 };
 
 #endif // PAGECHAT_H
\ No newline at end of file
@@ -17,6 +17,7 @@
 #include <QMenu>
 #include "BaseDialog.hpp"
 #include "BaseSettingsPage.hpp"
+#include <QElapsedTimer>
 
 class PageSettingsAgent;
 class PageSettingsLLM;
@@ -102,6 +103,9 @@ private:
     QDoubleSpinBox *m_doubleSpinBoxTemperature;
     QDoubleSpinBox *m_doubleSpinBoxTopP;
     QSpinBox *m_spinBoxMaxTokens;
+    QSpinBox *m_spinBoxMaxToolResultChars;
+    QCheckBox *m_checkBoxSpillToolResultBlobs;
+    QSpinBox *m_spinBoxMaxToolsPerRequest;
     QPlainTextEdit *m_plainTextEditSystemPrompt;
     QListWidget *m_listWidgetMcpServers;
     QMenu *m_contextMenuMcpServers;
@@ -211,6 +215,7 @@ class WidgetMcpServerInfo : public BaseWidget
     Q_OBJECT
 private Q_SLOTS:
     void slot_onComboBoxCurrentIndexChanged(int index);
+    void slot_onServerHealthChanged(const QString &serverUuid);
 
 public:
     explicit WidgetMcpServerInfo(QWidget *parent = nullptr);
@@ -235,6 +240,12 @@ protected:
     void initItems() override;
     void initLayout() override;
 
+private:
+    // 刷新连接状态
+    void updateHealthInfo();
+    // 刷新进程资源使用情况(仅stdio)
+    void updateResourceUsage();
+
 private:
     QCheckBox *m_checkBoxIsActive;
     QLineEdit *m_lineEditUuid;
@@ -242,12 +253,34 @@ private:
     QPlainTextEdit *m_plainTextEditDescription;
     QComboBox *m_comboBoxType;
     QSpinBox *m_spinBoxTimeout;
+    QSpinBox *m_spinBoxMaxConcurrentCalls;
+    QSpinBox *m_spinBoxResultCacheTtl;
+    QLineEdit *m_lineEditCacheableTools;
+    QLineEdit *m_lineEditHealth;
     QLabel *m_labelCommand;
     QLineEdit *m_lineEditCommand;
     QLabel *m_labelArgs;
     QPlainTextEdit *m_plainTextEditArgs;
     QLabel *m_labelEnvVars;
     QPlainTextEdit *m_plainTextEditEnvVars;
+    QLabel *m_labelMinReplicas;
+    QSpinBox *m_spinBoxMinReplicas;
+    QLabel *m_labelMaxReplicas;
+    QSpinBox *m_spinBoxMaxReplicas;
+    QLabel *m_labelIdleTimeout;
+    QSpinBox *m_spinBoxIdleTimeout;
+    QLabel *m_labelResourceLimits;
+    QWidget *m_widgetResourceLimits;
+    QSpinBox *m_spinBoxCpuQuota;
+    QSpinBox *m_spinBoxMemoryLimit;
+    QSpinBox *m_spinBoxNice;
+    QComboBox *m_comboBoxIoPriority;
+    QSpinBox *m_spinBoxMaxOpenFiles;
+    QLabel *m_labelResourceUsage;
+    QLineEdit *m_lineEditResourceUsage;
+    QString m_resourceUsageServerUuid;  // 上一次采样的服务器
+    qint64 m_lastCpuTimeMs = 0;         // 上一次采样的CPU时间
+    QElapsedTimer m_resourceUsageTimer; // 距离上一次采样的时间
     QLabel *m_labelHost;
     QLineEdit *m_lineEditHost;
     QLabel *m_labelPort;
@@ -305,6 +338,8 @@ private Q_SLOTS:
     void slot_onFilePathChangedLLMs(const QString &filePath);
     void slot_onFilePathChangedAgents(const QString &filePath);
     void slot_onFilePathChangedMcpServers(const QString &filePath);
+    void slot_onMaintenanceFinished(DataBaseMaintenanceReport report);
+    void slot_onIncrementalVacuumEnabled(bool success, qint64 bytesBefore, qint64 bytesAfter);
 
 public:
     explicit PageSettingsStorage(QWidget *parent = nullptr);
@@ -314,6 +349,12 @@ protected:
     void initItems() override;
     void initLayout() override;
 
+private:
+    // 刷新后台线程池的状态
+    void updateExecutorMetrics();
+    // 刷新数据库写入队列的状态与内容压缩、去重节省的空间
+    void updateWriteStats();
+
 private:
     QLineEdit *m_lineEditFilePathLLMs;
     QPushButton *m_pushButtonSelectFileLLMs;
@@ -321,6 +362,12 @@ private:
     QPushButton *m_pushButtonSelectFileAgents;
     QLineEdit *m_lineEditFilePathMcpServers;
     QPushButton *m_pushButtonSelectFileMcpServers;
+    QLineEdit *m_lineEditMaintenance;
+    QPushButton *m_pushButtonRunMaintenance;
+    QPushButton *m_pushButtonEnableIncrementalVacuum;
+    QLineEdit *m_lineEditExecutor;
+    QLineEdit *m_lineEditWriteStats;
+    QLineEdit *m_lineEditContentSavings;
 };
 
 class PageSettingsDisplay : public BaseWidget
@@ -0,0 +1,38 @@
+#ifndef TOOLRESULTSTORE_H
+#define TOOLRESULTSTORE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QMutex>
+#include "Singleton.h"
+
+/**
+ * 工具结果的内容寻址存储
+ *
+ * 过大的工具结果(图片、音频等二进制数据或截断前的完整文本)写入磁盘，消息中只保留引用id。
+ * id 为内容的 SHA-256，相同的内容只保存一份，文件按 id 前两位分目录存放。
+ */
+class ToolResultStore : public Singleton<ToolResultStore>
+{
+    friend class Singleton<ToolResultStore>;
+
+public:
+    ~ToolResultStore() = default;
+    // 保存数据并返回id，失败时返回空字符串
+    QString put(const QByteArray &data, const QString &suffix = QString());
+    // 读取数据，不存在时返回空
+    QByteArray get(const QString &id) const;
+    bool contains(const QString &id) const;
+    // 数据文件的路径，不存在时返回空字符串
+    QString filePath(const QString &id) const;
+
+private:
+    ToolResultStore() = default;
+    QString directoryOf(const QString &id) const;
+
+private:
+    mutable QMutex m_mutex;
+    const QString STORE_DIRECTORY = "./tool_results";
+};
+
+#endif // TOOLRESULTSTORE_H
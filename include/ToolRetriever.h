@@ -0,0 +1,60 @@
+#ifndef TOOLRETRIEVER_H
+#define TOOLRETRIEVER_H
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QSet>
+#include <QStringList>
+
+struct ToolSelectionStats
+{
+    int requests = 0;        // 进行过工具筛选的请求数
+    int totalTools = 0;      // 筛选前的工具数量
+    int selectedTools = 0;   // 实际发送的工具数量
+    qint64 fullBytes = 0;    // 筛选前工具列表序列化后的大小，单位: 字节
+    qint64 selectedBytes = 0; // 实际发送的工具列表大小，单位: 字节
+
+    // 节省的提示词大小，单位: 字节
+    qint64 savedBytes() const;
+    ToolSelectionStats &operator+=(const ToolSelectionStats &other);
+};
+
+/**
+ * 按与对话的相关性筛选发送给LLM的工具
+ *
+ * 使用 BM25 对工具的名称、描述、参数名与参数描述打分，名称的权重更高。
+ * 中文按单字与相邻两字切分，英文按单词、驼峰与下划线切分。
+ */
+class ToolRetriever
+{
+public:
+    /**
+     * @brief 选择最相关的工具.
+     *
+     * @param jsonArrayTools 所有工具(OpenAI function calling 格式).
+     * @param query 最新的用户消息.
+     * @param context 最近的对话内容，权重低于 query.
+     * @param pinnedToolNames 必须发送的工具(对话中已经调用过的工具)，不计入 topK.
+     * @param topK 除 pinnedToolNames 外最多选择的工具数量，相关工具不足时按原顺序补足.
+     * @param stats 输出本次筛选的统计，可为空.
+     * @return 保持原顺序的工具列表(顺序稳定有利于LLM服务端的前缀缓存).
+     */
+    static QJsonArray selectTools(const QJsonArray &jsonArrayTools,
+                                  const QString &query,
+                                  const QString &context,
+                                  const QSet<QString> &pinnedToolNames,
+                                  int topK,
+                                  ToolSelectionStats *stats = nullptr);
+    static QStringList tokenize(const QString &text);
+
+private:
+    // 构建工具的检索文本，名称重复一次以提高权重
+    static QStringList toolTerms(const QJsonObject &jsonObjTool);
+
+private:
+    static constexpr double BM25_K1 = 1.2;
+    static constexpr double BM25_B = 0.75;
+    static constexpr double CONTEXT_WEIGHT = 0.5; // 对话上下文中的词相对最新消息的权重
+};
+
+#endif // TOOLRETRIEVER_H
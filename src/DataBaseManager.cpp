@@ -5,22 +5,80 @@
 #include <QSqlQuery>
 #include <QtConcurrent>
 #include "ToastManager.h"
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QUuid>
+#include <QDateTime>
+#include <limits>
+#include <algorithm>
+#include <QCryptographicHash>
+#include <QSaveFile>
+#include "global.h"
 
 DataBaseManager::DataBaseManager(QObject *parent)
     : QObject(parent)
 {
+    // 查询结果以 QVector<Message> 跨线程传递(隐式共享，排队时不复制消息)
+    qRegisterMetaType<QVector<Message>>("QVector<Message>");
+    qRegisterMetaType<QVector<SearchResult>>("QVector<SearchResult>");
+    qRegisterMetaType<DataBaseMaintenanceReport>("DataBaseMaintenanceReport");
+
     // 创建数据库线程
     m_worker = new DataBaseWorker(DATABASE_FILENAME);
     m_worker->moveToThread(&m_thread);
 
+    // 退出前先提交写入队列中的消息(阻塞等待)，再结束线程
+    connect(qApp, &QCoreApplication::aboutToQuit, m_worker, &DataBaseWorker::slot_flushPendingWrites, Qt::BlockingQueuedConnection);
     connect(qApp, &QCoreApplication::aboutToQuit, &m_thread, &QThread::quit);
 
     connect(&m_thread, &QThread::started, m_worker, &DataBaseWorker::slot_initialize); // 在线程启动后初始化数据库，确保 QSqlDatabase 和 worker 在同一线程
-    connect(this, &DataBaseManager::sig_getAllConversationInfo, m_worker, &DataBaseWorker::slot_getAllConversationInfo, Qt::QueuedConnection);
+    // 在发出信号的线程中记录尚未提交的写入(先于写线程处理)，读取时据此决定是否需要先经过写线程
+    connect(this, &DataBaseManager::sig_insertNewConversation, this, [this](const QString &, const QString &uuid) { m_worker->beginWrite(uuid); }, Qt::DirectConnection);
+    connect(this, &DataBaseManager::sig_insertNewMessage, this, [this](const QString &conversationUuid) { m_worker->beginWrite(conversationUuid); }, Qt::DirectConnection);
+    connect(this, &DataBaseManager::sig_deleteConversation, this, [this](const QString &conversationUuid) { m_worker->beginWrite(conversationUuid); }, Qt::DirectConnection);
     connect(this, &DataBaseManager::sig_insertNewConversation, m_worker, &DataBaseWorker::slot_insertNewConversation, Qt::QueuedConnection);
     connect(this, &DataBaseManager::sig_insertNewMessage, m_worker, &DataBaseWorker::slot_insertNewMessage, Qt::QueuedConnection);
-    connect(this, &DataBaseManager::sig_getMessageList, m_worker, &DataBaseWorker::slot_getMessages, Qt::QueuedConnection);
     connect(this, &DataBaseManager::sig_deleteConversation, m_worker, &DataBaseWorker::slot_deleteConversation, Qt::QueuedConnection);
+    connect(this, &DataBaseManager::sig_runMaintenance, m_worker, &DataBaseWorker::slot_runMaintenance, Qt::QueuedConnection);
+    connect(this, &DataBaseManager::sig_enableIncrementalVacuum, m_worker, &DataBaseWorker::slot_enableIncrementalVacuum, Qt::QueuedConnection);
+
+    // 查询直接分派到只读连接，不在写线程中排队(只有相关的写入尚未提交时才先经过写线程)
+    connect(this, &DataBaseManager::sig_getAllConversationInfo, this, [this]()
+            { dispatchRead(m_worker->hasPendingWrites(), [](DataBaseReader *reader)
+                           { reader->slot_getAllConversationInfo(); }); }, Qt::DirectConnection);
+    // 向上翻页只读取更早的消息，不受未提交的写入影响
+    connect(this, &DataBaseManager::sig_getMessageList, this, [this](const QString &conversationUuid, qint64 beforeSeq, int limit, qint64 untilSeq)
+            { dispatchRead(beforeSeq <= 0 && m_worker->hasPendingWrites(conversationUuid), [conversationUuid, beforeSeq, limit, untilSeq](DataBaseReader *reader)
+                           { reader->slot_getMessages(conversationUuid, beforeSeq, limit, untilSeq); }); }, Qt::DirectConnection);
+    connect(this, &DataBaseManager::sig_getContextMessages, this, [this](const QString &conversationUuid, int limit)
+            { dispatchRead(m_worker->hasPendingWrites(conversationUuid), [conversationUuid, limit](DataBaseReader *reader)
+                           { reader->slot_getContextMessages(conversationUuid, limit); }); }, Qt::DirectConnection);
+    // 刚发送的消息也能搜索到
+    connect(this, &DataBaseManager::sig_search, this, [this](const QString &keywords, int limit)
+            { dispatchRead(m_worker->hasPendingWrites(), [keywords, limit](DataBaseReader *reader)
+                           { reader->slot_search(keywords, limit); }); }, Qt::DirectConnection);
+    connect(this, &DataBaseManager::sig_exportMessageContent, this, [this](const QString &messageUuid, const QString &filePath)
+            { dispatchRead(m_worker->hasPendingWrites(), [messageUuid, filePath](DataBaseReader *reader)
+                           { reader->slot_exportMessageContent(messageUuid, filePath); }); }, Qt::DirectConnection);
+
+    // 创建只读连接线程，查询结果直接通过 worker 的信号发出(不经过写线程)
+    const int readerCount = qBound(2, QThread::idealThreadCount() / 2, 4);
+    for (int i = 0; i < readerCount; ++i)
+    {
+        DataBaseReader *reader = new DataBaseReader(DATABASE_FILENAME, i);
+        QThread *readerThread = new QThread();
+        reader->moveToThread(readerThread);
+        connect(reader, &DataBaseReader::sig_allConversationInfoAcquired, m_worker, &DataBaseWorker::sig_allConversationInfoAcquired, Qt::DirectConnection);
+        connect(reader, &DataBaseReader::sig_messagesAcquired, m_worker, &DataBaseWorker::sig_messagesAcquired, Qt::DirectConnection);
+        connect(reader, &DataBaseReader::sig_contextMessagesAcquired, m_worker, &DataBaseWorker::sig_contextMessagesAcquired, Qt::DirectConnection);
+        connect(reader, &DataBaseReader::sig_searchFinished, m_worker, &DataBaseWorker::sig_searchFinished, Qt::DirectConnection);
+        connect(reader, &DataBaseReader::sig_messageContentExported, m_worker, &DataBaseWorker::sig_messageContentExported, Qt::DirectConnection);
+        connect(readerThread, &QThread::finished, reader, &QObject::deleteLater);
+        connect(qApp, &QCoreApplication::aboutToQuit, readerThread, &QThread::quit);
+        m_readers.append(reader);
+        m_readerThreads.append(readerThread);
+        readerThread->start();
+    }
 
     m_thread.start();
 }
@@ -29,6 +87,14 @@ DataBaseManager::~DataBaseManager()
 {
     m_thread.quit();
     m_thread.wait();
+    for (QThread *readerThread : m_readerThreads)
+    {
+        readerThread->quit();
+        readerThread->wait();
+        delete readerThread;
+    }
+    m_readerThreads.clear();
+    m_readers.clear();
 
     // 释放 worker
     if (m_worker)
@@ -43,67 +109,1066 @@ const DataBaseWorker *DataBaseManager::getWorkerPtr()
     return m_worker;
 }
 
-// DataBaseWorker
-DataBaseWorker::DataBaseWorker(const QString &dataBaseFile, QObject *parent)
-    : QObject(parent), m_dataBaseFile(dataBaseFile)
+DataBaseWriteStats DataBaseManager::getWriteStats() const
+{
+    return m_worker ? m_worker->getWriteStats() : DataBaseWriteStats();
+}
+
+void DataBaseManager::dispatchRead(bool needsFlush, const std::function<void(DataBaseReader *reader)> &read)
+{
+    // 按轮询选择只读连接，可在任意线程调用
+    DataBaseReader *reader = m_readers.at(static_cast<unsigned int>(m_nextReader.fetch_add(1)) % m_readers.size());
+    auto runRead = [reader, read]()
+    {
+        read(reader);
+    };
+    if (!needsFlush)
+    {
+        QMetaObject::invokeMethod(reader, runRead, Qt::QueuedConnection);
+        return;
+    }
+    // 排在之前发出的写入之后，先提交写入队列再交给只读连接
+    DataBaseWorker *worker = m_worker;
+    QMetaObject::invokeMethod(
+        worker,
+        [worker, reader, runRead]()
+        {
+            worker->slot_flushPendingWrites();
+            QMetaObject::invokeMethod(reader, runRead, Qt::QueuedConnection);
+        },
+        Qt::QueuedConnection);
+}
+
+QByteArray DataBaseManager::uuidToBlob(const QString &uuid)
+{
+    QUuid parsed(uuid);
+    // 不是合法uuid时按原文保存，读取时按长度区分
+    return parsed.isNull() ? uuid.toUtf8() : parsed.toRfc4122();
+}
+
+QString DataBaseManager::uuidFromBlob(const QByteArray &blob)
+{
+    if (blob.size() == 16)
+        return QUuid::fromRfc4122(blob).toString(QUuid::WithoutBraces);
+    return QString::fromUtf8(blob);
+}
+
+qint64 DataBaseManager::timeToEpochMs(const QString &time)
+{
+    QDateTime dateTime = QDateTime::fromString(time, "yyyy-MM-dd HH:mm:ss");
+    if (!dateTime.isValid())
+        dateTime = QDateTime::fromString(time, Qt::ISODate);
+    return dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : 0;
+}
+
+QString DataBaseManager::timeFromEpochMs(qint64 epochMs)
+{
+    return QDateTime::fromMSecsSinceEpoch(epochMs).toString("yyyy-MM-dd HH:mm:ss");
+}
+
+QByteArray DataBaseManager::compressContent(const QByteArray &utf8)
+{
+    if (utf8.size() < CONTENT_COMPRESS_THRESHOLD)
+        return QByteArray();
+    QByteArray compressed = qCompress(utf8);
+    // 压缩后仍有原大小90%以上(如随机数据)时不值得解压开销
+    if (compressed.size() >= utf8.size() / 10 * 9)
+        return QByteArray();
+    return compressed;
+}
+
+QString DataBaseManager::decompressContent(const QVariant &value, int codec)
+{
+    if (codec != CodecZlib)
+        return value.toString();
+    QByteArray compressed = value.toByteArray();
+    QByteArray utf8 = qUncompress(compressed);
+    if (utf8.isEmpty() && !compressed.isEmpty())
+        XLC_LOG_ERROR("Decompress message content failed (bytes={})", compressed.size());
+    return QString::fromUtf8(utf8);
+}
+
+bool DataBaseManager::readBlob(const QSqlDatabase &dataBase, qint64 blobId, const std::function<bool(const QByteArray &utf8)> &consumer)
+{
+    QSqlQuery query(dataBase);
+    query.setForwardOnly(true);
+    query.prepare("SELECT codec, data FROM blob_chunks WHERE blob_id = :blob_id ORDER BY chunk_index");
+    query.bindValue(":blob_id", blobId);
+    if (!query.exec())
+    {
+        XLC_LOG_ERROR("Read blob failed (blobId={}): {}", blobId, query.lastError().text());
+        return false;
+    }
+    while (query.next())
+    {
+        QByteArray data = query.value(1).toByteArray();
+        QByteArray utf8 = query.value(0).toInt() == CodecZlib ? qUncompress(data) : data;
+        if (utf8.isEmpty() && !data.isEmpty())
+        {
+            XLC_LOG_ERROR("Decompress blob chunk failed (blobId={}, bytes={})", blobId, data.size());
+            return false;
+        }
+        if (!consumer(utf8))
+            return false;
+    }
+    return true;
+}
+
+QString DataBaseManager::readContent(const QSqlDatabase &dataBase, const QVariant &content, int codec, qint64 blobId)
+{
+    if (codec != CodecBlob)
+        return decompressContent(content, codec);
+    QString text;
+    readBlob(dataBase, blobId,
+             [&text](const QByteArray &utf8)
+             {
+                 text += QString::fromUtf8(utf8);
+                 return true;
+             });
+    return text;
+}
+
+// DataBaseReader
+DataBaseReader::DataBaseReader(const QString &dataBaseFile, int index, QObject *parent)
+    : QObject(parent), m_dataBaseFile(dataBaseFile), m_connectionName(QString("databasereader_connection_%1").arg(index))
+{
+}
+
+DataBaseReader::~DataBaseReader()
+{
+    if (m_dataBase.isOpen())
+        m_dataBase.close();
+    m_dataBase = QSqlDatabase();
+    if (QSqlDatabase::contains(m_connectionName))
+        QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+bool DataBaseReader::ensureOpen()
+{
+    if (m_dataBase.isOpen())
+        return true;
+    m_dataBase = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+    m_dataBase.setDatabaseName(m_dataBaseFile);
+    m_dataBase.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000");
+    if (!m_dataBase.open())
+    {
+        XLC_LOG_ERROR("Reader failed to open database (connection={}): {}", m_connectionName, m_dataBase.lastError().text());
+        return false;
+    }
+    QSqlQuery query(m_dataBase);
+    for (const QString &pragma : {QString("PRAGMA query_only = ON"),
+                                  QString("PRAGMA mmap_size = %1").arg(DataBaseWorker::MMAP_SIZE),
+                                  QString("PRAGMA cache_size = %1").arg(DataBaseWorker::CACHE_SIZE)})
+    {
+        if (!query.exec(pragma))
+            XLC_LOG_WARN("Apply pragma failed (connection={}, query={}): {}", m_connectionName, pragma, query.lastError().text());
+    }
+    XLC_LOG_DEBUG("Reader opened database (connection={})", m_connectionName);
+    return true;
+}
+
+void DataBaseReader::slot_getAllConversationInfo()
+{
+    if (!ensureOpen())
+    {
+        Q_EMIT sig_allConversationInfoAcquired(false, QJsonArray());
+        return;
+    }
+    QSqlQuery query(m_dataBase);
+    query.prepare(R"(
+                SELECT
+                    c.id,
+                    c.agent_id,
+                    c.summary,
+                    c.created_time,
+                    c.updated_time,
+                    c.message_count,
+                    c.last_message_preview
+                FROM
+                    conversations c
+                ORDER BY
+                    c.updated_time DESC,
+                    c.created_time DESC
+            )");
+    if (!query.exec())
+    {
+        Q_EMIT sig_allConversationInfoAcquired(false, QJsonArray());
+        XLC_LOG_WARN("Get all conversation information failed (query={}): {}", query.lastQuery(), query.lastError().text());
+        ToastManager::showMessage(Toast::Type::Warning, QString("获取对话信息失败: %1").arg(query.lastError().text()));
+        return;
+    }
+    // 解析数据
+    QJsonArray jsonArrayConversationInfo;
+    while (query.next())
+    {
+        QJsonObject jsonObjConversationInfo;
+        jsonObjConversationInfo["uuid"] = DataBaseManager::uuidFromBlob(query.value(0).toByteArray());
+        jsonObjConversationInfo["agent_uuid"] = DataBaseManager::uuidFromBlob(query.value(1).toByteArray());
+        jsonObjConversationInfo["summary"] = query.value(2).toString();
+        jsonObjConversationInfo["created_time"] = DataBaseManager::timeFromEpochMs(query.value(3).toLongLong());
+        jsonObjConversationInfo["updated_time"] = DataBaseManager::timeFromEpochMs(query.value(4).toLongLong());
+        jsonObjConversationInfo["message_count"] = query.value(5).toInt();
+        jsonObjConversationInfo["last_message_preview"] = query.value(6).toString();
+        jsonArrayConversationInfo.append(jsonObjConversationInfo);
+    }
+    XLC_LOG_TRACE("Get all conversation information successfully (conversationsCount={}, query={})", jsonArrayConversationInfo.size(), query.lastQuery());
+    Q_EMIT sig_allConversationInfoAcquired(true, jsonArrayConversationInfo);
+}
+
+void DataBaseReader::slot_getMessages(const QString &conversationUuid, qint64 beforeSeq, int limit, qint64 untilSeq)
+{
+    if (!ensureOpen())
+    {
+        Q_EMIT sig_messagesAcquired(false, conversationUuid, beforeSeq, false, QVector<Message>());
+        return;
+    }
+    QSqlQuery query(m_dataBase);
+    auto fail = [&]()
+    {
+        XLC_LOG_WARN("Get messages failed (conversationUuid={}, beforeSeq={}, query={}): {}",
+                     conversationUuid,
+                     beforeSeq,
+                     query.lastQuery(),
+                     query.lastError().text());
+        ToastManager::showMessage(Toast::Type::Warning, QString("未能获取到历史消息 (conversationUuid=%1): %2").arg(conversationUuid).arg(query.lastError().text()));
+        Q_EMIT sig_messagesAcquired(false, conversationUuid, beforeSeq, false, QVector<Message>());
+    };
+
+    /**
+     * NOTE 按 seq 做键集分页(不使用 OFFSET 翻页)，只用于展示，LLM上下文由 slot_getContextMessages 单独加载
+     * 首次加载(beforeSeq <= 0): 最新的 limit 条消息；
+     * 向上翻页(beforeSeq > 0): seq < beforeSeq 的 limit 条消息，untilSeq > 0 时至少加载到 untilSeq(跳转到搜索结果)。
+     *  */
+    QByteArray conversationUuidBlob = DataBaseManager::uuidToBlob(conversationUuid);
+    qint64 upperSeq = beforeSeq > 0 ? beforeSeq : std::numeric_limits<qint64>::max();
+    // 这一页的起始位置，剩余消息不足一页时为0；untilSeq > 0 时至少加载到该位置
+    query.prepare(R"(
+            SELECT seq FROM messages
+            WHERE conversation_id = :conversationUuid AND seq < :upperSeq
+            ORDER BY seq DESC
+            LIMIT 1 OFFSET :offset
+        )");
+    query.bindValue(":conversationUuid", conversationUuidBlob);
+    query.bindValue(":upperSeq", upperSeq);
+    query.bindValue(":offset", qMax(limit - 1, 0));
+    if (!query.exec())
+    {
+        fail();
+        return;
+    }
+    qint64 lowerSeq = 0;
+    if (query.next())
+        lowerSeq = untilSeq > 0 ? qMin(query.value(0).toLongLong(), untilSeq) : query.value(0).toLongLong();
+    bool hasMore = false;
+    if (lowerSeq > 0)
+    {
+        query.prepare("SELECT 1 FROM messages WHERE conversation_id = :conversationUuid AND seq < :lowerSeq LIMIT 1");
+        query.bindValue(":conversationUuid", conversationUuidBlob);
+        query.bindValue(":lowerSeq", lowerSeq);
+        if (!query.exec())
+        {
+            fail();
+            return;
+        }
+        hasMore = query.next();
+    }
+    query.prepare(R"(
+            SELECT seq, id, role, content, created_time, avatar_file_path, tool_calls, tool_call_id, content_codec, content_blob_id
+            FROM messages
+            WHERE conversation_id = :conversationUuid AND seq >= :lowerSeq AND seq < :upperSeq
+            ORDER BY seq
+        )");
+    query.bindValue(":conversationUuid", conversationUuidBlob);
+    query.bindValue(":lowerSeq", lowerSeq);
+    query.bindValue(":upperSeq", upperSeq);
+    if (!query.exec())
+    {
+        fail();
+        return;
+    }
+    // 在读取线程中直接构造消息(包括解压内容与解析 tool_calls)，主线程不再做任何解析；
+    // 只有加载到界面或上下文中的这一页消息才会解压，对话列表与搜索不读取消息内容
+    QVector<Message> messages;
+    messages.reserve(limit);
+    while (query.next())
+        messages.append(readMessage(query, conversationUuid));
+    XLC_LOG_DEBUG("Get messages successfully (conversationUuid={}, beforeSeq={}, messagesCount={}, hasMore={})", conversationUuid, beforeSeq, messages.size(), hasMore);
+    Q_EMIT sig_messagesAcquired(true, conversationUuid, beforeSeq, hasMore, messages);
+}
+
+void DataBaseReader::slot_getContextMessages(const QString &conversationUuid, int limit)
+{
+    if (!ensureOpen())
+    {
+        Q_EMIT sig_contextMessagesAcquired(false, conversationUuid, QVector<Message>());
+        return;
+    }
+    QSqlQuery query(m_dataBase);
+    auto fail = [&]()
+    {
+        XLC_LOG_WARN("Get context messages failed (conversationUuid={}, query={}): {}",
+                     conversationUuid,
+                     query.lastQuery(),
+                     query.lastError().text());
+        ToastManager::showMessage(Toast::Type::Warning, QString("未能获取到对话上下文 (conversationUuid=%1): %2").arg(conversationUuid).arg(query.lastError().text()));
+        Q_EMIT sig_contextMessagesAcquired(false, conversationUuid, QVector<Message>());
+    };
+
+    // LLM上下文: 最近一次清除上下文之后的最新 limit 条消息，与界面已加载的消息无关
+    QByteArray conversationUuidBlob = DataBaseManager::uuidToBlob(conversationUuid);
+    // 最近一次清除上下文的位置(idx_messages_clear_context)
+    // 角色写为常量，与部分索引的条件一致才能使用该索引
+    query.prepare(QString(R"(
+            SELECT MAX(seq) FROM messages
+            WHERE conversation_id = :conversationUuid AND role = %1 AND content = :content
+        )").arg(static_cast<int>(Message::SYSTEM)));
+    query.bindValue(":conversationUuid", conversationUuidBlob);
+    query.bindValue(":content", DEFAULT_CONTENT_CLEAR_CONTEXT);
+    if (!query.exec())
+    {
+        fail();
+        return;
+    }
+    qint64 clearContextSeq = query.next() ? query.value(0).toLongLong() : 0;
+    query.prepare(R"(
+            SELECT seq, id, role, content, created_time, avatar_file_path, tool_calls, tool_call_id, content_codec, content_blob_id
+            FROM messages
+            WHERE conversation_id = :conversationUuid AND seq > :clearContextSeq
+            ORDER BY seq DESC
+            LIMIT :limit
+        )");
+    query.bindValue(":conversationUuid", conversationUuidBlob);
+    query.bindValue(":clearContextSeq", clearContextSeq);
+    query.bindValue(":limit", limit);
+    if (!query.exec())
+    {
+        fail();
+        return;
+    }
+    QVector<Message> messages;
+    messages.reserve(limit);
+    while (query.next())
+        messages.append(readMessage(query, conversationUuid));
+    std::reverse(messages.begin(), messages.end());
+    XLC_LOG_DEBUG("Get context messages successfully (conversationUuid={}, clearContextSeq={}, messagesCount={})", conversationUuid, clearContextSeq, messages.size());
+    Q_EMIT sig_contextMessagesAcquired(true, conversationUuid, messages);
+}
+
+Message DataBaseReader::readMessage(const QSqlQuery &query, const QString &conversationUuid) const
+{
+    // 列顺序: seq, id, role, content, created_time, avatar_file_path, tool_calls, tool_call_id, content_codec, content_blob_id
+    QJsonArray jsonArrayToolCalls;
+    QByteArray toolCalls = query.value(6).toByteArray();
+    if (!toolCalls.isEmpty())
+    {
+        QJsonDocument jsonDocToolCalls = QJsonDocument::fromJson(toolCalls);
+        if (jsonDocToolCalls.isArray())
+            jsonArrayToolCalls = jsonDocToolCalls.array();
+        else if (!jsonDocToolCalls.isNull())
+            XLC_LOG_ERROR("Parse toolcalls failed (conversationUuid={}, strToolCalls={}): strToolCalls is not an array", conversationUuid, QString::fromUtf8(toolCalls));
+    }
+    int role = query.value(2).toInt();
+    Message message(DataBaseManager::uuidFromBlob(query.value(1).toByteArray()),
+                    DataBaseManager::readContent(m_dataBase, query.value(3), query.value(8).toInt(), query.value(9).toLongLong()),
+                    role >= Message::USER && role <= Message::UNKNOWN ? static_cast<Message::Role>(role) : Message::UNKNOWN,
+                    DataBaseManager::timeFromEpochMs(query.value(4).toLongLong()),
+                    jsonArrayToolCalls,
+                    query.value(7).toString(),
+                    query.value(5).toString());
+    message.seq = query.value(0).toLongLong();
+    return message;
+}
+
+void DataBaseReader::slot_search(const QString &keywords, int limit)
+{
+    QElapsedTimer searchTimer;
+    searchTimer.start();
+    if (!ensureOpen())
+    {
+        Q_EMIT sig_searchFinished(keywords, false, QVector<SearchResult>(), 0, false);
+        return;
+    }
+    QSqlQuery query(m_dataBase);
+    if (m_ftsTokenizer < 0)
+    {
+        m_ftsTokenizer = 0;
+        if (query.exec("SELECT sql FROM sqlite_master WHERE name = 'messages_fts'") && query.next())
+            m_ftsTokenizer = query.value(0).toString().contains("trigram") ? 2 : 1;
+    }
+    if (m_ftsTokenizer == 0)
+    {
+        XLC_LOG_WARN("Search failed (keywords={}): full text index is not available", keywords);
+        ToastManager::showMessage(Toast::Type::Warning, "搜索失败: 全文索引不可用");
+        Q_EMIT sig_searchFinished(keywords, false, QVector<SearchResult>(), 0, false);
+        return;
+    }
+
+    // trigram 只能索引不少于3个字符的关键词，更短的关键词用 LIKE 过滤
+    QStringList indexedKeywords;
+    QStringList shortKeywords;
+    for (const QString &keyword : keywords.split(' ', Qt::SkipEmptyParts))
+    {
+        if (m_ftsTokenizer == 2 && keyword.size() < 3)
+            shortKeywords << keyword;
+        else
+            indexedKeywords << keyword;
+    }
+    if (indexedKeywords.isEmpty() && shortKeywords.isEmpty())
+    {
+        Q_EMIT sig_searchFinished(keywords, true, QVector<SearchResult>(), searchTimer.nsecsElapsed() / 1000, false);
+        return;
+    }
+    // 每个关键词作为一个短语(转义双引号)，所有关键词都要匹配
+    QStringList phrases;
+    for (QString keyword : indexedKeywords)
+        phrases << '"' + keyword.replace('"', "\"\"") + '"';
+    const QString match = phrases.join(' ');
+    auto likeConditions = [&shortKeywords](const QString &column)
+    {
+        QString conditions;
+        for (int i = 0; i < shortKeywords.size(); ++i)
+            conditions += QString(" AND %1 LIKE :like%2 ESCAPE '\\'").arg(column).arg(i);
+        return conditions;
+    };
+    auto bindLikes = [&shortKeywords](QSqlQuery &query)
+    {
+        for (int i = 0; i < shortKeywords.size(); ++i)
+        {
+            QString keyword = shortKeywords.at(i);
+            keyword.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_");
+            query.bindValue(QString(":like%1").arg(i), "%" + keyword + "%");
+        }
+    };
+    auto fail = [&]()
+    {
+        XLC_LOG_WARN("Search failed (keywords={}, query={}): {}", keywords, query.lastQuery(), query.lastError().text());
+        ToastManager::showMessage(Toast::Type::Warning, QString("搜索失败: %1").arg(query.lastError().text()));
+        Q_EMIT sig_searchFinished(keywords, false, QVector<SearchResult>(), searchTimer.nsecsElapsed() / 1000, false);
+    };
+
+    QVector<SearchResult> results;
+    // 对话标题(对话数量很少，直接排序)
+    if (!indexedKeywords.isEmpty())
+    {
+        query.prepare(R"(
+                SELECT conversation_id, highlight(conversations_fts, 0, :begin, :end), rank
+                FROM conversations_fts
+                WHERE conversations_fts MATCH :match)" +
+                      likeConditions("summary") + R"(
+                ORDER BY rank
+                LIMIT :limit
+            )");
+        query.bindValue(":begin", SearchResult::HIGHLIGHT_BEGIN);
+        query.bindValue(":end", SearchResult::HIGHLIGHT_END);
+        query.bindValue(":match", match);
+    }
+    else
+    {
+        query.prepare("SELECT id, summary, 0 FROM conversations WHERE 1" + likeConditions("summary") + " ORDER BY updated_time DESC LIMIT :limit");
+    }
+    bindLikes(query);
+    query.bindValue(":limit", limit);
+    if (!query.exec())
+    {
+        fail();
+        return;
+    }
+    while (query.next())
+    {
+        SearchResult result;
+        result.conversationUuid = DataBaseManager::uuidFromBlob(query.value(0).toByteArray());
+        result.snippet = indexedKeywords.isEmpty() ? buildSnippet(query.value(1).toString(), shortKeywords) : query.value(1).toString();
+        result.score = query.value(2).toDouble();
+        results.append(result);
+    }
+
+    // 消息内容
+    if (!indexedKeywords.isEmpty())
+    {
+        // 先找到最近的第 RANK_CANDIDATES 条匹配，只在这之后的匹配中按相关度排序，匹配很多时耗时也不会随数据量增长
+        query.prepare("SELECT rowid FROM messages_fts WHERE messages_fts MATCH :match ORDER BY rowid DESC LIMIT 1 OFFSET :offset");
+        query.bindValue(":match", match);
+        query.bindValue(":offset", RANK_CANDIDATES - 1);
+        if (!query.exec())
+        {
+            fail();
+            return;
+        }
+        qint64 minSeq = query.next() ? query.value(0).toLongLong() : 0;
+        query.prepare(R"(
+                SELECT m.seq, m.id, m.conversation_id, m.role, m.created_time, snippet(messages_fts, 0, :begin, :end, '…', :tokens), messages_fts.rank,
+                    m.content_codec, CASE WHEN m.content_codec != 0 THEN m.content END, m.content_blob_id,
+                    (SELECT b.size FROM blobs b WHERE b.id = m.content_blob_id)
+                FROM messages_fts
+                JOIN messages m ON m.seq = messages_fts.rowid
+                WHERE messages_fts MATCH :match AND messages_fts.rowid >= :minSeq AND (m.content_codec != 0 OR (1)" +
+                      likeConditions("m.content") + R"())
+                ORDER BY messages_fts.rank
+                LIMIT :limit
+            )");
+        query.bindValue(":begin", SearchResult::HIGHLIGHT_BEGIN);
+        query.bindValue(":end", SearchResult::HIGHLIGHT_END);
+        query.bindValue(":tokens", qMin(SNIPPET_CHARS * 2, 64));
+        query.bindValue(":match", match);
+        query.bindValue(":minSeq", minSeq);
+    }
+    else
+    {
+        // 压缩保存的消息无法用 LIKE 匹配，取出后解压过滤(受 SEARCH_DECODE_BYTES 限制)；按 seq 倒序逐行读取，够 limit 条后停止，不需要 LIMIT
+        query.setForwardOnly(true);
+        query.prepare(QString(R"(
+                SELECT m.seq, m.id, m.conversation_id, m.role, m.created_time, CASE WHEN m.content_codec = 0 THEN m.content END, 0,
+                    m.content_codec, CASE WHEN m.content_codec != 0 THEN m.content END, m.content_blob_id,
+                    (SELECT b.size FROM blobs b WHERE b.id = m.content_blob_id)
+                FROM messages m
+                WHERE m.seq > (SELECT COALESCE(MAX(seq), 0) FROM messages) - %1 AND m.role != %2 AND (m.content_codec != 0 OR (1)")
+                          .arg(SHORT_KEYWORD_SCAN)
+                          .arg(static_cast<int>(Message::SYSTEM)) +
+                      likeConditions("m.content") + R"())
+                ORDER BY m.seq DESC
+            )");
+    }
+    bindLikes(query);
+    if (!indexedKeywords.isEmpty())
+        query.bindValue(":limit", limit);
+    if (!query.exec())
+    {
+        fail();
+        return;
+    }
+    const QStringList allKeywords = indexedKeywords + shortKeywords;
+    int messageResults = 0;
+    qint64 decodedBytes = 0;
+    bool truncated = false;
+    while (messageResults < limit && query.next())
+    {
+        // 压缩保存的消息: 索引中是原文，但 snippet() 读到的是压缩数据，解压后截取摘要并检查短关键词
+        QString snippet = query.value(5).toString();
+        int codec = query.value(7).toInt();
+        if (codec != DataBaseManager::CodecPlainText)
+        {
+            // 解压的数据量有上限，超出后跳过剩余的压缩消息并报告结果不完整；Zlib 消息短于 BLOB_THRESHOLD_CHARS，blobs 按保存的大小预先判断
+            qint64 size = codec == DataBaseManager::CodecBlob ? query.value(10).toLongLong() : query.value(8).toByteArray().size();
+            if (decodedBytes + size > SEARCH_DECODE_BYTES)
+            {
+                truncated = true;
+                continue;
+            }
+            decodedBytes += size;
+            QString content = DataBaseManager::readContent(m_dataBase, query.value(8), codec, query.value(9).toLongLong());
+            bool matched = true;
+            for (const QString &keyword : shortKeywords)
+                matched = matched && content.contains(keyword, Qt::CaseInsensitive);
+            if (!matched)
+                continue;
+            snippet = buildSnippet(content, allKeywords);
+        }
+        else if (indexedKeywords.isEmpty())
+        {
+            snippet = buildSnippet(snippet, shortKeywords);
+        }
+        SearchResult result;
+        result.seq = query.value(0).toLongLong();
+        result.messageUuid = DataBaseManager::uuidFromBlob(query.value(1).toByteArray());
+        result.conversationUuid = DataBaseManager::uuidFromBlob(query.value(2).toByteArray());
+        result.role = query.value(3).toInt();
+        result.createdTime = DataBaseManager::timeFromEpochMs(query.value(4).toLongLong());
+        result.snippet = snippet;
+        result.score = query.value(6).toDouble();
+        results.append(result);
+        messageResults += 1;
+    }
+    qint64 elapsedUs = searchTimer.nsecsElapsed() / 1000;
+    XLC_LOG_DEBUG("Search finished (keywords={}, results={}, decodedBytes={}, truncated={}, elapsedMs={:.3f})", keywords, results.size(), decodedBytes, truncated, elapsedUs / 1000.0);
+    Q_EMIT sig_searchFinished(keywords, true, results, elapsedUs, truncated);
+}
+
+QString DataBaseReader::buildSnippet(const QString &content, const QStringList &keywords)
+{
+    int position = -1;
+    for (const QString &keyword : keywords)
+    {
+        int index = content.indexOf(keyword, 0, Qt::CaseInsensitive);
+        if (index >= 0 && (position < 0 || index < position))
+            position = index;
+    }
+    if (position < 0)
+        position = 0;
+    int start = qMax(0, position - SNIPPET_CHARS);
+    int end = qMin(content.size(), position + SNIPPET_CHARS * 2);
+    QString snippet = content.mid(start, end - start);
+    for (const QString &keyword : keywords)
+    {
+        int index = snippet.indexOf(keyword, 0, Qt::CaseInsensitive);
+        while (index >= 0)
+        {
+            snippet.insert(index + keyword.size(), SearchResult::HIGHLIGHT_END);
+            snippet.insert(index, SearchResult::HIGHLIGHT_BEGIN);
+            index = snippet.indexOf(keyword, index + keyword.size() + 2, Qt::CaseInsensitive);
+        }
+    }
+    return (start > 0 ? "…" : "") + snippet + (end < content.size() ? "…" : "");
+}
+
+void DataBaseReader::slot_exportMessageContent(const QString &messageUuid, const QString &filePath)
+{
+    if (!ensureOpen())
+    {
+        Q_EMIT sig_messageContentExported(messageUuid, filePath, false, 0);
+        return;
+    }
+    QSqlQuery query(m_dataBase);
+    query.prepare("SELECT content, content_codec, content_blob_id FROM messages WHERE id = :id");
+    query.bindValue(":id", DataBaseManager::uuidToBlob(messageUuid));
+    if (!query.exec() || !query.next())
+    {
+        XLC_LOG_WARN("Export message content failed (messageUuid={}): message not found {}", messageUuid, query.lastError().text());
+        Q_EMIT sig_messageContentExported(messageUuid, filePath, false, 0);
+        return;
+    }
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        XLC_LOG_WARN("Export message content failed (messageUuid={}, filePath={}): {}", messageUuid, filePath, file.errorString());
+        Q_EMIT sig_messageContentExported(messageUuid, filePath, false, 0);
+        return;
+    }
+    // 保存在 blobs 中的内容逐块写入文件，不在内存中拼接完整内容
+    qint64 bytes = 0;
+    bool success = true;
+    int codec = query.value(1).toInt();
+    if (codec == DataBaseManager::CodecBlob)
+    {
+        success = DataBaseManager::readBlob(m_dataBase, query.value(2).toLongLong(),
+                                            [&file, &bytes](const QByteArray &utf8)
+                                            {
+                                                bytes += utf8.size();
+                                                return file.write(utf8) == utf8.size();
+                                            });
+    }
+    else
+    {
+        QByteArray utf8 = DataBaseManager::decompressContent(query.value(0), codec).toUtf8();
+        bytes = utf8.size();
+        success = file.write(utf8) == utf8.size();
+    }
+    success = success && file.commit();
+    if (!success)
+        XLC_LOG_WARN("Export message content failed (messageUuid={}, filePath={}): {}", messageUuid, filePath, file.errorString());
+    else
+        XLC_LOG_INFO("Exported message content (messageUuid={}, filePath={}, bytes={})", messageUuid, filePath, bytes);
+    Q_EMIT sig_messageContentExported(messageUuid, filePath, success, bytes);
+}
+
+// DataBaseWorker
+DataBaseWorker::DataBaseWorker(const QString &dataBaseFile, QObject *parent)
+    : QObject(parent), m_dataBaseFile(dataBaseFile)
+{
+}
+
+DataBaseWorker::~DataBaseWorker()
+{
+    if (m_dataBase.isOpen())
+        m_dataBase.close();
+
+    if (QSqlDatabase::contains(DB_CONNECTION_NAME))
+    {
+        QSqlDatabase::removeDatabase(DB_CONNECTION_NAME);
+    }
+}
+
+void DataBaseWorker::initializeDatabase()
+{
+    if (!migrateSchema())
+        ToastManager::showMessage(Toast::Type::Warning, QString("初始化数据库链接失败: %1").arg(m_dataBase.lastError().text()));
+    QSqlQuery query(m_dataBase);
+    m_hasFullTextIndex = query.exec("SELECT 1 FROM sqlite_master WHERE name = 'messages_fts'") && query.next();
+    checkIncrementalVacuum();
+    // 迁移完成后才开启外键: 旧版本删除对话时留下的孤立消息在迁移中复制时不能违反外键，之后由维护任务分批删除
+    if (!query.exec("PRAGMA foreign_keys = ON"))
+        XLC_LOG_WARN("Enable foreign keys failed: {}", query.lastError().text());
+}
+
+void DataBaseWorker::checkIncrementalVacuum()
+{
+    QSqlQuery query(m_dataBase);
+    // 0: NONE, 1: FULL, 2: INCREMENTAL；新数据库在创建表之前已设置
+    m_incrementalVacuum = query.exec("PRAGMA auto_vacuum") && query.next() && query.value(0).toInt() == 2;
+    if (!m_incrementalVacuum)
+        XLC_LOG_INFO("Incremental vacuum is not enabled, free pages will only be reused (enable it in storage settings)");
+}
+
+void DataBaseWorker::slot_enableIncrementalVacuum()
+{
+    // VACUUM 会重写整个数据库文件(需要约两倍的磁盘空间)，期间所有写入都要等待，只在用户确认后执行
+    slot_flushPendingWrites();
+    qint64 bytesBefore = 0;
+    qint64 freeBytes = 0;
+    queryDataBaseSize(bytesBefore, freeBytes);
+    if (m_incrementalVacuum)
+    {
+        Q_EMIT sig_incrementalVacuumEnabled(true, bytesBefore, bytesBefore);
+        return;
+    }
+    if (m_maintenanceStep != MaintenanceIdle)
+    {
+        ToastManager::showMessage(Toast::Type::Warning, "正在执行数据库维护，请稍后再试");
+        Q_EMIT sig_incrementalVacuumEnabled(false, bytesBefore, bytesBefore);
+        return;
+    }
+    QElapsedTimer vacuumTimer;
+    vacuumTimer.start();
+    QSqlQuery query(m_dataBase);
+    if (!query.exec("PRAGMA auto_vacuum = INCREMENTAL") || !query.exec("VACUUM"))
+    {
+        XLC_LOG_WARN("Enable incremental vacuum failed: {}", query.lastError().text());
+        Q_EMIT sig_incrementalVacuumEnabled(false, bytesBefore, bytesBefore);
+        return;
+    }
+    checkIncrementalVacuum();
+    qint64 bytesAfter = 0;
+    queryDataBaseSize(bytesAfter, freeBytes);
+    XLC_LOG_INFO("Enabled incremental vacuum (success={}, bytesBefore={}, bytesAfter={}, elapsedMs={})",
+                 m_incrementalVacuum,
+                 bytesBefore,
+                 bytesAfter,
+                 vacuumTimer.elapsed());
+    Q_EMIT sig_incrementalVacuumEnabled(m_incrementalVacuum, bytesBefore, bytesAfter);
+}
+
+void DataBaseWorker::queryDataBaseSize(qint64 &totalBytes, qint64 &freeBytes)
+{
+    QSqlQuery query(m_dataBase);
+    qint64 pageSize = 0;
+    qint64 pageCount = 0;
+    qint64 freePages = 0;
+    if (query.exec("PRAGMA page_size") && query.next())
+        pageSize = query.value(0).toLongLong();
+    if (query.exec("PRAGMA page_count") && query.next())
+        pageCount = query.value(0).toLongLong();
+    if (query.exec("PRAGMA freelist_count") && query.next())
+        freePages = query.value(0).toLongLong();
+    totalBytes = pageCount * pageSize;
+    freeBytes = freePages * pageSize;
+}
+
+QStringList DataBaseWorker::schemaTableStatements()
+{
+    return {R"(
+            CREATE TABLE IF NOT EXISTS conversations (
+                id BLOB PRIMARY KEY,
+                agent_id BLOB NOT NULL,
+                summary TEXT,
+                created_time INTEGER NOT NULL,
+                updated_time INTEGER NOT NULL,
+                message_count INTEGER NOT NULL DEFAULT 0,
+                last_message_seq INTEGER NOT NULL DEFAULT 0,
+                last_message_preview TEXT
+            )
+        )",
+            R"(
+            CREATE TABLE IF NOT EXISTS blobs (
+                id INTEGER PRIMARY KEY,
+                hash BLOB UNIQUE NOT NULL,
+                size INTEGER NOT NULL,
+                stored_size INTEGER NOT NULL DEFAULT 0,
+                ref_count INTEGER NOT NULL DEFAULT 0,
+                created_time INTEGER NOT NULL
+            )
+        )",
+            // 每块单独压缩，读写时只需要一块的内存
+            R"(
+            CREATE TABLE IF NOT EXISTS blob_chunks (
+                blob_id INTEGER NOT NULL REFERENCES blobs(id) ON DELETE CASCADE,
+                chunk_index INTEGER NOT NULL,
+                codec INTEGER NOT NULL,
+                data BLOB NOT NULL,
+                PRIMARY KEY(blob_id, chunk_index)
+            )
+        )",
+            R"(
+            CREATE TABLE IF NOT EXISTS messages (
+                seq INTEGER PRIMARY KEY AUTOINCREMENT,
+                id BLOB UNIQUE NOT NULL,
+                conversation_id BLOB NOT NULL,
+                role INTEGER NOT NULL CHECK(role BETWEEN 0 AND 4),
+                content TEXT NOT NULL,
+                created_time INTEGER NOT NULL,
+                avatar_file_path TEXT,
+                tool_calls TEXT,
+                tool_call_id TEXT,
+                content_codec INTEGER NOT NULL DEFAULT 0,
+                content_blob_id INTEGER REFERENCES blobs(id),
+
+                FOREIGN KEY(conversation_id) REFERENCES conversations(id)
+                    ON DELETE CASCADE
+                    ON UPDATE CASCADE
+            )
+        )"};
+}
+
+QStringList DataBaseWorker::schemaIndexStatements()
+{
+    return {"CREATE INDEX IF NOT EXISTS idx_conversations_agent_id ON conversations(agent_id)",
+            // 启动时按更新时间列出对话只需扫描索引
+            "CREATE INDEX IF NOT EXISTS idx_conversations_updated_created_time ON conversations(updated_time DESC, created_time DESC)",
+            "CREATE INDEX IF NOT EXISTS idx_messages_conversation_id ON messages(conversation_id)",
+            "CREATE INDEX IF NOT EXISTS idx_messages_created_time ON messages(created_time)",
+            // 加载消息时用于查找最近一次清除上下文的位置
+            QString("CREATE INDEX IF NOT EXISTS idx_messages_clear_context ON messages(conversation_id, seq) WHERE role = %1").arg(static_cast<int>(Message::SYSTEM)),
+            // 删除 blobs 时按此索引检查引用
+            "CREATE INDEX IF NOT EXISTS idx_messages_content_blob_id ON messages(content_blob_id) WHERE content_blob_id IS NOT NULL",
+            "CREATE INDEX IF NOT EXISTS idx_blobs_unreferenced ON blobs(id) WHERE ref_count <= 0",
+            // conversations 中冗余保存消息数量与最后一条消息，由触发器维护(压缩保存的消息由写入线程更新预览)
+            R"(
+            CREATE TRIGGER IF NOT EXISTS trg_messages_after_insert AFTER INSERT ON messages
+            BEGIN
+                UPDATE conversations
+                SET
+                    message_count = message_count + 1,
+                    last_message_seq = NEW.seq,
+                    last_message_preview = CASE WHEN NEW.content_codec = 0 THEN substr(NEW.content, 1, 200) END
+                WHERE
+                    id = NEW.conversation_id;
+            END
+        )",
+            R"(
+            CREATE TRIGGER IF NOT EXISTS trg_messages_after_delete AFTER DELETE ON messages
+            BEGIN
+                UPDATE conversations
+                SET
+                    message_count = message_count - 1
+                WHERE
+                    id = OLD.conversation_id;
+                -- 删除的是最后一条消息时才需要重新查找
+                UPDATE conversations
+                SET
+                    last_message_seq = COALESCE((SELECT MAX(seq) FROM messages WHERE conversation_id = OLD.conversation_id), 0),
+                    last_message_preview = (SELECT CASE WHEN content_codec = 0 THEN substr(content, 1, 200) END FROM messages WHERE conversation_id = OLD.conversation_id ORDER BY seq DESC LIMIT 1)
+                WHERE
+                    id = OLD.conversation_id AND last_message_seq = OLD.seq;
+            END
+        )",
+            // blobs 的引用计数，计数为0的 blobs 由 slot_collectGarbageBlobs 删除
+            R"(
+            CREATE TRIGGER IF NOT EXISTS trg_messages_blob_insert AFTER INSERT ON messages WHEN NEW.content_blob_id IS NOT NULL
+            BEGIN
+                UPDATE blobs SET ref_count = ref_count + 1 WHERE id = NEW.content_blob_id;
+            END
+        )",
+            R"(
+            CREATE TRIGGER IF NOT EXISTS trg_messages_blob_update AFTER UPDATE OF content_blob_id ON messages
+            BEGIN
+                UPDATE blobs SET ref_count = ref_count + 1 WHERE id = NEW.content_blob_id;
+                UPDATE blobs SET ref_count = ref_count - 1 WHERE id = OLD.content_blob_id;
+            END
+        )",
+            R"(
+            CREATE TRIGGER IF NOT EXISTS trg_messages_blob_delete AFTER DELETE ON messages WHEN OLD.content_blob_id IS NOT NULL
+            BEGIN
+                UPDATE blobs SET ref_count = ref_count - 1 WHERE id = OLD.content_blob_id;
+            END
+        )"};
+}
+
+QStringList DataBaseWorker::fullTextSchemaStatements(const QString &tokenizer)
+{
+    const int systemRole = static_cast<int>(Message::SYSTEM);
+    return {QString("CREATE VIRTUAL TABLE IF NOT EXISTS messages_fts USING fts5(content, content='messages', content_rowid='seq', tokenize='%1')").arg(tokenizer),
+            QString("CREATE VIRTUAL TABLE IF NOT EXISTS conversations_fts USING fts5(summary, conversation_id UNINDEXED, tokenize='%1')").arg(tokenizer),
+            // 清除上下文等系统消息不进入索引，压缩保存的消息由写入线程索引原文
+            QString(R"(
+            CREATE TRIGGER IF NOT EXISTS trg_messages_fts_insert AFTER INSERT ON messages WHEN NEW.role != %1 AND NEW.content_codec = 0
+            BEGIN
+                INSERT INTO messages_fts(rowid, content) VALUES (NEW.seq, NEW.content);
+            END
+        )").arg(systemRole),
+            QString(R"(
+            CREATE TRIGGER IF NOT EXISTS trg_messages_fts_delete AFTER DELETE ON messages WHEN OLD.role != %1 AND OLD.content_codec = 0
+            BEGIN
+                INSERT INTO messages_fts(messages_fts, rowid, content) VALUES ('delete', OLD.seq, OLD.content);
+            END
+        )").arg(systemRole),
+            R"(
+            CREATE TRIGGER IF NOT EXISTS trg_conversations_fts_insert AFTER INSERT ON conversations
+            BEGIN
+                INSERT INTO conversations_fts(summary, conversation_id) VALUES (NEW.summary, NEW.id);
+            END
+        )",
+            R"(
+            CREATE TRIGGER IF NOT EXISTS trg_conversations_fts_update AFTER UPDATE OF summary ON conversations
+            BEGIN
+                DELETE FROM conversations_fts WHERE conversation_id = OLD.id;
+                INSERT INTO conversations_fts(summary, conversation_id) VALUES (NEW.summary, NEW.id);
+            END
+        )",
+            R"(
+            CREATE TRIGGER IF NOT EXISTS trg_conversations_fts_delete AFTER DELETE ON conversations
+            BEGIN
+                DELETE FROM conversations_fts WHERE conversation_id = OLD.id;
+            END
+        )"};
+}
+
+QString DataBaseWorker::probeFullTextTokenizer()
+{
+    // trigram 分词器(SQLite 3.34+)可以检索中文等不以空格分词的文本，不可用时退回 unicode61；FTS5 不可用时返回空
+    QSqlQuery query(m_dataBase);
+    for (const QString &candidate : {QString("trigram"), QString("unicode61")})
+    {
+        if (query.exec(QString("CREATE VIRTUAL TABLE temp.fts_probe USING fts5(content, tokenize='%1')").arg(candidate)))
+        {
+            query.exec("DROP TABLE temp.fts_probe");
+            return candidate;
+        }
+        XLC_LOG_WARN("Full text tokenizer is not available (tokenizer={}): {}", candidate, query.lastError().text());
+    }
+    return QString();
+}
+
+bool DataBaseWorker::execStatements(const QStringList &statements)
 {
+    QSqlQuery query(m_dataBase);
+    for (const QString &statement : statements)
+    {
+        if (!query.exec(statement))
+        {
+            XLC_LOG_ERROR("Execute statement failed (query={}): {}", statement, query.lastError().text());
+            return false;
+        }
+    }
+    return true;
 }
 
-DataBaseWorker::~DataBaseWorker()
+bool DataBaseWorker::migrateSchema()
 {
-    if (m_dataBase.isOpen())
-        m_dataBase.close();
+    QSqlQuery query(m_dataBase);
+    int version = 0;
+    if (query.exec("PRAGMA user_version") && query.next())
+        version = query.value(0).toInt();
+    if (version > SCHEMA_VERSION)
+    {
+        XLC_LOG_ERROR("Database schema is newer than supported (version={}, supported={})", version, SCHEMA_VERSION);
+        return false;
+    }
 
-    if (QSqlDatabase::contains(DB_CONNECTION_NAME))
+    // 新数据库直接创建最新版本的表结构
+    bool hasTables = query.exec("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'conversations'") && query.next();
+    if (version == 0 && !hasTables)
     {
-        QSqlDatabase::removeDatabase(DB_CONNECTION_NAME);
+        m_dataBase.transaction();
+        QString tokenizer = probeFullTextTokenizer();
+        if (tokenizer.isEmpty())
+            XLC_LOG_WARN("FTS5 is not available, full text search is disabled");
+        if (!execStatements(schemaTableStatements() + schemaIndexStatements() + (tokenizer.isEmpty() ? QStringList() : fullTextSchemaStatements(tokenizer))) ||
+            !query.exec(QString("PRAGMA user_version = %1").arg(SCHEMA_VERSION)) ||
+            !m_dataBase.commit())
+        {
+            XLC_LOG_ERROR("Create database schema failed: {}", m_dataBase.lastError().text());
+            m_dataBase.rollback();
+            return false;
+        }
+        XLC_LOG_INFO("Created database schema (version={})", SCHEMA_VERSION);
+        return true;
+    }
+
+    // 已有数据库按版本依次迁移，每个迁移与版本号在同一个事务中提交，失败时回滚到上一个版本
+    struct Migration
+    {
+        int version;
+        const char *description;
+        bool (DataBaseWorker::*migrate)();
+    };
+    const Migration migrations[] = {
+        {1, "conversation stats", &DataBaseWorker::migrateConversationStats},
+        {2, "compact column types", &DataBaseWorker::migrateCompactColumns},
+        {3, "full text search", &DataBaseWorker::migrateFullTextSearch},
+        {4, "content compression", &DataBaseWorker::migrateContentCompression},
+        {5, "blob store", &DataBaseWorker::migrateBlobStore},
+        {6, "foreign key indexes", &DataBaseWorker::migrateForeignKeyIndexes},
+    };
+    for (const Migration &migration : migrations)
+    {
+        if (migration.version <= version)
+            continue;
+        QElapsedTimer migrateTimer;
+        migrateTimer.start();
+        if (!m_dataBase.transaction())
+        {
+            XLC_LOG_ERROR("Migrate database failed (version={}): {}", migration.version, m_dataBase.lastError().text());
+            return false;
+        }
+        if (!(this->*migration.migrate)() ||
+            !query.exec(QString("PRAGMA user_version = %1").arg(migration.version)) ||
+            !m_dataBase.commit())
+        {
+            XLC_LOG_ERROR("Migrate database failed (version={}, description={}): {}", migration.version, migration.description, m_dataBase.lastError().text());
+            m_dataBase.rollback();
+            return false;
+        }
+        version = migration.version;
+        XLC_LOG_INFO("Migrated database (version={}, description={}, elapsedMs={})", migration.version, migration.description, migrateTimer.elapsed());
     }
+    return true;
 }
 
-void DataBaseWorker::initializeDatabase()
+bool DataBaseWorker::migrateConversationStats()
 {
-    // 创建 conversations 表
     QSqlQuery query(m_dataBase);
-    if (!query.exec(R"(
-            CREATE TABLE IF NOT EXISTS conversations (
-                id TEXT PRIMARY KEY,
-                agent_id TEXT NOT NULL,
-                summary TEXT, 
-                created_time TEXT NOT NULL,
-                updated_time TEXT NOT NULL
-            );
-        )"))
-    {
-        XLC_LOG_WARN("Initialize database failed (query={}): {}", query.lastQuery(), query.lastError().text());
-        ToastManager::showMessage(Toast::Type::Warning, QString("初始化数据库链接失败: %1").arg(query.lastError().text()));
-        return;
+    bool hasColumns = false;
+    if (query.exec("PRAGMA table_info(conversations)"))
+    {
+        while (query.next())
+        {
+            if (query.value(1).toString() == "message_count")
+                hasColumns = true;
+        }
     }
-    // 创建 idx_conversations_agent_id 索引
-    if (!query.exec(R"(
-            CREATE INDEX IF NOT EXISTS idx_conversations_agent_id ON conversations(agent_id);
-        )"))
+    // 此时仍是文本列的表结构
+    QStringList statements;
+    if (!hasColumns)
     {
-        XLC_LOG_WARN("Initialize database (query={}): {}", query.lastQuery(), query.lastError().text());
-        ToastManager::showMessage(Toast::Type::Warning, QString("初始化数据库链接失败: %1").arg(query.lastError().text()));
+        statements << "ALTER TABLE conversations ADD COLUMN message_count INTEGER NOT NULL DEFAULT 0"
+                   << "ALTER TABLE conversations ADD COLUMN last_message_seq INTEGER NOT NULL DEFAULT 0"
+                   << "ALTER TABLE conversations ADD COLUMN last_message_preview TEXT";
     }
-    // 创建 idx_conversations_updated_time 索引
-    if (!query.exec(R"(
-            CREATE INDEX IF NOT EXISTS idx_conversations_updated_time ON conversations(updated_time);
-        )"))
+    statements << "DROP INDEX IF EXISTS idx_conversations_updated_time";
+    if (!hasColumns)
     {
-        XLC_LOG_WARN("Initialize database (query={}): {}", query.lastQuery(), query.lastError().text());
-        ToastManager::showMessage(Toast::Type::Warning, QString("初始化数据库链接失败: %1").arg(query.lastError().text()));
+        statements << R"(
+            UPDATE conversations
+            SET
+                message_count = (SELECT COUNT(*) FROM messages m WHERE m.conversation_id = conversations.id),
+                last_message_seq = COALESCE((SELECT MAX(m.seq) FROM messages m WHERE m.conversation_id = conversations.id), 0),
+                last_message_preview = (SELECT substr(m.content, 1, 200) FROM messages m WHERE m.conversation_id = conversations.id ORDER BY m.seq DESC LIMIT 1)
+        )";
     }
+    return execStatements(statements);
+}
 
-    // 创建 messages 表
-    if (!query.exec(R"(
-            CREATE TABLE IF NOT EXISTS messages (
+bool DataBaseWorker::migrateCompactColumns()
+{
+    // 迁移中的表结构固定为版本2，之后的列由后续迁移添加，不能使用 schemaTableStatements()
+    const QStringList tableStatements{R"(
+            CREATE TABLE conversations (
+                id BLOB PRIMARY KEY,
+                agent_id BLOB NOT NULL,
+                summary TEXT,
+                created_time INTEGER NOT NULL,
+                updated_time INTEGER NOT NULL,
+                message_count INTEGER NOT NULL DEFAULT 0,
+                last_message_seq INTEGER NOT NULL DEFAULT 0,
+                last_message_preview TEXT
+            )
+        )",
+                                      R"(
+            CREATE TABLE messages (
                 seq INTEGER PRIMARY KEY AUTOINCREMENT,
-                id TEXT UNIQUE NOT NULL,
-                conversation_id TEXT NOT NULL,
-                role TEXT NOT NULL CHECK(role IN ('USER', 'ASSISTANT', 'TOOL', 'SYSTEM', 'UNKNOWN')),
+                id BLOB UNIQUE NOT NULL,
+                conversation_id BLOB NOT NULL,
+                role INTEGER NOT NULL CHECK(role BETWEEN 0 AND 4),
                 content TEXT NOT NULL,
-                created_time TEXT NOT NULL,
+                created_time INTEGER NOT NULL,
                 avatar_file_path TEXT,
                 tool_calls TEXT,
                 tool_call_id TEXT,
@@ -111,29 +1176,469 @@ void DataBaseWorker::initializeDatabase()
                 FOREIGN KEY(conversation_id) REFERENCES conversations(id)
                     ON DELETE CASCADE
                     ON UPDATE CASCADE
-            );
-        )"))
+            )
+        )"};
+    const QStringList indexStatements{
+        "CREATE INDEX idx_conversations_agent_id ON conversations(agent_id)",
+        "CREATE INDEX idx_conversations_updated_created_time ON conversations(updated_time DESC, created_time DESC)",
+        "CREATE INDEX idx_messages_conversation_id ON messages(conversation_id)",
+        "CREATE INDEX idx_messages_created_time ON messages(created_time)",
+        QString("CREATE INDEX idx_messages_clear_context ON messages(conversation_id, seq) WHERE role = %1").arg(static_cast<int>(Message::SYSTEM)),
+        R"(
+            CREATE TRIGGER trg_messages_after_insert AFTER INSERT ON messages
+            BEGIN
+                UPDATE conversations
+                SET
+                    message_count = message_count + 1,
+                    last_message_seq = NEW.seq,
+                    last_message_preview = substr(NEW.content, 1, 200)
+                WHERE
+                    id = NEW.conversation_id;
+            END
+        )",
+        R"(
+            CREATE TRIGGER trg_messages_after_delete AFTER DELETE ON messages
+            BEGIN
+                UPDATE conversations
+                SET
+                    message_count = message_count - 1
+                WHERE
+                    id = OLD.conversation_id;
+                UPDATE conversations
+                SET
+                    last_message_seq = COALESCE((SELECT MAX(seq) FROM messages WHERE conversation_id = OLD.conversation_id), 0),
+                    last_message_preview = (SELECT substr(content, 1, 200) FROM messages WHERE conversation_id = OLD.conversation_id ORDER BY seq DESC LIMIT 1)
+                WHERE
+                    id = OLD.conversation_id AND last_message_seq = OLD.seq;
+            END
+        )"};
+
+    // 旧表改名后按新的列类型重建，逐行转换后删除旧表；触发器在复制完成后再创建，避免重复计数
+    if (!execStatements({"DROP TRIGGER IF EXISTS trg_messages_after_insert",
+                         "DROP TRIGGER IF EXISTS trg_messages_after_delete",
+                         "DROP INDEX IF EXISTS idx_conversations_agent_id",
+                         "DROP INDEX IF EXISTS idx_conversations_updated_time",
+                         "DROP INDEX IF EXISTS idx_conversations_updated_created_time",
+                         "DROP INDEX IF EXISTS idx_messages_conversation_id",
+                         "DROP INDEX IF EXISTS idx_messages_created_time",
+                         "DROP INDEX IF EXISTS idx_messages_clear_context",
+                         "ALTER TABLE messages RENAME TO messages_v1",
+                         "ALTER TABLE conversations RENAME TO conversations_v1"}) ||
+        !execStatements(tableStatements))
+        return false;
+
+    QSqlQuery querySelect(m_dataBase);
+    querySelect.setForwardOnly(true);
+    QSqlQuery queryInsert(m_dataBase);
+    if (!querySelect.exec(R"(
+                SELECT id, agent_id, summary, created_time, updated_time, message_count, last_message_seq, last_message_preview
+                FROM conversations_v1
+            )") ||
+        !queryInsert.prepare(R"(
+                INSERT INTO conversations (id, agent_id, summary, created_time, updated_time, message_count, last_message_seq, last_message_preview)
+                VALUES (?, ?, ?, ?, ?, ?, ?, ?)
+            )"))
     {
-        XLC_LOG_WARN("Initialize database failed (query={}): {}", query.lastQuery(), query.lastError().text());
-        ToastManager::showMessage(Toast::Type::Warning, QString("初始化数据库链接失败: %1").arg(query.lastError().text()));
-        return;
+        XLC_LOG_ERROR("Migrate conversations failed: {} {}", querySelect.lastError().text(), queryInsert.lastError().text());
+        return false;
+    }
+    int conversationCount = 0;
+    while (querySelect.next())
+    {
+        queryInsert.addBindValue(DataBaseManager::uuidToBlob(querySelect.value(0).toString()));
+        queryInsert.addBindValue(DataBaseManager::uuidToBlob(querySelect.value(1).toString()));
+        queryInsert.addBindValue(querySelect.value(2));
+        queryInsert.addBindValue(DataBaseManager::timeToEpochMs(querySelect.value(3).toString()));
+        queryInsert.addBindValue(DataBaseManager::timeToEpochMs(querySelect.value(4).toString()));
+        queryInsert.addBindValue(querySelect.value(5));
+        queryInsert.addBindValue(querySelect.value(6));
+        queryInsert.addBindValue(querySelect.value(7));
+        if (!queryInsert.exec())
+        {
+            XLC_LOG_ERROR("Migrate conversation failed (uuid={}): {}", querySelect.value(0).toString(), queryInsert.lastError().text());
+            return false;
+        }
+        conversationCount += 1;
+    }
+
+    if (!querySelect.exec(R"(
+                SELECT seq, id, conversation_id, role, content, created_time, avatar_file_path, tool_calls, tool_call_id
+                FROM messages_v1
+                ORDER BY seq
+            )") ||
+        !queryInsert.prepare(R"(
+                INSERT INTO messages (seq, id, conversation_id, role, content, created_time, avatar_file_path, tool_calls, tool_call_id)
+                VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)
+            )"))
+    {
+        XLC_LOG_ERROR("Migrate messages failed: {} {}", querySelect.lastError().text(), queryInsert.lastError().text());
+        return false;
+    }
+    int messageCount = 0;
+    while (querySelect.next())
+    {
+        queryInsert.addBindValue(querySelect.value(0));
+        queryInsert.addBindValue(DataBaseManager::uuidToBlob(querySelect.value(1).toString()));
+        queryInsert.addBindValue(DataBaseManager::uuidToBlob(querySelect.value(2).toString()));
+        queryInsert.addBindValue(static_cast<int>(Message::roleFromString(querySelect.value(3).toString())));
+        queryInsert.addBindValue(querySelect.value(4));
+        queryInsert.addBindValue(DataBaseManager::timeToEpochMs(querySelect.value(5).toString()));
+        queryInsert.addBindValue(querySelect.value(6));
+        queryInsert.addBindValue(querySelect.value(7));
+        queryInsert.addBindValue(querySelect.value(8));
+        if (!queryInsert.exec())
+        {
+            XLC_LOG_ERROR("Migrate message failed (uuid={}): {}", querySelect.value(1).toString(), queryInsert.lastError().text());
+            return false;
+        }
+        messageCount += 1;
+    }
+    querySelect.finish();
+
+    if (!execStatements(QStringList{"DROP TABLE messages_v1", "DROP TABLE conversations_v1"} + indexStatements))
+        return false;
+    XLC_LOG_INFO("Migrated to compact column types (conversations={}, messages={})", conversationCount, messageCount);
+    return true;
+}
+
+bool DataBaseWorker::migrateFullTextSearch()
+{
+    QString tokenizer = probeFullTextTokenizer();
+    if (tokenizer.isEmpty())
+    {
+        XLC_LOG_WARN("FTS5 is not available, full text search is disabled");
+        return true;
+    }
+    // 版本3的全文索引，此时还没有 content_codec 列(迁移4重建消息的触发器)；清除上下文等系统消息不进入索引
+    const int systemRole = static_cast<int>(Message::SYSTEM);
+    QStringList statements{
+        QString("CREATE VIRTUAL TABLE messages_fts USING fts5(content, content='messages', content_rowid='seq', tokenize='%1')").arg(tokenizer),
+        QString("CREATE VIRTUAL TABLE conversations_fts USING fts5(summary, conversation_id UNINDEXED, tokenize='%1')").arg(tokenizer),
+        QString(R"(
+            CREATE TRIGGER trg_messages_fts_insert AFTER INSERT ON messages WHEN NEW.role != %1
+            BEGIN
+                INSERT INTO messages_fts(rowid, content) VALUES (NEW.seq, NEW.content);
+            END
+        )").arg(systemRole),
+        QString(R"(
+            CREATE TRIGGER trg_messages_fts_delete AFTER DELETE ON messages WHEN OLD.role != %1
+            BEGIN
+                INSERT INTO messages_fts(messages_fts, rowid, content) VALUES ('delete', OLD.seq, OLD.content);
+            END
+        )").arg(systemRole),
+        R"(
+            CREATE TRIGGER trg_conversations_fts_insert AFTER INSERT ON conversations
+            BEGIN
+                INSERT INTO conversations_fts(summary, conversation_id) VALUES (NEW.summary, NEW.id);
+            END
+        )",
+        R"(
+            CREATE TRIGGER trg_conversations_fts_update AFTER UPDATE OF summary ON conversations
+            BEGIN
+                DELETE FROM conversations_fts WHERE conversation_id = OLD.id;
+                INSERT INTO conversations_fts(summary, conversation_id) VALUES (NEW.summary, NEW.id);
+            END
+        )",
+        R"(
+            CREATE TRIGGER trg_conversations_fts_delete AFTER DELETE ON conversations
+            BEGIN
+                DELETE FROM conversations_fts WHERE conversation_id = OLD.id;
+            END
+        )",
+        // 索引已有数据
+        "INSERT INTO conversations_fts(summary, conversation_id) SELECT summary, id FROM conversations",
+        QString("INSERT INTO messages_fts(rowid, content) SELECT seq, content FROM messages WHERE role != %1").arg(systemRole)};
+    if (!execStatements(statements))
+        return false;
+    XLC_LOG_INFO("Created full text index (tokenizer={})", tokenizer);
+    return true;
+}
+
+bool DataBaseWorker::migrateContentCompression()
+{
+    QSqlQuery query(m_dataBase);
+    bool hasFullTextIndex = query.exec("SELECT 1 FROM sqlite_master WHERE name = 'messages_fts'") && query.next();
+    // 触发器需要区分压缩保存的消息，按版本4重新创建；压缩保存的消息由写入线程更新预览与索引原文
+    const int systemRole = static_cast<int>(Message::SYSTEM);
+    QStringList statements{"ALTER TABLE messages ADD COLUMN content_codec INTEGER NOT NULL DEFAULT 0",
+                           "DROP TRIGGER trg_messages_after_insert",
+                           "DROP TRIGGER trg_messages_after_delete",
+                           R"(
+            CREATE TRIGGER trg_messages_after_insert AFTER INSERT ON messages
+            BEGIN
+                UPDATE conversations
+                SET
+                    message_count = message_count + 1,
+                    last_message_seq = NEW.seq,
+                    last_message_preview = CASE WHEN NEW.content_codec = 0 THEN substr(NEW.content, 1, 200) END
+                WHERE
+                    id = NEW.conversation_id;
+            END
+        )",
+                           R"(
+            CREATE TRIGGER trg_messages_after_delete AFTER DELETE ON messages
+            BEGIN
+                UPDATE conversations
+                SET
+                    message_count = message_count - 1
+                WHERE
+                    id = OLD.conversation_id;
+                UPDATE conversations
+                SET
+                    last_message_seq = COALESCE((SELECT MAX(seq) FROM messages WHERE conversation_id = OLD.conversation_id), 0),
+                    last_message_preview = (SELECT CASE WHEN content_codec = 0 THEN substr(content, 1, 200) END FROM messages WHERE conversation_id = OLD.conversation_id ORDER BY seq DESC LIMIT 1)
+                WHERE
+                    id = OLD.conversation_id AND last_message_seq = OLD.seq;
+            END
+        )"};
+    if (hasFullTextIndex)
+    {
+        statements << "DROP TRIGGER trg_messages_fts_insert"
+                   << "DROP TRIGGER trg_messages_fts_delete"
+                   << QString(R"(
+            CREATE TRIGGER trg_messages_fts_insert AFTER INSERT ON messages WHEN NEW.role != %1 AND NEW.content_codec = 0
+            BEGIN
+                INSERT INTO messages_fts(rowid, content) VALUES (NEW.seq, NEW.content);
+            END
+        )").arg(systemRole)
+                   << QString(R"(
+            CREATE TRIGGER trg_messages_fts_delete AFTER DELETE ON messages WHEN OLD.role != %1 AND OLD.content_codec = 0
+            BEGIN
+                INSERT INTO messages_fts(messages_fts, rowid, content) VALUES ('delete', OLD.seq, OLD.content);
+            END
+        )").arg(systemRole);
+    }
+    if (!execStatements(statements))
+        return false;
+
+    // 压缩已有的较大消息，tool_calls 改为紧凑JSON(空数组不保存)；全文索引中已是原文，不需要更新
+    QSqlQuery querySelect(m_dataBase);
+    querySelect.setForwardOnly(true);
+    QSqlQuery queryUpdate(m_dataBase);
+    if (!querySelect.exec(QString(R"(
+                SELECT seq, content, tool_calls
+                FROM messages
+                WHERE content_codec = 0 AND (length(CAST(content AS BLOB)) >= %1 OR tool_calls IS NOT NULL)
+            )").arg(DataBaseManager::CONTENT_COMPRESS_THRESHOLD)) ||
+        !queryUpdate.prepare("UPDATE messages SET content = :content, content_codec = :codec, tool_calls = :tool_calls WHERE seq = :seq"))
+    {
+        XLC_LOG_ERROR("Compress messages failed: {} {}", querySelect.lastError().text(), queryUpdate.lastError().text());
+        return false;
+    }
+    int compressedCount = 0;
+    qint64 bytesBefore = 0;
+    qint64 bytesAfter = 0;
+    while (querySelect.next())
+    {
+        QString content = querySelect.value(1).toString();
+        QByteArray utf8 = content.toUtf8();
+        QByteArray compressed = DataBaseManager::compressContent(utf8);
+        QByteArray toolCalls = querySelect.value(2).toByteArray();
+        QJsonDocument jsonDocToolCalls = QJsonDocument::fromJson(toolCalls);
+        QVariant compactToolCalls = toolCalls.isEmpty() ? QVariant() : QVariant(QString::fromUtf8(toolCalls));
+        if (jsonDocToolCalls.isArray())
+            compactToolCalls = jsonDocToolCalls.array().isEmpty() ? QVariant() : QVariant(QString::fromUtf8(jsonDocToolCalls.toJson(QJsonDocument::Compact)));
+        queryUpdate.bindValue(":content", compressed.isEmpty() ? QVariant(content) : QVariant(compressed));
+        queryUpdate.bindValue(":codec", compressed.isEmpty() ? DataBaseManager::CodecPlainText : DataBaseManager::CodecZlib);
+        queryUpdate.bindValue(":tool_calls", compactToolCalls);
+        queryUpdate.bindValue(":seq", querySelect.value(0));
+        if (!queryUpdate.exec())
+        {
+            XLC_LOG_ERROR("Compress message failed (seq={}): {}", querySelect.value(0).toLongLong(), queryUpdate.lastError().text());
+            return false;
+        }
+        bytesBefore += utf8.size() + toolCalls.size();
+        bytesAfter += (compressed.isEmpty() ? utf8.size() : compressed.size()) + compactToolCalls.toString().toUtf8().size();
+        if (!compressed.isEmpty())
+            compressedCount += 1;
     }
-    // 创建 idx_conversations_agent_id 索引
-    if (!query.exec(R"(
-            CREATE INDEX IF NOT EXISTS idx_messages_conversation_id ON messages(conversation_id);
-        )"))
+    // 释放的页在 VACUUM 之前留在数据库文件中复用
+    XLC_LOG_INFO("Compressed message contents (compressed={}, bytesBefore={}, bytesAfter={}, savedBytes={})",
+                 compressedCount,
+                 bytesBefore,
+                 bytesAfter,
+                 bytesBefore - bytesAfter);
+    return true;
+}
+
+bool DataBaseWorker::migrateBlobStore()
+{
+    // 版本5的 blobs 表与引用计数触发器
+    QStringList statements{
+        R"(
+            CREATE TABLE blobs (
+                id INTEGER PRIMARY KEY,
+                hash BLOB UNIQUE NOT NULL,
+                size INTEGER NOT NULL,
+                stored_size INTEGER NOT NULL DEFAULT 0,
+                ref_count INTEGER NOT NULL DEFAULT 0,
+                created_time INTEGER NOT NULL
+            )
+        )",
+        // 每块单独压缩，读写时只需要一块的内存
+        R"(
+            CREATE TABLE blob_chunks (
+                blob_id INTEGER NOT NULL REFERENCES blobs(id) ON DELETE CASCADE,
+                chunk_index INTEGER NOT NULL,
+                codec INTEGER NOT NULL,
+                data BLOB NOT NULL,
+                PRIMARY KEY(blob_id, chunk_index)
+            )
+        )"};
+    // 引用计数由触发器维护，计数为0的 blobs 由 slot_collectGarbageBlobs 删除
+    statements << "ALTER TABLE messages ADD COLUMN content_blob_id INTEGER REFERENCES blobs(id)"
+               << "CREATE INDEX idx_blobs_unreferenced ON blobs(id) WHERE ref_count <= 0"
+               << R"(
+            CREATE TRIGGER trg_messages_blob_insert AFTER INSERT ON messages WHEN NEW.content_blob_id IS NOT NULL
+            BEGIN
+                UPDATE blobs SET ref_count = ref_count + 1 WHERE id = NEW.content_blob_id;
+            END
+        )"
+               << R"(
+            CREATE TRIGGER trg_messages_blob_update AFTER UPDATE OF content_blob_id ON messages
+            BEGIN
+                UPDATE blobs SET ref_count = ref_count + 1 WHERE id = NEW.content_blob_id;
+                UPDATE blobs SET ref_count = ref_count - 1 WHERE id = OLD.content_blob_id;
+            END
+        )"
+               << R"(
+            CREATE TRIGGER trg_messages_blob_delete AFTER DELETE ON messages WHEN OLD.content_blob_id IS NOT NULL
+            BEGIN
+                UPDATE blobs SET ref_count = ref_count - 1 WHERE id = OLD.content_blob_id;
+            END
+        )";
+    if (!execStatements(statements))
+        return false;
+
+    // 较大的已有消息内容移入 blobs；全文索引中已是原文，不需要更新
+    QSqlQuery querySelect(m_dataBase);
+    querySelect.setForwardOnly(true);
+    QSqlQuery queryUpdate(m_dataBase);
+    if (!querySelect.exec(QString(R"(
+                SELECT seq, content, content_codec
+                FROM messages
+                WHERE content_codec = %1 OR (content_codec = %2 AND length(content) >= %3)
+            )")
+                              .arg(DataBaseManager::CodecZlib)
+                              .arg(DataBaseManager::CodecPlainText)
+                              .arg(DataBaseManager::BLOB_THRESHOLD_CHARS)) ||
+        !queryUpdate.prepare("UPDATE messages SET content = '', content_codec = :codec, content_blob_id = :blob_id WHERE seq = :seq"))
+    {
+        XLC_LOG_ERROR("Move messages to blob store failed: {} {}", querySelect.lastError().text(), queryUpdate.lastError().text());
+        return false;
+    }
+    int movedCount = 0;
+    qint64 bytesBefore = 0;
+    qint64 bytesAfter = 0;
+    while (querySelect.next())
+    {
+        QString content = DataBaseManager::decompressContent(querySelect.value(1), querySelect.value(2).toInt());
+        if (content.size() < DataBaseManager::BLOB_THRESHOLD_CHARS)
+            continue;
+        qint64 storedBytes = 0;
+        qint64 size = 0;
+        qint64 blobId = storeBlob(content, storedBytes, size);
+        if (blobId <= 0)
+            return false;
+        queryUpdate.bindValue(":codec", DataBaseManager::CodecBlob);
+        queryUpdate.bindValue(":blob_id", blobId);
+        queryUpdate.bindValue(":seq", querySelect.value(0));
+        if (!queryUpdate.exec())
+        {
+            XLC_LOG_ERROR("Move message to blob store failed (seq={}): {}", querySelect.value(0).toLongLong(), queryUpdate.lastError().text());
+            return false;
+        }
+        bytesBefore += querySelect.value(1).toByteArray().size();
+        bytesAfter += storedBytes;
+        movedCount += 1;
+    }
+    XLC_LOG_INFO("Moved message contents to blob store (moved={}, bytesBefore={}, bytesAfter={}, savedBytes={})",
+                 movedCount,
+                 bytesBefore,
+                 bytesAfter,
+                 bytesBefore - bytesAfter);
+    return true;
+}
+
+bool DataBaseWorker::migrateForeignKeyIndexes()
+{
+    // 删除对话时按 idx_messages_conversation_id 查找级联删除的消息，删除 blobs 时按此索引检查引用
+    return execStatements({"CREATE INDEX idx_messages_content_blob_id ON messages(content_blob_id) WHERE content_blob_id IS NOT NULL"});
+}
+
+void DataBaseWorker::forEachUtf8Chunk(const QString &content, const std::function<void(const QByteArray &utf8)> &consumer)
+{
+    int position = 0;
+    while (position < content.size())
+    {
+        int length = qMin(DataBaseManager::BLOB_CHUNK_CHARS, content.size() - position);
+        if (position + length < content.size() && content.at(position + length - 1).isHighSurrogate())
+            length -= 1;
+        consumer(content.midRef(position, length).toUtf8());
+        position += length;
+    }
+}
+
+qint64 DataBaseWorker::storeBlob(const QString &content, qint64 &storedBytes, qint64 &size)
+{
+    storedBytes = 0;
+    size = 0;
+    // 第一遍逐块计算哈希，相同内容已保存过时直接引用
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    forEachUtf8Chunk(content,
+                     [&hash, &size](const QByteArray &utf8)
+                     {
+                         hash.addData(utf8);
+                         size += utf8.size();
+                     });
+    QByteArray digest = hash.result();
+    QSqlQuery query(m_dataBase);
+    query.prepare("SELECT id FROM blobs WHERE hash = :hash");
+    query.bindValue(":hash", digest);
+    if (query.exec() && query.next())
+        return query.value(0).toLongLong();
+
+    query.prepare("INSERT INTO blobs (hash, size, created_time) VALUES (:hash, :size, :created_time)");
+    query.bindValue(":hash", digest);
+    query.bindValue(":size", size);
+    query.bindValue(":created_time", QDateTime::currentMSecsSinceEpoch());
+    if (!query.exec())
     {
-        XLC_LOG_WARN("Initialize database (query={}): {}", query.lastQuery(), query.lastError().text());
-        ToastManager::showMessage(Toast::Type::Warning, QString("初始化数据库链接失败: %1").arg(query.lastError().text()));
+        XLC_LOG_WARN("Insert blob failed (bytes={}): {}", size, query.lastError().text());
+        return 0;
     }
-    // 创建 idx_conversations_updated_time 索引
-    if (!query.exec(R"(
-            CREATE INDEX IF NOT EXISTS idx_messages_created_time ON messages(created_time);
-        )"))
+    qint64 blobId = query.lastInsertId().toLongLong();
+    // 第二遍逐块压缩写入，不生成完整内容的 UTF-8 或压缩副本
+    QSqlQuery queryChunk(m_dataBase);
+    queryChunk.prepare("INSERT INTO blob_chunks (blob_id, chunk_index, codec, data) VALUES (:blob_id, :chunk_index, :codec, :data)");
+    int chunkIndex = 0;
+    bool success = true;
+    forEachUtf8Chunk(content,
+                     [&](const QByteArray &utf8)
+                     {
+                         if (!success)
+                             return;
+                         QByteArray compressed = DataBaseManager::compressContent(utf8);
+                         queryChunk.bindValue(":blob_id", blobId);
+                         queryChunk.bindValue(":chunk_index", chunkIndex++);
+                         queryChunk.bindValue(":codec", compressed.isEmpty() ? DataBaseManager::CodecPlainText : DataBaseManager::CodecZlib);
+                         queryChunk.bindValue(":data", compressed.isEmpty() ? utf8 : compressed);
+                         success = queryChunk.exec();
+                         storedBytes += compressed.isEmpty() ? utf8.size() : compressed.size();
+                     });
+    query.prepare("UPDATE blobs SET stored_size = :stored_size WHERE id = :id");
+    query.bindValue(":stored_size", storedBytes);
+    query.bindValue(":id", blobId);
+    if (!success || !query.exec())
     {
-        XLC_LOG_WARN("Initialize database (query={}): {}", query.lastQuery(), query.lastError().text());
-        ToastManager::showMessage(Toast::Type::Warning, QString("初始化数据库链接失败: %1").arg(query.lastError().text()));
+        // 不保留写了一半的内容，否则之后相同的内容会引用到它
+        XLC_LOG_WARN("Insert blob chunks failed (blobId={}): {} {}", blobId, queryChunk.lastError().text(), query.lastError().text());
+        query.exec(QString("DELETE FROM blob_chunks WHERE blob_id = %1").arg(blobId));
+        query.exec(QString("DELETE FROM blobs WHERE id = %1").arg(blobId));
+        storedBytes = 0;
+        return 0;
     }
+    return blobId;
 }
 
 void DataBaseWorker::slot_initialize()
@@ -151,52 +1656,36 @@ void DataBaseWorker::slot_initialize()
     else
         XLC_LOG_INFO("Worker opened database successfully");
 
-    initializeDatabase();
-}
-
-void DataBaseWorker::slot_getAllConversationInfo()
-{
+    // WAL 模式下读取与写入互不阻塞；synchronous=NORMAL 时只在检查点 fsync，断电最多丢失最近提交的事务，不会损坏数据库
+    // auto_vacuum 只有在创建第一个表之前设置才会直接生效，已有数据库需要用户在存储设置中手动转换(slot_enableIncrementalVacuum)
     QSqlQuery query(m_dataBase);
-    query.prepare(R"(
-                SELECT
-                    c.id,
-                    c.agent_id,
-                    c.summary,
-                    c.created_time,
-                    c.updated_time,
-                    COUNT(m.conversation_id) AS message_count
-                FROM
-                    conversations c
-                LEFT JOIN
-                    messages m ON c.id = m.conversation_id
-                GROUP BY
-                    c.id, c.agent_id, c.summary, c.created_time, c.updated_time
-                ORDER BY
-                    c.updated_time DESC,
-                    c.created_time DESC
-            )");
-    if (!query.exec())
-    {
-        Q_EMIT sig_allConversationInfoAcquired(false, QJsonArray());
-        XLC_LOG_WARN("Get all conversation information failed (query={}): {}", query.lastQuery(), query.lastError().text());
-        ToastManager::showMessage(Toast::Type::Warning, QString("获取对话信息失败: %1").arg(query.lastError().text()));
-        return;
-    }
-    // 解析数据
-    QJsonArray jsonArrayConversationInfo;
-    while (query.next())
+    for (const QString &pragma : {QString("PRAGMA auto_vacuum = INCREMENTAL"),
+                                  QString("PRAGMA journal_mode = WAL"),
+                                  QString("PRAGMA synchronous = NORMAL"),
+                                  QString("PRAGMA busy_timeout = 5000"),
+                                  QString("PRAGMA temp_store = MEMORY"),
+                                  QString("PRAGMA mmap_size = %1").arg(MMAP_SIZE),
+                                  QString("PRAGMA cache_size = %1").arg(CACHE_SIZE)})
     {
-        QJsonObject jsonObjConversationInfo;
-        jsonObjConversationInfo["uuid"] = query.value(0).toString();
-        jsonObjConversationInfo["agent_uuid"] = query.value(1).toString();
-        jsonObjConversationInfo["summary"] = query.value(2).toString();
-        jsonObjConversationInfo["created_time"] = query.value(3).toString();
-        jsonObjConversationInfo["updated_time"] = query.value(4).toString();
-        jsonObjConversationInfo["message_count"] = query.value(5).toInt();
-        jsonArrayConversationInfo.append(jsonObjConversationInfo);
+        if (!query.exec(pragma))
+            XLC_LOG_WARN("Apply pragma failed (query={}): {}", pragma, query.lastError().text());
     }
-    XLC_LOG_TRACE("Get all conversation information successfully (conversationsCount={}, query={})", jsonArrayConversationInfo.size(), query.lastQuery());
-    Q_EMIT sig_allConversationInfoAcquired(true, jsonArrayConversationInfo);
+    if (query.exec("PRAGMA journal_mode") && query.next())
+        XLC_LOG_INFO("Database journal mode: {}", query.value(0).toString());
+
+    initializeDatabase();
+
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(FLUSH_INTERVAL_MS);
+    connect(m_flushTimer, &QTimer::timeout, this, &DataBaseWorker::slot_flushPendingWrites);
+
+    // 启动时不与加载对话列表争抢，稍后再执行第一次维护
+    m_maintenanceIntervalTimer = new QTimer(this);
+    m_maintenanceIntervalTimer->setInterval(MAINTENANCE_INTERVAL_MS);
+    connect(m_maintenanceIntervalTimer, &QTimer::timeout, this, &DataBaseWorker::slot_runMaintenance);
+    m_maintenanceIntervalTimer->start();
+    QTimer::singleShot(MAINTENANCE_DELAY_MS, this, &DataBaseWorker::slot_runMaintenance);
 }
 
 void DataBaseWorker::slot_insertNewConversation(const QString &agentUuid,
@@ -210,11 +1699,11 @@ void DataBaseWorker::slot_insertNewConversation(const QString &agentUuid,
                 INSERT INTO conversations (id, agent_id, summary, created_time, updated_time)
                 VALUES (:id, :agent_id, :summary, :created_time, :updated_time)
             )");
-    query.bindValue(":id", uuid);
-    query.bindValue(":agent_id", agentUuid);
+    query.bindValue(":id", DataBaseManager::uuidToBlob(uuid));
+    query.bindValue(":agent_id", DataBaseManager::uuidToBlob(agentUuid));
     query.bindValue(":summary", summary);
-    query.bindValue(":created_time", createdTime);
-    query.bindValue(":updated_time", updatedTime);
+    query.bindValue(":created_time", DataBaseManager::timeToEpochMs(createdTime));
+    query.bindValue(":updated_time", DataBaseManager::timeToEpochMs(updatedTime));
     if (!query.exec())
     {
         XLC_LOG_WARN("Insert conversations failed (uuid={}, agentUuid={}, summary={}, createdTime={}, updatedTime={}, query={}): {}",
@@ -237,6 +1726,7 @@ void DataBaseWorker::slot_insertNewConversation(const QString &agentUuid,
                       updatedTime,
                       query.lastQuery());
     }
+    endWrites(uuid, 1);
 }
 
 void DataBaseWorker::slot_insertNewMessage(const QString &conversationUuid,
@@ -248,157 +1738,517 @@ void DataBaseWorker::slot_insertNewMessage(const QString &conversationUuid,
                                            const QJsonArray &toolCalls,
                                            const QString &toolCallId)
 {
-    QString strRole;
-    switch (role)
-    {
-    case 0:
-        strRole = "USER";
-        break;
-    case 1:
-        strRole = "ASSISTANT";
-        break;
-    case 2:
-        strRole = "TOOL";
-        break;
-    case 3:
-        strRole = "SYSTEM";
-        break;
-    default:
-        strRole = "UNKNOWN";
-        break;
-    }
-    QString strToolCalls = QString::fromUtf8(QJsonDocument(toolCalls).toJson(QJsonDocument::Indented));
+    // 写入队列，与同一批次的其他消息在一个事务中提交
+    m_pendingMessages.append(PendingMessage{conversationUuid, uuid, role, content, createdTime, avatarFilePath, toolCalls, toolCallId});
+    // 更新对应 conversation 的更新时间(同一对话只保留最新的时间)
+    m_pendingUpdatedTimes.insert(conversationUuid, createdTime);
+    m_queueDepth = m_pendingMessages.size();
+    if (m_pendingMessages.size() > m_maxQueueDepth)
+        m_maxQueueDepth = m_pendingMessages.size();
+    if (m_pendingMessages.size() >= FLUSH_MAX_MESSAGES || !m_flushTimer)
+        slot_flushPendingWrites();
+    else if (!m_flushTimer->isActive())
+        m_flushTimer->start();
+}
+
+void DataBaseWorker::slot_updateConversationUpdatedTime(const QString &uuid, const QString &newUpdatedTime)
+{
+    // 与消息一起提交
+    m_pendingUpdatedTimes.insert(uuid, newUpdatedTime);
+    if (m_flushTimer && !m_flushTimer->isActive())
+        m_flushTimer->start();
+}
+
+void DataBaseWorker::slot_flushPendingWrites()
+{
+    if (m_flushTimer)
+        m_flushTimer->stop();
+    if (m_pendingMessages.isEmpty() && m_pendingUpdatedTimes.isEmpty())
+        return;
+    QVector<PendingMessage> pendingMessages = std::move(m_pendingMessages);
+    QHash<QString, QString> pendingUpdatedTimes = std::move(m_pendingUpdatedTimes);
+    m_pendingMessages.clear();
+    m_pendingUpdatedTimes.clear();
+    m_queueDepth = 0;
+    // 提交(或失败)后才允许只读连接跳过写线程读取这些对话
+    QHash<QString, int> flushedWrites;
+    for (const PendingMessage &message : pendingMessages)
+        flushedWrites[message.conversationUuid] += 1;
+
+    QElapsedTimer commitTimer;
+    commitTimer.start();
+    // 事务失败时仍逐条写入(每条自动提交)，避免整批消息丢失
+    bool inTransaction = m_dataBase.transaction();
+    if (!inTransaction)
+        XLC_LOG_WARN("Begin transaction failed, writing messages one by one: {}", m_dataBase.lastError().text());
+
     // 插入新消息
     QSqlQuery query(m_dataBase);
     query.prepare(R"(
-                INSERT INTO messages (id, conversation_id, role, content, created_time, avatar_file_path, tool_calls, tool_call_id)
-                VALUES (:id, :conversation_id, :role, :content, :created_time, :avatar_file_path, :tool_calls, :tool_call_id)
+                INSERT INTO messages (id, conversation_id, role, content, content_codec, content_blob_id, created_time, avatar_file_path, tool_calls, tool_call_id)
+                VALUES (:id, :conversation_id, :role, :content, :content_codec, :content_blob_id, :created_time, :avatar_file_path, :tool_calls, :tool_call_id)
+            )");
+    // 压缩保存的消息: 全文索引写入原文，并更新对话的最后一条消息预览(触发器无法读取压缩的内容)
+    QSqlQuery queryIndex(m_dataBase);
+    queryIndex.prepare("INSERT INTO messages_fts(rowid, content) VALUES (:seq, :content)");
+    QSqlQuery queryPreview(m_dataBase);
+    queryPreview.prepare("UPDATE conversations SET last_message_preview = :preview WHERE id = :id AND last_message_seq = :seq");
+    int failedMessages = 0;
+    qint64 contentBytes = 0;
+    qint64 storedContentBytes = 0;
+    int deduplicatedBlobs = 0;
+    for (const PendingMessage &message : pendingMessages)
+    {
+        QString strRole = Message::roleToString(static_cast<Message::Role>(message.role));
+        // 紧凑格式，没有工具调用时不保存
+        QString strToolCalls = message.toolCalls.isEmpty() ? QString() : QString::fromUtf8(QJsonDocument(message.toolCalls).toJson(QJsonDocument::Compact));
+        // 较大的内容保存到 blobs(相同内容只保存一份)，其余内容超过阈值时压缩后保存在行内
+        qint64 blobId = 0;
+        qint64 blobStoredBytes = 0;
+        qint64 blobSize = 0;
+        if (message.content.size() >= DataBaseManager::BLOB_THRESHOLD_CHARS)
+            blobId = storeBlob(message.content, blobStoredBytes, blobSize);
+        QByteArray utf8 = blobId > 0 ? QByteArray() : message.content.toUtf8();
+        QByteArray compressed = blobId > 0 ? QByteArray() : DataBaseManager::compressContent(utf8);
+        int codec = blobId > 0 ? DataBaseManager::CodecBlob : (compressed.isEmpty() ? DataBaseManager::CodecPlainText : DataBaseManager::CodecZlib);
+        query.bindValue(":id", DataBaseManager::uuidToBlob(message.uuid));
+        query.bindValue(":conversation_id", DataBaseManager::uuidToBlob(message.conversationUuid));
+        query.bindValue(":role", message.role);
+        if (codec == DataBaseManager::CodecBlob)
+            query.bindValue(":content", QString(""));
+        else
+            query.bindValue(":content", compressed.isEmpty() ? QVariant(message.content) : QVariant(compressed));
+        query.bindValue(":content_codec", codec);
+        query.bindValue(":content_blob_id", blobId > 0 ? QVariant(blobId) : QVariant());
+        query.bindValue(":created_time", DataBaseManager::timeToEpochMs(message.createdTime));
+        query.bindValue(":avatar_file_path", message.avatarFilePath);
+        query.bindValue(":tool_calls", strToolCalls.isEmpty() ? QVariant() : QVariant(strToolCalls));
+        query.bindValue(":tool_call_id", message.toolCallId);
+        bool inserted = query.exec();
+        if (inserted && codec != DataBaseManager::CodecPlainText)
+        {
+            qint64 seq = query.lastInsertId().toLongLong();
+            if (m_hasFullTextIndex && message.role != Message::SYSTEM)
+            {
+                queryIndex.bindValue(":seq", seq);
+                queryIndex.bindValue(":content", message.content);
+                if (!queryIndex.exec())
+                    XLC_LOG_WARN("Index compressed message failed (uuid={}): {}", message.uuid, queryIndex.lastError().text());
+            }
+            queryPreview.bindValue(":preview", message.content.left(200));
+            queryPreview.bindValue(":id", DataBaseManager::uuidToBlob(message.conversationUuid));
+            queryPreview.bindValue(":seq", seq);
+            if (!queryPreview.exec())
+                XLC_LOG_WARN("Update last message preview failed (uuid={}): {}", message.uuid, queryPreview.lastError().text());
+        }
+        if (inserted && codec == DataBaseManager::CodecBlob)
+        {
+            // 去重时不写入任何内容
+            contentBytes += blobSize;
+            storedContentBytes += blobStoredBytes;
+            if (blobStoredBytes == 0)
+                deduplicatedBlobs += 1;
+        }
+        else if (inserted)
+        {
+            contentBytes += utf8.size();
+            storedContentBytes += compressed.isEmpty() ? utf8.size() : compressed.size();
+        }
+        if (!inserted)
+        {
+            failedMessages += 1;
+            XLC_LOG_WARN("Insert message failed (uuid={}, conversationUuid={}, role={}, content={}, createdTime={}, avatarFilePath={}, toolCalls={}, toolCallId={}, query={}): {}",
+                         message.uuid,
+                         message.conversationUuid,
+                         strRole,
+                         message.content,
+                         message.createdTime,
+                         message.avatarFilePath,
+                         strToolCalls,
+                         message.toolCallId,
+                         query.lastQuery(),
+                         query.lastError().text());
+            ToastManager::showMessage(Toast::Type::Warning, QString("未能插入消息 (uuid=%1): %2").arg(message.uuid).arg(query.lastError().text()));
+        }
+        else
+        {
+            XLC_LOG_TRACE("Insert message successfully (uuid={}, conversationUuid={}, role={}, createdTime={}, toolCallId={})",
+                          message.uuid,
+                          message.conversationUuid,
+                          strRole,
+                          message.createdTime,
+                          message.toolCallId);
+        }
+    }
+
+    // 更新 conversation 的更新时间，每个对话只更新一次
+    QSqlQuery queryUpdate(m_dataBase);
+    queryUpdate.prepare(R"(
+                UPDATE conversations
+                SET 
+                updated_time = :new_updated_time
+                WHERE
+                id = :id
             )");
-    query.bindValue(":id", uuid);
-    query.bindValue(":conversation_id", conversationUuid);
-    query.bindValue(":role", strRole);
-    query.bindValue(":content", content);
-    query.bindValue(":created_time", createdTime);
-    query.bindValue(":avatar_file_path", avatarFilePath);
-    query.bindValue(":tool_calls", strToolCalls);
-    query.bindValue(":tool_call_id", toolCallId);
+    for (auto it = pendingUpdatedTimes.constBegin(); it != pendingUpdatedTimes.constEnd(); ++it)
+    {
+        queryUpdate.bindValue(":new_updated_time", DataBaseManager::timeToEpochMs(it.value()));
+        queryUpdate.bindValue(":id", DataBaseManager::uuidToBlob(it.key()));
+        if (!queryUpdate.exec())
+        {
+            XLC_LOG_WARN("Update conversation updated_time failed (uuid={}, newUpdatedTime={}, query={}): {}",
+                         it.key(),
+                         it.value(),
+                         queryUpdate.lastQuery(),
+                         queryUpdate.lastError().text());
+            ToastManager::showMessage(Toast::Type::Warning, QString("未能更新对话最后更新时间 (conversationUuid=%1): %2").arg(it.key()).arg(queryUpdate.lastError().text()));
+        }
+    }
+
+    if (inTransaction && !m_dataBase.commit())
+    {
+        XLC_LOG_ERROR("Commit messages failed (messages={}): {}", pendingMessages.size(), m_dataBase.lastError().text());
+        ToastManager::showMessage(Toast::Type::Error, QString("未能保存消息: %1").arg(m_dataBase.lastError().text()));
+        m_dataBase.rollback();
+        endWrites(flushedWrites);
+        return;
+    }
+    endWrites(flushedWrites);
+    qint64 commitUs = commitTimer.nsecsElapsed() / 1000;
+    m_commits += 1;
+    m_messagesWritten += pendingMessages.size() - failedMessages;
+    m_lastCommitUs = commitUs;
+    m_totalCommitUs += commitUs;
+    m_contentBytes += contentBytes;
+    m_storedContentBytes += storedContentBytes;
+    m_deduplicatedBlobs += deduplicatedBlobs;
+    XLC_LOG_DEBUG("Flushed pending writes (messages={}, failed={}, conversations={}, commitMs={:.3f}, averageCommitMs={:.3f}, maxQueueDepth={}, contentBytes={}, storedContentBytes={}, deduplicated={}, totalSavedBytes={})",
+                  pendingMessages.size(),
+                  failedMessages,
+                  pendingUpdatedTimes.size(),
+                  commitUs / 1000.0,
+                  m_totalCommitUs / 1000.0 / m_commits,
+                  m_maxQueueDepth.load(),
+                  contentBytes,
+                  storedContentBytes,
+                  deduplicatedBlobs,
+                  m_contentBytes - m_storedContentBytes);
+}
+
+DataBaseWriteStats DataBaseWorker::getWriteStats() const
+{
+    DataBaseWriteStats stats;
+    stats.queueDepth = m_queueDepth;
+    stats.maxQueueDepth = m_maxQueueDepth;
+    stats.commits = m_commits;
+    stats.messagesWritten = m_messagesWritten;
+    stats.lastCommitUs = m_lastCommitUs;
+    stats.totalCommitUs = m_totalCommitUs;
+    stats.contentBytes = m_contentBytes;
+    stats.storedContentBytes = m_storedContentBytes;
+    stats.deduplicatedBlobs = m_deduplicatedBlobs;
+    return stats;
+}
+
+void DataBaseWorker::beginWrite(const QString &conversationUuid)
+{
+    QMutexLocker locker(&m_mutexPendingWrites);
+    m_pendingWrites[conversationUuid] += 1;
+}
+
+bool DataBaseWorker::hasPendingWrites(const QString &conversationUuid) const
+{
+    QMutexLocker locker(&m_mutexPendingWrites);
+    return conversationUuid.isEmpty() ? !m_pendingWrites.isEmpty() : m_pendingWrites.contains(conversationUuid);
+}
+
+void DataBaseWorker::endWrites(const QString &conversationUuid, int count)
+{
+    QMutexLocker locker(&m_mutexPendingWrites);
+    auto it = m_pendingWrites.find(conversationUuid);
+    if (it == m_pendingWrites.end())
+        return;
+    it.value() -= count;
+    if (it.value() <= 0)
+        m_pendingWrites.erase(it);
+}
+
+void DataBaseWorker::endWrites(const QHash<QString, int> &counts)
+{
+    for (auto it = counts.constBegin(); it != counts.constEnd(); ++it)
+        endWrites(it.key(), it.value());
+}
+
+void DataBaseWorker::slot_collectGarbageBlobs()
+{
+    // 已在分批回收中，新产生的未引用 blobs 会在后续批次中一并删除
+    if (m_isCollectingBlobs)
+        return;
+    m_isCollectingBlobs = true;
+    m_collectedBlobs = 0;
+    m_collectedBlobBytes = 0;
+    collectGarbageBlobsStep();
+}
+
+void DataBaseWorker::collectGarbageBlobsStep()
+{
+    // 每批一个短事务，批次之间回到事件循环，排在后面的写入不需要等待全部回收完成
+    int count = collectGarbageBlobs(m_collectedBlobBytes);
+    if (count > 0)
+        m_collectedBlobs += count;
+    if (count >= GC_BATCH_SIZE)
+    {
+        QTimer::singleShot(0, this, &DataBaseWorker::collectGarbageBlobsStep);
+        return;
+    }
+    m_isCollectingBlobs = false;
+    if (m_collectedBlobs > 0)
+        XLC_LOG_INFO("Collected garbage blobs (count={}, storedBytes={})", m_collectedBlobs, m_collectedBlobBytes);
+}
+
+int DataBaseWorker::collectGarbageBlobs(qint64 &storedBytes)
+{
+    QSqlQuery query(m_dataBase);
+    QStringList ids;
+    qint64 bytes = 0;
+    query.prepare("SELECT id, stored_size FROM blobs WHERE ref_count <= 0 LIMIT :limit");
+    query.bindValue(":limit", GC_BATCH_SIZE);
     if (!query.exec())
     {
-        XLC_LOG_WARN("Insert message failed (uuid={}, conversationUuid={}, role={}, content={}, createdTime={}, avatarFilePath={}, toolCalls={}, toolCallId={}, query={}): {}",
-                     uuid,
-                     conversationUuid,
-                     strRole,
-                     content,
-                     createdTime,
-                     avatarFilePath,
-                     strToolCalls,
-                     toolCallId,
-                     query.lastQuery(),
-                     query.lastError().text());
-        ToastManager::showMessage(Toast::Type::Warning, QString("未能插入消息 (uuid=%1): %2").arg(uuid).arg(query.lastError().text()));
+        XLC_LOG_WARN("Collect garbage blobs failed: {}", query.lastError().text());
+        return -1;
     }
-    else
+    while (query.next())
     {
-        XLC_LOG_TRACE("Insert message successfully (uuid={}, conversationUuid={}, role={}, content={}, createdTime={}, avatarFilePath={}, toolCalls={}, toolCallId={}, query={})",
-                      uuid,
-                      conversationUuid,
-                      strRole,
-                      content,
-                      createdTime,
-                      avatarFilePath,
-                      strToolCalls,
-                      toolCallId,
-                      query.lastQuery());
+        ids << query.value(0).toString();
+        bytes += query.value(1).toLongLong();
     }
+    if (ids.isEmpty())
+        return 0;
+    m_dataBase.transaction();
+    if (!query.exec(QString("DELETE FROM blob_chunks WHERE blob_id IN (%1)").arg(ids.join(','))) ||
+        !query.exec(QString("DELETE FROM blobs WHERE id IN (%1)").arg(ids.join(','))) ||
+        !m_dataBase.commit())
+    {
+        XLC_LOG_WARN("Collect garbage blobs failed: {}", query.lastError().text());
+        m_dataBase.rollback();
+        return -1;
+    }
+    storedBytes += bytes;
+    return ids.size();
+}
 
-    // 更新对应 conversation 的更新时间
-    slot_updateConversationUpdatedTime(conversationUuid, createdTime);
+bool DataBaseWorker::unindexCompressedMessages(const QByteArray &conversationId, qint64 maxSeq)
+{
+    if (!m_hasFullTextIndex)
+        return true;
+    QSqlQuery querySelect(m_dataBase);
+    querySelect.setForwardOnly(true);
+    querySelect.prepare(QString(R"(
+                SELECT seq, content, content_codec, content_blob_id
+                FROM messages
+                WHERE conversation_id = :conversation_id AND seq <= :max_seq AND content_codec != %1 AND role != %2
+            )")
+                            .arg(DataBaseManager::CodecPlainText)
+                            .arg(static_cast<int>(Message::SYSTEM)));
+    querySelect.bindValue(":conversation_id", conversationId);
+    querySelect.bindValue(":max_seq", maxSeq);
+    QSqlQuery queryDelete(m_dataBase);
+    if (!querySelect.exec() ||
+        !queryDelete.prepare("INSERT INTO messages_fts(messages_fts, rowid, content) VALUES ('delete', :seq, :content)"))
+    {
+        XLC_LOG_WARN("Remove compressed messages from full text index failed: {} {}", querySelect.lastError().text(), queryDelete.lastError().text());
+        return false;
+    }
+    while (querySelect.next())
+    {
+        queryDelete.bindValue(":seq", querySelect.value(0));
+        queryDelete.bindValue(":content", DataBaseManager::readContent(m_dataBase, querySelect.value(1), querySelect.value(2).toInt(), querySelect.value(3).toLongLong()));
+        if (!queryDelete.exec())
+        {
+            XLC_LOG_WARN("Remove compressed messages from full text index failed (seq={}): {}", querySelect.value(0).toLongLong(), queryDelete.lastError().text());
+            return false;
+        }
+    }
+    return true;
 }
 
-void DataBaseWorker::slot_updateConversationUpdatedTime(const QString &uuid, const QString &newUpdatedTime)
+int DataBaseWorker::deleteMessagesBatch(const QByteArray &conversationId, int limit)
 {
-    // 更新 conversation 的更新时间
     QSqlQuery query(m_dataBase);
-    query.prepare(R"(
-                UPDATE conversations
-                SET 
-                updated_time = :new_updated_time
-                WHERE
-                id = :id
-            )");
-    query.bindValue(":new_updated_time", newUpdatedTime);
-    query.bindValue(":id", uuid);
+    query.prepare("SELECT seq FROM messages WHERE conversation_id = :conversation_id ORDER BY seq LIMIT 1 OFFSET :offset");
+    query.bindValue(":conversation_id", conversationId);
+    query.bindValue(":offset", limit - 1);
     if (!query.exec())
     {
-        XLC_LOG_WARN("Update conversation updated_time failed (uuid={}, newUpdatedTime={}, query={}): {}",
-                     uuid,
-                     newUpdatedTime,
-                     query.lastQuery(),
-                     query.lastError().text());
-        ToastManager::showMessage(Toast::Type::Warning, QString("未能更新对话最后更新时间 (conversationUuid=%1): %2").arg(uuid).arg(query.lastError().text()));
+        XLC_LOG_WARN("Delete messages failed: {}", query.lastError().text());
+        return -1;
     }
-    else
+    // 不足 limit 条时删除全部
+    qint64 maxSeq = query.next() ? query.value(0).toLongLong() : std::numeric_limits<qint64>::max();
+
+    m_dataBase.transaction();
+    query.prepare("DELETE FROM messages WHERE conversation_id = :conversation_id AND seq <= :max_seq");
+    query.bindValue(":conversation_id", conversationId);
+    query.bindValue(":max_seq", maxSeq);
+    if (!unindexCompressedMessages(conversationId, maxSeq) || !query.exec())
     {
-        XLC_LOG_TRACE("Update conversation updated_time successfully (uuid={}, newUpdatedTime={}, query={})",
-                      uuid,
-                      newUpdatedTime,
-                      query.lastQuery());
+        XLC_LOG_WARN("Delete messages failed: {}", query.lastError().text());
+        m_dataBase.rollback();
+        return -1;
+    }
+    int deletedCount = query.numRowsAffected();
+    if (!m_dataBase.commit())
+    {
+        XLC_LOG_WARN("Delete messages failed: {}", m_dataBase.lastError().text());
+        m_dataBase.rollback();
+        return -1;
     }
+    return deletedCount;
+}
+
+void DataBaseWorker::slot_runMaintenance()
+{
+    if (m_maintenanceStep != MaintenanceIdle)
+        return;
+    m_maintenanceReport = DataBaseMaintenanceReport();
+    m_maintenanceTimer.start();
+    qint64 freeBytes = 0;
+    queryDataBaseSize(m_maintenanceReport.fileBytesBefore, freeBytes);
+
+    m_maintenanceReport.incrementalVacuum = m_incrementalVacuum;
+    m_orphanScanAfter = QByteArray(""); // 空而非 null，绑定为长度为0的 BLOB(小于任何对话id)
+    m_orphanConversationId.clear();
+    m_maintenanceStep = MaintenanceOrphanMessages;
+    runMaintenanceStep();
 }
 
-void DataBaseWorker::slot_getMessages(const QString &conversationUuid)
+void DataBaseWorker::runMaintenanceStep()
 {
+    QElapsedTimer stepTimer;
+    stepTimer.start();
     QSqlQuery query(m_dataBase);
-    query.prepare(R"(
-                SELECT
-                    msg.id,
-                    msg.conversation_id,
-                    msg.role,
-                    msg.content,
-                    msg.created_time,
-                    msg.avatar_file_path,
-                    msg.tool_calls,
-                    msg.tool_call_id
-                FROM
-                    messages msg
-                WHERE
-                    msg.conversation_id = :conversationUuid
-                ORDER BY
-                    msg.seq
+    switch (m_maintenanceStep)
+    {
+    case MaintenanceOrphanMessages:
+    {
+        // 所属对话已不存在的消息(开启外键之前删除对话时留下的)，按对话分批删除
+        if (!m_orphanConversationId.isEmpty())
+        {
+            int deletedCount = deleteMessagesBatch(m_orphanConversationId, MAINTENANCE_BATCH_SIZE);
+            if (deletedCount > 0)
+                m_maintenanceReport.orphanMessages += deletedCount;
+            if (deletedCount < MAINTENANCE_BATCH_SIZE)
+                m_orphanConversationId.clear();
+            break;
+        }
+        // 按 conversation_id 顺序在 idx_messages_conversation_id 中逐个查找下一个对话，每批最多查找 ORPHAN_SCAN_CONVERSATIONS 个
+        query.prepare(R"(
+                SELECT m.conversation_id, EXISTS(SELECT 1 FROM conversations c WHERE c.id = m.conversation_id)
+                FROM messages m
+                WHERE m.conversation_id > :after
+                ORDER BY m.conversation_id
+                LIMIT 1
             )");
-    query.bindValue(":conversationUuid", conversationUuid);
-    if (!query.exec())
+        for (int i = 0; i < ORPHAN_SCAN_CONVERSATIONS && m_orphanConversationId.isEmpty(); ++i)
+        {
+            query.bindValue(":after", m_orphanScanAfter);
+            if (!query.exec())
+            {
+                XLC_LOG_WARN("Find orphan messages failed: {}", query.lastError().text());
+                m_maintenanceStep = MaintenanceBlobs;
+                break;
+            }
+            if (!query.next())
+            {
+                m_maintenanceStep = MaintenanceBlobs;
+                break;
+            }
+            m_orphanScanAfter = query.value(0).toByteArray();
+            if (!query.value(1).toBool())
+                m_orphanConversationId = m_orphanScanAfter;
+        }
+        break;
+    }
+    case MaintenanceBlobs:
     {
-        XLC_LOG_WARN("Get messages failed (conversationUuid={}, query={}): {}",
-                     conversationUuid,
-                     query.lastQuery(),
-                     query.lastError().text());
-        ToastManager::showMessage(Toast::Type::Warning, QString("未能获取到历史消息 (conversationUuid=%1): %2").arg(conversationUuid).arg(query.lastError().text()));
-        Q_EMIT sig_messagesAcquired(false, conversationUuid, QJsonArray());
+        qint64 storedBytes = 0;
+        int collectedCount = collectGarbageBlobs(storedBytes);
+        if (collectedCount > 0)
+            m_maintenanceReport.collectedBlobs += collectedCount;
+        if (collectedCount < GC_BATCH_SIZE)
+            m_maintenanceStep = MaintenanceVacuum;
+        break;
+    }
+    case MaintenanceVacuum:
+    {
+        // 未开启增量 auto_vacuum 时空闲页只能留给之后的写入复用
+        if (!m_incrementalVacuum || !query.exec("PRAGMA freelist_count") || !query.next() || query.value(0).toLongLong() == 0)
+        {
+            m_maintenanceStep = MaintenanceAnalyze;
+            break;
+        }
+        // 每次 sqlite3_step 归还一页，而 QSQLITE 对没有结果列的语句只执行一步，因此每页执行一次
+        qint64 freePages = qMin<qint64>(query.value(0).toLongLong(), VACUUM_PAGES_PER_STEP);
+        m_dataBase.transaction();
+        bool success = query.prepare("PRAGMA incremental_vacuum");
+        for (qint64 i = 0; success && i < freePages; ++i)
+            success = query.exec();
+        if (!success || !m_dataBase.commit())
+        {
+            XLC_LOG_WARN("Incremental vacuum failed: {}", query.lastError().text());
+            m_dataBase.rollback();
+            m_maintenanceStep = MaintenanceAnalyze;
+        }
+        break;
+    }
+    case MaintenanceAnalyze:
+    {
+        // 限制每个索引扫描的行数，数据库再大 ANALYZE 的耗时也有上限
+        if (!query.exec(QString("PRAGMA analysis_limit = %1").arg(ANALYSIS_LIMIT)) || !query.exec("ANALYZE"))
+            XLC_LOG_WARN("Analyze database failed: {}", query.lastError().text());
+        m_maintenanceStep = MaintenanceIdle;
+        break;
+    }
+    case MaintenanceIdle:
         return;
     }
-    // 解析数据
-    QJsonArray jsonArrayMessages;
-    while (query.next())
+    m_maintenanceReport.steps += 1;
+    m_maintenanceReport.longestStepMs = qMax(m_maintenanceReport.longestStepMs, stepTimer.elapsed());
+
+    if (m_maintenanceStep == MaintenanceIdle)
     {
-        QJsonObject jsonObjMessage;
-        jsonObjMessage["uuid"] = query.value(0).toString();
-        jsonObjMessage["conversation_uuid"] = query.value(1).toString();
-        jsonObjMessage["role"] = query.value(2).toString();
-        jsonObjMessage["content"] = query.value(3).toString();
-        jsonObjMessage["created_time"] = query.value(4).toString();
-        jsonObjMessage["avatar_file_path"] = query.value(5).toString();
-        jsonObjMessage["tool_calls"] = query.value(6).toString();
-        jsonObjMessage["tool_call_id"] = query.value(7).toString();
-        jsonArrayMessages.append(jsonObjMessage);
+        finishMaintenance();
+        return;
     }
-    XLC_LOG_DEBUG("Get messages successfully (conversationUuid={}, messagesCount={}, query={})", conversationUuid, jsonArrayMessages.size(), query.lastQuery());
-    Q_EMIT sig_messagesAcquired(true, conversationUuid, jsonArrayMessages);
+    // 排在已收到的请求之后执行下一批，维护期间插入消息最多等待一批
+    QTimer::singleShot(0, this, &DataBaseWorker::runMaintenanceStep);
+}
+
+void DataBaseWorker::finishMaintenance()
+{
+    queryDataBaseSize(m_maintenanceReport.fileBytesAfter, m_maintenanceReport.freeBytesAfter);
+    m_maintenanceReport.elapsedMs = m_maintenanceTimer.elapsed();
+    XLC_LOG_INFO("Database maintenance finished (orphanMessages={}, collectedBlobs={}, bytesBefore={}, bytesAfter={}, reclaimedBytes={}, freeBytes={}, steps={}, longestStepMs={}, elapsedMs={})",
+                 m_maintenanceReport.orphanMessages,
+                 m_maintenanceReport.collectedBlobs,
+                 m_maintenanceReport.fileBytesBefore,
+                 m_maintenanceReport.fileBytesAfter,
+                 m_maintenanceReport.fileBytesBefore - m_maintenanceReport.fileBytesAfter,
+                 m_maintenanceReport.freeBytesAfter,
+                 m_maintenanceReport.steps,
+                 m_maintenanceReport.longestStepMs,
+                 m_maintenanceReport.elapsedMs);
+    emit sig_maintenanceFinished(m_maintenanceReport);
 }
 
 void DataBaseWorker::slot_deleteConversation(const QString &conversationUuid)
 {
+    slot_flushPendingWrites();
+    // 消息由外键级联删除；压缩保存的消息的全文索引需要先用原文删除
+    QByteArray conversationId = DataBaseManager::uuidToBlob(conversationUuid);
     QSqlQuery query(m_dataBase);
+    m_dataBase.transaction();
     query.prepare(R"(
                 DELETE
                 FROM
@@ -406,9 +2256,10 @@ void DataBaseWorker::slot_deleteConversation(const QString &conversationUuid)
                 WHERE
                     id = :conversationUuid
             )");
-    query.bindValue(":conversationUuid", conversationUuid);
-    if (!query.exec())
+    query.bindValue(":conversationUuid", conversationId);
+    if (!unindexCompressedMessages(conversationId, std::numeric_limits<qint64>::max()) || !query.exec() || !m_dataBase.commit())
     {
+        m_dataBase.rollback();
         XLC_LOG_WARN("Delete conversation failed (uuid={}, query={}): {}",
                      conversationUuid,
                      query.lastQuery(),
@@ -421,4 +2272,6 @@ void DataBaseWorker::slot_deleteConversation(const QString &conversationUuid)
                       conversationUuid,
                       query.lastQuery());
     }
+    endWrites(conversationUuid, 1);
+    slot_collectGarbageBlobs();
 }
\ No newline at end of file
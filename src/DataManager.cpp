@@ -2,7 +2,8 @@
 #include "Logger.hpp"
 #include <QFile>
 #include <QJsonDocument>
-#include <QtConcurrent/QtConcurrent>
+#include <QFutureWatcher>
+#include "Executor.h"
 #include <QFuture>
 #include <QSettings>
 #include "ToastManager.h"
@@ -33,6 +34,7 @@ DataManager::DataManager(QObject *parent)
     connect(this, &DataManager::sig_mcpServersLoaded, this, &DataManager::slot_onMcpServersLoaded);
     connect(DataBaseManager::getInstance()->getWorkerPtr(), &DataBaseWorker::sig_allConversationInfoAcquired, this, &DataManager::slot_handleAllConversationInfoAcquired, Qt::QueuedConnection);
     connect(DataBaseManager::getInstance()->getWorkerPtr(), &DataBaseWorker::sig_messagesAcquired, this, &DataManager::slot_handleMessagesAcquired, Qt::QueuedConnection);
+    connect(DataBaseManager::getInstance()->getWorkerPtr(), &DataBaseWorker::sig_contextMessagesAcquired, this, &DataManager::slot_handleContextMessagesAcquired, Qt::QueuedConnection);
 }
 
 void DataManager::init()
@@ -50,7 +52,8 @@ void DataManager::loadDataAsync()
 
 void DataManager::loadLLMsAsync()
 {
-    QFuture<bool> futureMcpServers = QtConcurrent::run(
+    QFuture<bool> futureMcpServers = Executor::getInstance()->run(
+        Executor::Pool::Interactive,
         [this]()
         {
             return this->loadLLMs(m_filePathLLMs);
@@ -75,7 +78,8 @@ void DataManager::loadLLMsAsync()
 
 void DataManager::loadMcpServersAsync()
 {
-    QFuture<bool> futureMcpServers = QtConcurrent::run(
+    QFuture<bool> futureMcpServers = Executor::getInstance()->run(
+        Executor::Pool::Interactive,
         [this]()
         {
             return this->loadMcpServers(m_filePathMcpServers);
@@ -100,7 +104,8 @@ void DataManager::loadMcpServersAsync()
 
 void DataManager::loadAgentsAsync()
 {
-    QFuture<bool> futureAgents = QtConcurrent::run(
+    QFuture<bool> futureAgents = Executor::getInstance()->run(
+        Executor::Pool::Interactive,
         [this]()
         {
             return this->loadAgents(m_filePathAgents);
@@ -145,60 +150,25 @@ void DataManager::slot_handleAllConversationInfoAcquired(bool success, QJsonArra
         QString updatedTime = obj["updated_time"].toString();
         int messageCount = obj["message_count"].toInt();
 
-        m_conversations.insert(uuid, Conversation::create(uuid, agentUuid, summary, createdTime, updatedTime, messageCount));
+        std::shared_ptr<Conversation> conversation = Conversation::create(uuid, agentUuid, summary, createdTime, updatedTime, messageCount);
+        conversation->lastMessagePreview = obj["last_message_preview"].toString();
+        m_conversations.insert(uuid, conversation);
     }
     Q_EMIT sig_conversationsLoaded(success);
 }
 
-void DataManager::slot_handleMessagesAcquired(bool success, const QString &conversationUuid, QJsonArray jsonArrayMessages)
+void DataManager::slot_handleMessagesAcquired(bool success, const QString &conversationUuid, qint64 beforeSeq, bool hasMore, QVector<Message> messages)
 {
     if (!success)
-        return;
-
-    // 解析消息列表，装载消息
-    QList<Message> messages;
-    for (int i = 0; i < jsonArrayMessages.size(); ++i)
     {
-        if (!jsonArrayMessages.at(i).isObject())
-            continue;
-        QJsonObject jsonObjMessage = jsonArrayMessages.at(i).toObject();
-        QString uuid = jsonObjMessage["uuid"].toString();
-        QString conversationUuid = jsonObjMessage["conversation_uuid"].toString();
-        QString roleStr = jsonObjMessage["role"].toString();
-        QString content = jsonObjMessage["content"].toString();
-        QString createdTime = jsonObjMessage["created_time"].toString();
-        QString avatarFilePath = jsonObjMessage["avatar_file_path"].toString();
-        QString strToolCalls = jsonObjMessage["tool_calls"].toString();
-        QString toolCallId = jsonObjMessage["tool_call_id"].toString();
-
-        QJsonParseError parseError;
-        QJsonDocument jsonDocToolCalls = QJsonDocument::fromJson(strToolCalls.toUtf8(), &parseError);
-        QJsonArray jsonArrayToolCalls = QJsonArray();
-        if (!jsonDocToolCalls.isNull())
-        {
-            if (!jsonDocToolCalls.isArray())
-            {
-                XLC_LOG_ERROR("Parse toolcalls failed (conversationUuid={}, strToolCalls={}): strToolCalls is not an array", conversationUuid, strToolCalls);
-            }
-            else
-            {
-                jsonArrayToolCalls = jsonDocToolCalls.array();
-            }
-        }
-        Message::Role role;
-        if (roleStr == "USER")
-            role = Message::USER;
-        else if (roleStr == "ASSISTANT")
-            role = Message::ASSISTANT;
-        else if (roleStr == "TOOL")
-            role = Message::TOOL;
-        else if (roleStr == "SYSTEM")
-            role = Message::SYSTEM;
-        else
-            role = Message::UNKNOWN;
-
-        messages.append(Message(uuid, content, role, createdTime, jsonArrayToolCalls, toolCallId, avatarFilePath));
+        // 向上翻页失败时不再继续翻页，避免滚动时反复失败
+        std::shared_ptr<Conversation> conversation = getConversation(conversationUuid);
+        if (beforeSeq > 0 && conversation)
+            conversation->prependMessages(QVector<Message>(), false);
+        return;
     }
+
+    // 消息已在数据库读取线程中解析完成，这里只装载
     std::shared_ptr<Conversation> conversation = getConversation(conversationUuid);
     if (!conversation)
     {
@@ -206,13 +176,31 @@ void DataManager::slot_handleMessagesAcquired(bool success, const QString &conve
         ToastManager::showMessage(Toast::Type::Warning, QString("历史消息获取失败，不存在的对话: %1").arg(conversationUuid));
         return;
     }
-    conversation->loadMessages(messages);
+    if (beforeSeq > 0)
+    {
+        conversation->prependMessages(messages, hasMore);
+        Q_EMIT sig_olderMessagesLoaded(conversationUuid, messages.size());
+        return;
+    }
+    conversation->loadMessages(messages, hasMore);
     // 从正在获取消息列表中删除对话
     removePengingConversation(conversationUuid);
     // 通知界面更新消息
     Q_EMIT sig_messagesLoaded(conversationUuid);
 }
 
+void DataManager::slot_handleContextMessagesAcquired(bool success, const QString &conversationUuid, QVector<Message> messages)
+{
+    std::shared_ptr<Conversation> conversation = getConversation(conversationUuid);
+    if (!conversation)
+    {
+        XLC_LOG_WARN("Handle context messages acquired failed (conversationUuid={}): conversation not found", conversationUuid);
+        return;
+    }
+    // 失败时(已提示)以空上下文继续，不阻止发送消息
+    conversation->loadContext(success ? messages : QVector<Message>());
+}
+
 bool DataManager::loadLLMs(const QString &filePath)
 {
     QFile file(filePath);
@@ -356,7 +344,8 @@ void DataManager::saveLLMs(const QString &filePath) const
 
 void DataManager::saveLLMsAsync(const QString &filePath) const
 {
-    QFuture<void> futureLLMs = QtConcurrent::run(
+    QFuture<void> futureLLMs = Executor::getInstance()->run(
+        Executor::Pool::Background,
         [this, filePath]()
         {
             if (filePath.trimmed().isEmpty())
@@ -556,7 +545,8 @@ void DataManager::saveMcpServers(const QString &filePath) const
 
 void DataManager::saveMcpServersAsync(const QString &filePath) const
 {
-    QFuture<void> futureMcpServers = QtConcurrent::run(
+    QFuture<void> futureMcpServers = Executor::getInstance()->run(
+        Executor::Pool::Background,
         [this, filePath]()
         {
             if (filePath.trimmed().isEmpty())
@@ -778,7 +768,8 @@ void DataManager::DataManager::saveAgents(const QString &filePath) const
 
 void DataManager::saveAgentsAsync(const QString &filePath) const
 {
-    QFuture<void> futureAgents = QtConcurrent::run(
+    QFuture<void> futureAgents = Executor::getInstance()->run(
+        Executor::Pool::Background,
         [this, filePath]()
         {
             if (filePath.trimmed().isEmpty())
@@ -980,9 +971,20 @@ McpServer::McpServer()
       description(),
       type(sse),
       timeout(30),
+      maxConcurrentCalls(4),
+      resultCacheTtl(60),
+      cacheableTools(),
       command(),
       args(),
       envVars(),
+      minReplicas(1),
+      maxReplicas(1),
+      idleTimeout(0),
+      cpuQuotaPercent(0),
+      memoryLimitMB(0),
+      niceValue(0),
+      ioPriorityClass(0),
+      maxOpenFiles(0),
       host(),
       port(),
       baseUrl(),
@@ -1008,9 +1010,20 @@ McpServer::McpServer(bool isActive,
       description(description),
       type(type),
       timeout(timeout),
+      maxConcurrentCalls(4),
+      resultCacheTtl(60),
+      cacheableTools(),
       command(command),
       args(args),
       envVars(envVars),
+      minReplicas(1),
+      maxReplicas(1),
+      idleTimeout(0),
+      cpuQuotaPercent(0),
+      memoryLimitMB(0),
+      niceValue(0),
+      ioPriorityClass(0),
+      maxOpenFiles(0),
       host(),
       port(),
       baseUrl(baseUrl),
@@ -1037,9 +1050,20 @@ McpServer::McpServer(bool isActive,
       description(description),
       type(type),
       timeout(timeout),
+      maxConcurrentCalls(4),
+      resultCacheTtl(60),
+      cacheableTools(),
       command(command),
       args(args),
       envVars(envVars),
+      minReplicas(1),
+      maxReplicas(1),
+      idleTimeout(0),
+      cpuQuotaPercent(0),
+      memoryLimitMB(0),
+      niceValue(0),
+      ioPriorityClass(0),
+      maxOpenFiles(0),
       host(host),
       port(port),
       baseUrl(),
@@ -1057,6 +1081,13 @@ McpServer McpServer::fromJson(const QJsonObject &jsonObject)
     server.description = jsonObject["description"].toString();
     server.type = static_cast<Type>(jsonObject["type"].toInt());
     server.timeout = jsonObject["timeout"].toInt();
+    server.maxConcurrentCalls = jsonObject["maxConcurrentCalls"].toInt(4);
+    server.resultCacheTtl = qMax(0, jsonObject["resultCacheTtl"].toInt(60));
+    QJsonArray cacheableToolsArray = jsonObject["cacheableTools"].toArray();
+    for (const QJsonValue &value : cacheableToolsArray)
+    {
+        server.cacheableTools.append(value.toString());
+    }
 
     if (server.type == stdio)
     {
@@ -1072,6 +1103,15 @@ McpServer McpServer::fromJson(const QJsonObject &jsonObject)
         {
             server.envVars.insert(it.key(), it.value().toString());
         }
+        server.minReplicas = qMax(1, jsonObject["minReplicas"].toInt(1));
+        server.maxReplicas = qMax(server.minReplicas, jsonObject["maxReplicas"].toInt(1));
+        server.idleTimeout = qMax(0, jsonObject["idleTimeout"].toInt(0));
+        QJsonObject resourceLimitsObject = jsonObject["resourceLimits"].toObject();
+        server.cpuQuotaPercent = qMax(0, resourceLimitsObject["cpuQuotaPercent"].toInt(0));
+        server.memoryLimitMB = qMax(0, resourceLimitsObject["memoryLimitMB"].toInt(0));
+        server.niceValue = qBound(0, resourceLimitsObject["niceValue"].toInt(0), 19);
+        server.ioPriorityClass = resourceLimitsObject["ioPriorityClass"].toInt(0);
+        server.maxOpenFiles = qMax(0, resourceLimitsObject["maxOpenFiles"].toInt(0));
     }
     else if (server.type == sse || server.type == streambleHttp)
     {
@@ -1094,6 +1134,14 @@ QJsonObject McpServer::toJsonObject() const
     jsonObject["description"] = description;
     jsonObject["type"] = type;
     jsonObject["timeout"] = timeout;
+    jsonObject["maxConcurrentCalls"] = maxConcurrentCalls;
+    jsonObject["resultCacheTtl"] = resultCacheTtl;
+    QJsonArray cacheableToolsArray;
+    for (const QString &toolName : cacheableTools)
+    {
+        cacheableToolsArray.append(toolName);
+    }
+    jsonObject["cacheableTools"] = cacheableToolsArray;
 
     if (type == stdio)
     {
@@ -1111,6 +1159,16 @@ QJsonObject McpServer::toJsonObject() const
             envVarsObject.insert(it.key(), it.value());
         }
         jsonObject["envVars"] = envVarsObject;
+        jsonObject["minReplicas"] = minReplicas;
+        jsonObject["maxReplicas"] = maxReplicas;
+        jsonObject["idleTimeout"] = idleTimeout;
+        QJsonObject resourceLimitsObject;
+        resourceLimitsObject["cpuQuotaPercent"] = cpuQuotaPercent;
+        resourceLimitsObject["memoryLimitMB"] = memoryLimitMB;
+        resourceLimitsObject["niceValue"] = niceValue;
+        resourceLimitsObject["ioPriorityClass"] = ioPriorityClass;
+        resourceLimitsObject["maxOpenFiles"] = maxOpenFiles;
+        jsonObject["resourceLimits"] = resourceLimitsObject;
     }
     else if (type == sse || type == streambleHttp)
     {
@@ -1133,6 +1191,9 @@ Agent::Agent()
       temperature(),
       topP(),
       maxTokens(),
+      maxToolResultChars(20000),
+      spillToolResultBlobs(true),
+      maxToolsPerRequest(0),
       mcpServers(),
       conversations()
 {
@@ -1157,6 +1218,9 @@ Agent::Agent(const QString &name,
       temperature(temperature),
       topP(topP),
       maxTokens(maxTokens),
+      maxToolResultChars(20000),
+      spillToolResultBlobs(true),
+      maxToolsPerRequest(0),
       mcpServers(mcpServers),
       conversations(conversations)
 {
@@ -1175,6 +1239,9 @@ Agent Agent::fromJson(const QJsonObject &jsonObject)
     agent.temperature = jsonObject["temperature"].toDouble();
     agent.topP = jsonObject["topP"].toDouble();
     agent.maxTokens = jsonObject["maxTokens"].toInt();
+    agent.maxToolResultChars = qMax(0, jsonObject["maxToolResultChars"].toInt(20000));
+    agent.spillToolResultBlobs = jsonObject["spillToolResultBlobs"].toBool(true);
+    agent.maxToolsPerRequest = qMax(0, jsonObject["maxToolsPerRequest"].toInt(0));
 
     QJsonArray mcpServersArray = jsonObject["mcpServers"].toArray();
     for (const QJsonValue &mcpServerUuid : mcpServersArray)
@@ -1201,6 +1268,9 @@ QJsonObject Agent::toJsonObject() const
     jsonObject["temperature"] = temperature;
     jsonObject["topP"] = topP;
     jsonObject["maxTokens"] = maxTokens;
+    jsonObject["maxToolResultChars"] = maxToolResultChars;
+    jsonObject["spillToolResultBlobs"] = spillToolResultBlobs;
+    jsonObject["maxToolsPerRequest"] = maxToolsPerRequest;
 
     QJsonArray mcpServersArray;
     for (const QString &mcpServerUuid : mcpServers)
@@ -1224,8 +1294,11 @@ Conversation::Conversation(const QString &agentUuid)
       createdTime(getCurrentDateTime()),
       updatedTime(getCurrentDateTime()),
       jsonArrayCachedMessages(QJsonArray()),
-      messageCount(-1)
+      messageCount(0),
+      messagesLoaded(true),
+      contextLoaded(true)
 {
+    // 新建的对话在数据库中没有消息，不需要加载
 }
 
 Conversation::Conversation(const QString &uuid,
@@ -1344,54 +1417,13 @@ void Conversation::addMessage(const Message &newMessage)
     updatedTime = newMessage.createdTime;
     // 更新消息数量
     messageCount += 1;
+    lastMessagePreview = newMessage.content.left(200);
 
     // 更新 messages 缓存
-    QJsonObject jsonObjNewMessage;
-    jsonObjNewMessage["content"] = newMessage.content;
-    switch (newMessage.role)
-    {
-    case Message::USER:
     {
-        jsonObjNewMessage["role"] = "user";
         QMutexLocker locker(&mutex_jsonArrayCachedMessages);
-        jsonArrayCachedMessages.push_back(jsonObjNewMessage);
-        break;
-    }
-    case Message::ASSISTANT:
-    {
-        jsonObjNewMessage["role"] = "assistant";
-        if (!newMessage.toolCalls.isEmpty())
-        {
-            jsonObjNewMessage["tool_calls"] = newMessage.toolCalls;
-        }
-        QMutexLocker locker(&mutex_jsonArrayCachedMessages);
-        jsonArrayCachedMessages.push_back(jsonObjNewMessage);
-        break;
-    }
-    case Message::TOOL:
-    {
-        jsonObjNewMessage["role"] = "tool";
-        jsonObjNewMessage["tool_call_id"] = newMessage.toolCallId;
-        QMutexLocker locker(&mutex_jsonArrayCachedMessages);
-        jsonArrayCachedMessages.push_back(jsonObjNewMessage);
-        break;
-    }
-    case Message::SYSTEM:
-    {
-        jsonObjNewMessage["role"] = "system";
-        // 清除上下文
-        if (newMessage.content == DEFAULT_CONTENT_CLEAR_CONTEXT)
-        {
-            QMutexLocker locker(&mutex_jsonArrayCachedMessages);
-            jsonArrayCachedMessages = QJsonArray();
-        }
-        break;
-    }
-    default:
-    {
-        // 其他情况不添加
-        break;
-    }
+        appendCachedMessage(newMessage);
+        trimCachedMessages();
     }
 
     // 插入数据库
@@ -1410,8 +1442,9 @@ const QVector<Message> Conversation::getMessages()
     /**
      * NOTE 先返回当前messages，
      *      ↓
-     *      再将messageCount与当前messages.size()作比较
-     *      if (messages.size() != messageCount || messageCount = -1) -> 通知DataBaseManager拉取最新的数据（sig_getMessages(const QString &conversationUuid)），
+     *      再检查是否已从数据库加载
+     *      if (!messagesLoaded) -> 通知DataBaseManager拉取最新一页（sig_getMessageList(conversationUuid, 0, MESSAGE_PAGE_SIZE, 0)）
+     *      与LLM上下文（sig_getContextMessages(conversationUuid, contextLimit())），两者互不依赖，
      *      并将当前conversationUuid加入DataManager的pendingConversations中，表示正在拉取数据，然后发送信号通知界面更新状态。
      *      ↓
      *      在DataManager响应DataBaseManager中获取Messages的信号（sig_resultGetMessages(uuid, QJsonArray[存储Message的json数组])），
@@ -1419,17 +1452,37 @@ const QVector<Message> Conversation::getMessages()
      *      ↓
      *      在updateMessages中，更新messages后触发信号通知页面刷新消息列表
      *  */
-    if (messageCount == -1 || messages.size() != messageCount)
+    if (!messagesLoaded)
     {
         if (!DataManager::getInstance()->isPendingConversations(uuid))
         {
             DataManager::getInstance()->addPengingConversation(uuid);
-            Q_EMIT DataBaseManager::getInstance()->sig_getMessageList(uuid);
+            Q_EMIT DataBaseManager::getInstance()->sig_getMessageList(uuid, 0, MESSAGE_PAGE_SIZE, 0);
+            if (!contextLoaded)
+                Q_EMIT DataBaseManager::getInstance()->sig_getContextMessages(uuid, contextLimit());
         }
     }
     return messages;
 }
 
+void Conversation::loadOlderMessages(qint64 untilSeq)
+{
+    if (!messagesLoaded || !olderMessagesRemaining || loadingOlderMessages || messages.isEmpty())
+        return;
+    loadingOlderMessages = true;
+    Q_EMIT DataBaseManager::getInstance()->sig_getMessageList(uuid, messages.first().seq, MESSAGE_PAGE_SIZE, untilSeq);
+}
+
+bool Conversation::hasOlderMessages() const
+{
+    return olderMessagesRemaining;
+}
+
+bool Conversation::isMessagesLoaded() const
+{
+    return messagesLoaded;
+}
+
 const QJsonArray Conversation::getCachedMessages()
 {
     QMutexLocker locker(&mutex_jsonArrayCachedMessages);
@@ -1443,62 +1496,101 @@ void Conversation::clearContext()
     addMessage(Message(DEFAULT_CONTENT_CLEAR_CONTEXT, Message::SYSTEM, getCurrentDateTime()));
 }
 
-void Conversation::loadMessages(const QList<Message> &messageList)
+void Conversation::loadMessages(const QVector<Message> &messageList, bool hasOlderMessages)
+{
+    // 与数据库线程构造的消息共享数据，不复制
+    messages = messageList;
+    messagesLoaded = true;
+    olderMessagesRemaining = hasOlderMessages;
+    loadingOlderMessages = false;
+    if (!messageList.isEmpty())
+        updatedTime = messageList.last().createdTime;
+    XLC_LOG_DEBUG("Load messages successfully (loadedCount={}, messageCount={}, hasOlderMessages={})", messages.size(), messageCount, hasOlderMessages);
+}
+
+void Conversation::loadContext(const QVector<Message> &contextMessages)
 {
     QMutexLocker locker(&mutex_jsonArrayCachedMessages);
     jsonArrayCachedMessages = QJsonArray();
-    messages.clear();
-    // 更新消息数量
-    messageCount = messageList.size();
-    for (const Message &message : messageList)
-    {
-        // 更新 messages
-        messages.append(message);
-        // 更新本地对话更新时间
-        updatedTime = message.createdTime;
-
-        // 更新 json messages 缓存
-        QJsonObject jsonObjMessage;
-        jsonObjMessage["content"] = message.content;
-        switch (message.role)
-        {
-        case Message::USER:
-        {
-            jsonObjMessage["role"] = "user";
-            jsonArrayCachedMessages.push_back(jsonObjMessage);
-            break;
-        }
-        case Message::ASSISTANT:
-        {
-            jsonObjMessage["role"] = "assistant";
-            if (!message.toolCalls.isEmpty())
-            {
-                jsonObjMessage["tool_calls"] = message.toolCalls;
-            }
-            jsonArrayCachedMessages.push_back(jsonObjMessage);
-            break;
-        }
-        case Message::TOOL:
-        {
-            jsonObjMessage["role"] = "tool";
-            jsonObjMessage["tool_call_id"] = message.toolCallId;
-            jsonArrayCachedMessages.push_back(jsonObjMessage);
-            break;
-        }
-        case Message::SYSTEM:
-        {
-            jsonObjMessage["role"] = "system";
-            // 清除上下文
-            if (message.content == DEFAULT_CONTENT_CLEAR_CONTEXT)
-                jsonArrayCachedMessages = QJsonArray();
-            break;
-        }
-        default:
+    contextLoaded = true;
+    for (const Message &message : contextMessages)
+        appendCachedMessage(message);
+    trimCachedMessages();
+    XLC_LOG_DEBUG("Load context successfully (conversationUuid={}, loadedCount={}, contextCount={})", uuid, contextMessages.size(), jsonArrayCachedMessages.size());
+}
+
+bool Conversation::isContextLoaded() const
+{
+    return contextLoaded;
+}
+
+int Conversation::contextLimit() const
+{
+    std::shared_ptr<Agent> agent = DataManager::getInstance()->getAgent(agentUuid);
+    return agent && agent->context > 0 ? agent->context : DEFAULT_CONTEXT_MESSAGES;
+}
+
+void Conversation::appendCachedMessage(const Message &message)
+{
+    QJsonObject jsonObjMessage;
+    jsonObjMessage["content"] = message.content;
+    switch (message.role)
+    {
+    case Message::USER:
+    {
+        jsonObjMessage["role"] = "user";
+        jsonArrayCachedMessages.push_back(jsonObjMessage);
+        break;
+    }
+    case Message::ASSISTANT:
+    {
+        jsonObjMessage["role"] = "assistant";
+        if (!message.toolCalls.isEmpty())
         {
-            // 其他情况不添加
-            break;
-        }
+            jsonObjMessage["tool_calls"] = message.toolCalls;
         }
+        jsonArrayCachedMessages.push_back(jsonObjMessage);
+        break;
+    }
+    case Message::TOOL:
+    {
+        jsonObjMessage["role"] = "tool";
+        jsonObjMessage["tool_call_id"] = message.toolCallId;
+        jsonArrayCachedMessages.push_back(jsonObjMessage);
+        break;
     }
-    XLC_LOG_DEBUG("Load messages successfully (messageCount={})", messageCount);
+    case Message::SYSTEM:
+    {
+        // 清除上下文
+        if (message.content == DEFAULT_CONTENT_CLEAR_CONTEXT)
+            jsonArrayCachedMessages = QJsonArray();
+        break;
+    }
+    default:
+    {
+        // 其他情况不添加
+        break;
+    }
+    }
+}
+
+void Conversation::trimCachedMessages()
+{
+    // 系统提示词不计入上下文数量
+    int first = 0;
+    if (!jsonArrayCachedMessages.isEmpty() && jsonArrayCachedMessages.first().toObject().value("role").toString() == "system")
+        first = 1;
+    int limit = contextLimit();
+    while (jsonArrayCachedMessages.size() - first > limit)
+        jsonArrayCachedMessages.removeAt(first);
+    // 开头的工具结果对应的 tool_calls 已被移除，单独发送会被拒绝
+    while (jsonArrayCachedMessages.size() > first && jsonArrayCachedMessages.at(first).toObject().value("role").toString() == "tool")
+        jsonArrayCachedMessages.removeAt(first);
+}
+
+void Conversation::prependMessages(const QVector<Message> &olderMessages, bool hasOlderMessages)
+{
+    loadingOlderMessages = false;
+    olderMessagesRemaining = hasOlderMessages && !olderMessages.isEmpty();
+    messages = olderMessages + messages;
 }
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "Executor.h"
+#include <QThread>
+#include "Logger.hpp"
+
+double ExecutorPoolMetrics::averageQueueWaitMs() const
+{
+    qint64 startedTasks = completedTasks + activeThreadCount;
+    if (startedTasks == 0)
+        return 0.0;
+    return static_cast<double>(totalQueueWaitMs) / static_cast<double>(startedTasks);
+}
+
+bool ExecutorPoolMetrics::isSaturated() const
+{
+    return activeThreadCount >= maxThreadCount;
+}
+
+Executor::Executor()
+{
+    m_pools[static_cast<int>(Pool::Interactive)].setMaxThreadCount(qMax(2, QThread::idealThreadCount()));
+    m_pools[static_cast<int>(Pool::IoBlocking)].setMaxThreadCount(IO_BLOCKING_THREAD_COUNT);
+    m_pools[static_cast<int>(Pool::Background)].setMaxThreadCount(BACKGROUND_THREAD_COUNT);
+    for (int i = 0; i < POOL_COUNT; ++i)
+    {
+        m_metrics[i].maxThreadCount = m_pools[i].maxThreadCount();
+        XLC_LOG_DEBUG("Executor pool created (pool={}, maxThreadCount={})", poolName(static_cast<Pool>(i)), m_metrics[i].maxThreadCount);
+    }
+}
+
+Executor::~Executor()
+{
+    for (int i = 0; i < POOL_COUNT; ++i)
+    {
+        m_pools[i].clear();
+        m_pools[i].waitForDone();
+    }
+}
+
+ExecutorPoolMetrics Executor::metrics(Pool pool) const
+{
+    QMutexLocker locker(&m_mutexMetrics);
+    return m_metrics[static_cast<int>(pool)];
+}
+
+const char *Executor::poolName(Pool pool)
+{
+    switch (pool)
+    {
+    case Pool::Interactive:
+        return "Interactive";
+    case Pool::IoBlocking:
+        return "IoBlocking";
+    case Pool::Background:
+        return "Background";
+    default:
+        return "Unknown";
+    }
+}
+
+QThreadPool *Executor::threadPool(Pool pool)
+{
+    return &m_pools[static_cast<int>(pool)];
+}
+
+void Executor::onTaskQueued(Pool pool)
+{
+    QMutexLocker locker(&m_mutexMetrics);
+    ExecutorPoolMetrics &metrics = m_metrics[static_cast<int>(pool)];
+    metrics.queuedTasks += 1;
+    metrics.peakQueuedTasks = qMax(metrics.peakQueuedTasks, metrics.queuedTasks);
+}
+
+void Executor::onTaskStarted(Pool pool, qint64 queueWaitMs)
+{
+    QMutexLocker locker(&m_mutexMetrics);
+    ExecutorPoolMetrics &metrics = m_metrics[static_cast<int>(pool)];
+    metrics.queuedTasks -= 1;
+    metrics.activeThreadCount += 1;
+    metrics.totalQueueWaitMs += queueWaitMs;
+    metrics.maxQueueWaitMs = qMax(metrics.maxQueueWaitMs, queueWaitMs);
+    if (queueWaitMs >= SLOW_QUEUE_WAIT_MS)
+    {
+        XLC_LOG_WARN("Executor pool saturated (pool={}, queueWaitMs={}, activeThreadCount={}, maxThreadCount={}, queuedTasks={})",
+                     poolName(pool),
+                     queueWaitMs,
+                     metrics.activeThreadCount,
+                     metrics.maxThreadCount,
+                     metrics.queuedTasks);
+    }
+}
+
+void Executor::onTaskFinished(Pool pool)
+{
+    QMutexLocker locker(&m_mutexMetrics);
+    ExecutorPoolMetrics &metrics = m_metrics[static_cast<int>(pool)];
+    metrics.activeThreadCount -= 1;
+    metrics.completedTasks += 1;
+}
@@ -1,6 +1,7 @@
 #include "HistoryMessageListWidget.h"
 #include <QPainterPath>
 #include <QPixmapCache>
+#include <QScrollBar>
 #include "Logger.hpp"
 #include "ColorRepository.h"
 
@@ -47,6 +48,17 @@ void HistoryMessageListModel::addMessage(const HistoryMessage &message)
     endInsertRows();
 }
 
+void HistoryMessageListModel::prependMessages(const QVector<HistoryMessage> &messages)
+{
+    if (messages.isEmpty())
+        return;
+    beginInsertRows(QModelIndex(), 0, messages.count() - 1);
+    QVector<HistoryMessage> newMessages = messages;
+    newMessages += m_messages;
+    m_messages = std::move(newMessages);
+    endInsertRows();
+}
+
 const HistoryMessage *HistoryMessageListModel::messageAt(int row) const
 {
     if (row >= m_messages.size())
@@ -54,6 +66,16 @@ const HistoryMessage *HistoryMessageListModel::messageAt(int row) const
     return &m_messages.at(row);
 }
 
+int HistoryMessageListModel::rowOf(const QString &id) const
+{
+    for (int row = 0; row < m_messages.size(); ++row)
+    {
+        if (m_messages.at(row).id == id)
+            return row;
+    }
+    return -1;
+}
+
 void HistoryMessageListModel::clearCachedSizes()
 {
     for (HistoryMessage &message : m_messages)
@@ -66,9 +88,9 @@ void HistoryMessageListModel::clearAllMessage()
     {
         return;
     }
-    beginInsertRows(QModelIndex(), 0, m_messages.count() - 1);
+    beginRemoveRows(QModelIndex(), 0, m_messages.count() - 1);
     m_messages.clear();
-    endInsertRows();
+    endRemoveRows();
 }
 
 // CMessageDelegate
@@ -264,6 +286,14 @@ HistoryMessageListWidget::HistoryMessageListWidget(QWidget *parent)
     setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     // NOTE 使用虚拟化列表可以实现多消息不卡顿
     setVerticalScrollMode(QAbstractItemView::ScrollPerPixel); // Smooth scroll
+
+    // 滚动到顶部附近时通知加载更早的消息
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this,
+            [this](int value)
+            {
+                if (value <= LOAD_OLDER_THRESHOLD && m_model->rowCount() > 0)
+                    Q_EMIT sig_reachedTop();
+            });
 }
 
 void HistoryMessageListWidget::resizeEvent(QResizeEvent *event)
@@ -299,6 +329,40 @@ void HistoryMessageListWidget::addMessage(const HistoryMessage &message)
     m_model->addMessage(message);
 }
 
+void HistoryMessageListWidget::prependMessages(const QVector<HistoryMessage> &messages)
+{
+    // 保持当前可见内容到底部的距离不变，插入后视图不跳动
+    QScrollBar *scrollBar = verticalScrollBar();
+    int distanceToBottom = scrollBar->maximum() - scrollBar->value();
+    m_model->prependMessages(messages);
+    doItemsLayout();
+    scrollBar->setValue(scrollBar->maximum() - distanceToBottom);
+}
+
+bool HistoryMessageListWidget::isScrollable()
+{
+    executeDelayedItemsLayout();
+    return verticalScrollBar()->maximum() > 0;
+}
+
+bool HistoryMessageListWidget::scrollToMessage(const QString &id)
+{
+    int row = id.isEmpty() ? -1 : m_model->rowOf(id);
+    if (row < 0)
+        return false;
+    QModelIndex index = m_model->index(row);
+    executeDelayedItemsLayout();
+    scrollTo(index, QAbstractItemView::PositionAtCenter);
+    return true;
+}
+
+QString HistoryMessageListWidget::messageIdAt(const QPoint &pos) const
+{
+    QModelIndex index = indexAt(pos);
+    const HistoryMessage *message = index.isValid() ? m_model->messageAt(index.row()) : nullptr;
+    return message ? message->id : QString();
+}
+
 void HistoryMessageListWidget::clearContext()
 {
     m_model->addMessage(HistoryMessage(DEFAULT_CONTENT_CLEAR_CONTEXT, Message::SYSTEM, getCurrentDateTime()));
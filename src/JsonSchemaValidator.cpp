@@ -0,0 +1,355 @@
+#include "JsonSchemaValidator.h"
+#include <QJsonDocument>
+#include <cmath>
+
+std::shared_ptr<const JsonSchemaValidator> JsonSchemaValidator::compile(const QJsonObject &jsonObjSchema)
+{
+    std::shared_ptr<JsonSchemaValidator> validator(new JsonSchemaValidator());
+    validator->m_jsonObjRoot = jsonObjSchema;
+    validator->m_root = validator->compileNode(jsonObjSchema);
+    // 编译完成后不再需要原始schema
+    validator->m_jsonObjRoot = QJsonObject();
+    return validator;
+}
+
+bool JsonSchemaValidator::validate(const QJsonValue &value, QStringList *errors) const
+{
+    return validateNode(m_root, value, "$", errors);
+}
+
+JsonSchemaValidator::Node *JsonSchemaValidator::newNode()
+{
+    std::shared_ptr<Node> node = std::make_shared<Node>();
+    m_nodes.append(node);
+    return node.get();
+}
+
+const JsonSchemaValidator::Node *JsonSchemaValidator::compileRef(const QString &ref)
+{
+    auto it = m_refs.constFind(ref);
+    if (it != m_refs.constEnd())
+        return it.value();
+    // 只支持文档内的 JSON Pointer(#/definitions/xxx、#/$defs/xxx)
+    if (!ref.startsWith('#'))
+        return nullptr;
+    QJsonValue jsonValueTarget = m_jsonObjRoot;
+    for (QString token : ref.mid(1).split('/', Qt::SkipEmptyParts))
+    {
+        token.replace("~1", "/").replace("~0", "~");
+        if (jsonValueTarget.isObject())
+            jsonValueTarget = jsonValueTarget.toObject().value(token);
+        else if (jsonValueTarget.isArray())
+            jsonValueTarget = jsonValueTarget.toArray().at(token.toInt());
+        else
+            return nullptr;
+    }
+    if (!jsonValueTarget.isObject() && !jsonValueTarget.isBool())
+        return nullptr;
+    // 先登记占位节点，递归引用自身时直接指向该节点
+    Node *node = newNode();
+    m_refs.insert(ref, node);
+    node->ref = compileNode(jsonValueTarget);
+    return node;
+}
+
+const JsonSchemaValidator::Node *JsonSchemaValidator::compileNode(const QJsonValue &jsonValueSchema)
+{
+    Node *node = newNode();
+    // true 代表任意值，false 代表不允许任何值
+    if (jsonValueSchema.isBool())
+    {
+        if (!jsonValueSchema.toBool())
+            node->notNode = newNode();
+        return node;
+    }
+    QJsonObject jsonObjSchema = jsonValueSchema.toObject();
+
+    if (jsonObjSchema.value("$ref").isString())
+        node->ref = compileRef(jsonObjSchema.value("$ref").toString());
+
+    QJsonValue jsonValueType = jsonObjSchema.value("type");
+    QJsonArray jsonArrayTypes = jsonValueType.isArray() ? jsonValueType.toArray() : QJsonArray({jsonValueType});
+    for (const QJsonValue &type : jsonArrayTypes)
+    {
+        QString typeName = type.toString();
+        if (typeName == "null")
+            node->types |= Null;
+        else if (typeName == "boolean")
+            node->types |= Boolean;
+        else if (typeName == "integer")
+            node->types |= Integer;
+        else if (typeName == "number")
+            node->types |= Number | Integer;
+        else if (typeName == "string")
+            node->types |= String;
+        else if (typeName == "array")
+            node->types |= Array;
+        else if (typeName == "object")
+            node->types |= Object;
+    }
+
+    if (jsonObjSchema.value("enum").isArray())
+    {
+        node->hasEnum = true;
+        node->enumValues = jsonObjSchema.value("enum").toArray();
+    }
+    if (jsonObjSchema.contains("const"))
+    {
+        node->hasConst = true;
+        node->constValue = jsonObjSchema.value("const");
+    }
+
+    // 数值范围(同时兼容 draft-04 的布尔 exclusiveMinimum/exclusiveMaximum)
+    if (jsonObjSchema.value("minimum").isDouble())
+    {
+        node->hasMinimum = true;
+        node->minimum = jsonObjSchema.value("minimum").toDouble();
+        node->exclusiveMinimum = jsonObjSchema.value("exclusiveMinimum").toBool(false);
+    }
+    if (jsonObjSchema.value("exclusiveMinimum").isDouble())
+    {
+        node->hasMinimum = true;
+        node->minimum = jsonObjSchema.value("exclusiveMinimum").toDouble();
+        node->exclusiveMinimum = true;
+    }
+    if (jsonObjSchema.value("maximum").isDouble())
+    {
+        node->hasMaximum = true;
+        node->maximum = jsonObjSchema.value("maximum").toDouble();
+        node->exclusiveMaximum = jsonObjSchema.value("exclusiveMaximum").toBool(false);
+    }
+    if (jsonObjSchema.value("exclusiveMaximum").isDouble())
+    {
+        node->hasMaximum = true;
+        node->maximum = jsonObjSchema.value("exclusiveMaximum").toDouble();
+        node->exclusiveMaximum = true;
+    }
+
+    node->minLength = jsonObjSchema.value("minLength").toInt(-1);
+    node->maxLength = jsonObjSchema.value("maxLength").toInt(-1);
+    node->minItems = jsonObjSchema.value("minItems").toInt(-1);
+    node->maxItems = jsonObjSchema.value("maxItems").toInt(-1);
+    node->minProperties = jsonObjSchema.value("minProperties").toInt(-1);
+    node->maxProperties = jsonObjSchema.value("maxProperties").toInt(-1);
+    node->uniqueItems = jsonObjSchema.value("uniqueItems").toBool(false);
+    if (jsonObjSchema.value("pattern").isString())
+    {
+        // 无法编译的正则表达式忽略，避免误拒
+        QRegularExpression pattern(jsonObjSchema.value("pattern").toString());
+        if (pattern.isValid())
+        {
+            pattern.optimize();
+            node->hasPattern = true;
+            node->pattern = pattern;
+        }
+    }
+
+    QJsonObject jsonObjProperties = jsonObjSchema.value("properties").toObject();
+    for (auto it = jsonObjProperties.constBegin(); it != jsonObjProperties.constEnd(); ++it)
+        node->properties.insert(it.key(), compileNode(it.value()));
+    for (const QJsonValue &required : jsonObjSchema.value("required").toArray())
+        node->required.append(required.toString());
+    QJsonValue jsonValueAdditionalProperties = jsonObjSchema.value("additionalProperties");
+    if (jsonValueAdditionalProperties.isBool())
+        node->additionalPropertiesAllowed = jsonValueAdditionalProperties.toBool();
+    else if (jsonValueAdditionalProperties.isObject())
+        node->additionalProperties = compileNode(jsonValueAdditionalProperties);
+
+    QJsonValue jsonValueItems = jsonObjSchema.value("items");
+    if (jsonValueItems.isObject() || jsonValueItems.isBool())
+        node->items = compileNode(jsonValueItems);
+    else if (jsonValueItems.isArray())
+    {
+        for (const QJsonValue &item : jsonValueItems.toArray())
+            node->tupleItems.append(compileNode(item));
+    }
+
+    for (const QJsonValue &subSchema : jsonObjSchema.value("allOf").toArray())
+        node->allOf.append(compileNode(subSchema));
+    for (const QJsonValue &subSchema : jsonObjSchema.value("anyOf").toArray())
+        node->anyOf.append(compileNode(subSchema));
+    for (const QJsonValue &subSchema : jsonObjSchema.value("oneOf").toArray())
+        node->oneOf.append(compileNode(subSchema));
+    if (jsonObjSchema.value("not").isObject() || jsonObjSchema.value("not").isBool())
+        node->notNode = compileNode(jsonObjSchema.value("not"));
+    return node;
+}
+
+bool JsonSchemaValidator::validateNode(const Node *node, const QJsonValue &value, const QString &path, QStringList *errors) const
+{
+    if (!node)
+        return true;
+    bool valid = true;
+    if (node->ref && !validateNode(node->ref, value, path, errors))
+        valid = false;
+
+    const int type = typeOf(value);
+    if (node->types != 0 && (node->types & type) == 0)
+        return addError(errors, path, QString("expected %1, got %2").arg(typeNames(node->types), typeNames(type)));
+
+    if (node->hasEnum && !node->enumValues.contains(value))
+        valid = addError(errors, path, QString("must be one of %1").arg(QString::fromUtf8(QJsonDocument(node->enumValues).toJson(QJsonDocument::Compact))));
+    if (node->hasConst && node->constValue != value)
+        valid = addError(errors, path, "does not match the constant value");
+
+    if (value.isDouble())
+    {
+        double number = value.toDouble();
+        if (node->hasMinimum && (number < node->minimum || (node->exclusiveMinimum && number == node->minimum)))
+            valid = addError(errors, path, QString("must be %1 %2").arg(node->exclusiveMinimum ? ">" : ">=").arg(node->minimum));
+        if (node->hasMaximum && (number > node->maximum || (node->exclusiveMaximum && number == node->maximum)))
+            valid = addError(errors, path, QString("must be %1 %2").arg(node->exclusiveMaximum ? "<" : "<=").arg(node->maximum));
+    }
+    else if (value.isString())
+    {
+        QString text = value.toString();
+        int length = text.toUcs4().size();
+        if (node->minLength >= 0 && length < node->minLength)
+            valid = addError(errors, path, QString("must be at least %1 characters long").arg(node->minLength));
+        if (node->maxLength >= 0 && length > node->maxLength)
+            valid = addError(errors, path, QString("must be at most %1 characters long").arg(node->maxLength));
+        if (node->hasPattern && !node->pattern.match(text).hasMatch())
+            valid = addError(errors, path, QString("must match pattern %1").arg(node->pattern.pattern()));
+    }
+    else if (value.isArray())
+    {
+        QJsonArray jsonArray = value.toArray();
+        if (node->minItems >= 0 && jsonArray.size() < node->minItems)
+            valid = addError(errors, path, QString("must contain at least %1 items").arg(node->minItems));
+        if (node->maxItems >= 0 && jsonArray.size() > node->maxItems)
+            valid = addError(errors, path, QString("must contain at most %1 items").arg(node->maxItems));
+        for (int i = 0; i < jsonArray.size(); ++i)
+        {
+            const Node *itemNode = i < node->tupleItems.size() ? node->tupleItems.at(i) : node->items;
+            if (!validateNode(itemNode, jsonArray.at(i), QString("%1[%2]").arg(path).arg(i), errors))
+                valid = false;
+            if (node->uniqueItems)
+            {
+                for (int j = 0; j < i; ++j)
+                {
+                    if (jsonArray.at(j) == jsonArray.at(i))
+                    {
+                        valid = addError(errors, QString("%1[%2]").arg(path).arg(i), QString("duplicates item %1").arg(j));
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    else if (value.isObject())
+    {
+        QJsonObject jsonObj = value.toObject();
+        if (node->minProperties >= 0 && jsonObj.size() < node->minProperties)
+            valid = addError(errors, path, QString("must contain at least %1 properties").arg(node->minProperties));
+        if (node->maxProperties >= 0 && jsonObj.size() > node->maxProperties)
+            valid = addError(errors, path, QString("must contain at most %1 properties").arg(node->maxProperties));
+        for (const QString &required : node->required)
+        {
+            if (!jsonObj.contains(required))
+                valid = addError(errors, path, QString("missing required property `%1`").arg(required));
+        }
+        for (auto it = jsonObj.constBegin(); it != jsonObj.constEnd(); ++it)
+        {
+            QString propertyPath = path + "." + it.key();
+            auto it_Property = node->properties.constFind(it.key());
+            if (it_Property != node->properties.constEnd())
+            {
+                if (!validateNode(it_Property.value(), it.value(), propertyPath, errors))
+                    valid = false;
+            }
+            else if (!node->additionalPropertiesAllowed)
+            {
+                valid = addError(errors, propertyPath, "unknown property is not allowed");
+            }
+            else if (node->additionalProperties && !validateNode(node->additionalProperties, it.value(), propertyPath, errors))
+            {
+                valid = false;
+            }
+        }
+    }
+
+    for (const Node *subNode : node->allOf)
+    {
+        if (!validateNode(subNode, value, path, errors))
+            valid = false;
+    }
+    if (!node->anyOf.isEmpty())
+    {
+        bool matched = false;
+        for (const Node *subNode : node->anyOf)
+        {
+            if (validateNode(subNode, value, path, nullptr))
+            {
+                matched = true;
+                break;
+            }
+        }
+        if (!matched)
+            valid = addError(errors, path, "does not match any of the allowed schemas (anyOf)");
+    }
+    if (!node->oneOf.isEmpty())
+    {
+        int matchedCount = 0;
+        for (const Node *subNode : node->oneOf)
+        {
+            if (validateNode(subNode, value, path, nullptr))
+                matchedCount += 1;
+        }
+        if (matchedCount != 1)
+            valid = addError(errors, path, QString("must match exactly one schema (oneOf), matched %1").arg(matchedCount));
+    }
+    if (node->notNode && validateNode(node->notNode, value, path, nullptr))
+        valid = addError(errors, path, "is not allowed");
+    return valid;
+}
+
+bool JsonSchemaValidator::addError(QStringList *errors, const QString &path, const QString &message)
+{
+    if (errors && errors->size() < MAX_ERRORS)
+        errors->append(path + ": " + message);
+    return false;
+}
+
+int JsonSchemaValidator::typeOf(const QJsonValue &value)
+{
+    switch (value.type())
+    {
+    case QJsonValue::Null:
+    case QJsonValue::Undefined:
+        return Null;
+    case QJsonValue::Bool:
+        return Boolean;
+    case QJsonValue::Double:
+    {
+        double number = value.toDouble();
+        return std::isfinite(number) && std::floor(number) == number ? Integer : Number;
+    }
+    case QJsonValue::String:
+        return String;
+    case QJsonValue::Array:
+        return Array;
+    case QJsonValue::Object:
+        return Object;
+    }
+    return Null;
+}
+
+QString JsonSchemaValidator::typeNames(int types)
+{
+    QStringList names;
+    if (types & Null)
+        names.append("null");
+    if (types & Boolean)
+        names.append("boolean");
+    if (types & Number)
+        names.append("number");
+    else if (types & Integer)
+        names.append("integer");
+    if (types & String)
+        names.append("string");
+    if (types & Array)
+        names.append("array");
+    if (types & Object)
+        names.append("object");
+    return names.join(" or ");
+}
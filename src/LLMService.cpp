@@ -4,6 +4,7 @@
 #include <QNetworkReply>
 #include "ToastManager.h"
 #include <QJsonDocument>
+#include "ToolResultStore.h"
 
 LLMService *LLMService::s_instance = nullptr;
 
@@ -46,16 +47,19 @@ void LLMService::postMessage(std::shared_ptr<Conversation> conversation, std::sh
         return;
     }
 
+    // 按相关性筛选工具，减少每次请求的提示词大小
+    QJsonArray selectedTools = selectTools(conversation, agent, tools);
+
     // 构建请求体
     QJsonObject jsonObjBody;
-    if (!tools.empty())
+    if (!selectedTools.empty())
     {
         jsonObjBody = {
             {"model", llm->modelID},
             {"max_tokens", agent->maxTokens},
             {"temperature", agent->temperature},
             {"messages", conversation->getCachedMessages()},
-            {"tools", tools},
+            {"tools", selectedTools},
             {"tool_choice", "auto"}};
     }
     else
@@ -86,10 +90,70 @@ void LLMService::postMessage(std::shared_ptr<Conversation> conversation, std::sh
                   llm->uuid,
                   llm->modelID,
                   llm->modelName,
-                  tools.size(),
+                  selectedTools.size(),
                   QString::fromUtf8(QJsonDocument(jsonObjBody).toJson(QJsonDocument::Indented)));
 }
 
+void LLMService::rejectToolCall(const CallToolArgs &callToolArgs, const QString &errorMessage, const QStringList &validationErrors)
+{
+    XLC_LOG_DEBUG("Rejected tool call before dispatch (callId={}, toolName={}): {} {}", callToolArgs.callId, callToolArgs.toolName, errorMessage, validationErrors.join("; "));
+    MCPService::getInstance()->recordRejectedToolCall(callToolArgs.toolName);
+    QString structuredError = MCPService::buildStructuredError("invalid_arguments",
+                                                               errorMessage + ", the tool was not called. Fix the arguments and call the tool again",
+                                                               QJsonObject({{"callId", callToolArgs.callId},
+                                                                            {"errors", QJsonArray::fromStringList(validationErrors)}}));
+    // 调用方在 rejectToolCall 返回后才记录待处理的调用
+    QMetaObject::invokeMethod(
+        this,
+        [this, callToolArgs, structuredError]()
+        {
+            slot_onToolCallFinished(callToolArgs, false, QJsonObject(), structuredError);
+        },
+        Qt::QueuedConnection);
+}
+
+ToolSelectionStats LLMService::getToolSelectionStats() const
+{
+    return m_toolSelectionStats;
+}
+
+QJsonArray LLMService::selectTools(std::shared_ptr<Conversation> conversation, std::shared_ptr<Agent> agent, const QJsonArray &tools)
+{
+    if (agent->maxToolsPerRequest <= 0 || tools.size() <= agent->maxToolsPerRequest)
+        return tools;
+    // 从最新的消息向前查找: 最新的用户消息作为查询，其余最近的消息作为上下文
+    QJsonArray jsonArrayMessages = conversation->getCachedMessages();
+    QString query;
+    QStringList contextList;
+    QSet<QString> usedToolNames;
+    for (int i = jsonArrayMessages.size() - 1; i >= 0; --i)
+    {
+        QJsonObject jsonObjMessage = jsonArrayMessages.at(i).toObject();
+        for (const QJsonValue &jsonValueToolCall : jsonObjMessage.value("tool_calls").toArray())
+            usedToolNames.insert(jsonValueToolCall.toObject().value("function").toObject().value("name").toString());
+        QString role = jsonObjMessage.value("role").toString();
+        if (role == "system" || role == "tool")
+            continue;
+        QString content = jsonObjMessage.value("content").toString();
+        if (query.isEmpty() && role == "user")
+            query = content;
+        else if (contextList.size() < TOOL_SELECTION_CONTEXT_MESSAGES)
+            contextList.append(content.left(TOOL_SELECTION_CONTEXT_CHARS));
+    }
+
+    ToolSelectionStats stats;
+    QJsonArray selectedTools = ToolRetriever::selectTools(tools, query, contextList.join('\n'), usedToolNames, agent->maxToolsPerRequest, &stats);
+    m_toolSelectionStats += stats;
+    XLC_LOG_DEBUG("Selected tools (conversationUuid={}, selected={}, total={}, pinned={}, savedBytes={}, totalSavedBytes={})",
+                  conversation->uuid,
+                  stats.selectedTools,
+                  stats.totalTools,
+                  usedToolNames.size(),
+                  stats.savedBytes(),
+                  m_toolSelectionStats.savedBytes());
+    return selectedTools;
+}
+
 void LLMService::handleResponse(QNetworkReply *reply, std::shared_ptr<Conversation> conversation, std::shared_ptr<Agent> agent, std::shared_ptr<LLM> llm, const QJsonArray &tools, int retries_left)
 {
     // 确保 reply 在处理完毕后被销毁
@@ -237,13 +301,32 @@ void LLMService::handleSuccessfulResponse(const std::shared_ptr<Conversation> &c
                         Q_EMIT sig_toolCalled(conversation->uuid, QString("Calling tool (callId=%1, toolName=%2)").arg(callId).arg(toolName));
                         // 获取 arguments
                         QJsonObject jsonObjectArguments = QJsonObject();
-                        if (jsonObjFunction.contains("arguments") && jsonObjFunction.value("arguments").isString())
+                        QString argumentsError;
+                        QJsonValue jsonValueArguments = jsonObjFunction.value("arguments");
+                        if (jsonValueArguments.isObject())
+                        {
+                            jsonObjectArguments = jsonValueArguments.toObject();
+                        }
+                        else if (jsonValueArguments.isString() && !jsonValueArguments.toString().trimmed().isEmpty())
                         {
-                            QString strArguments = jsonObjFunction.value("arguments").toString();
-                            jsonObjectArguments = QJsonDocument::fromJson(strArguments.toUtf8()).object();
+                            QJsonParseError parseError;
+                            QJsonDocument jsonDocArguments = QJsonDocument::fromJson(jsonValueArguments.toString().toUtf8(), &parseError);
+                            if (parseError.error != QJsonParseError::NoError)
+                                argumentsError = QString("arguments is not valid JSON: %1 at offset %2").arg(parseError.errorString()).arg(parseError.offset);
+                            else if (!jsonDocArguments.isObject())
+                                argumentsError = "arguments must be a JSON object";
+                            else
+                                jsonObjectArguments = jsonDocArguments.object();
                         }
-                        // 执行工具
-                        MCPService::getInstance()->callTool(CallToolArgs{conversation->uuid, callId, toolName, jsonObjectArguments});
+                        // 发送前按 inputSchema 校验参数，不合法时直接返回错误，省去一次服务器往返
+                        QStringList validationErrors;
+                        if (argumentsError.isEmpty() && !MCPService::getInstance()->validateToolArguments(toolName, jsonObjectArguments, &validationErrors))
+                            argumentsError = "arguments do not match the input schema of the tool";
+                        CallToolArgs callToolArgs{conversation->uuid, callId, toolName, jsonObjectArguments};
+                        if (argumentsError.isEmpty())
+                            MCPService::getInstance()->callTool(callToolArgs); // 执行工具
+                        else
+                            rejectToolCall(callToolArgs, argumentsError, validationErrors);
                         // 更新待处理工具调用数量
                         conversation->pendingToolCalls += 1;
                         continue;
@@ -263,13 +346,15 @@ void LLMService::handleSuccessfulResponse(const std::shared_ptr<Conversation> &c
     }
 }
 
-QString LLMService::formatMcpToolResponse(const QJsonObject &jsonObjToolCallResult, const QString &toolName, bool isVisionModel)
+QString LLMService::formatMcpToolResponse(const QJsonObject &jsonObjToolCallResult, const QString &toolName, std::shared_ptr<Agent> agent, bool isVisionModel)
 {
+    const bool spillBlobs = agent ? agent->spillToolResultBlobs : true;
+    const int maxChars = agent ? agent->maxToolResultChars : 0;
     QString content = "Here is the result of mcp tool use `" + toolName + "`:\n";
 
     if (jsonObjToolCallResult.contains("content") && jsonObjToolCallResult.value("content").isArray())
     {
-        QJsonArray jsonArrayContent = jsonObjToolCallResult.value("content").toArray();
+        QJsonArray jsonArrayContent = compactToolResultContent(jsonObjToolCallResult.value("content").toArray(), spillBlobs);
 
         if (isVisionModel)
         {
@@ -291,33 +376,29 @@ QString LLMService::formatMcpToolResponse(const QJsonObject &jsonObjToolCallResu
                             }
                             content += text + "\n";
                         }
-                        else if (type == "image")
+                        else if (type == "image" || type == "audio")
                         {
-                            QString mimeType = "image/png";
+                            QString mimeType = type == "image" ? "image/png" : "audio/mp3";
                             if (jsonObjContentItem.contains("mimeType") && jsonObjContentItem.value("mimeType").isString())
                             {
                                 mimeType = jsonObjContentItem.value("mimeType").toString();
                             }
-                            QString data = "";
-                            if (jsonObjContentItem.contains("data") && jsonObjContentItem.value("data").isString())
+                            // 已保存到磁盘的数据只返回引用
+                            if (jsonObjContentItem.contains("blobId"))
                             {
-                                data = jsonObjContentItem.value("data").toString();
-                            }
-                            content += "Here is a image result: data:" + mimeType + ";base64," + data + "\n";
-                        }
-                        else if (type == "audio")
-                        {
-                            QString mimeType = "audio/mp3";
-                            if (jsonObjContentItem.contains("mimeType") && jsonObjContentItem.value("mimeType").isString())
-                            {
-                                mimeType = jsonObjContentItem.value("mimeType").toString();
+                                content += QString("Here is a %1 result stored as blob `%2` (%3, %4 bytes)\n")
+                                               .arg(type)
+                                               .arg(jsonObjContentItem.value("blobId").toString())
+                                               .arg(mimeType)
+                                               .arg(jsonObjContentItem.value("size").toInt());
+                                continue;
                             }
                             QString data = "";
                             if (jsonObjContentItem.contains("data") && jsonObjContentItem.value("data").isString())
                             {
                                 data = jsonObjContentItem.value("data").toString();
                             }
-                            content += "Here is a audio result: data:" + mimeType + ";base64," + data + "\n";
+                            content += "Here is a " + type + " result: data:" + mimeType + ";base64," + data + "\n";
                         }
                         else
                         {
@@ -338,11 +419,99 @@ QString LLMService::formatMcpToolResponse(const QJsonObject &jsonObjToolCallResu
         content += "no content\n";
     }
 
-    return content;
+    return truncateToolResult(content, maxChars, spillBlobs);
 };
 
+QJsonArray LLMService::compactToolResultContent(const QJsonArray &jsonArrayContent, bool spillBlobs)
+{
+    // 将base64数据保存到磁盘，成功时用 blobId 替换 dataKey 字段
+    auto spillBase64 = [](QJsonObject &jsonObj, const QString &dataKey, const QString &mimeType)
+    {
+        QByteArray data = QByteArray::fromBase64(jsonObj.value(dataKey).toString().toLatin1());
+        if (data.isEmpty())
+            return;
+        QString blobId = ToolResultStore::getInstance()->put(data, mimeType.section('/', 1, 1).section('+', 0, 0));
+        if (blobId.isEmpty())
+            return;
+        jsonObj.remove(dataKey);
+        jsonObj.insert("blobId", blobId);
+        jsonObj.insert("size", data.size());
+    };
+
+    QJsonArray jsonArrayResult;
+    for (const QJsonValue &value : jsonArrayContent)
+    {
+        if (!value.isObject())
+        {
+            jsonArrayResult.append(value);
+            continue;
+        }
+        QJsonObject jsonObjContentItem = value.toObject();
+        QString type = jsonObjContentItem.value("type").toString();
+        if (type == "text")
+        {
+            jsonObjContentItem.insert("text", minifyJsonText(jsonObjContentItem.value("text").toString()));
+        }
+        else if ((type == "image" || type == "audio") && spillBlobs && jsonObjContentItem.value("data").isString())
+        {
+            spillBase64(jsonObjContentItem, "data", jsonObjContentItem.value("mimeType").toString());
+        }
+        else if (type == "resource" && jsonObjContentItem.value("resource").isObject())
+        {
+            // 嵌入的资源: 文本资源压缩，二进制资源保存到磁盘
+            QJsonObject jsonObjResource = jsonObjContentItem.value("resource").toObject();
+            if (jsonObjResource.value("text").isString())
+                jsonObjResource.insert("text", minifyJsonText(jsonObjResource.value("text").toString()));
+            else if (spillBlobs && jsonObjResource.value("blob").isString())
+                spillBase64(jsonObjResource, "blob", jsonObjResource.value("mimeType").toString());
+            jsonObjContentItem.insert("resource", jsonObjResource);
+        }
+        jsonArrayResult.append(jsonObjContentItem);
+    }
+    return jsonArrayResult;
+}
+
+QString LLMService::minifyJsonText(const QString &text)
+{
+    // 只处理JSON对象或数组，其他文本原样返回
+    QString trimmedText = text.trimmed();
+    if (!trimmedText.startsWith('{') && !trimmedText.startsWith('['))
+        return text;
+    QJsonParseError parseError;
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(trimmedText.toUtf8(), &parseError);
+    if (parseError.error != QJsonParseError::NoError)
+        return text;
+    QString minifiedText = QString::fromUtf8(jsonDoc.toJson(QJsonDocument::Compact));
+    return minifiedText.size() < text.size() ? minifiedText : text;
+}
+
+QString LLMService::truncateToolResult(const QString &content, int maxChars, bool spillFullResult)
+{
+    if (maxChars <= 0 || content.size() <= maxChars)
+        return content;
+    // 保留开头和结尾，大部分工具的关键信息(摘要、错误、统计)出现在这两处
+    int headChars = maxChars * 3 / 4;
+    int tailChars = maxChars - headChars;
+    if (headChars > 0 && content.at(headChars - 1).isHighSurrogate())
+        headChars -= 1;
+    if (tailChars > 0 && content.at(content.size() - tailChars).isLowSurrogate())
+        tailChars -= 1;
+    QString blobId = spillFullResult ? ToolResultStore::getInstance()->put(content.toUtf8(), "txt") : QString();
+    QString header = QString("[Tool result truncated: showing %1 of %2 characters%3]\n")
+                         .arg(headChars + tailChars)
+                         .arg(content.size())
+                         .arg(blobId.isEmpty() ? QString() : QString(", full result stored as blob `%1`").arg(blobId));
+    XLC_LOG_DEBUG("Truncated tool result (chars={}, maxChars={}, blobId={})", content.size(), maxChars, blobId);
+    return header + content.left(headChars) +
+           QString("\n...[%1 characters omitted]...\n").arg(content.size() - headChars - tailChars) +
+           content.right(tailChars);
+}
+
 void LLMService::slot_onToolCallFinished(const CallToolArgs &callToolArgs, bool success, const QJsonObject &jsonObjectToolCallResult, const QString &errorMessage)
 {
+    // 不属于对话的调用(如基准测试)由发起方处理
+    if (callToolArgs.conversationUuid.isEmpty())
+        return;
     std::shared_ptr<Conversation> conversation = DataManager::getInstance()->getConversation(callToolArgs.conversationUuid);
     if (!conversation)
     {
@@ -355,8 +524,9 @@ void LLMService::slot_onToolCallFinished(const CallToolArgs &callToolArgs, bool
 
     if (success)
     {
-        // 更新消息列表
-        QString formattedContent = formatMcpToolResponse(jsonObjectToolCallResult, callToolArgs.toolName, false);
+        // 更新消息列表(按agent的限制压缩结果，避免后续每次请求都重复发送过大的结果)
+        std::shared_ptr<Agent> agent = DataManager::getInstance()->getAgent(conversation->agentUuid);
+        QString formattedContent = formatMcpToolResponse(jsonObjectToolCallResult, callToolArgs.toolName, agent, false);
         conversation->addMessage(Message(formattedContent, Message::TOOL, getCurrentDateTime(), QJsonArray(), callToolArgs.callId));
 
         // 展示调用结果
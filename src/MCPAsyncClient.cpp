@@ -0,0 +1,254 @@
+#include "MCPAsyncClient.h"
+#include <QJsonDocument>
+#include "Logger.hpp"
+
+MCPAsyncClient::MCPAsyncClient(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void MCPAsyncClient::initialize(const QString &clientName, const QString &clientVersion, const QJsonObject &capabilities, int timeoutMs, InitializeHandler handler)
+{
+    QJsonObject params{
+        {"protocolVersion", MCP_PROTOCOL_VERSION},
+        {"capabilities", capabilities},
+        {"clientInfo", QJsonObject({{"name", clientName}, {"version", clientVersion}})}};
+    sendRequest(
+        "initialize", params,
+        [this, handler](bool success, const QJsonObject &result, const QString &errorMessage)
+        {
+            if (!success)
+            {
+                handler(false, errorMessage);
+                return;
+            }
+            m_serverCapabilities = result.value("capabilities").toObject();
+            m_protocolVersion = result.value("protocolVersion").toString(MCP_PROTOCOL_VERSION);
+            XLC_LOG_DEBUG("MCP server initialized (protocolVersion={}, serverInfo={})",
+                          m_protocolVersion,
+                          QString::fromUtf8(QJsonDocument(result.value("serverInfo").toObject()).toJson(QJsonDocument::Compact)));
+            sendNotification("notifications/initialized");
+            handleInitialized();
+            handler(true, QString());
+        },
+        timeoutMs);
+}
+
+qint64 MCPAsyncClient::sendRequest(const QString &method, const QJsonObject &params, ResponseHandler handler, int timeoutMs)
+{
+    qint64 requestId = m_nextRequestId++;
+    PendingRequest pendingRequest;
+    pendingRequest.method = method;
+    pendingRequest.handler = std::move(handler);
+    if (timeoutMs > 0)
+    {
+        pendingRequest.timer = new QTimer(this);
+        pendingRequest.timer->setSingleShot(true);
+        connect(pendingRequest.timer, &QTimer::timeout, this,
+                [this, requestId, method, timeoutMs]()
+                {
+                    // 超时后通知服务器取消，并返回错误
+                    auto it = m_pendingRequests.find(requestId);
+                    if (it == m_pendingRequests.end())
+                        return;
+                    ResponseHandler handler = it->handler;
+                    cancelRequest(requestId, "timeout");
+                    handler(false, QJsonObject(), QString("Request timed out (method=%1, timeoutMs=%2)").arg(method).arg(timeoutMs));
+                });
+        pendingRequest.timer->start(timeoutMs);
+    }
+    m_pendingRequests.insert(requestId, pendingRequest);
+
+    QJsonObject message{
+        {"jsonrpc", "2.0"},
+        {"id", requestId},
+        {"method", method}};
+    if (!params.isEmpty())
+        message.insert("params", params);
+    XLC_LOG_TRACE("Sending MCP request (id={}, method={})", requestId, method);
+    writeMessage(message, requestId);
+    return requestId;
+}
+
+void MCPAsyncClient::sendNotification(const QString &method, const QJsonObject &params)
+{
+    QJsonObject message{
+        {"jsonrpc", "2.0"},
+        {"method", method}};
+    if (!params.isEmpty())
+        message.insert("params", params);
+    writeMessage(message, -1);
+}
+
+void MCPAsyncClient::cancelRequest(qint64 requestId, const QString &reason)
+{
+    auto it = m_pendingRequests.find(requestId);
+    if (it == m_pendingRequests.end())
+        return;
+    if (it->timer)
+        it->timer->deleteLater();
+    QString method = it->method;
+    m_pendingRequests.erase(it);
+    XLC_LOG_DEBUG("Cancelling MCP request (id={}, method={}, reason={})", requestId, method, reason);
+    // initialize 请求不能被取消
+    if (method != "initialize")
+        sendNotification("notifications/cancelled", QJsonObject({{"requestId", requestId}, {"reason", reason}}));
+    abortRequest(requestId);
+}
+
+void MCPAsyncClient::listTools(int timeoutMs, ListHandler handler)
+{
+    listAll("tools/list", "tools", timeoutMs, std::move(handler));
+}
+
+void MCPAsyncClient::listAll(const QString &method, const QString &resultKey, int timeoutMs, ListHandler handler)
+{
+    listPage(method, resultKey, QString(), std::make_shared<QJsonArray>(), timeoutMs, std::move(handler));
+}
+
+void MCPAsyncClient::listPage(const QString &method, const QString &resultKey, const QString &cursor, std::shared_ptr<QJsonArray> items, int timeoutMs, ListHandler handler)
+{
+    QJsonObject params;
+    if (!cursor.isEmpty())
+        params.insert("cursor", cursor);
+    sendRequest(
+        method, params,
+        [this, method, resultKey, items, timeoutMs, handler](bool success, const QJsonObject &result, const QString &errorMessage)
+        {
+            if (!success)
+            {
+                handler(false, QJsonArray(), errorMessage);
+                return;
+            }
+            for (const QJsonValue &item : result.value(resultKey).toArray())
+                items->append(item);
+            QString nextCursor = result.value("nextCursor").toString();
+            if (nextCursor.isEmpty())
+                handler(true, *items, QString());
+            else
+                listPage(method, resultKey, nextCursor, items, timeoutMs, handler);
+        },
+        timeoutMs);
+}
+
+const QJsonObject &MCPAsyncClient::getServerCapabilities() const
+{
+    return m_serverCapabilities;
+}
+
+const QString &MCPAsyncClient::getProtocolVersion() const
+{
+    return m_protocolVersion;
+}
+
+int MCPAsyncClient::getPendingRequestCount() const
+{
+    return m_pendingRequests.size();
+}
+
+bool MCPAsyncClient::isServerError(const QString &errorMessage)
+{
+    return errorMessage.startsWith(SERVER_ERROR_PREFIX);
+}
+
+void MCPAsyncClient::abortRequest(qint64 requestId)
+{
+    Q_UNUSED(requestId);
+}
+
+void MCPAsyncClient::handleInitialized()
+{
+}
+
+bool MCPAsyncClient::hasNotificationChannel() const
+{
+    return isConnected();
+}
+
+QJsonObject MCPAsyncClient::clientCapabilities()
+{
+    return QJsonObject({{"roots", QJsonObject({{"listChanged", false}})}});
+}
+
+void MCPAsyncClient::handleMessage(const QJsonObject &message)
+{
+    bool hasId = message.contains("id") && !message.value("id").isNull();
+    // 响应
+    if (hasId && (message.contains("result") || message.contains("error")))
+    {
+        qint64 requestId = static_cast<qint64>(message.value("id").toDouble(-1));
+        auto it = m_pendingRequests.find(requestId);
+        if (it == m_pendingRequests.end())
+        {
+            XLC_LOG_DEBUG("Dropped MCP response for unknown request (id={})", requestId);
+            return;
+        }
+        // 先移除再回调，回调中可能发送新的请求
+        PendingRequest pendingRequest = it.value();
+        m_pendingRequests.erase(it);
+        if (pendingRequest.timer)
+            pendingRequest.timer->deleteLater();
+        if (message.contains("error"))
+        {
+            QJsonObject jsonObjError = message.value("error").toObject();
+            QString errorMessage = QString("%1 (code=%2): %3")
+                                       .arg(SERVER_ERROR_PREFIX)
+                                       .arg(jsonObjError.value("code").toInt())
+                                       .arg(jsonObjError.value("message").toString());
+            pendingRequest.handler(false, QJsonObject(), errorMessage);
+        }
+        else
+        {
+            pendingRequest.handler(true, message.value("result").toObject(), QString());
+        }
+        return;
+    }
+
+    QString method = message.value("method").toString();
+    if (method.isEmpty())
+    {
+        XLC_LOG_DEBUG("Dropped invalid MCP message: {}", QString::fromUtf8(QJsonDocument(message).toJson(QJsonDocument::Compact)));
+        return;
+    }
+    // 服务器发来的请求
+    if (hasId)
+    {
+        QJsonObject response{
+            {"jsonrpc", "2.0"},
+            {"id", message.value("id")}};
+        if (method == "ping")
+            response.insert("result", QJsonObject());
+        else if (method == "roots/list")
+            response.insert("result", QJsonObject({{"roots", QJsonArray()}}));
+        else
+            response.insert("error", QJsonObject({{"code", -32601}, {"message", QString("Method not found: %1").arg(method)}}));
+        writeMessage(response, -1);
+        return;
+    }
+    // 通知
+    Q_EMIT sig_notificationReceived(method, message.value("params").toObject());
+}
+
+void MCPAsyncClient::failRequest(qint64 requestId, const QString &errorMessage)
+{
+    auto it = m_pendingRequests.find(requestId);
+    if (it == m_pendingRequests.end())
+        return;
+    PendingRequest pendingRequest = it.value();
+    m_pendingRequests.erase(it);
+    if (pendingRequest.timer)
+        pendingRequest.timer->deleteLater();
+    pendingRequest.handler(false, QJsonObject(), errorMessage);
+}
+
+void MCPAsyncClient::failAllRequests(const QString &errorMessage)
+{
+    QList<qint64> requestIds = m_pendingRequests.keys();
+    for (qint64 requestId : requestIds)
+        failRequest(requestId, errorMessage);
+}
+
+bool MCPAsyncClient::hasPendingRequest(qint64 requestId) const
+{
+    return m_pendingRequests.contains(requestId);
+}
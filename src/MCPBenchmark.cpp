@@ -0,0 +1,303 @@
+#include "MCPBenchmark.h"
+#include <QTimer>
+#include <QPointer>
+#include <QUuid>
+#include <algorithm>
+#include <cmath>
+#include "DataManager.h"
+#include "Logger.hpp"
+
+MCPLatencyStats MCPLatencyStats::fromSamples(QVector<qint64> samplesUs, int failures)
+{
+    MCPLatencyStats stats;
+    stats.count = samplesUs.size();
+    stats.failures = failures;
+    if (samplesUs.isEmpty())
+        return stats;
+    std::sort(samplesUs.begin(), samplesUs.end());
+    double total = 0;
+    for (qint64 sample : samplesUs)
+        total += sample;
+    stats.meanUs = total / samplesUs.size();
+    auto percentile = [&samplesUs](double p)
+    {
+        int index = static_cast<int>(std::ceil(p * samplesUs.size())) - 1;
+        return samplesUs.at(qBound(0, index, samplesUs.size() - 1));
+    };
+    stats.p50Us = percentile(0.50);
+    stats.p95Us = percentile(0.95);
+    stats.p99Us = percentile(0.99);
+    return stats;
+}
+
+QString MCPLatencyStats::toString() const
+{
+    return QString("count=%1, failures=%2, mean=%3ms, p50=%4ms, p95=%5ms, p99=%6ms")
+        .arg(count)
+        .arg(failures)
+        .arg(meanUs / 1000.0, 0, 'f', 3)
+        .arg(p50Us / 1000.0, 0, 'f', 3)
+        .arg(p95Us / 1000.0, 0, 'f', 3)
+        .arg(p99Us / 1000.0, 0, 'f', 3);
+}
+
+MCPBenchmark::MCPBenchmark(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void MCPBenchmark::start(int sequentialCalls, int parallelCalls)
+{
+    m_sequentialCalls = qMax(1, sequentialCalls);
+    m_parallelCalls = qMax(1, parallelCalls);
+    m_clock.start();
+    m_buildToolsMs = benchmarkBuildTools();
+    XLC_LOG_INFO("[MCPBenchmark] buildTools: {} tools in {:.3f}ms (average of {} rounds)", TOOL_COUNT, m_buildToolsMs, BUILD_TOOLS_ROUNDS);
+    m_targets = findTargets();
+    m_targetIndex = 0;
+    m_phase = Raw;
+    if (m_targets.isEmpty())
+        XLC_LOG_WARN("[MCPBenchmark] No connected mock MCP server found (tools prefixed with {}), skipping call benchmarks", TOOL_NAME_PREFIX);
+    connect(MCPService::getInstance(), &MCPService::sig_toolCallFinished, this, &MCPBenchmark::slot_onToolCallFinished);
+    QTimer::singleShot(0, this, &MCPBenchmark::runNext);
+}
+
+double MCPBenchmark::benchmarkBuildTools()
+{
+    // 与模拟服务器默认生成的工具结构一致
+    QJsonArray jsonArrayTools;
+    for (int i = 0; i < TOOL_COUNT; ++i)
+    {
+        QJsonObject jsonObjProperties;
+        for (int p = 0; p < 8; ++p)
+        {
+            jsonObjProperties.insert(QString("arg%1").arg(p),
+                                     QJsonObject({{"type", p % 2 == 0 ? "string" : "integer"},
+                                                  {"description", QString("Argument %1 of mock tool %2.").arg(p).arg(i)}}));
+        }
+        jsonArrayTools.append(QJsonObject({{"name", QString("%1%2").arg(TOOL_NAME_PREFIX).arg(i)},
+                                           {"description", QString("Mock tool %1 for benchmarks.").arg(i)},
+                                           {"inputSchema", QJsonObject({{"type", "object"}, {"properties", jsonObjProperties}, {"required", QJsonArray({"arg0"})}})}}));
+    }
+    // 写入临时的工具表，不影响 MCPService 中正在使用的工具
+    const QString serverUuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    qint64 totalNs = 0;
+    for (int round = 0; round < BUILD_TOOLS_ROUNDS; ++round)
+    {
+        QHash<QString, std::shared_ptr<MCPTool>> toolTable;
+        QElapsedTimer timer;
+        timer.start();
+        MCPService::buildTools(serverUuid, jsonArrayTools, toolTable);
+        totalNs += timer.nsecsElapsed();
+    }
+    return totalNs / 1e6 / BUILD_TOOLS_ROUNDS;
+}
+
+QVector<MCPBenchmark::Target> MCPBenchmark::findTargets()
+{
+    MCPService *service = MCPService::getInstance();
+    QVector<Target> targets;
+    for (const std::shared_ptr<McpServer> &mcpServer : DataManager::getInstance()->getMcpServers())
+    {
+        // 基于 cpp-mcp 的 sse 客户端不经过异步客户端，没有可对照的基线
+        if (!mcpServer || mcpServer->type == McpServer::Type::sse || !service->isInitialized(mcpServer->uuid))
+            continue;
+        Target target;
+        const QHash<QString, QString> toolNames = service->getToolNames(mcpServer->uuid);
+        for (auto it = toolNames.constBegin(); it != toolNames.constEnd(); ++it)
+        {
+            if (it.value().startsWith(TOOL_NAME_PREFIX))
+            {
+                target.toolId = it.key();
+                target.toolName = it.value();
+                break;
+            }
+        }
+        if (target.toolId.isEmpty())
+            continue;
+        target.serverUuid = mcpServer->uuid;
+        target.serverName = mcpServer->name;
+        target.transport = mcpServer->type == McpServer::Type::stdio ? QString("stdio") : QString("streamableHttp");
+        target.transport += QString(", maxConcurrentCalls=%1").arg(mcpServer->maxConcurrentCalls);
+        if (mcpServer->type == McpServer::Type::stdio && mcpServer->maxReplicas > 1)
+            target.transport += QString(", replicas=%1~%2").arg(mcpServer->minReplicas).arg(mcpServer->maxReplicas);
+        targets.append(target);
+    }
+    return targets;
+}
+
+void MCPBenchmark::runNext()
+{
+    if (m_targetIndex >= m_targets.size())
+    {
+        disconnect(MCPService::getInstance(), &MCPService::sig_toolCallFinished, this, &MCPBenchmark::slot_onToolCallFinished);
+        QString report = buildReport();
+        for (const QString &line : report.split('\n'))
+            XLC_LOG_INFO("[MCPBenchmark] {}", line);
+        Q_EMIT sig_finished(report);
+        return;
+    }
+    m_completedCalls = 0;
+    m_failedCalls = 0;
+    m_samplesUs.clear();
+    m_pendingCalls.clear();
+    XLC_LOG_DEBUG("[MCPBenchmark] Running phase {} (server={})", static_cast<int>(m_phase), m_targets.at(m_targetIndex).serverName);
+    if (m_phase == Raw)
+        warmUp();
+    else if (m_phase == Service)
+        runServiceCall();
+    else
+        runParallelCalls();
+}
+
+void MCPBenchmark::warmUp()
+{
+    // 空闲关闭的进程先重新启动，启动耗时不计入调用耗时
+    const Target &target = m_targets.at(m_targetIndex);
+    QPointer<MCPBenchmark> guard(this);
+    MCPService::getInstance()->sendRawRequest(
+        target.serverUuid, "ping", QJsonObject(),
+        [guard](bool success, const QJsonObject &, const QString &errorMessage)
+        {
+            if (!guard)
+                return;
+            if (success)
+            {
+                guard->runRawCall();
+                return;
+            }
+            XLC_LOG_WARN("[MCPBenchmark] MCP server not available (server={}): {}", guard->m_targets.at(guard->m_targetIndex).serverName, errorMessage);
+            guard->m_failedCalls = guard->m_sequentialCalls;
+            guard->finishPhase();
+        },
+        30000);
+}
+
+void MCPBenchmark::runRawCall()
+{
+    const Target &target = m_targets.at(m_targetIndex);
+    QPointer<MCPBenchmark> guard(this);
+    CallToolArgs callToolArgs = buildCallToolArgs();
+    const qint64 startNs = m_clock.nsecsElapsed();
+    MCPService::getInstance()->sendRawRequest(
+        target.serverUuid,
+        "tools/call",
+        QJsonObject({{"name", target.toolName}, {"arguments", callToolArgs.parameters}}),
+        [guard, startNs](bool success, const QJsonObject &result, const QString &)
+        {
+            if (!guard)
+                return;
+            guard->m_samplesUs.append((guard->m_clock.nsecsElapsed() - startNs) / 1000);
+            if (!success || result.value("isError").toBool(false))
+                guard->m_failedCalls += 1;
+            guard->m_completedCalls += 1;
+            if (guard->m_completedCalls >= guard->m_sequentialCalls)
+                guard->finishPhase();
+            else
+                guard->runRawCall();
+        },
+        30000);
+}
+
+void MCPBenchmark::runServiceCall()
+{
+    CallToolArgs callToolArgs = buildCallToolArgs();
+    m_pendingCalls.insert(callToolArgs.callId, m_clock.nsecsElapsed());
+    MCPService::getInstance()->callTool(callToolArgs);
+}
+
+void MCPBenchmark::runParallelCalls()
+{
+    QVector<CallToolArgs> calls;
+    calls.reserve(m_parallelCalls);
+    for (int i = 0; i < m_parallelCalls; ++i)
+        calls.append(buildCallToolArgs());
+    const qint64 startNs = m_clock.nsecsElapsed();
+    for (const CallToolArgs &callToolArgs : calls)
+    {
+        m_pendingCalls.insert(callToolArgs.callId, startNs);
+        MCPService::getInstance()->callTool(callToolArgs);
+    }
+}
+
+void MCPBenchmark::slot_onToolCallFinished(const CallToolArgs &callToolArgs, bool success, const QJsonObject &jsonObjectToolCallResult, const QString &errorMessage)
+{
+    Q_UNUSED(jsonObjectToolCallResult)
+    Q_UNUSED(errorMessage)
+    auto it_Pending = m_pendingCalls.find(callToolArgs.callId);
+    if (it_Pending == m_pendingCalls.end())
+        return;
+    m_samplesUs.append((m_clock.nsecsElapsed() - it_Pending.value()) / 1000);
+    m_pendingCalls.erase(it_Pending);
+    if (!success)
+        m_failedCalls += 1;
+    m_completedCalls += 1;
+    if (m_phase == Service)
+    {
+        if (m_completedCalls >= m_sequentialCalls)
+            finishPhase();
+        else
+            runServiceCall();
+    }
+    else if (m_phase == Parallel && m_completedCalls >= m_parallelCalls)
+    {
+        finishPhase();
+    }
+}
+
+void MCPBenchmark::finishPhase()
+{
+    Target &target = m_targets[m_targetIndex];
+    if (m_phase == Raw)
+    {
+        target.raw = MCPLatencyStats::fromSamples(m_samplesUs, m_failedCalls);
+        m_phase = Service;
+    }
+    else if (m_phase == Service)
+    {
+        target.service = MCPLatencyStats::fromSamples(m_samplesUs, m_failedCalls);
+        m_phase = Parallel;
+    }
+    else
+    {
+        // 所有调用同时开始，最慢的一次即总耗时
+        qint64 elapsedUs = m_samplesUs.isEmpty() ? 0 : *std::max_element(m_samplesUs.constBegin(), m_samplesUs.constEnd());
+        target.throughput = elapsedUs > 0 ? m_completedCalls * 1e6 / elapsedUs : 0;
+        target.parallelFailures = m_failedCalls;
+        m_phase = Raw;
+        m_targetIndex += 1;
+    }
+    // 在下一次事件循环中继续，避免在回调中嵌套执行
+    QTimer::singleShot(0, this, &MCPBenchmark::runNext);
+}
+
+CallToolArgs MCPBenchmark::buildCallToolArgs()
+{
+    // 每次调用的参数不同，避免命中结果缓存
+    m_callSequence += 1;
+    CallToolArgs callToolArgs;
+    callToolArgs.callId = QString("benchmark-%1").arg(m_callSequence);
+    callToolArgs.toolName = m_targets.at(m_targetIndex).toolId;
+    callToolArgs.parameters = QJsonObject({{"arg0", QString::number(m_callSequence)}});
+    return callToolArgs;
+}
+
+QString MCPBenchmark::buildReport() const
+{
+    QStringList lines;
+    lines.append(QString("buildTools(%1 tools): %2ms").arg(TOOL_COUNT).arg(m_buildToolsMs, 0, 'f', 3));
+    for (const Target &target : m_targets)
+    {
+        lines.append(QString("%1 [%2]").arg(target.serverName).arg(target.transport));
+        lines.append(QString("  raw client: %1").arg(target.raw.toString()));
+        lines.append(QString("  MCPService: %1").arg(target.service.toString()));
+        lines.append(QString("  overhead per call: mean=%1ms, p50=%2ms")
+                         .arg((target.service.meanUs - target.raw.meanUs) / 1000.0, 0, 'f', 3)
+                         .arg((target.service.p50Us - target.raw.p50Us) / 1000.0, 0, 'f', 3));
+        lines.append(QString("  parallel(%1 calls): %2 calls/s, failures=%3")
+                         .arg(m_parallelCalls)
+                         .arg(target.throughput, 0, 'f', 1)
+                         .arg(target.parallelFailures));
+    }
+    return lines.join('\n');
+}
@@ -0,0 +1,122 @@
+#include "MCPCallScheduler.h"
+#include <QThread>
+#include "Logger.hpp"
+
+double MCPCallQueueMetrics::averageWaitMs() const
+{
+    if (dispatchedCalls == 0)
+        return 0.0;
+    return static_cast<double>(totalWaitMs) / static_cast<double>(dispatchedCalls);
+}
+
+MCPCallScheduler::MCPCallScheduler(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void MCPCallScheduler::setMaxInFlight(const QString &serverUuid, int maxInFlight)
+{
+    ServerQueue &queue = m_queues[serverUuid];
+    int newMaxInFlight = qMax(1, maxInFlight);
+    if (queue.metrics.maxInFlight == newMaxInFlight)
+        return;
+    queue.metrics.maxInFlight = newMaxInFlight;
+    XLC_LOG_DEBUG("Set max in-flight tool calls (serverUuid={}, maxInFlight={})", serverUuid, newMaxInFlight);
+    // 名额增加后可能可以立即派发排队中的调用
+    dispatch(serverUuid);
+}
+
+void MCPCallScheduler::enqueue(const QString &serverUuid, const QString &conversationUuid, Task task)
+{
+    ServerQueue &queue = m_queues[serverUuid];
+    PendingCall pendingCall;
+    pendingCall.task = std::move(task);
+    pendingCall.waitTimer.start();
+
+    QQueue<PendingCall> &pendingCalls = queue.pendingCalls[conversationUuid];
+    if (pendingCalls.isEmpty())
+        queue.conversationOrder.enqueue(conversationUuid);
+    pendingCalls.enqueue(pendingCall);
+    queue.metrics.queueLength += 1;
+
+    XLC_LOG_TRACE("Enqueued tool call (serverUuid={}, conversationUuid={}, queueLength={}, inFlight={}, maxInFlight={})",
+                  serverUuid,
+                  conversationUuid,
+                  queue.metrics.queueLength,
+                  queue.metrics.inFlight,
+                  queue.metrics.maxInFlight);
+    dispatch(serverUuid);
+    Q_EMIT sig_queueMetricsChanged(serverUuid);
+}
+
+void MCPCallScheduler::release(const QString &serverUuid)
+{
+    // 调用一般在工作线程结束，切换回主线程修改队列
+    if (QThread::currentThread() != thread())
+    {
+        QMetaObject::invokeMethod(
+            this,
+            [this, serverUuid]()
+            {
+                release(serverUuid);
+            },
+            Qt::QueuedConnection);
+        return;
+    }
+
+    auto it = m_queues.find(serverUuid);
+    if (it == m_queues.end() || it->metrics.inFlight <= 0)
+    {
+        XLC_LOG_WARN("Release tool call failed (serverUuid={}): no call in flight", serverUuid);
+        return;
+    }
+    it->metrics.inFlight -= 1;
+    dispatch(serverUuid);
+    Q_EMIT sig_queueMetricsChanged(serverUuid);
+}
+
+MCPCallQueueMetrics MCPCallScheduler::metrics(const QString &serverUuid) const
+{
+    return m_queues.value(serverUuid).metrics;
+}
+
+void MCPCallScheduler::dispatch(const QString &serverUuid)
+{
+    while (true)
+    {
+        // task 可能同步调用 enqueue/release 修改 m_queues，每轮重新查找队列
+        auto it = m_queues.find(serverUuid);
+        if (it == m_queues.end())
+            return;
+        ServerQueue &queue = it.value();
+        if (queue.metrics.inFlight >= queue.metrics.maxInFlight || queue.conversationOrder.isEmpty())
+            return;
+
+        // 轮转取出下一个对话的调用
+        QString conversationUuid = queue.conversationOrder.dequeue();
+        QQueue<PendingCall> &pendingCalls = queue.pendingCalls[conversationUuid];
+        PendingCall pendingCall = pendingCalls.dequeue();
+        if (pendingCalls.isEmpty())
+            queue.pendingCalls.remove(conversationUuid);
+        else
+            queue.conversationOrder.enqueue(conversationUuid);
+
+        // 更新队列状态
+        qint64 waitMs = pendingCall.waitTimer.elapsed();
+        queue.metrics.queueLength -= 1;
+        queue.metrics.inFlight += 1;
+        queue.metrics.dispatchedCalls += 1;
+        queue.metrics.totalWaitMs += waitMs;
+        queue.metrics.maxWaitMs = qMax(queue.metrics.maxWaitMs, waitMs);
+        XLC_LOG_DEBUG("Dispatching tool call (serverUuid={}, conversationUuid={}, waitMs={}, queueLength={}, inFlight={}, maxInFlight={}, averageWaitMs={:.1f})",
+                      serverUuid,
+                      conversationUuid,
+                      waitMs,
+                      queue.metrics.queueLength,
+                      queue.metrics.inFlight,
+                      queue.metrics.maxInFlight,
+                      queue.metrics.averageWaitMs());
+
+        pendingCall.task();
+    }
+}
@@ -0,0 +1,117 @@
+#include "MCPResourceCache.h"
+#include <QJsonObject>
+#include "ToolResultStore.h"
+#include "Logger.hpp"
+
+bool MCPResourceContent::isBlob() const
+{
+    return !blobId.isEmpty();
+}
+
+QVector<MCPResourceContent> MCPResourceContent::fromJsonArray(const QJsonArray &jsonArrayContents)
+{
+    // 每次解码的base64字符数(4的倍数)，避免同时持有完整的base64字符串与解码结果的多份拷贝
+    const int BASE64_CHUNK_CHARS = 4 * 1024 * 1024;
+    QVector<MCPResourceContent> contents;
+    for (const QJsonValue &jsonValueContent : jsonArrayContents)
+    {
+        QJsonObject jsonObjContent = jsonValueContent.toObject();
+        MCPResourceContent content;
+        content.uri = jsonObjContent.value("uri").toString();
+        content.mimeType = jsonObjContent.value("mimeType").toString();
+        if (jsonObjContent.value("blob").isString())
+        {
+            QString base64 = jsonObjContent.value("blob").toString();
+            QByteArray data;
+            data.reserve(base64.size() / 4 * 3);
+            for (int offset = 0; offset < base64.size(); offset += BASE64_CHUNK_CHARS)
+                data.append(QByteArray::fromBase64(base64.midRef(offset, BASE64_CHUNK_CHARS).toLatin1()));
+            content.size = data.size();
+            content.blobId = ToolResultStore::getInstance()->put(data, content.mimeType.section('/', 1, 1).section('+', 0, 0));
+            if (content.blobId.isEmpty())
+            {
+                XLC_LOG_WARN("Store resource blob failed (uri={}, bytes={})", content.uri, data.size());
+                continue;
+            }
+        }
+        else
+        {
+            content.text = jsonObjContent.value("text").toString();
+            content.size = content.text.toUtf8().size();
+        }
+        contents.append(content);
+    }
+    return contents;
+}
+
+MCPResourceCache::MCPResourceCache(int maxCostBytes)
+    : m_cache(maxCostBytes)
+{
+}
+
+bool MCPResourceCache::lookup(const QString &serverUuid, const QString &uri, QVector<MCPResourceContent> &contents)
+{
+    QString key = buildKey(serverUuid, uri);
+    Entry *entry = m_cache.object(key);
+    if (entry && !entry->subscribed && entry->insertedTimer.elapsed() >= UNSUBSCRIBED_TTL_MS)
+    {
+        m_cache.remove(key);
+        entry = nullptr;
+    }
+    if (!entry)
+    {
+        m_misses += 1;
+        return false;
+    }
+    m_hits += 1;
+    contents = entry->contents;
+    return true;
+}
+
+void MCPResourceCache::insert(const QString &serverUuid, const QString &uri, const QVector<MCPResourceContent> &contents, bool subscribed)
+{
+    // 二进制内容已在磁盘中，只计算文本占用
+    int cost = 1;
+    for (const MCPResourceContent &content : contents)
+        cost += content.text.size() * 2;
+    if (cost > m_cache.maxCost())
+    {
+        XLC_LOG_DEBUG("Resource too large to cache (serverUuid={}, uri={}, bytes={})", serverUuid, uri, cost);
+        return;
+    }
+    Entry *entry = new Entry();
+    entry->contents = contents;
+    entry->subscribed = subscribed;
+    entry->insertedTimer.start();
+    m_cache.insert(buildKey(serverUuid, uri), entry, cost);
+}
+
+void MCPResourceCache::invalidate(const QString &serverUuid, const QString &uri)
+{
+    m_cache.remove(buildKey(serverUuid, uri));
+}
+
+void MCPResourceCache::invalidateServer(const QString &serverUuid)
+{
+    const QString prefix = serverUuid + '\n';
+    for (const QString &key : m_cache.keys())
+    {
+        if (key.startsWith(prefix))
+            m_cache.remove(key);
+    }
+}
+
+qint64 MCPResourceCache::hits() const
+{
+    return m_hits;
+}
+
+qint64 MCPResourceCache::misses() const
+{
+    return m_misses;
+}
+
+QString MCPResourceCache::buildKey(const QString &serverUuid, const QString &uri)
+{
+    return serverUuid + '\n' + uri;
+}
@@ -1,8 +1,13 @@
 #include "MCPService.h"
 #include <QCoreApplication>
 #include "Logger.hpp"
-#include <QtConcurrent>
+#include "Executor.h"
 #include <QFutureWatcher>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QFutureInterface>
+#include "MCPStreamableHttpClient.h"
+#include <limits>
 #include <ToastManager.h>
 
 MCPTool::MCPTool(const QString &name, const QString &serverUuid, const QJsonObject &jsonObjTool)
@@ -85,72 +90,42 @@ MCPService::MCPService(QObject *parent)
     // 注册自定义类型（在不同线程之间安全地传递自定义数据，需要通过 qRegisterMetaType() 显式地告诉 Qt 如何处理这些数据类型。）
     qRegisterMetaType<CallToolArgs>("CallToolArgs");
     qRegisterMetaType<mcp::json>("mcp::json");
+
+    m_callScheduler = new MCPCallScheduler(this);
+    // 排队与执行中的调用数量随服务器健康状态一起显示
+    connect(m_callScheduler, &MCPCallScheduler::sig_queueMetricsChanged, this, &MCPService::sig_serverHealthChanged);
+    m_networkAccessManager = new QNetworkAccessManager(this);
+
+    // 定时检测客户端连通性
+    m_timerHealthCheck = new QTimer(this);
+    m_timerHealthCheck->setInterval(HEALTH_CHECK_INTERVAL_MS);
+    connect(m_timerHealthCheck, &QTimer::timeout, this, &MCPService::slot_onHealthCheckTimeout);
+    m_timerHealthCheck->start();
 }
 
-std::shared_ptr<MCPClient> MCPService::createStdioClient(std::shared_ptr<McpServer> server)
+std::shared_ptr<MCPAsyncClient> MCPService::startStdioProcess(std::shared_ptr<McpServer> server)
 {
-    // 拼接完整命令
-    QString fullCommand(server->command);
-    for (const QString &arg : server->args)
-    {
-        fullCommand.append(" ").append(arg);
-    }
-    // 拼接环境变量
-    mcp::json environmentVariables;
-    for (auto it = server->envVars.constBegin(); it != server->envVars.constEnd(); ++it)
-    {
-        environmentVariables[it.key().toStdString()] = it.value().toStdString();
-    }
-    // 创建stdio client
-    std::unique_ptr<mcp::stdio_client> client = std::make_unique<mcp::stdio_client>(fullCommand.toStdString(), environmentVariables);
-    // 设置capabilities
-    mcp::json capabilities = {{"roots", {{"listChanged", true}}}};
-    client->set_capabilities(capabilities);
-    try
-    {
-        // 初始化连接
-        XLC_LOG_DEBUG("Initializing connection (MCPServer={})", server->uuid);
-        if (!client->initialize("XLCClient", mcp::MCP_VERSION))
-        {
-            XLC_LOG_ERROR("Failed to initialize connection to MCP server (MCPServer={})", server->uuid);
-            ToastManager::showMessage(Toast::Type::Error, QString("Failed to initialize connection to MCP server (MCPServer=%1)").arg(server->uuid));
-            return nullptr;
-        }
-        // Ping 服务器
-        XLC_LOG_DEBUG("Pinging MCP server (MCPServer={})", server->uuid);
-        if (!client->ping())
-        {
-            XLC_LOG_ERROR("Failed ping to MCP server (MCPServer={})", server->uuid);
-            ToastManager::showMessage(Toast::Type::Error, QString("Failed ping to MCP server (MCPServer=%1)").arg(server->uuid));
-            return nullptr;
-        }
-        // 获取capabilities
-        XLC_LOG_DEBUG("Getting capabilities for MCP server (MCPServer={})", server->uuid);
-        mcp::json capabilities = client->get_server_capabilities();
-        XLC_LOG_DEBUG("MCP server capabilities (MCPServer={}): {}", server->uuid, capabilities.dump(4));
-        // 创建 MCPClient 对象
-        auto mcpClient = std::make_shared<MCPClient>();
-        // 获取tools
-        XLC_LOG_DEBUG("Getting tools for MCP server (MCPServer={})", server->uuid);
-        mcpClient->tools = registerTools(server->uuid, client.get());
-        XLC_LOG_DEBUG("Retrieved tools from MCP server (count={}, serverUuid={})", mcpClient->tools.size(), server->uuid);
-        mcpClient->client = std::move(client);
-        return mcpClient;
-    }
-    catch (const mcp::mcp_exception &e)
-    {
-        XLC_LOG_ERROR("Create stdio client failed (code={}): {}", static_cast<int>(e.code()), e.what());
-        ToastManager::showMessage(Toast::Type::Error, QString("Create stdio client failed (code=%1): %2")
-                                                          .arg(static_cast<int>(e.code()))
-                                                          .arg(e.what()));
-        return nullptr;
-    }
-    catch (const std::exception &e)
-    {
-        XLC_LOG_ERROR("Create stdio client failed: {}", e.what());
-        ToastManager::showMessage(Toast::Type::Error, QString("Create stdio client failed: %1").arg(e.what()));
-        return nullptr;
-    }
+    MCPProcessLimits limits;
+    limits.cpuQuotaPercent = server->cpuQuotaPercent;
+    limits.memoryLimitMB = server->memoryLimitMB;
+    limits.niceValue = server->niceValue;
+    limits.ioPriorityClass = server->ioPriorityClass;
+    limits.maxOpenFiles = server->maxOpenFiles;
+    // 客户端属于主线程，释放时通过 deleteLater 销毁(进程在后台退出)
+    MCPStdioClient *stdioClient = new MCPStdioClient(server->command, server->args, server->envVars, limits);
+    std::shared_ptr<MCPAsyncClient> asyncClient(stdioClient,
+                                                [](MCPAsyncClient *client)
+                                                {
+                                                    client->deleteLater();
+                                                });
+    stdioClient->start();
+    return asyncClient;
+}
+
+QFuture<std::shared_ptr<MCPClient>> MCPService::createStdioClient(std::shared_ptr<McpServer> server)
+{
+    std::shared_ptr<MCPAsyncClient> asyncClient = startStdioProcess(server);
+    return initializeAsyncClient(server->uuid, asyncClient, server->timeout > 0 ? server->timeout * 1000 : 30000);
 }
 
 std::shared_ptr<MCPClient> MCPService::createSSEClient(std::shared_ptr<McpServer> server)
@@ -230,22 +205,16 @@ std::shared_ptr<MCPClient> MCPService::createMCPClient(const QString &serverUuid
     std::shared_ptr<McpServer> mcpServer = DataManager::getInstance()->getMcpServer(serverUuid);
     switch (mcpServer->type)
     {
-    case McpServer::Type::stdio:
-    {
-        return createStdioClient(mcpServer);
-        break;
-    }
     case McpServer::Type::sse:
     {
         return createSSEClient(mcpServer);
         break;
     }
+    case McpServer::Type::stdio:
     case McpServer::Type::streambleHttp:
     {
-        // 暂不支持的服务器类型
-        XLC_LOG_WARN("Create MCP client failed ({} - streambleHttp): Unsupported MCPServer type", static_cast<int>(mcpServer->type));
-        ToastManager::showMessage(Toast::Type::Warning, QString("Create MCP client failed (type=%1 - streambleHttp): Unsupported MCPServer type").arg(static_cast<int>(mcpServer->type)));
-
+        // stdio 与 streambleHttp 客户端基于事件循环，需要通过 startCreateClient 在主线程创建
+        XLC_LOG_WARN("Create MCP client failed (type={}): must be created on the main thread", static_cast<int>(mcpServer->type));
         break;
     }
     default:
@@ -258,32 +227,216 @@ std::shared_ptr<MCPClient> MCPService::createMCPClient(const QString &serverUuid
     return nullptr;
 }
 
+QFuture<std::shared_ptr<MCPClient>> MCPService::createStreamableHttpClient(std::shared_ptr<McpServer> server)
+{
+    // 拼接url
+    QString endpoint = server->endpoint.isEmpty() ? QString("/mcp") : server->endpoint;
+    if (!endpoint.startsWith('/'))
+        endpoint.prepend('/');
+    QUrl url;
+    if (!server->baseUrl.isEmpty())
+    {
+        QString baseUrl = server->baseUrl;
+        while (baseUrl.endsWith('/'))
+            baseUrl.chop(1);
+        url = QUrl(baseUrl + endpoint);
+    }
+    else if (!server->host.isEmpty() && server->port != 0)
+    {
+        url = QUrl(QString("http://%1:%2%3").arg(server->host).arg(server->port).arg(endpoint));
+    }
+    if (!url.isValid() || url.scheme().isEmpty())
+    {
+        XLC_LOG_ERROR("Create streamable http client failed (MCPServer={}): invalid url", server->uuid);
+        ToastManager::showMessage(Toast::Type::Error, QString("Create streamable http client failed (MCPServer=%1): invalid url").arg(server->uuid));
+        QFutureInterface<std::shared_ptr<MCPClient>> futureInterface;
+        futureInterface.reportStarted();
+        futureInterface.reportResult(std::shared_ptr<MCPClient>());
+        futureInterface.reportFinished();
+        return futureInterface.future();
+    }
+
+    // 客户端属于主线程，释放时通过 deleteLater 销毁
+    MCPStreamableHttpClient *httpClient = new MCPStreamableHttpClient(m_networkAccessManager, url, MCPStreamableHttpClient::parseRequestHeaders(server->requestHeaders));
+    std::shared_ptr<MCPAsyncClient> asyncClient(httpClient,
+                                                [](MCPAsyncClient *client)
+                                                {
+                                                    client->deleteLater();
+                                                });
+    XLC_LOG_DEBUG("Connecting to MCP server (MCPServer={}, url={})", server->uuid, url.toString());
+    return initializeAsyncClient(server->uuid, asyncClient, server->timeout > 0 ? server->timeout * 1000 : 30000);
+}
+
+QFuture<std::shared_ptr<MCPClient>> MCPService::initializeAsyncClient(const QString &serverUuid, std::shared_ptr<MCPAsyncClient> asyncClient, int timeoutMs)
+{
+    QFutureInterface<std::shared_ptr<MCPClient>> futureInterface;
+    futureInterface.reportStarted();
+    QFuture<std::shared_ptr<MCPClient>> future = futureInterface.future();
+    auto finish = [futureInterface](std::shared_ptr<MCPClient> mcpClient) mutable
+    {
+        futureInterface.reportResult(mcpClient);
+        futureInterface.reportFinished();
+    };
+
+    connectAsyncClient(serverUuid, asyncClient.get());
+
+    XLC_LOG_DEBUG("Initializing connection to MCP server (MCPServer={})", serverUuid);
+    asyncClient->initialize(
+        "XLCClient", MCPAsyncClient::MCP_PROTOCOL_VERSION, MCPAsyncClient::clientCapabilities(), timeoutMs,
+        [this, asyncClient, serverUuid, timeoutMs, finish](bool success, const QString &errorMessage) mutable
+        {
+            if (!success)
+            {
+                XLC_LOG_ERROR("Failed initialize connection to MCP server (MCPServer={}): {}", serverUuid, errorMessage);
+                ToastManager::showMessage(Toast::Type::Error, QString("Failed initialize connection to MCP server (MCPServer=%1): %2").arg(serverUuid).arg(errorMessage));
+                finish(nullptr);
+                return;
+            }
+            XLC_LOG_DEBUG("MCP server capabilities (MCPServer={}): {}", serverUuid, QString::fromUtf8(QJsonDocument(asyncClient->getServerCapabilities()).toJson(QJsonDocument::Compact)));
+            // 获取tools
+            XLC_LOG_DEBUG("Attempting get tools from MCP server (MCPServer={})", serverUuid);
+            asyncClient->listTools(
+                timeoutMs,
+                [this, asyncClient, serverUuid, finish](bool success, const QJsonArray &jsonArrayTools, const QString &errorMessage) mutable
+                {
+                    if (!success)
+                    {
+                        XLC_LOG_ERROR("Get tools from MCP server failed (MCPServer={}): {}", serverUuid, errorMessage);
+                        ToastManager::showMessage(Toast::Type::Error, QString("Get tools from MCP server failed (MCPServer=%1): %2").arg(serverUuid).arg(errorMessage));
+                        finish(nullptr);
+                        return;
+                    }
+                    auto mcpClient = std::make_shared<MCPClient>();
+                    mcpClient->tools = registerTools(serverUuid, jsonArrayTools);
+                    mcpClient->asyncClient = asyncClient;
+                    mcpClient->lastActiveTimer.start();
+                    XLC_LOG_DEBUG("Retrieved tools from MCP server (count={}, serverUuid={})", mcpClient->tools.size(), serverUuid);
+                    finish(mcpClient);
+                });
+        });
+    return future;
+}
+
+void MCPService::connectAsyncClient(const QString &serverUuid, MCPAsyncClient *asyncClient)
+{
+    connect(asyncClient, &MCPAsyncClient::sig_notificationReceived, this,
+            [this, serverUuid](const QString &method, const QJsonObject &params)
+            {
+                handleAsyncClientNotification(serverUuid, method, params);
+            });
+    connect(asyncClient, &MCPAsyncClient::sig_disconnected, this,
+            [this, serverUuid, asyncClient](const QString &errorMessage)
+            {
+                // 只处理正在使用的客户端，重连时被替换的旧客户端忽略
+                std::shared_ptr<MCPClient> client;
+                {
+                    QMutexLocker locker(&m_mutexClients);
+                    client = m_clients.value(serverUuid);
+                }
+                if (client && client->asyncClient.get() == asyncClient)
+                    openCircuit(serverUuid, errorMessage);
+            });
+    connect(asyncClient, &MCPAsyncClient::sig_notificationChannelChanged, this,
+            [this, serverUuid, asyncClient](bool available)
+            {
+                if (available)
+                    return;
+                std::shared_ptr<MCPClient> client;
+                {
+                    QMutexLocker locker(&m_mutexClients);
+                    client = m_clients.value(serverUuid);
+                }
+                if (!client || client->asyncClient.get() != asyncClient || client->subscribedResources.isEmpty())
+                    return;
+                // 通知通道中断期间收不到资源更新，已订阅的缓存不再可信，之后的读取按未订阅处理
+                XLC_LOG_DEBUG("MCP notification channel lost, dropping subscribed resources (serverUuid={}, resources={})", serverUuid, client->subscribedResources.size());
+                client->subscribedResources.clear();
+                m_resourceCache.invalidateServer(serverUuid);
+            });
+}
+
+QFuture<std::shared_ptr<MCPClient>> MCPService::startCreateClient(const QString &serverUuid)
+{
+    std::shared_ptr<McpServer> mcpServer = DataManager::getInstance()->getMcpServer(serverUuid);
+    if (mcpServer && mcpServer->type == McpServer::Type::stdio)
+        return createStdioClient(mcpServer);
+    if (mcpServer && mcpServer->type == McpServer::Type::streambleHttp)
+        return createStreamableHttpClient(mcpServer);
+    // 基于 cpp-mcp 的客户端会阻塞线程，在 IoBlocking 线程池中创建
+    return Executor::getInstance()->run(
+        Executor::Pool::IoBlocking,
+        [this, serverUuid]()
+        {
+            return createMCPClient(serverUuid);
+        },
+        Executor::Priority::High);
+}
+
+void MCPService::handleAsyncClientNotification(const QString &serverUuid, const QString &method, const QJsonObject &params)
+{
+    if (method == "notifications/resources/updated")
+    {
+        QString uri = params.value("uri").toString();
+        XLC_LOG_DEBUG("MCP resource updated (serverUuid={}, uri={})", serverUuid, uri);
+        m_resourceCache.invalidate(serverUuid, uri);
+        return;
+    }
+    if (method != "notifications/tools/list_changed")
+    {
+        XLC_LOG_TRACE("Received MCP notification (serverUuid={}, method={}): {}", serverUuid, method, QString::fromUtf8(QJsonDocument(params).toJson(QJsonDocument::Compact)));
+        return;
+    }
+    std::shared_ptr<MCPClient> client;
+    {
+        QMutexLocker locker(&m_mutexClients);
+        client = m_clients.value(serverUuid);
+    }
+    if (!client || !client->asyncClient)
+        return;
+    std::shared_ptr<McpServer> mcpServer = DataManager::getInstance()->getMcpServer(serverUuid);
+    const int timeoutMs = mcpServer && mcpServer->timeout > 0 ? mcpServer->timeout * 1000 : 30000;
+    XLC_LOG_DEBUG("MCP server tools changed, refreshing tools (serverUuid={})", serverUuid);
+    m_toolResultCache.invalidateServer(serverUuid);
+    std::weak_ptr<MCPClient> weakClient = client;
+    client->asyncClient->listTools(
+        timeoutMs,
+        [this, serverUuid, weakClient](bool success, const QJsonArray &jsonArrayTools, const QString &errorMessage)
+        {
+            std::shared_ptr<MCPClient> client = weakClient.lock();
+            if (!client)
+                return;
+            if (!success)
+            {
+                XLC_LOG_WARN("Refresh tools failed (serverUuid={}): {}", serverUuid, errorMessage);
+                return;
+            }
+            QVector<QString> tools = registerTools(serverUuid, jsonArrayTools);
+            {
+                QMutexLocker locker(&m_mutexTools);
+                for (const QString &toolId : client->tools)
+                {
+                    if (!tools.contains(toolId))
+                        m_tools.remove(toolId);
+                }
+            }
+            client->tools = tools;
+            XLC_LOG_INFO("Refresh tools succeeded (serverUuid={}, count={})", serverUuid, tools.size());
+        });
+}
+
 QVector<QString> MCPService::registerTools(const QString &serverUuid, mcp::client *client)
 {
     try
     {
-        QVector<QString> tools;
-        QMutexLocker locker(&m_mutexTools);
+        // 转换为 tools/list 的原始格式
+        QJsonArray jsonArrayTools;
         for (const auto &tool : client->get_tools())
         {
-            std::shared_ptr<MCPTool> mcpTool = std::make_shared<MCPTool>(QString::fromStdString(tool.name), serverUuid);
-            // 解析 properties 对象
-            QJsonObject jsonObjProperties = QJsonDocument::fromJson(QByteArray::fromStdString(tool.parameters_schema.value("properties", mcp::json::object()).dump())).object();
-            // 解析 required 数组
-            QJsonArray jsonArrayRequired = QJsonDocument::fromJson(QByteArray::fromStdString(tool.parameters_schema.value("required", mcp::json::array()).dump())).array();
-            QJsonObject newJsonObjTool = {
-                {"type", "function"},
-                {"function", QJsonObject({{"name", mcpTool->id},
-                                          {"description", QString::fromStdString(tool.description)},
-                                          {"parameters", QJsonObject({{"type", "object"},
-                                                                      {"properties", jsonObjProperties},
-                                                                      {"required", jsonArrayRequired}})}})}};
-            mcpTool->jsonObjTool = newJsonObjTool;
-            tools.push_back(mcpTool->id);
-            // 更新工具列表
-            m_tools.insert(mcpTool->id, mcpTool);
+            jsonArrayTools.append(QJsonObject({{"name", QString::fromStdString(tool.name)},
+                                               {"description", QString::fromStdString(tool.description)},
+                                               {"inputSchema", QJsonDocument::fromJson(QByteArray::fromStdString(tool.parameters_schema.dump())).object()}}));
         }
-        return tools;
+        return registerTools(serverUuid, jsonArrayTools);
     }
     catch (const mcp::mcp_exception &e)
     {
@@ -297,6 +450,41 @@ QVector<QString> MCPService::registerTools(const QString &serverUuid, mcp::clien
     }
 }
 
+QVector<QString> MCPService::registerTools(const QString &serverUuid, const QJsonArray &jsonArrayTools)
+{
+    QMutexLocker locker(&m_mutexTools);
+    return buildTools(serverUuid, jsonArrayTools, m_tools);
+}
+
+QVector<QString> MCPService::buildTools(const QString &serverUuid, const QJsonArray &jsonArrayTools, QHash<QString, std::shared_ptr<MCPTool>> &toolTable)
+{
+    QVector<QString> tools;
+    for (const QJsonValue &jsonValueTool : jsonArrayTools)
+    {
+        QJsonObject jsonObjMcpTool = jsonValueTool.toObject();
+        std::shared_ptr<MCPTool> mcpTool = std::make_shared<MCPTool>(jsonObjMcpTool.value("name").toString(), serverUuid);
+        QJsonObject jsonObjInputSchema = jsonObjMcpTool.value("inputSchema").toObject();
+        // 解析 properties 对象
+        QJsonObject jsonObjProperties = jsonObjInputSchema.value("properties").toObject();
+        // 解析 required 数组
+        QJsonArray jsonArrayRequired = jsonObjInputSchema.value("required").toArray();
+        QJsonObject newJsonObjTool = {
+            {"type", "function"},
+            {"function", QJsonObject({{"name", mcpTool->id},
+                                      {"description", jsonObjMcpTool.value("description").toString()},
+                                      {"parameters", QJsonObject({{"type", "object"},
+                                                                  {"properties", jsonObjProperties},
+                                                                  {"required", jsonArrayRequired}})}})}};
+        mcpTool->jsonObjTool = newJsonObjTool;
+        mcpTool->annotations = jsonObjMcpTool.value("annotations").toObject();
+        mcpTool->argumentsValidator = JsonSchemaValidator::compile(jsonObjInputSchema);
+        tools.push_back(mcpTool->id);
+        // 更新工具列表
+        toolTable.insert(mcpTool->id, mcpTool);
+    }
+    return tools;
+}
+
 void MCPService::initClient(const QString &serverUuid)
 {
     if (!DataManager::getInstance()->getMcpServer(serverUuid))
@@ -331,11 +519,7 @@ void MCPService::initClient(const QString &serverUuid)
     XLC_LOG_DEBUG("Initializing MCP server (serverUuid={})", serverUuid);
 
     // 启动新的异步初始化任务
-    QFuture<std::shared_ptr<MCPClient>> future = QtConcurrent::run(
-        [this, serverUuid]()
-        {
-            return createMCPClient(serverUuid);
-        });
+    QFuture<std::shared_ptr<MCPClient>> future = startCreateClient(serverUuid);
 
     {
         QMutexLocker locker(&m_mutexPendingClients);
@@ -363,6 +547,8 @@ void MCPService::initClient(const QString &serverUuid)
                             QMutexLocker locker(&m_mutexClients);
                             m_clients.insert(serverUuid, client); // 存储已就绪的客户端
                         }
+                        recordSuccess(serverUuid);
+                        maintainReplicas(serverUuid, client);
                         Q_EMIT sig_clientReady(serverUuid, client);
                     }
                     else
@@ -380,7 +566,7 @@ void MCPService::initClient(const QString &serverUuid)
                 }
                 else
                 {
-                    // 对于 QtConcurrent::run 来说，通常不会出现这种情况，但为了健壮性考虑
+                    // 对于 startCreateClient 来说，通常不会出现这种情况，但为了健壮性考虑
                     XLC_LOG_WARN("Server future completed but result unavailable or cancelled (exception state) (serverUuid={})", serverUuid);
                     ToastManager::showMessage(Toast::Type::Error,
                                               QString("初始化MCP客户端失败 (serverUuid=%1): Server future completed but result unavailable or cancelled (exception state)")
@@ -404,6 +590,10 @@ void MCPService::closeClient(const QString &serverUuid)
         client = it_Client.value();
         m_clients.erase(it_Client);
     }
+    if (m_health.remove(serverUuid) > 0)
+        Q_EMIT sig_serverHealthChanged(serverUuid);
+    m_toolResultCache.invalidateServer(serverUuid);
+    m_resourceCache.invalidateServer(serverUuid);
 
     // 从m_tools中清除工具
     {
@@ -427,7 +617,7 @@ void MCPService::callTool(const CallToolArgs &callToolArgs)
             QString errorMessage = QString("Call tool failed (callId=%1, tool=%2): tool not found").arg(callToolArgs.callId).arg(callToolArgs.toolName);
             XLC_LOG_WARN("{}", errorMessage);
             ToastManager::showMessage(Toast::Type::Error, errorMessage);
-            Q_EMIT sig_toolCallFinished(callToolArgs, false, QJsonObject(), errorMessage);
+            failToolCallLater(callToolArgs, errorMessage);
             return;
         }
         mcpTool = it_McpTool.value();
@@ -443,7 +633,7 @@ void MCPService::callTool(const CallToolArgs &callToolArgs)
             QString errorMessage = QString("Call tool failed (callId=%1, server=%2): mcp client not found").arg(callToolArgs.callId).arg(mcpTool->serverUuid);
             XLC_LOG_WARN("{}", errorMessage);
             ToastManager::showMessage(Toast::Type::Error, errorMessage);
-            Q_EMIT sig_toolCallFinished(callToolArgs, false, QJsonObject(), errorMessage);
+            failToolCallLater(callToolArgs, errorMessage);
             return;
         }
         mcpClient = it_McpClient.value();
@@ -454,82 +644,368 @@ void MCPService::callTool(const CallToolArgs &callToolArgs)
         QString errorMessage = QString("Call tool failed (callId=%1, server=%2, tool=%3): original tool not found").arg(callToolArgs.callId).arg(mcpTool->serverUuid).arg(callToolArgs.toolName);
         XLC_LOG_WARN("{}", errorMessage);
         ToastManager::showMessage(Toast::Type::Error, errorMessage);
-        Q_EMIT sig_toolCallFinished(callToolArgs, false, QJsonObject(), errorMessage);
+        failToolCallLater(callToolArgs, errorMessage);
         return;
     }
 
-    // 异步调用tool
-    QtConcurrent::run(
-        [this, mcpClient, mcpTool, callToolArgs]()
+    // 只读/幂等工具命中缓存时直接返回，不占用服务器调用名额
+    std::shared_ptr<McpServer> mcpServer = DataManager::getInstance()->getMcpServer(mcpTool->serverUuid);
+    QString cacheKey;
+    if (mcpServer && mcpServer->resultCacheTtl > 0 && isToolCacheable(mcpServer, mcpTool))
+    {
+        cacheKey = MCPToolResultCache::buildKey(mcpTool->serverUuid, mcpTool->name, callToolArgs.parameters);
+        QJsonObject jsonObjCachedResult;
+        if (m_toolResultCache.lookup(cacheKey, mcpTool->id, jsonObjCachedResult))
         {
-            try
-            {
-                // 使用std::string作为中间件转换QJsonObject到mcp::json
-                mcp::json arguments = mcp::json::parse(QString::fromUtf8(QJsonDocument(callToolArgs.parameters).toJson(QJsonDocument::Compact)).toStdString());
-                mcp::json result = mcpClient->client->call_tool(mcpTool->name.toStdString(), arguments);
-                // 根据 isError 字段判断是否调用成功
-                if (result.contains("isError") && result["isError"].is_boolean() && !result["isError"])
+            XLC_LOG_DEBUG("Call tool served from cache (callId={}, tool={}, serverUuid={})", callToolArgs.callId, mcpTool->name, mcpTool->serverUuid);
+            QMetaObject::invokeMethod(
+                this,
+                [this, callToolArgs, jsonObjCachedResult]()
                 {
-                    // 调用成功
-                    XLC_LOG_TRACE("Call tool succeeded (callId={}, tool={}): {}", callToolArgs.callId, mcpTool->name, result.dump(4));
-                    // 处理调用结果
-                    QJsonObject jsonObjToolCallResult = QJsonDocument::fromJson(QString::fromStdString(result.dump()).toUtf8()).object();
-                    Q_EMIT sig_toolCallFinished(callToolArgs, true, jsonObjToolCallResult, QString());
-                }
-                else
-                {
-                    // 调用失败
-                    QString errorMessage = QString("Call tool failed (callId=%1, tool=%2): %3")
-                                               .arg(callToolArgs.callId)
-                                               .arg(mcpTool->name)
-                                               .arg("no error details available");
-                    // 如果有 content 字段，并且内容是字符串，提取错误信息
-                    if (result.contains("content") && result["content"].is_array() && !result["content"].empty() &&
-                        result["content"][0].contains("text") && result["content"][0]["text"].is_string())
-                    {
-                        errorMessage = QString("Call tool failed (callId=%1, tool=%2): %3")
-                                           .arg(callToolArgs.callId)
-                                           .arg(mcpTool->name)
-                                           .arg(QString::fromStdString(result["content"][0]["text"].get<std::string>()));
-                    }
-                    XLC_LOG_ERROR("{}", errorMessage);
-                    ToastManager::showMessage(Toast::Type::Error, errorMessage);
-                    Q_EMIT sig_toolCallFinished(callToolArgs, false, QJsonObject(), errorMessage);
-                }
-            }
+                    Q_EMIT sig_toolCallFinished(callToolArgs, true, jsonObjCachedResult, QString());
+                },
+                Qt::QueuedConnection);
+            return;
+        }
+    }
+
+    // 熔断器打开时直接返回结构化错误，LLM无需等待调用超时
+    auto it_Health = m_health.constFind(mcpTool->serverUuid);
+    if (it_Health != m_health.constEnd() && it_Health->isCircuitOpen())
+    {
+        qint64 retryAfterMs = qMax<qint64>(0, QDateTime::currentDateTime().msecsTo(it_Health->nextReconnectTime));
+        QString errorMessage = buildStructuredError("mcp_server_unavailable",
+                                                    QString("MCP server is currently unavailable, tool `%1` was not called").arg(mcpTool->name),
+                                                    QJsonObject({{"callId", callToolArgs.callId},
+                                                                 {"serverUuid", mcpTool->serverUuid},
+                                                                 {"state", MCPServerHealth::stateName(it_Health->state)},
+                                                                 {"retryAfterSeconds", static_cast<int>((retryAfterMs + 999) / 1000)},
+                                                                 {"lastError", it_Health->lastError}}));
+        XLC_LOG_DEBUG("Call tool rejected by open circuit (callId={}, tool={}, serverUuid={})", callToolArgs.callId, mcpTool->name, mcpTool->serverUuid);
+        failToolCallLater(callToolArgs, errorMessage);
+        return;
+    }
+
+    // 按服务器排队执行tool，避免同一服务器的大量并行调用占满线程池
+    const int timeoutSeconds = mcpServer ? mcpServer->timeout : 0;
+    std::shared_ptr<ToolCallContext> context = std::make_shared<ToolCallContext>();
+    context->callToolArgs = callToolArgs;
+    context->serverUuid = mcpTool->serverUuid;
+    context->toolName = mcpTool->name;
+    context->cacheKey = cacheKey;
+    context->cacheTtlSeconds = mcpServer ? mcpServer->resultCacheTtl : 0;
+    m_callScheduler->setMaxInFlight(context->serverUuid, mcpServer ? mcpServer->maxConcurrentCalls : 1);
+    m_callScheduler->enqueue(context->serverUuid, callToolArgs.conversationUuid,
+                             [this, mcpClient, mcpTool, context, timeoutSeconds]()
+                             {
+                                 context->elapsedTimer.start();
+                                 // 截止时间从开始执行时计算，排队等待的时间不计入
+                                 if (timeoutSeconds > 0)
+                                 {
+                                     int timeoutMs = static_cast<int>(qMin<qint64>(static_cast<qint64>(timeoutSeconds) * 1000, std::numeric_limits<int>::max()));
+                                     QTimer::singleShot(timeoutMs, this,
+                                                        [this, context, timeoutSeconds]()
+                                                        {
+                                                            onToolCallTimeout(context, timeoutSeconds);
+                                                        });
+                                 }
+                                 if (mcpClient->asyncClient || mcpClient->isSuspended)
+                                 {
+                                     // 异步客户端不占用线程；放到下一轮事件循环，保证结果不会在 callTool 返回前发出
+                                     QMetaObject::invokeMethod(
+                                         this,
+                                         [this, mcpClient, mcpTool, context]()
+                                         {
+                                             executeToolCallAsync(mcpClient, mcpTool, context);
+                                         },
+                                         Qt::QueuedConnection);
+                                     return;
+                                 }
+                                 Executor::getInstance()->run(Executor::Pool::IoBlocking,
+                                                              [this, mcpClient, mcpTool, context]()
+                                                              {
+                                                                  executeToolCall(mcpClient, mcpTool, context);
+                                                              });
+                             });
+}
+
+void MCPService::executeToolCall(std::shared_ptr<MCPClient> mcpClient, std::shared_ptr<MCPTool> mcpTool, std::shared_ptr<ToolCallContext> context)
+{
+    const CallToolArgs &callToolArgs = context->callToolArgs;
+    bool success = false;
+    QJsonObject jsonObjToolCallResult;
+    QString errorMessage;
+    // 服务器返回了结果(包括 isError)说明连接正常；抛出异常则视为连接故障
+    bool connectionFailed = false;
+    try
+    {
+        // 使用std::string作为中间件转换QJsonObject到mcp::json
+        mcp::json arguments = mcp::json::parse(QString::fromUtf8(QJsonDocument(callToolArgs.parameters).toJson(QJsonDocument::Compact)).toStdString());
+        mcp::json result = mcpClient->client->call_tool(mcpTool->name.toStdString(), arguments);
+        // 根据 isError 字段判断是否调用成功
+        if (result.contains("isError") && result["isError"].is_boolean() && !result["isError"])
+        {
+            // 调用成功
+            XLC_LOG_TRACE("Call tool succeeded (callId={}, tool={}): {}", callToolArgs.callId, mcpTool->name, result.dump(4));
+            // 处理调用结果
+            jsonObjToolCallResult = QJsonDocument::fromJson(QString::fromStdString(result.dump()).toUtf8()).object();
+            success = true;
+        }
+        else
+        {
             // 调用失败
-            catch (const mcp::mcp_exception &e)
+            errorMessage = QString("Call tool failed (callId=%1, tool=%2): %3")
+                               .arg(callToolArgs.callId)
+                               .arg(mcpTool->name)
+                               .arg("no error details available");
+            // 如果有 content 字段，并且内容是字符串，提取错误信息
+            if (result.contains("content") && result["content"].is_array() && !result["content"].empty() &&
+                result["content"][0].contains("text") && result["content"][0]["text"].is_string())
             {
-                QString errorMessage = QString("Call tool failed (callId=%1, tool=%2): mcp error=%3")
-                                           .arg(callToolArgs.callId)
-                                           .arg(mcpTool->name)
-                                           .arg(e.what());
-                XLC_LOG_WARN("{}", errorMessage);
-                ToastManager::showMessage(Toast::Type::Error, errorMessage);
-                Q_EMIT sig_toolCallFinished(callToolArgs, false, QJsonObject(), errorMessage);
+                errorMessage = QString("Call tool failed (callId=%1, tool=%2): %3")
+                                   .arg(callToolArgs.callId)
+                                   .arg(mcpTool->name)
+                                   .arg(QString::fromStdString(result["content"][0]["text"].get<std::string>()));
             }
-            catch (const std::exception &e)
+        }
+    }
+    // 调用失败
+    catch (const mcp::mcp_exception &e)
+    {
+        errorMessage = QString("Call tool failed (callId=%1, tool=%2): mcp error=%3")
+                           .arg(callToolArgs.callId)
+                           .arg(mcpTool->name)
+                           .arg(e.what());
+        connectionFailed = true;
+    }
+    catch (const std::exception &e)
+    {
+        errorMessage = QString("Call tool failed (callId=%1, tool=%2): standard error=%3")
+                           .arg(callToolArgs.callId)
+                           .arg(mcpTool->name)
+                           .arg(e.what());
+        connectionFailed = true;
+    }
+    catch (...)
+    {
+        errorMessage = QString("Call tool failed (callId=%1, tool=%2): no error details available")
+                           .arg(callToolArgs.callId)
+                           .arg(mcpTool->name);
+        connectionFailed = true;
+    }
+
+    finishToolCall(context, success, jsonObjToolCallResult, errorMessage, connectionFailed);
+}
+
+void MCPService::executeToolCallAsync(std::shared_ptr<MCPClient> mcpClient, std::shared_ptr<MCPTool> mcpTool, std::shared_ptr<ToolCallContext> context)
+{
+    // 调用在排队期间已经超时
+    if (context->settled)
+        return;
+    // 进程已因空闲关闭，重新启动后再调用
+    if (mcpClient->isSuspended || !mcpClient->asyncClient)
+    {
+        resumeClient(context->serverUuid, mcpClient,
+                     [this, mcpClient, mcpTool, context](bool success, const QString &errorMessage)
+                     {
+                         if (success)
+                         {
+                             executeToolCallAsync(mcpClient, mcpTool, context);
+                             return;
+                         }
+                         finishToolCall(context, false, QJsonObject(),
+                                        QString("Call tool failed (callId=%1, tool=%2): relaunch MCP server failed: %3")
+                                            .arg(context->callToolArgs.callId)
+                                            .arg(context->toolName)
+                                            .arg(errorMessage),
+                                        true);
+                     });
+        return;
+    }
+    mcpClient->lastActiveTimer.restart();
+    std::shared_ptr<MCPAsyncClient> asyncClient = selectReplica(context->serverUuid, mcpClient);
+    context->asyncClient = asyncClient;
+    const QString callId = context->callToolArgs.callId;
+    const QString toolName = mcpTool->name;
+    qint64 requestId = asyncClient->sendRequest(
+        "tools/call",
+        QJsonObject({{"name", toolName}, {"arguments", context->callToolArgs.parameters}}),
+        [this, context, callId, toolName, weakClient = std::weak_ptr<MCPClient>(mcpClient)](bool success, const QJsonObject &result, const QString &errorMessage)
+        {
+            // 空闲时间从调用结束时开始计算
+            if (std::shared_ptr<MCPClient> mcpClient = weakClient.lock())
+                mcpClient->lastActiveTimer.restart();
+            if (!success)
             {
-                QString errorMessage = QString("Call tool failed (callId=%1, tool=%2): standard error=%3")
-                                           .arg(callToolArgs.callId)
-                                           .arg(mcpTool->name)
-                                           .arg(e.what());
-
-                XLC_LOG_WARN("{}", errorMessage);
-                ToastManager::showMessage(Toast::Type::Error, errorMessage);
-                Q_EMIT sig_toolCallFinished(callToolArgs, false, QJsonObject(), errorMessage);
+                // 服务器返回了 JSON-RPC error 说明连接正常
+                finishToolCall(context, false, QJsonObject(),
+                               QString("Call tool failed (callId=%1, tool=%2): %3").arg(callId).arg(toolName).arg(errorMessage),
+                               !MCPAsyncClient::isServerError(errorMessage));
+                return;
             }
-            catch (...)
+            // 根据 isError 字段判断是否调用成功
+            if (result.value("isError").toBool(false))
             {
-                QString errorMessage = QString("Call tool failed (callId=%1, tool=%2): no error details available")
-                                           .arg(callToolArgs.callId)
-                                           .arg(mcpTool->name);
-
-                XLC_LOG_WARN("{}", errorMessage);
-                ToastManager::showMessage(Toast::Type::Error, errorMessage);
-                Q_EMIT sig_toolCallFinished(callToolArgs, false, QJsonObject(), errorMessage);
+                QString errorDetails("no error details available");
+                // 如果有 content 字段，并且内容是字符串，提取错误信息
+                QJsonArray jsonArrayContent = result.value("content").toArray();
+                if (!jsonArrayContent.isEmpty() && jsonArrayContent.first().toObject().value("text").isString())
+                    errorDetails = jsonArrayContent.first().toObject().value("text").toString();
+                finishToolCall(context, false, QJsonObject(),
+                               QString("Call tool failed (callId=%1, tool=%2): %3").arg(callId).arg(toolName).arg(errorDetails),
+                               false);
+                return;
             }
+            XLC_LOG_TRACE("Call tool succeeded (callId={}, tool={}): {}", callId, toolName, QString::fromUtf8(QJsonDocument(result).toJson(QJsonDocument::Compact)));
+            finishToolCall(context, true, result, QString(), false);
         });
+    // 超时后通知服务器取消请求(notifications/cancelled)
+    std::weak_ptr<MCPAsyncClient> weakAsyncClient = asyncClient;
+    context->cancelHandler = [weakAsyncClient, requestId]()
+    {
+        if (std::shared_ptr<MCPAsyncClient> asyncClient = weakAsyncClient.lock())
+            asyncClient->cancelRequest(requestId, "timeout");
+    };
+}
+
+void MCPService::finishToolCall(std::shared_ptr<ToolCallContext> context, bool success, const QJsonObject &jsonObjToolCallResult, const QString &errorMessage, bool connectionFailed)
+{
+    const CallToolArgs &callToolArgs = context->callToolArgs;
+    // 已经超时的调用，结果不再返回给LLM
+    if (!context->settle())
+    {
+        XLC_LOG_WARN("Dropped late tool call result (callId={}, tool={}, elapsedMs={}, success={})",
+                     callToolArgs.callId,
+                     context->toolName,
+                     context->elapsedTimer.elapsed(),
+                     success);
+        return;
+    }
+    if (success)
+    {
+        if (!context->cacheKey.isEmpty())
+            m_toolResultCache.insert(context->cacheKey, callToolArgs.toolName, jsonObjToolCallResult, context->elapsedTimer.elapsed(), context->cacheTtlSeconds);
+        Q_EMIT sig_toolCallFinished(callToolArgs, true, jsonObjToolCallResult, QString());
+    }
+    else
+    {
+        if (connectionFailed)
+            XLC_LOG_WARN("{}", errorMessage);
+        else
+            XLC_LOG_ERROR("{}", errorMessage);
+        ToastManager::showMessage(Toast::Type::Error, errorMessage);
+        Q_EMIT sig_toolCallFinished(callToolArgs, false, QJsonObject(), errorMessage);
+    }
+    m_callScheduler->release(context->serverUuid);
+
+    // 切换回主线程更新健康状态
+    const QString serverUuid = context->serverUuid;
+    QMetaObject::invokeMethod(
+        this,
+        [this, serverUuid, connectionFailed, errorMessage]()
+        {
+            if (connectionFailed)
+                recordFailure(serverUuid, errorMessage);
+            else
+                recordSuccess(serverUuid);
+        },
+        Qt::QueuedConnection);
+}
+
+void MCPService::onToolCallTimeout(std::shared_ptr<ToolCallContext> context, int timeoutSeconds)
+{
+    // 调用已经返回
+    if (!context->settle())
+        return;
+
+    const CallToolArgs &callToolArgs = context->callToolArgs;
+    QString errorMessage = buildStructuredError("tool_call_timeout",
+                                                QString("Tool `%1` did not respond within %2 seconds, the call was abandoned").arg(context->toolName).arg(timeoutSeconds),
+                                                QJsonObject({{"callId", callToolArgs.callId},
+                                                             {"serverUuid", context->serverUuid},
+                                                             {"timeoutSeconds", timeoutSeconds}}));
+    XLC_LOG_WARN("Call tool timed out (callId={}, tool={}, serverUuid={}, timeoutSeconds={})", callToolArgs.callId, context->toolName, context->serverUuid, timeoutSeconds);
+    ToastManager::showMessage(Toast::Type::Error, QString("调用工具超时 (tool=%1, timeout=%2s)").arg(context->toolName).arg(timeoutSeconds));
+    // 通知传输层取消请求
+    if (context->cancelHandler)
+        context->cancelHandler();
+    Q_EMIT sig_toolCallFinished(callToolArgs, false, QJsonObject(), errorMessage);
+    // 立即归还名额，卡住的调用不再阻塞队列
+    m_callScheduler->release(context->serverUuid);
+
+    // 多数 stdio 服务器在单线程中处理请求，卡住的进程会阻塞后续所有调用，直接重启进程
+    std::shared_ptr<McpServer> mcpServer = DataManager::getInstance()->getMcpServer(context->serverUuid);
+    if (mcpServer && mcpServer->type == McpServer::Type::stdio)
+    {
+        // 进程池中卡住的是额外副本时只回收该副本
+        std::shared_ptr<MCPAsyncClient> asyncClient = context->asyncClient.lock();
+        std::shared_ptr<MCPClient> mcpClient;
+        {
+            QMutexLocker locker(&m_mutexClients);
+            mcpClient = m_clients.value(context->serverUuid);
+        }
+        if (asyncClient && mcpClient && retireReplica(context->serverUuid, mcpClient, asyncClient.get()))
+            recordFailure(context->serverUuid, errorMessage);
+        else
+            openCircuit(context->serverUuid, errorMessage);
+    }
+    else
+    {
+        recordFailure(context->serverUuid, errorMessage);
+    }
+}
+
+void MCPService::failToolCallLater(const CallToolArgs &callToolArgs, const QString &errorMessage)
+{
+    QMetaObject::invokeMethod(
+        this,
+        [this, callToolArgs, errorMessage]()
+        {
+            Q_EMIT sig_toolCallFinished(callToolArgs, false, QJsonObject(), errorMessage);
+        },
+        Qt::QueuedConnection);
+}
+
+bool MCPService::isToolCacheable(std::shared_ptr<McpServer> mcpServer, std::shared_ptr<MCPTool> mcpTool)
+{
+    if (mcpServer->cacheableTools.contains(mcpTool->name))
+        return true;
+    // 注解只是服务器给出的提示，声明只读或幂等时认为相同参数的结果可以复用
+    return mcpTool->annotations.value("readOnlyHint").toBool(false) || mcpTool->annotations.value("idempotentHint").toBool(false);
+}
+
+bool MCPService::validateToolArguments(const QString &toolId, const QJsonObject &arguments, QStringList *errors)
+{
+    std::shared_ptr<MCPTool> mcpTool;
+    {
+        QMutexLocker locker(&m_mutexTools);
+        mcpTool = m_tools.value(toolId);
+    }
+    if (!mcpTool || !mcpTool->argumentsValidator)
+        return true;
+    return mcpTool->argumentsValidator->validate(arguments, errors);
+}
+
+void MCPService::recordRejectedToolCall(const QString &toolId)
+{
+    QString serverUuid;
+    {
+        QMutexLocker locker(&m_mutexTools);
+        std::shared_ptr<MCPTool> mcpTool = m_tools.value(toolId);
+        if (!mcpTool)
+            return;
+        serverUuid = mcpTool->serverUuid;
+    }
+    m_health[serverUuid].rejectedToolCalls += 1;
+    Q_EMIT sig_serverHealthChanged(serverUuid);
+}
+
+QString MCPService::buildStructuredError(const QString &code, const QString &message, const QJsonObject &details)
+{
+    QJsonObject jsonObjError = details;
+    jsonObjError.insert("code", code);
+    jsonObjError.insert("message", message);
+    return QString::fromUtf8(QJsonDocument(QJsonObject({{"error", jsonObjError}})).toJson(QJsonDocument::Compact));
 }
 
 QJsonArray MCPService::getToolsFromServer(const QString &serverUuid)
@@ -559,6 +1035,13 @@ QJsonArray MCPService::getToolsFromServer(const QString &serverUuid)
         client = it_McpClient.value();
     }
 
+    // 工具列表来自缓存；进程已因空闲关闭时提前启动，与LLM请求并行
+    if (client->isSuspended)
+    {
+        XLC_LOG_DEBUG("Prewarming suspended MCP server (serverUuid={})", serverUuid);
+        resumeClient(serverUuid, client, nullptr);
+    }
+
     QMutexLocker locker(&m_mutexTools);
     QJsonArray jsonArrayTools;
     for (const QString &toolId : client->tools)
@@ -588,48 +1071,816 @@ QJsonArray MCPService::getToolsFromServers(const QSet<QString> mcpServers)
     return jsonArrayTools;
 }
 
-// void MCPService::checkMcpConnectivity(const QString &serverUuid)
-// {
-//     QFuture<bool> future = QtConcurrent::run(
-//         [this, serverUuid]()
-//         {
-//             QMutexLocker lockerClients(&m_mutexClients);
-//             auto it = m_clients.find(serverUuid);
-//             if (it != m_clients.end())
-//             {
-//                 try
-//                 {
-//                     it.value()->client->get_tools();
-//                     XLC_LOG_INFO("Check MCP connectivity successed (serverUuid={})", serverUuid);
-//                     return true;
-//                 }
-//                 catch (const mcp::mcp_exception &e)
-//                 {
-//                     XLC_LOG_INFO("Check MCP connectivity failed (serverUuid={}, errormsg={}): mcp error", serverUuid, e.what());
-//                     return false;
-//                 }
-//                 catch (const std::exception &e)
-//                 {
-//                     XLC_LOG_INFO("Check MCP connectivity failed (serverUuid={}, errormsg={}): error", serverUuid, e.what());
-//                     return false;
-//                 }
-//             }
-//             else
-//             {
-//                 XLC_LOG_INFO("Check MCP connectivity failed (serverUuid={}): client not found", serverUuid);
-//                 return false;
-//             }
-//         });
-
-//     QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>();
-//     connect(watcher, &QFutureWatcher<bool>::finished, this,
-//             [this, watcher, serverUuid]()
-//             {
-//                 Q_EMIT sig_checkMcpConnectivityFinished(serverUuid, watcher->future().result());
-//                 watcher->deleteLater();
-//             });
-//     watcher->setFuture(future);
-// }
+bool MCPServerHealth::isCircuitOpen() const
+{
+    return state == Unhealthy || state == Reconnecting;
+}
+
+QString MCPServerHealth::stateName(State state)
+{
+    switch (state)
+    {
+    case Unknown:
+        return "unknown";
+    case Healthy:
+        return "healthy";
+    case Unhealthy:
+        return "unhealthy";
+    case Reconnecting:
+        return "reconnecting";
+    case Suspended:
+        return "suspended";
+    default:
+        return "unknown";
+    }
+}
+
+void MCPService::checkMcpConnectivity(const QString &serverUuid)
+{
+    std::shared_ptr<MCPClient> client;
+    {
+        QMutexLocker locker(&m_mutexClients);
+        auto it_McpClient = m_clients.find(serverUuid);
+        if (it_McpClient != m_clients.end())
+            client = it_McpClient.value();
+    }
+    if (!client)
+    {
+        XLC_LOG_DEBUG("Check MCP connectivity failed (serverUuid={}): client not found", serverUuid);
+        Q_EMIT sig_checkMcpConnectivityFinished(serverUuid, false);
+        return;
+    }
+    // 进程已因空闲关闭，无需检测
+    if (client->isSuspended)
+    {
+        Q_EMIT sig_checkMcpConnectivityFinished(serverUuid, true);
+        return;
+    }
+    MCPServerHealth &health = m_health[serverUuid];
+    if (health.isChecking || health.isCircuitOpen())
+        return;
+    health.isChecking = true;
+
+    // 检测结果: (错误信息, 耗时)，错误信息为空代表检测成功
+    auto onCheckFinished = [this, serverUuid](const QPair<QString, qint64> &result)
+    {
+        auto it_Health = m_health.find(serverUuid);
+        if (it_Health == m_health.end())
+            return; // 检测期间客户端已关闭
+        it_Health->isChecking = false;
+        bool success = result.first.isEmpty();
+        if (success)
+        {
+            it_Health->latencyMs = result.second;
+            XLC_LOG_TRACE("Check MCP connectivity succeeded (serverUuid={}, latencyMs={})", serverUuid, result.second);
+            recordSuccess(serverUuid);
+        }
+        else
+        {
+            QString errorMessage = QString("Check MCP connectivity failed (serverUuid=%1): %2").arg(serverUuid).arg(result.first);
+            XLC_LOG_WARN("{}", errorMessage);
+            // ping 失败说明连接已断开，无需等待连续失败
+            openCircuit(serverUuid, errorMessage);
+        }
+        Q_EMIT sig_checkMcpConnectivityFinished(serverUuid, success);
+    };
+
+    // 异步客户端直接在主线程发送 ping 请求
+    if (client->asyncClient)
+    {
+        if (!client->asyncClient->isConnected())
+        {
+            onCheckFinished(qMakePair(QString("client is not running"), qint64(0)));
+            return;
+        }
+        std::shared_ptr<McpServer> mcpServer = DataManager::getInstance()->getMcpServer(serverUuid);
+        const int timeoutMs = mcpServer && mcpServer->timeout > 0 ? mcpServer->timeout * 1000 : 30000;
+        QElapsedTimer timer;
+        timer.start();
+        client->asyncClient->sendRequest(
+            "ping", QJsonObject(),
+            [onCheckFinished, timer](bool success, const QJsonObject &, const QString &errorMessage)
+            {
+                onCheckFinished(qMakePair(success ? QString() : QString("ping failed: %1").arg(errorMessage), timer.elapsed()));
+            },
+            timeoutMs);
+        return;
+    }
+
+    QFuture<QPair<QString, qint64>> future = Executor::getInstance()->run(
+        Executor::Pool::IoBlocking,
+        [client]()
+        {
+            QElapsedTimer timer;
+            timer.start();
+            try
+            {
+                if (!client->client->is_running())
+                    return qMakePair(QString("client is not running"), timer.elapsed());
+                if (!client->client->ping())
+                    return qMakePair(QString("ping failed"), timer.elapsed());
+                return qMakePair(QString(), timer.elapsed());
+            }
+            catch (const mcp::mcp_exception &e)
+            {
+                return qMakePair(QString("mcp error=%1").arg(e.what()), timer.elapsed());
+            }
+            catch (const std::exception &e)
+            {
+                return qMakePair(QString("standard error=%1").arg(e.what()), timer.elapsed());
+            }
+        });
+
+    QFutureWatcher<QPair<QString, qint64>> *watcher = new QFutureWatcher<QPair<QString, qint64>>();
+    connect(watcher, &QFutureWatcher<QPair<QString, qint64>>::finished, this,
+            [watcher, onCheckFinished]()
+            {
+                QPair<QString, qint64> result = watcher->result();
+                watcher->deleteLater();
+                onCheckFinished(result);
+            });
+    watcher->setFuture(future);
+}
+
+void MCPService::slot_onHealthCheckTimeout()
+{
+    QHash<QString, std::shared_ptr<MCPClient>> clients;
+    {
+        QMutexLocker locker(&m_mutexClients);
+        clients = m_clients;
+    }
+    QDateTime currentDateTime = QDateTime::currentDateTime();
+    for (auto it = clients.constBegin(); it != clients.constEnd(); ++it)
+    {
+        const QString &serverUuid = it.key();
+        if (it.value()->isSuspended || suspendIdleClient(serverUuid, it.value()))
+            continue;
+        maintainReplicas(serverUuid, it.value());
+        auto it_Health = m_health.constFind(serverUuid);
+        if (it_Health != m_health.constEnd())
+        {
+            if (it_Health->isChecking || it_Health->isCircuitOpen())
+                continue;
+            // 最近有调用成功则不需要额外的ping
+            if (it_Health->lastCheckedTime.isValid() && it_Health->lastCheckedTime.msecsTo(currentDateTime) < HEALTH_CHECK_INTERVAL_MS / 2)
+                continue;
+        }
+        // 有调用正在执行时，调用结果本身就能反映连接状态；单线程的stdio服务器也无法及时响应ping
+        if (m_callScheduler->metrics(serverUuid).inFlight > 0)
+            continue;
+        checkMcpConnectivity(serverUuid);
+    }
+}
+
+MCPServerHealth MCPService::getServerHealth(const QString &serverUuid) const
+{
+    return m_health.value(serverUuid);
+}
+
+void MCPService::recordSuccess(const QString &serverUuid)
+{
+    MCPServerHealth &health = m_health[serverUuid];
+    // 熔断器打开后旧客户端返回的结果不影响重连流程
+    if (health.isCircuitOpen())
+        return;
+    bool changed = health.state != MCPServerHealth::Healthy || health.consecutiveFailures != 0;
+    health.state = MCPServerHealth::Healthy;
+    health.consecutiveFailures = 0;
+    health.lastCheckedTime = QDateTime::currentDateTime();
+    if (changed)
+        Q_EMIT sig_serverHealthChanged(serverUuid);
+}
+
+void MCPService::recordFailure(const QString &serverUuid, const QString &errorMessage)
+{
+    MCPServerHealth &health = m_health[serverUuid];
+    if (health.isCircuitOpen())
+        return;
+    health.consecutiveFailures += 1;
+    health.lastError = errorMessage;
+    health.lastCheckedTime = QDateTime::currentDateTime();
+    XLC_LOG_DEBUG("MCP server call failed (serverUuid={}, consecutiveFailures={}, threshold={})", serverUuid, health.consecutiveFailures, FAILURE_THRESHOLD);
+    if (health.consecutiveFailures >= FAILURE_THRESHOLD)
+        openCircuit(serverUuid, errorMessage);
+    else
+        Q_EMIT sig_serverHealthChanged(serverUuid);
+}
+
+void MCPService::openCircuit(const QString &serverUuid, const QString &errorMessage)
+{
+    MCPServerHealth &health = m_health[serverUuid];
+    if (health.isCircuitOpen())
+        return;
+    health.state = MCPServerHealth::Unhealthy;
+    health.lastError = errorMessage;
+    health.lastCheckedTime = QDateTime::currentDateTime();
+    XLC_LOG_WARN("MCP server unavailable, circuit opened (serverUuid={}, consecutiveFailures={}): {}", serverUuid, health.consecutiveFailures, errorMessage);
+    ToastManager::showMessage(Toast::Type::Warning, QString("MCP服务器连接异常，将自动重连 (serverUuid=%1)").arg(serverUuid));
+    scheduleReconnect(serverUuid);
+    Q_EMIT sig_serverHealthChanged(serverUuid);
+}
+
+void MCPService::scheduleReconnect(const QString &serverUuid)
+{
+    MCPServerHealth &health = m_health[serverUuid];
+    // 指数退避 + 随机抖动，避免多个服务器同时重连
+    int delayMs = RECONNECT_MAX_DELAY_MS;
+    if (health.reconnectAttempts < 16)
+        delayMs = qMin(RECONNECT_MAX_DELAY_MS, RECONNECT_BASE_DELAY_MS << health.reconnectAttempts);
+    delayMs += QRandomGenerator::global()->bounded(delayMs / 4 + 1);
+    health.nextReconnectTime = QDateTime::currentDateTime().addMSecs(delayMs);
+    XLC_LOG_INFO("Scheduling MCP client reconnect (serverUuid={}, attempt={}, delayMs={})", serverUuid, health.reconnectAttempts + 1, delayMs);
+    QTimer::singleShot(delayMs, this,
+                       [this, serverUuid]()
+                       {
+                           reconnectClient(serverUuid);
+                       });
+}
+
+void MCPService::reconnectClient(const QString &serverUuid)
+{
+    auto it_Health = m_health.find(serverUuid);
+    if (it_Health == m_health.end() || it_Health->state != MCPServerHealth::Unhealthy)
+        return;
+    if (!DataManager::getInstance()->getMcpServer(serverUuid))
+    {
+        XLC_LOG_DEBUG("Reconnect MCP client cancelled (serverUuid={}): MCP server not found", serverUuid);
+        m_health.erase(it_Health);
+        return;
+    }
+    it_Health->state = MCPServerHealth::Reconnecting;
+    XLC_LOG_INFO("Reconnecting MCP client (serverUuid={}, attempt={})", serverUuid, it_Health->reconnectAttempts + 1);
+    // 重连后的服务器状态可能已经变化，之前缓存的结果不再可信
+    m_toolResultCache.invalidateServer(serverUuid);
+    m_resourceCache.invalidateServer(serverUuid);
+    Q_EMIT sig_serverHealthChanged(serverUuid);
+
+    QFuture<std::shared_ptr<MCPClient>> future = startCreateClient(serverUuid);
+
+    QFutureWatcher<std::shared_ptr<MCPClient>> *watcher = new QFutureWatcher<std::shared_ptr<MCPClient>>();
+    connect(watcher, &QFutureWatcher<std::shared_ptr<MCPClient>>::finished, this,
+            [this, watcher, serverUuid]()
+            {
+                std::shared_ptr<MCPClient> newClient = watcher->result();
+                watcher->deleteLater();
+                auto it_Health = m_health.find(serverUuid);
+                if (it_Health == m_health.end())
+                {
+                    // 重连期间客户端已关闭，清理新注册的工具
+                    if (newClient)
+                    {
+                        QMutexLocker locker(&m_mutexTools);
+                        for (const QString &toolId : newClient->tools)
+                            m_tools.remove(toolId);
+                    }
+                    releaseClientLater(newClient);
+                    return;
+                }
+                if (!newClient)
+                {
+                    it_Health->reconnectAttempts += 1;
+                    it_Health->state = MCPServerHealth::Unhealthy;
+                    it_Health->lastError = QString("Reconnect MCP client failed (serverUuid=%1, attempt=%2)").arg(serverUuid).arg(it_Health->reconnectAttempts);
+                    XLC_LOG_WARN("{}", it_Health->lastError);
+                    scheduleReconnect(serverUuid);
+                    Q_EMIT sig_serverHealthChanged(serverUuid);
+                    return;
+                }
+
+                // 替换断开的客户端
+                std::shared_ptr<MCPClient> oldClient;
+                {
+                    QMutexLocker locker(&m_mutexClients);
+                    oldClient = m_clients.value(serverUuid);
+                    m_clients.insert(serverUuid, newClient);
+                }
+                // 清除服务器上已不存在的工具
+                if (oldClient)
+                {
+                    QMutexLocker locker(&m_mutexTools);
+                    for (const QString &toolId : oldClient->tools)
+                    {
+                        if (!newClient->tools.contains(toolId))
+                            m_tools.remove(toolId);
+                    }
+                }
+                releaseClientLater(oldClient);
+
+                it_Health->state = MCPServerHealth::Healthy;
+                it_Health->consecutiveFailures = 0;
+                it_Health->reconnectAttempts = 0;
+                it_Health->reconnectCount += 1;
+                it_Health->lastCheckedTime = QDateTime::currentDateTime();
+                it_Health->nextReconnectTime = QDateTime();
+                XLC_LOG_INFO("Reconnect MCP client succeeded (serverUuid={}, reconnectCount={})", serverUuid, it_Health->reconnectCount);
+                ToastManager::showMessage(Toast::Type::Success, QString("MCP服务器重连成功 (serverUuid=%1)").arg(serverUuid));
+                maintainReplicas(serverUuid, newClient);
+                Q_EMIT sig_clientReady(serverUuid, newClient);
+                Q_EMIT sig_serverHealthChanged(serverUuid);
+            });
+    watcher->setFuture(future);
+}
+
+void MCPService::releaseClientLater(std::shared_ptr<MCPClient> client)
+{
+    if (!client)
+        return;
+    Executor::getInstance()->run(Executor::Pool::Background,
+                                 [client]() mutable
+                                 {
+                                     client.reset();
+                                 });
+}
+
+std::shared_ptr<MCPAsyncClient> MCPService::selectReplica(const QString &serverUuid, std::shared_ptr<MCPClient> mcpClient)
+{
+    std::shared_ptr<MCPAsyncClient> selected = mcpClient->asyncClient;
+    int minLoad = selected->getPendingRequestCount();
+    MCPReplica *selectedReplica = nullptr;
+    for (MCPReplica &replica : mcpClient->replicas)
+    {
+        if (!replica.client->isConnected())
+            continue;
+        int load = replica.client->getPendingRequestCount();
+        if (load < minLoad)
+        {
+            minLoad = load;
+            selected = replica.client;
+            selectedReplica = &replica;
+        }
+    }
+    if (selectedReplica)
+        selectedReplica->idleTimer.restart();
+
+    // 所有进程都在处理请求时扩容，每次只启动一个副本
+    std::shared_ptr<McpServer> mcpServer = DataManager::getInstance()->getMcpServer(serverUuid);
+    if (minLoad > 0 && mcpServer && mcpServer->type == McpServer::Type::stdio && mcpClient->startingReplicas == 0 &&
+        1 + mcpClient->replicas.size() < mcpServer->maxReplicas)
+    {
+        startReplica(serverUuid, mcpClient);
+    }
+    return selected;
+}
+
+void MCPService::startReplica(const QString &serverUuid, std::shared_ptr<MCPClient> mcpClient)
+{
+    std::shared_ptr<McpServer> mcpServer = DataManager::getInstance()->getMcpServer(serverUuid);
+    if (!mcpServer)
+        return;
+    std::shared_ptr<MCPAsyncClient> asyncClient = startStdioProcess(mcpServer);
+    MCPAsyncClient *replicaClient = asyncClient.get();
+    std::weak_ptr<MCPClient> weakClient = mcpClient;
+    // 副本进程退出只移除该副本，不影响其他进程
+    connect(replicaClient, &MCPAsyncClient::sig_disconnected, this,
+            [this, serverUuid, weakClient, replicaClient](const QString &errorMessage)
+            {
+                Q_UNUSED(errorMessage);
+                if (std::shared_ptr<MCPClient> mcpClient = weakClient.lock())
+                    retireReplica(serverUuid, mcpClient, replicaClient);
+            });
+    mcpClient->startingReplicas += 1;
+    XLC_LOG_DEBUG("Starting MCP server replica (serverUuid={}, replicas={}, maxReplicas={})", serverUuid, 1 + mcpClient->replicas.size(), mcpServer->maxReplicas);
+    asyncClient->initialize(
+        "XLCClient", MCPAsyncClient::MCP_PROTOCOL_VERSION, MCPAsyncClient::clientCapabilities(),
+        mcpServer->timeout > 0 ? mcpServer->timeout * 1000 : 30000,
+        [this, serverUuid, weakClient, asyncClient](bool success, const QString &errorMessage)
+        {
+            std::shared_ptr<MCPClient> mcpClient = weakClient.lock();
+            if (!mcpClient)
+                return;
+            mcpClient->startingReplicas -= 1;
+            if (!success)
+            {
+                XLC_LOG_WARN("Start MCP server replica failed (serverUuid={}): {}", serverUuid, errorMessage);
+                return;
+            }
+            MCPReplica replica;
+            replica.client = asyncClient;
+            replica.idleTimer.start();
+            mcpClient->replicas.append(replica);
+            XLC_LOG_INFO("MCP server replica started (serverUuid={}, replicas={})", serverUuid, 1 + mcpClient->replicas.size());
+            Q_EMIT sig_serverHealthChanged(serverUuid);
+        });
+}
+
+bool MCPService::retireReplica(const QString &serverUuid, std::shared_ptr<MCPClient> mcpClient, MCPAsyncClient *asyncClient)
+{
+    for (int i = 0; i < mcpClient->replicas.size(); ++i)
+    {
+        if (mcpClient->replicas[i].client.get() != asyncClient)
+            continue;
+        mcpClient->replicas.remove(i);
+        XLC_LOG_INFO("MCP server replica retired (serverUuid={}, replicas={})", serverUuid, 1 + mcpClient->replicas.size());
+        Q_EMIT sig_serverHealthChanged(serverUuid);
+        return true;
+    }
+    return false;
+}
+
+void MCPService::maintainReplicas(const QString &serverUuid, std::shared_ptr<MCPClient> mcpClient)
+{
+    std::shared_ptr<McpServer> mcpServer = DataManager::getInstance()->getMcpServer(serverUuid);
+    if (!mcpClient || !mcpClient->asyncClient || !mcpServer || mcpServer->type != McpServer::Type::stdio)
+        return;
+    auto it_Health = m_health.constFind(serverUuid);
+    if (it_Health != m_health.constEnd() && it_Health->isCircuitOpen())
+        return;
+    // 回收空闲副本，保留最少进程数
+    const int minReplicas = qMax(1, mcpServer->minReplicas);
+    for (int i = mcpClient->replicas.size() - 1; i >= 0 && 1 + mcpClient->replicas.size() > minReplicas; --i)
+    {
+        const MCPReplica &replica = mcpClient->replicas[i];
+        if (replica.client->getPendingRequestCount() == 0 && replica.idleTimer.elapsed() > REPLICA_IDLE_TIMEOUT_MS)
+            retireReplica(serverUuid, mcpClient, replica.client.get());
+    }
+    // 补足最少进程数(启动时预热、副本异常退出后恢复)
+    const int maxReplicas = qMax(minReplicas, mcpServer->maxReplicas);
+    for (int count = 1 + mcpClient->replicas.size() + mcpClient->startingReplicas; count < minReplicas && count < maxReplicas; ++count)
+        startReplica(serverUuid, mcpClient);
+}
+
+bool MCPService::suspendIdleClient(const QString &serverUuid, std::shared_ptr<MCPClient> mcpClient)
+{
+    std::shared_ptr<McpServer> mcpServer = DataManager::getInstance()->getMcpServer(serverUuid);
+    if (!mcpServer || mcpServer->type != McpServer::Type::stdio || mcpServer->idleTimeout <= 0)
+        return false;
+    if (!mcpClient->asyncClient || mcpClient->isResuming || !mcpClient->lastActiveTimer.isValid())
+        return false;
+    if (mcpClient->lastActiveTimer.elapsed() < static_cast<qint64>(mcpServer->idleTimeout) * 1000)
+        return false;
+    auto it_Health = m_health.find(serverUuid);
+    if (it_Health != m_health.end() && (it_Health->isCircuitOpen() || it_Health->isChecking))
+        return false;
+    MCPCallQueueMetrics metrics = m_callScheduler->metrics(serverUuid);
+    if (metrics.inFlight > 0 || metrics.queueLength > 0)
+        return false;
+    if (mcpClient->asyncClient->getPendingRequestCount() > 0 || mcpClient->startingReplicas > 0)
+        return false;
+    for (const MCPReplica &replica : mcpClient->replicas)
+    {
+        if (replica.client->getPendingRequestCount() > 0)
+            return false;
+    }
+
+    // 统计回收的内存(包括进程池中的副本)
+    qint64 reclaimedBytes = 0;
+    auto addResidentMemory = [&reclaimedBytes](MCPAsyncClient *asyncClient)
+    {
+        if (MCPStdioClient *stdioClient = qobject_cast<MCPStdioClient *>(asyncClient))
+            reclaimedBytes += qMax<qint64>(0, stdioClient->getResidentMemoryBytes());
+    };
+    addResidentMemory(mcpClient->asyncClient.get());
+    for (const MCPReplica &replica : mcpClient->replicas)
+        addResidentMemory(replica.client.get());
+    int processCount = 1 + mcpClient->replicas.size();
+
+    // 释放客户端后进程在后台依次关闭标准输入、terminate、kill
+    mcpClient->replicas.clear();
+    mcpClient->asyncClient.reset();
+    mcpClient->isSuspended = true;
+    // 订阅随进程结束，关闭期间收不到资源更新通知
+    mcpClient->subscribedResources.clear();
+    m_resourceCache.invalidateServer(serverUuid);
+
+    MCPServerHealth &health = m_health[serverUuid];
+    health.state = MCPServerHealth::Suspended;
+    health.idleShutdownCount += 1;
+    health.reclaimedMemoryBytes += reclaimedBytes;
+    XLC_LOG_INFO("MCP server suspended after idle timeout (serverUuid={}, idleTimeout={}s, processes={}, reclaimedMB={:.1f}, totalReclaimedMB={:.1f})",
+                 serverUuid,
+                 mcpServer->idleTimeout,
+                 processCount,
+                 reclaimedBytes / 1048576.0,
+                 health.reclaimedMemoryBytes / 1048576.0);
+    Q_EMIT sig_serverHealthChanged(serverUuid);
+    return true;
+}
+
+void MCPService::resumeClient(const QString &serverUuid, std::shared_ptr<MCPClient> mcpClient, std::function<void(bool success, const QString &errorMessage)> callback)
+{
+    if (!mcpClient->isSuspended)
+    {
+        if (callback)
+            callback(true, QString());
+        return;
+    }
+    if (callback)
+        mcpClient->resumeCallbacks.append(callback);
+    if (mcpClient->isResuming)
+        return;
+
+    std::shared_ptr<McpServer> mcpServer = DataManager::getInstance()->getMcpServer(serverUuid);
+    if (!mcpServer)
+    {
+        QVector<std::function<void(bool, const QString &)>> callbacks = std::move(mcpClient->resumeCallbacks);
+        mcpClient->resumeCallbacks.clear();
+        for (const auto &resumeCallback : callbacks)
+            resumeCallback(false, "MCP server not found");
+        return;
+    }
+    mcpClient->isResuming = true;
+    XLC_LOG_DEBUG("Relaunching suspended MCP server (serverUuid={})", serverUuid);
+    QElapsedTimer relaunchTimer;
+    relaunchTimer.start();
+    std::shared_ptr<MCPAsyncClient> asyncClient = startStdioProcess(mcpServer);
+    connectAsyncClient(serverUuid, asyncClient.get());
+    // 工具列表沿用缓存，只需要完成初始化
+    std::weak_ptr<MCPClient> weakClient = mcpClient;
+    asyncClient->initialize(
+        "XLCClient", MCPAsyncClient::MCP_PROTOCOL_VERSION, MCPAsyncClient::clientCapabilities(),
+        mcpServer->timeout > 0 ? mcpServer->timeout * 1000 : 30000,
+        [this, serverUuid, weakClient, asyncClient, relaunchTimer](bool success, const QString &errorMessage)
+        {
+            std::shared_ptr<MCPClient> mcpClient = weakClient.lock();
+            if (!mcpClient)
+                return;
+            mcpClient->isResuming = false;
+            QVector<std::function<void(bool, const QString &)>> callbacks = std::move(mcpClient->resumeCallbacks);
+            mcpClient->resumeCallbacks.clear();
+            if (success)
+            {
+                mcpClient->asyncClient = asyncClient;
+                mcpClient->isSuspended = false;
+                mcpClient->lastActiveTimer.start();
+                MCPServerHealth &health = m_health[serverUuid];
+                health.state = MCPServerHealth::Healthy;
+                health.consecutiveFailures = 0;
+                health.lastCheckedTime = QDateTime::currentDateTime();
+                health.relaunchCount += 1;
+                health.lastRelaunchLatencyMs = relaunchTimer.elapsed();
+                health.totalRelaunchLatencyMs += health.lastRelaunchLatencyMs;
+                XLC_LOG_INFO("MCP server relaunched (serverUuid={}, latencyMs={}, averageLatencyMs={})",
+                             serverUuid,
+                             health.lastRelaunchLatencyMs,
+                             health.totalRelaunchLatencyMs / health.relaunchCount);
+                Q_EMIT sig_serverHealthChanged(serverUuid);
+                maintainReplicas(serverUuid, mcpClient);
+            }
+            else
+            {
+                XLC_LOG_WARN("Relaunch MCP server failed (serverUuid={}): {}", serverUuid, errorMessage);
+            }
+            for (const auto &resumeCallback : callbacks)
+                resumeCallback(success, errorMessage);
+        });
+}
+
+int MCPService::getReplicaCount(const QString &serverUuid)
+{
+    std::shared_ptr<MCPClient> mcpClient;
+    {
+        QMutexLocker locker(&m_mutexClients);
+        mcpClient = m_clients.value(serverUuid);
+    }
+    if (!mcpClient || mcpClient->isSuspended)
+        return 0;
+    return 1 + mcpClient->replicas.size();
+}
+
+MCPProcessUsage MCPService::getResourceUsage(const QString &serverUuid)
+{
+    MCPProcessUsage usage;
+    std::shared_ptr<MCPClient> mcpClient;
+    {
+        QMutexLocker locker(&m_mutexClients);
+        mcpClient = m_clients.value(serverUuid);
+    }
+    if (!mcpClient || !mcpClient->asyncClient)
+        return usage;
+    auto addUsage = [&usage](MCPAsyncClient *asyncClient)
+    {
+        if (MCPStdioClient *stdioClient = qobject_cast<MCPStdioClient *>(asyncClient))
+            usage += stdioClient->getResourceUsage();
+    };
+    addUsage(mcpClient->asyncClient.get());
+    for (const MCPReplica &replica : mcpClient->replicas)
+        addUsage(replica.client.get());
+    return usage;
+}
+
+void MCPService::acquireAsyncClient(const QString &serverUuid, std::function<void(std::shared_ptr<MCPClient> mcpClient, const QString &errorMessage)> callback)
+{
+    std::shared_ptr<MCPClient> mcpClient;
+    {
+        QMutexLocker locker(&m_mutexClients);
+        mcpClient = m_clients.value(serverUuid);
+    }
+    if (!mcpClient)
+    {
+        callback(nullptr, "MCP client not initialized");
+        return;
+    }
+    // 基于 cpp-mcp 的客户端(sse)没有提供资源与提示词接口
+    if (mcpClient->client)
+    {
+        callback(nullptr, "resources and prompts are not supported for sse MCP servers");
+        return;
+    }
+    resumeClient(serverUuid, mcpClient,
+                 [mcpClient, callback](bool success, const QString &errorMessage)
+                 {
+                     if (!success || !mcpClient->asyncClient)
+                     {
+                         callback(nullptr, errorMessage.isEmpty() ? QString("MCP client not available") : errorMessage);
+                         return;
+                     }
+                     mcpClient->lastActiveTimer.restart();
+                     callback(mcpClient, QString());
+                 });
+}
+
+void MCPService::listResources(const QString &serverUuid, MCPAsyncClient::ListHandler callback)
+{
+    std::shared_ptr<McpServer> mcpServer = DataManager::getInstance()->getMcpServer(serverUuid);
+    const int timeoutMs = mcpServer && mcpServer->timeout > 0 ? mcpServer->timeout * 1000 : 30000;
+    acquireAsyncClient(serverUuid,
+                       [timeoutMs, callback](std::shared_ptr<MCPClient> mcpClient, const QString &errorMessage)
+                       {
+                           if (!mcpClient)
+                           {
+                               callback(false, QJsonArray(), errorMessage);
+                               return;
+                           }
+                           if (!mcpClient->asyncClient->getServerCapabilities().contains("resources"))
+                           {
+                               callback(true, QJsonArray(), QString());
+                               return;
+                           }
+                           mcpClient->asyncClient->listAll("resources/list", "resources", timeoutMs, callback);
+                       });
+}
+
+void MCPService::readResource(const QString &serverUuid, const QString &uri, ResourceHandler callback)
+{
+    QVector<MCPResourceContent> contents;
+    if (m_resourceCache.lookup(serverUuid, uri, contents))
+    {
+        XLC_LOG_DEBUG("Read resource from cache (serverUuid={}, uri={})", serverUuid, uri);
+        callback(true, contents, QString());
+        return;
+    }
+    // 同一资源正在读取时只等待结果，不重复请求
+    const QString pendingKey = serverUuid + '\n' + uri;
+    auto it_Pending = m_pendingResourceReads.find(pendingKey);
+    if (it_Pending != m_pendingResourceReads.end())
+    {
+        it_Pending->append(callback);
+        return;
+    }
+    m_pendingResourceReads.insert(pendingKey, {callback});
+    auto finish = [this, pendingKey](bool success, const QVector<MCPResourceContent> &contents, const QString &errorMessage)
+    {
+        QVector<ResourceHandler> callbacks = m_pendingResourceReads.take(pendingKey);
+        for (const ResourceHandler &pendingCallback : callbacks)
+            pendingCallback(success, contents, errorMessage);
+    };
+
+    std::shared_ptr<McpServer> mcpServer = DataManager::getInstance()->getMcpServer(serverUuid);
+    const int timeoutMs = mcpServer && mcpServer->timeout > 0 ? mcpServer->timeout * 1000 : 30000;
+    acquireAsyncClient(
+        serverUuid,
+        [this, serverUuid, uri, timeoutMs, finish](std::shared_ptr<MCPClient> mcpClient, const QString &errorMessage)
+        {
+            if (!mcpClient)
+            {
+                finish(false, QVector<MCPResourceContent>(), errorMessage);
+                return;
+            }
+            // 先订阅再读取，避免读取与订阅之间的更新被遗漏；收不到通知时(如 HTTP 服务器不提供通知流)订阅没有意义，按未订阅缓存
+            bool subscribed = mcpClient->asyncClient->getServerCapabilities().value("resources").toObject().value("subscribe").toBool(false) &&
+                              mcpClient->asyncClient->hasNotificationChannel();
+            if (subscribed)
+                subscribeResource(serverUuid, mcpClient, uri);
+            QElapsedTimer elapsedTimer;
+            elapsedTimer.start();
+            mcpClient->asyncClient->sendRequest(
+                "resources/read",
+                QJsonObject({{"uri", uri}}),
+                [this, serverUuid, uri, subscribed, elapsedTimer, finish](bool success, const QJsonObject &result, const QString &errorMessage)
+                {
+                    if (!success)
+                    {
+                        XLC_LOG_WARN("Read resource failed (serverUuid={}, uri={}): {}", serverUuid, uri, errorMessage);
+                        finish(false, QVector<MCPResourceContent>(), errorMessage);
+                        return;
+                    }
+                    QVector<MCPResourceContent> contents = MCPResourceContent::fromJsonArray(result.value("contents").toArray());
+                    qint64 bytes = 0;
+                    for (const MCPResourceContent &content : contents)
+                        bytes += content.size;
+                    XLC_LOG_DEBUG("Read resource succeeded (serverUuid={}, uri={}, contents={}, bytes={}, elapsedMs={})",
+                                  serverUuid, uri, contents.size(), bytes, elapsedTimer.elapsed());
+                    m_resourceCache.insert(serverUuid, uri, contents, subscribed);
+                    finish(true, contents, QString());
+                },
+                timeoutMs);
+        });
+}
+
+void MCPService::subscribeResource(const QString &serverUuid, std::shared_ptr<MCPClient> mcpClient, const QString &uri)
+{
+    if (mcpClient->subscribedResources.contains(uri))
+        return;
+    mcpClient->subscribedResources.insert(uri);
+    std::weak_ptr<MCPClient> weakClient = mcpClient;
+    mcpClient->asyncClient->sendRequest(
+        "resources/subscribe",
+        QJsonObject({{"uri", uri}}),
+        [this, serverUuid, uri, weakClient](bool success, const QJsonObject &, const QString &errorMessage)
+        {
+            if (success)
+                return;
+            XLC_LOG_WARN("Subscribe resource failed (serverUuid={}, uri={}): {}", serverUuid, uri, errorMessage);
+            // 收不到更新通知，缓存的内容不再可信
+            if (std::shared_ptr<MCPClient> mcpClient = weakClient.lock())
+                mcpClient->subscribedResources.remove(uri);
+            m_resourceCache.invalidate(serverUuid, uri);
+        });
+}
+
+void MCPService::listPrompts(const QString &serverUuid, MCPAsyncClient::ListHandler callback)
+{
+    std::shared_ptr<McpServer> mcpServer = DataManager::getInstance()->getMcpServer(serverUuid);
+    const int timeoutMs = mcpServer && mcpServer->timeout > 0 ? mcpServer->timeout * 1000 : 30000;
+    acquireAsyncClient(serverUuid,
+                       [timeoutMs, callback](std::shared_ptr<MCPClient> mcpClient, const QString &errorMessage)
+                       {
+                           if (!mcpClient)
+                           {
+                               callback(false, QJsonArray(), errorMessage);
+                               return;
+                           }
+                           if (!mcpClient->asyncClient->getServerCapabilities().contains("prompts"))
+                           {
+                               callback(true, QJsonArray(), QString());
+                               return;
+                           }
+                           mcpClient->asyncClient->listAll("prompts/list", "prompts", timeoutMs, callback);
+                       });
+}
+
+void MCPService::getPrompt(const QString &serverUuid, const QString &name, const QJsonObject &arguments, MCPAsyncClient::ResponseHandler callback)
+{
+    std::shared_ptr<McpServer> mcpServer = DataManager::getInstance()->getMcpServer(serverUuid);
+    const int timeoutMs = mcpServer && mcpServer->timeout > 0 ? mcpServer->timeout * 1000 : 30000;
+    acquireAsyncClient(serverUuid,
+                       [name, arguments, timeoutMs, callback](std::shared_ptr<MCPClient> mcpClient, const QString &errorMessage)
+                       {
+                           if (!mcpClient)
+                           {
+                               callback(false, QJsonObject(), errorMessage);
+                               return;
+                           }
+                           QJsonObject params({{"name", name}});
+                           if (!arguments.isEmpty())
+                               params.insert("arguments", arguments);
+                           mcpClient->asyncClient->sendRequest("prompts/get", params, callback, timeoutMs);
+                       });
+}
+
+MCPToolCacheStats MCPService::getToolCacheStats(const QString &serverUuid) const
+{
+    return m_toolResultCache.serverStats(serverUuid);
+}
+
+MCPCallQueueMetrics MCPService::getCallQueueMetrics(const QString &serverUuid) const
+{
+    return m_callScheduler->metrics(serverUuid);
+}
+
+QHash<QString, QString> MCPService::getToolNames(const QString &serverUuid)
+{
+    std::shared_ptr<MCPClient> mcpClient;
+    {
+        QMutexLocker locker(&m_mutexClients);
+        mcpClient = m_clients.value(serverUuid);
+    }
+    QHash<QString, QString> toolNames;
+    if (!mcpClient)
+        return toolNames;
+    QMutexLocker locker(&m_mutexTools);
+    for (const QString &toolId : mcpClient->tools)
+    {
+        std::shared_ptr<MCPTool> mcpTool = m_tools.value(toolId);
+        if (mcpTool)
+            toolNames.insert(mcpTool->id, mcpTool->name);
+    }
+    return toolNames;
+}
+
+void MCPService::sendRawRequest(const QString &serverUuid, const QString &method, const QJsonObject &params, MCPAsyncClient::ResponseHandler callback, int timeoutMs)
+{
+    acquireAsyncClient(serverUuid,
+                       [method, params, callback, timeoutMs](std::shared_ptr<MCPClient> mcpClient, const QString &errorMessage)
+                       {
+                           if (!mcpClient)
+                           {
+                               callback(false, QJsonObject(), errorMessage);
+                               return;
+                           }
+                           mcpClient->asyncClient->sendRequest(method, params, callback, timeoutMs);
+                       });
+}
 
 bool MCPService::isInitialized(const QString &serverUuid)
 {
@@ -0,0 +1,556 @@
+#include "MCPStdioClient.h"
+#include <QJsonDocument>
+#include <QProcessEnvironment>
+#include <QTimer>
+#include "Logger.hpp"
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_LINUX)
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QCoreApplication>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+bool MCPProcessLimits::isEmpty() const
+{
+    return cpuQuotaPercent <= 0 && memoryLimitMB <= 0 && niceValue <= 0 && ioPriorityClass <= 0 && maxOpenFiles <= 0;
+}
+
+MCPProcessUsage &MCPProcessUsage::operator+=(const MCPProcessUsage &other)
+{
+    cpuTimeMs += other.cpuTimeMs;
+    residentMemoryBytes += other.residentMemoryBytes;
+    peakResidentMemoryBytes += other.peakResidentMemoryBytes;
+    processCount += other.processCount;
+    cgroupCount += other.cgroupCount;
+    if (limitsError.isEmpty())
+        limitsError = other.limitsError;
+    return *this;
+}
+
+namespace
+{
+    // 在 fork 之后、exec 之前为子进程设置资源限制
+    class LimitedProcess : public QProcess
+    {
+    public:
+        explicit LimitedProcess(const MCPProcessLimits &limits)
+            : m_limits(limits)
+        {
+        }
+        // cgroup 不可用时使用 RLIMIT_AS 限制内存
+        void setAddressSpaceLimitEnabled(bool enabled)
+        {
+            m_isAddressSpaceLimitEnabled = enabled;
+        }
+        // 子进程在 exec 之前加入的cgroup(cgroup.procs 的路径)，为空代表不使用cgroup
+        void setCgroupProcsPath(const QString &path)
+        {
+            m_cgroupProcsPath = path.toLocal8Bit();
+        }
+
+    protected:
+#if defined(Q_OS_LINUX)
+        // 运行在子进程中，只能调用异步信号安全的函数
+        void setupChildProcess() override
+        {
+            // 向 cgroup.procs 写入 0 代表移动写入的进程，exec 之后服务器及其子进程都受限制
+            if (!m_cgroupProcsPath.isEmpty())
+            {
+                int fd = open(m_cgroupProcsPath.constData(), O_WRONLY | O_CLOEXEC);
+                if (fd >= 0)
+                {
+                    ssize_t written = write(fd, "0", 1);
+                    Q_UNUSED(written);
+                    close(fd);
+                }
+            }
+            if (m_limits.niceValue > 0)
+                setpriority(PRIO_PROCESS, 0, qMin(m_limits.niceValue, 19));
+            if (m_limits.ioPriorityClass == 2 || m_limits.ioPriorityClass == 3)
+            {
+                // IOPRIO_WHO_PROCESS = 1, IOPRIO_CLASS_SHIFT = 13；best-effort 使用最低级别 7
+                int ioPriorityData = m_limits.ioPriorityClass == 3 ? 0 : 7;
+                syscall(SYS_ioprio_set, 1, 0, (m_limits.ioPriorityClass << 13) | ioPriorityData);
+            }
+            if (m_limits.maxOpenFiles > 0)
+                lowerLimit(RLIMIT_NOFILE, static_cast<rlim_t>(m_limits.maxOpenFiles));
+            if (m_isAddressSpaceLimitEnabled && m_limits.memoryLimitMB > 0)
+                lowerLimit(RLIMIT_AS, static_cast<rlim_t>(m_limits.memoryLimitMB) * 1024 * 1024);
+        }
+
+    private:
+        // 只能降低限制，非特权进程无法提高硬限制
+        static void lowerLimit(int resource, rlim_t value)
+        {
+            struct rlimit limit;
+            if (getrlimit(resource, &limit) != 0)
+                return;
+            if (limit.rlim_max != RLIM_INFINITY && value > limit.rlim_max)
+                value = limit.rlim_max;
+            limit.rlim_cur = value;
+            limit.rlim_max = value;
+            setrlimit(resource, &limit);
+        }
+#endif
+
+    private:
+        MCPProcessLimits m_limits;
+        bool m_isAddressSpaceLimitEnabled = false;
+        QByteArray m_cgroupProcsPath;
+    };
+
+#if defined(Q_OS_LINUX)
+    // 当前进程所在的cgroup v2目录，不可用时返回空
+    QString currentCgroupDirectory()
+    {
+        QFile file("/proc/self/cgroup");
+        if (!file.open(QIODevice::ReadOnly))
+            return QString();
+        for (const QByteArray &line : file.readAll().split('\n'))
+        {
+            // cgroup v2: "0::/user.slice/..."
+            if (line.startsWith("0::"))
+                return QString("/sys/fs/cgroup") + QString::fromUtf8(line.mid(3).trimmed());
+        }
+        return QString();
+    }
+
+    QByteArray readFile(const QString &path)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+            return QByteArray();
+        return file.readAll();
+    }
+
+    bool writeFile(const QString &path, const QByteArray &data)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+        return file.write(data) == data.size() && file.flush();
+    }
+
+    // 为服务器进程委派的cgroup子树，进程内只初始化一次
+    struct CgroupDelegation
+    {
+        QString directory;              // 服务器进程的cgroup在此目录下创建，为空代表不可用
+        QList<QByteArray> controllers;  // 已为子cgroup启用的控制器
+        QString errorMessage;           // 不可用的原因
+    };
+
+    // cgroup v2 中启用了控制器的cgroup不能直接包含进程，先把本进程移入叶子节点 xlc-assistant，再为当前cgroup启用控制器
+    CgroupDelegation delegateCgroup()
+    {
+        CgroupDelegation delegation;
+        QString cgroupDirectory = currentCgroupDirectory();
+        if (cgroupDirectory.isEmpty() || !QFileInfo::exists(cgroupDirectory + "/cgroup.controllers"))
+        {
+            delegation.errorMessage = "cgroup v2 不可用";
+            return delegation;
+        }
+        QList<QByteArray> available = readFile(cgroupDirectory + "/cgroup.controllers").trimmed().split(' ');
+        QList<QByteArray> controllers;
+        for (const QByteArray &controller : {QByteArray("cpu"), QByteArray("memory")})
+        {
+            if (available.contains(controller))
+                controllers << controller;
+        }
+        if (controllers.isEmpty())
+        {
+            delegation.errorMessage = QString("cgroup %1 未委派 cpu/memory 控制器").arg(cgroupDirectory);
+            return delegation;
+        }
+        if (!QFileInfo(cgroupDirectory).isWritable() || !QFileInfo(cgroupDirectory + "/cgroup.subtree_control").isWritable())
+        {
+            delegation.errorMessage = QString("cgroup %1 不可写").arg(cgroupDirectory);
+            return delegation;
+        }
+        QList<QByteArray> enabled = readFile(cgroupDirectory + "/cgroup.subtree_control").trimmed().split(' ');
+        bool isEnabled = true;
+        for (const QByteArray &controller : controllers)
+            isEnabled &= enabled.contains(controller);
+        if (!isEnabled)
+        {
+            // 当前cgroup中还有其他进程时无法启用控制器(EBUSY)
+            QString leafDirectory = cgroupDirectory + "/xlc-assistant";
+            QDir().mkdir(leafDirectory);
+            QByteArray subtreeControl;
+            for (const QByteArray &controller : controllers)
+                subtreeControl.append(subtreeControl.isEmpty() ? "+" : " +").append(controller);
+            if (!writeFile(leafDirectory + "/cgroup.procs", QByteArray::number(QCoreApplication::applicationPid())) ||
+                !writeFile(cgroupDirectory + "/cgroup.subtree_control", subtreeControl))
+            {
+                delegation.errorMessage = QString("无法为 cgroup %1 启用 %2 控制器(cgroup 中可能还有其他进程)").arg(cgroupDirectory).arg(QString::fromUtf8(subtreeControl));
+                return delegation;
+            }
+            XLC_LOG_INFO("Delegated cgroup subtree for MCP servers (cgroup={}, controllers={})", cgroupDirectory, QString::fromUtf8(subtreeControl));
+        }
+        delegation.directory = cgroupDirectory;
+        delegation.controllers = controllers;
+        return delegation;
+    }
+
+    const CgroupDelegation &cgroupDelegation()
+    {
+        static const CgroupDelegation delegation = delegateCgroup();
+        return delegation;
+    }
+#endif
+} // namespace
+
+MCPStdioClient::MCPStdioClient(const QString &command,
+                               const QVector<QString> &args,
+                               const QMap<QString, QString> &envVars,
+                               const MCPProcessLimits &limits,
+                               QObject *parent)
+    : MCPAsyncClient(parent), m_process(new LimitedProcess(limits)), m_command(command), m_limits(limits)
+{
+    m_process->setProgram(command);
+    m_process->setArguments(QStringList(args.begin(), args.end()));
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    for (auto it = envVars.constBegin(); it != envVars.constEnd(); ++it)
+        environment.insert(it.key(), it.value());
+    m_process->setProcessEnvironment(environment);
+
+    connect(m_process, &QProcess::started, this,
+            [this]()
+            {
+                XLC_LOG_DEBUG("MCP server process started (command={}, pid={})", m_command, m_process->processId());
+                checkCgroupMembership();
+                for (const QByteArray &data : m_pendingWrites)
+                    m_process->write(data);
+                m_pendingWrites.clear();
+            });
+    connect(m_process, &QProcess::readyReadStandardOutput, this, &MCPStdioClient::handleReadyReadStandardOutput);
+    connect(m_process, &QProcess::readyReadStandardError, this, &MCPStdioClient::handleReadyReadStandardError);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this](int exitCode, QProcess::ExitStatus exitStatus)
+            {
+                handleProcessExited(QString("MCP server process exited (command=%1, exitCode=%2, crashed=%3)")
+                                        .arg(m_command)
+                                        .arg(exitCode)
+                                        .arg(exitStatus == QProcess::CrashExit));
+            });
+    connect(m_process, &QProcess::errorOccurred, this,
+            [this](QProcess::ProcessError error)
+            {
+                // 进程运行期间的读写错误会伴随 finished，只处理启动失败
+                if (error == QProcess::FailedToStart)
+                    handleProcessExited(QString("MCP server process failed to start (command=%1): %2").arg(m_command).arg(m_process->errorString()));
+            });
+}
+
+MCPStdioClient::~MCPStdioClient()
+{
+    disconnect(m_process, nullptr, this, nullptr);
+    failAllRequests("MCP client closed");
+    if (m_process->state() == QProcess::NotRunning)
+    {
+        removeCgroup();
+        delete m_process;
+        return;
+    }
+    // 关闭标准输入通知服务器退出，超时后依次 terminate、kill；进程对象在退出后自行释放，析构不阻塞主线程
+    QProcess *process = m_process;
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), process, &QObject::deleteLater);
+#if defined(Q_OS_LINUX)
+    if (!m_cgroupPath.isEmpty())
+    {
+        // 进程退出后删除cgroup
+        QString cgroupPath = m_cgroupPath;
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), process,
+                [cgroupPath]()
+                {
+                    QDir().rmdir(cgroupPath);
+                });
+    }
+#endif
+    process->closeWriteChannel();
+    const int shutdownTimeoutMs = SHUTDOWN_TIMEOUT_MS;
+    QTimer::singleShot(shutdownTimeoutMs, process,
+                       [process, shutdownTimeoutMs]()
+                       {
+                           process->terminate();
+                           QTimer::singleShot(shutdownTimeoutMs, process,
+                                              [process]()
+                                              {
+                                                  process->kill();
+                                              });
+                       });
+}
+
+void MCPStdioClient::start()
+{
+#if defined(Q_OS_LINUX)
+    // 启动前创建cgroup并写入限制，子进程在 exec 之前加入
+    m_limitsError.clear();
+    if (m_limits.cpuQuotaPercent > 0 || m_limits.memoryLimitMB > 0)
+    {
+        m_cgroupPath = setupCgroup(m_limitsError);
+        if (m_cgroupPath.isEmpty())
+        {
+            // 内存上限退回 RLIMIT_AS(限制的是虚拟地址空间)，CPU配额无法替代
+            if (m_limits.cpuQuotaPercent > 0)
+                m_limitsError = QString("CPU配额未生效: %1").arg(m_limitsError);
+            else
+                m_limitsError = QString("内存上限改用 RLIMIT_AS: %1").arg(m_limitsError);
+            XLC_LOG_WARN("Apply cgroup limits failed, falling back to rlimits (command={}): {}", m_command, m_limitsError);
+        }
+    }
+    static_cast<LimitedProcess *>(m_process)->setCgroupProcsPath(m_cgroupPath.isEmpty() ? QString() : m_cgroupPath + "/cgroup.procs");
+    static_cast<LimitedProcess *>(m_process)->setAddressSpaceLimitEnabled(m_cgroupPath.isEmpty());
+#else
+    if (m_limits.cpuQuotaPercent > 0 || m_limits.memoryLimitMB > 0)
+        m_limitsError = "CPU配额与内存上限仅Linux生效";
+    if (!m_limits.isEmpty())
+        XLC_LOG_DEBUG("Process resource limits are only supported on Linux (command={})", m_command);
+#endif
+    m_isConnected = true;
+    XLC_LOG_DEBUG("Starting MCP server process (command={}, args={})", m_command, m_process->arguments().join(' '));
+    m_process->start(QIODevice::ReadWrite);
+}
+
+bool MCPStdioClient::isConnected() const
+{
+    return m_isConnected;
+}
+
+qint64 MCPStdioClient::processId() const
+{
+    return m_process->processId();
+}
+
+qint64 MCPStdioClient::getResidentMemoryBytes() const
+{
+    MCPProcessUsage usage = getResourceUsage();
+    if (usage.processCount == 0 || usage.residentMemoryBytes <= 0)
+        return -1;
+    return usage.residentMemoryBytes;
+}
+
+MCPProcessUsage MCPStdioClient::getResourceUsage() const
+{
+    MCPProcessUsage usage;
+    qint64 pid = m_process->processId();
+    if (pid <= 0)
+        return usage;
+    usage.processCount = 1;
+    usage.limitsError = m_limitsError;
+#if defined(Q_OS_WIN)
+    HANDLE handle = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+    if (!handle)
+        return usage;
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (GetProcessTimes(handle, &creationTime, &exitTime, &kernelTime, &userTime))
+    {
+        // FILETIME 单位为 100ns
+        auto toMs = [](const FILETIME &fileTime)
+        {
+            return static_cast<qint64>((static_cast<quint64>(fileTime.dwHighDateTime) << 32 | fileTime.dwLowDateTime) / 10000);
+        };
+        usage.cpuTimeMs = toMs(kernelTime) + toMs(userTime);
+    }
+    PROCESS_MEMORY_COUNTERS counters;
+    if (K32GetProcessMemoryInfo(handle, &counters, sizeof(counters)))
+    {
+        usage.residentMemoryBytes = static_cast<qint64>(counters.WorkingSetSize);
+        usage.peakResidentMemoryBytes = static_cast<qint64>(counters.PeakWorkingSetSize);
+    }
+    CloseHandle(handle);
+#elif defined(Q_OS_LINUX)
+    // 使用cgroup时统计包括子进程(npx、uvx 启动的实际服务器)
+    if (!m_cgroupPath.isEmpty())
+    {
+        for (const QByteArray &line : readFile(m_cgroupPath + "/cpu.stat").split('\n'))
+        {
+            if (line.startsWith("usage_usec "))
+                usage.cpuTimeMs = line.mid(11).trimmed().toLongLong() / 1000;
+        }
+        usage.residentMemoryBytes = readFile(m_cgroupPath + "/memory.current").trimmed().toLongLong();
+        // memory.peak 需要 Linux 5.19 以上
+        usage.peakResidentMemoryBytes = qMax(usage.residentMemoryBytes, readFile(m_cgroupPath + "/memory.peak").trimmed().toLongLong());
+        usage.cgroupCount = 1;
+        return usage;
+    }
+    // /proc/<pid>/stat 中进程名可能包含空格，从最后一个 ')' 之后解析: state(3) ... utime(14) stime(15)
+    QByteArray stat = readFile(QString("/proc/%1/stat").arg(pid));
+    QList<QByteArray> fields = stat.mid(stat.lastIndexOf(')') + 2).split(' ');
+    if (fields.size() > 12)
+    {
+        long clockTicks = sysconf(_SC_CLK_TCK);
+        if (clockTicks > 0)
+            usage.cpuTimeMs = (fields[11].toLongLong() + fields[12].toLongLong()) * 1000 / clockTicks;
+    }
+    // VmRSS:     12345 kB
+    for (const QByteArray &line : readFile(QString("/proc/%1/status").arg(pid)).split('\n'))
+    {
+        if (line.startsWith("VmRSS:"))
+            usage.residentMemoryBytes = line.mid(6).trimmed().split(' ').first().toLongLong() * 1024;
+        else if (line.startsWith("VmHWM:"))
+            usage.peakResidentMemoryBytes = line.mid(6).trimmed().split(' ').first().toLongLong() * 1024;
+    }
+#endif
+    return usage;
+}
+
+void MCPStdioClient::writeMessage(const QJsonObject &message, qint64 requestId)
+{
+    if (!m_isConnected)
+    {
+        if (requestId >= 0)
+            failRequest(requestId, "MCP server process is not running");
+        return;
+    }
+    QByteArray data = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    data.append('\n');
+    if (m_process->state() == QProcess::Running)
+        m_process->write(data);
+    else
+        m_pendingWrites.append(data);
+}
+
+void MCPStdioClient::handleReadyReadStandardOutput()
+{
+    m_buffer.append(m_process->readAllStandardOutput());
+    // 只在新读取的数据中查找换行，单行的大响应分多次到达时不会重复扫描
+    int lineStart = 0;
+    int searchFrom = m_bufferScannedBytes;
+    while (true)
+    {
+        int lineEnd = m_buffer.indexOf('\n', searchFrom);
+        if (lineEnd < 0)
+            break;
+        QByteArray line = m_buffer.mid(lineStart, lineEnd - lineStart).trimmed();
+        lineStart = lineEnd + 1;
+        searchFrom = lineStart;
+        if (!line.isEmpty())
+            parseLine(line);
+    }
+    if (lineStart > 0)
+        m_buffer.remove(0, lineStart);
+    m_bufferScannedBytes = m_buffer.size();
+}
+
+void MCPStdioClient::handleReadyReadStandardError()
+{
+    // 服务器日志输出到标准错误
+    m_bufferStandardError.append(m_process->readAllStandardError());
+    int lineEnd;
+    while ((lineEnd = m_bufferStandardError.indexOf('\n')) >= 0)
+    {
+        QByteArray line = m_bufferStandardError.left(lineEnd).trimmed();
+        m_bufferStandardError.remove(0, lineEnd + 1);
+        if (!line.isEmpty())
+            XLC_LOG_DEBUG("MCP server stderr (command={}): {}", m_command, QString::fromUtf8(line));
+    }
+}
+
+void MCPStdioClient::handleProcessExited(const QString &errorMessage)
+{
+    if (!m_isConnected)
+        return;
+    m_isConnected = false;
+    m_pendingWrites.clear();
+    removeCgroup();
+    XLC_LOG_WARN("{}", errorMessage);
+    failAllRequests(errorMessage);
+    Q_EMIT sig_disconnected(errorMessage);
+}
+
+void MCPStdioClient::parseLine(const QByteArray &line)
+{
+    QJsonParseError parseError;
+    QJsonDocument jsonDocument = QJsonDocument::fromJson(line, &parseError);
+    if (parseError.error != QJsonParseError::NoError)
+    {
+        // 部分服务器会向标准输出打印非协议内容
+        XLC_LOG_DEBUG("Dropped non JSON-RPC output (command={}): {}", m_command, QString::fromUtf8(line));
+        return;
+    }
+    if (jsonDocument.isArray())
+    {
+        for (const QJsonValue &jsonValueMessage : jsonDocument.array())
+            handleMessage(jsonValueMessage.toObject());
+    }
+    else
+    {
+        handleMessage(jsonDocument.object());
+    }
+}
+
+QString MCPStdioClient::setupCgroup(QString &errorMessage)
+{
+#if defined(Q_OS_LINUX)
+    const CgroupDelegation &delegation = cgroupDelegation();
+    if (delegation.directory.isEmpty())
+    {
+        errorMessage = delegation.errorMessage;
+        return QString();
+    }
+    if ((m_limits.cpuQuotaPercent > 0 && !delegation.controllers.contains("cpu")) ||
+        (m_limits.memoryLimitMB > 0 && !delegation.controllers.contains("memory")))
+    {
+        errorMessage = QString("cgroup %1 未委派所需的控制器").arg(delegation.directory);
+        return QString();
+    }
+    static int cgroupSerial = 0;
+    QString cgroupPath = QString("%1/xlc-mcp-%2-%3").arg(delegation.directory).arg(QCoreApplication::applicationPid()).arg(++cgroupSerial);
+    if (!QDir().mkdir(cgroupPath))
+    {
+        errorMessage = QString("创建 cgroup %1 失败").arg(cgroupPath);
+        return QString();
+    }
+    bool success = true;
+    // cpu.max: "$MAX $PERIOD"，配额按百分比换算
+    if (m_limits.cpuQuotaPercent > 0)
+        success &= writeFile(cgroupPath + "/cpu.max", QString("%1 100000").arg(static_cast<qint64>(m_limits.cpuQuotaPercent) * 1000).toUtf8());
+    if (m_limits.memoryLimitMB > 0)
+        success &= writeFile(cgroupPath + "/memory.max", QByteArray::number(static_cast<qint64>(m_limits.memoryLimitMB) * 1024 * 1024));
+    if (!success)
+    {
+        errorMessage = QString("写入 cgroup %1 的限制失败").arg(cgroupPath);
+        QDir().rmdir(cgroupPath);
+        return QString();
+    }
+    XLC_LOG_DEBUG("Created cgroup for MCP server process (command={}, cgroup={}, cpuQuotaPercent={}, memoryLimitMB={})",
+                  m_command, cgroupPath, m_limits.cpuQuotaPercent, m_limits.memoryLimitMB);
+    return cgroupPath;
+#else
+    Q_UNUSED(errorMessage);
+    return QString();
+#endif
+}
+
+void MCPStdioClient::checkCgroupMembership()
+{
+#if defined(Q_OS_LINUX)
+    if (m_cgroupPath.isEmpty())
+        return;
+    // 子进程中加入cgroup失败时无法报告，启动后检查进程是否在cgroup中
+    QList<QByteArray> pids = readFile(m_cgroupPath + "/cgroup.procs").split('\n');
+    if (pids.contains(QByteArray::number(m_process->processId())))
+        return;
+    m_limitsError = QString("进程未能加入 cgroup %1，CPU配额与内存上限未生效").arg(m_cgroupPath);
+    XLC_LOG_WARN("MCP server process is not in its cgroup (command={}, pid={}, cgroup={})", m_command, m_process->processId(), m_cgroupPath);
+    removeCgroup();
+#endif
+}
+
+void MCPStdioClient::removeCgroup()
+{
+#if defined(Q_OS_LINUX)
+    if (m_cgroupPath.isEmpty())
+        return;
+    // cgroup中仍有进程时删除失败，由析构时的退出回调再次尝试
+    if (QDir().rmdir(m_cgroupPath))
+        m_cgroupPath.clear();
+#endif
+}
@@ -0,0 +1,371 @@
+#include "MCPStreamableHttpClient.h"
+#include <QJsonDocument>
+#include "Logger.hpp"
+
+MCPStreamableHttpClient::MCPStreamableHttpClient(QNetworkAccessManager *networkAccessManager,
+                                                 const QUrl &url,
+                                                 const QMap<QByteArray, QByteArray> &requestHeaders,
+                                                 QObject *parent)
+    : MCPAsyncClient(parent), m_networkAccessManager(networkAccessManager), m_url(url), m_requestHeaders(requestHeaders)
+{
+}
+
+MCPStreamableHttpClient::~MCPStreamableHttpClient()
+{
+    // 断开所有响应，避免析构后回调
+    for (auto it = m_streams.begin(); it != m_streams.end(); ++it)
+    {
+        QNetworkReply *reply = it.key();
+        disconnect(reply, nullptr, this, nullptr);
+        reply->abort();
+        reply->deleteLater();
+    }
+    m_streams.clear();
+    failAllRequests("MCP client closed");
+
+    // 通知服务器结束会话
+    if (!m_sessionId.isEmpty() && m_isConnected)
+    {
+        QNetworkReply *reply = m_networkAccessManager->deleteResource(buildRequest());
+        connect(reply, &QNetworkReply::finished, reply, &QObject::deleteLater);
+    }
+}
+
+bool MCPStreamableHttpClient::isConnected() const
+{
+    return m_isConnected;
+}
+
+bool MCPStreamableHttpClient::hasNotificationChannel() const
+{
+    return m_isConnected && m_hasNotificationChannel;
+}
+
+QMap<QByteArray, QByteArray> MCPStreamableHttpClient::parseRequestHeaders(const QString &requestHeaders)
+{
+    QMap<QByteArray, QByteArray> headers;
+    QStringList lines = requestHeaders.split('\n', Qt::SkipEmptyParts);
+    for (const QString &line : lines)
+    {
+        int idx = line.indexOf('=');
+        if (idx <= 0)
+            continue;
+        QString key = line.left(idx).trimmed();
+        QString value = line.mid(idx + 1).trimmed();
+        if (!key.isEmpty())
+            headers.insert(key.toUtf8(), value.toUtf8());
+    }
+    return headers;
+}
+
+QNetworkRequest MCPStreamableHttpClient::buildRequest() const
+{
+    QNetworkRequest request(m_url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    request.setRawHeader("Accept", "application/json, text/event-stream");
+    // https 服务器支持时通过 ALPN 使用HTTP/2，多个并发请求复用同一个连接；明文 http 不生效
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    for (auto it = m_requestHeaders.constBegin(); it != m_requestHeaders.constEnd(); ++it)
+        request.setRawHeader(it.key(), it.value());
+    if (!m_sessionId.isEmpty())
+        request.setRawHeader("Mcp-Session-Id", m_sessionId);
+    if (!getProtocolVersion().isEmpty())
+        request.setRawHeader("MCP-Protocol-Version", getProtocolVersion().toUtf8());
+    return request;
+}
+
+void MCPStreamableHttpClient::writeMessage(const QJsonObject &message, qint64 requestId)
+{
+    if (!m_isConnected)
+    {
+        if (requestId >= 0)
+            failRequest(requestId, "MCP session is closed");
+        return;
+    }
+    QByteArray body = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    QNetworkReply *reply = m_networkAccessManager->post(buildRequest(), body);
+    std::shared_ptr<Stream> stream = std::make_shared<Stream>();
+    if (requestId >= 0)
+        stream->requestIds.insert(requestId);
+    trackReply(reply, stream);
+}
+
+void MCPStreamableHttpClient::abortRequest(qint64 requestId)
+{
+    for (auto it = m_streams.begin(); it != m_streams.end(); ++it)
+    {
+        if (!it.value()->requestIds.remove(requestId))
+            continue;
+        // 该响应只服务于被取消的请求，直接中止
+        if (it.value()->requestIds.isEmpty())
+            it.key()->abort();
+        return;
+    }
+}
+
+void MCPStreamableHttpClient::handleInitialized()
+{
+    openNotificationStream();
+}
+
+void MCPStreamableHttpClient::trackReply(QNetworkReply *reply, std::shared_ptr<Stream> stream)
+{
+    m_streams.insert(reply, stream);
+    connect(reply, &QNetworkReply::readyRead, this,
+            [this, reply]()
+            {
+                handleReadyRead(reply);
+            });
+    connect(reply, &QNetworkReply::finished, this,
+            [this, reply]()
+            {
+                handleFinished(reply);
+            });
+}
+
+void MCPStreamableHttpClient::handleReadyRead(QNetworkReply *reply)
+{
+    std::shared_ptr<Stream> stream = m_streams.value(reply);
+    if (!stream)
+        return;
+    // 捕获会话id
+    if (m_sessionId.isEmpty() && reply->hasRawHeader("Mcp-Session-Id"))
+        m_sessionId = reply->rawHeader("Mcp-Session-Id");
+    stream->isEventStream = reply->header(QNetworkRequest::ContentTypeHeader).toString().startsWith("text/event-stream");
+    stream->buffer.append(reply->readAll());
+    // SSE流边收边解析，JSON等待响应结束后解析
+    if (stream->isEventStream)
+        parseEventStream(*stream);
+}
+
+void MCPStreamableHttpClient::handleFinished(QNetworkReply *reply)
+{
+    reply->deleteLater();
+    std::shared_ptr<Stream> streamPtr = m_streams.take(reply);
+    if (!streamPtr)
+        return;
+    Stream &stream = *streamPtr;
+    if (m_sessionId.isEmpty() && reply->hasRawHeader("Mcp-Session-Id"))
+        m_sessionId = reply->rawHeader("Mcp-Session-Id");
+    stream.isEventStream = reply->header(QNetworkRequest::ContentTypeHeader).toString().startsWith("text/event-stream");
+    stream.buffer.append(reply->readAll());
+
+    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    QNetworkReply::NetworkError error = reply->error();
+    if (stream.isNotification)
+    {
+        handleNotificationStreamFinished(stream, statusCode, error);
+        return;
+    }
+    if (error == QNetworkReply::OperationCanceledError && stream.requestIds.isEmpty())
+        return; // 请求已取消
+
+    // 会话过期，需要重新初始化
+    if (statusCode == 404 && !m_sessionId.isEmpty())
+    {
+        disconnectSession(QString("MCP session expired (sessionId=%1)").arg(QString::fromUtf8(m_sessionId)));
+        return;
+    }
+
+    if (stream.isEventStream)
+    {
+        // 处理剩余的完整事件
+        parseEventStream(stream);
+    }
+    else if (error == QNetworkReply::NoError && !stream.buffer.trimmed().isEmpty())
+    {
+        dispatchPayload(stream, stream.buffer);
+        stream.buffer.clear();
+    }
+
+    if (stream.requestIds.isEmpty())
+        return;
+
+    // 流在返回响应前中断，尝试通过 Last-Event-ID 恢复
+    if (stream.isEventStream && !stream.lastEventId.isEmpty() && stream.resumeAttempts < MAX_RESUME_ATTEMPTS &&
+        !(stream.isResume && statusCode == 405))
+    {
+        resumeStream(stream);
+        return;
+    }
+
+    QString errorMessage;
+    if (error != QNetworkReply::NoError)
+        errorMessage = QString("HTTP request failed (status=%1): %2").arg(statusCode).arg(reply->errorString());
+    else
+        errorMessage = QString("HTTP response ended before the MCP response was received (status=%1)").arg(statusCode);
+    XLC_LOG_WARN("{} (url={})", errorMessage, m_url.toString());
+    for (qint64 requestId : stream.requestIds)
+        failRequest(requestId, errorMessage);
+}
+
+void MCPStreamableHttpClient::parseEventStream(Stream &stream)
+{
+    int lineStart = 0;
+    while (true)
+    {
+        int lineEnd = stream.buffer.indexOf('\n', lineStart);
+        if (lineEnd < 0)
+            break;
+        QByteArray line = stream.buffer.mid(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+        if (line.endsWith('\r'))
+            line.chop(1);
+
+        // 空行代表事件结束
+        if (line.isEmpty())
+        {
+            if (!stream.eventId.isEmpty())
+                stream.lastEventId = stream.eventId;
+            if (!stream.eventData.isEmpty())
+                dispatchPayload(stream, stream.eventData);
+            stream.eventId.clear();
+            stream.eventData.clear();
+            continue;
+        }
+        if (line.startsWith(':'))
+            continue; // 注释(心跳)
+
+        int colon = line.indexOf(':');
+        QByteArray field = colon < 0 ? line : line.left(colon);
+        QByteArray value = colon < 0 ? QByteArray() : line.mid(colon + 1);
+        if (value.startsWith(' '))
+            value.remove(0, 1);
+        if (field == "data")
+        {
+            if (!stream.eventData.isEmpty())
+                stream.eventData.append('\n');
+            stream.eventData.append(value);
+        }
+        else if (field == "id")
+        {
+            stream.eventId = QString::fromUtf8(value);
+        }
+    }
+    stream.buffer.remove(0, lineStart);
+}
+
+void MCPStreamableHttpClient::dispatchPayload(Stream &stream, const QByteArray &payload)
+{
+    QJsonParseError parseError;
+    QJsonDocument jsonDocument = QJsonDocument::fromJson(payload, &parseError);
+    if (parseError.error != QJsonParseError::NoError)
+    {
+        XLC_LOG_WARN("Parse MCP message failed (url={}): {}", m_url.toString(), parseError.errorString());
+        return;
+    }
+    QJsonArray jsonArrayMessages;
+    if (jsonDocument.isArray())
+        jsonArrayMessages = jsonDocument.array();
+    else
+        jsonArrayMessages.append(jsonDocument.object());
+    for (const QJsonValue &jsonValueMessage : jsonArrayMessages)
+    {
+        QJsonObject message = jsonValueMessage.toObject();
+        if (message.contains("id") && (message.contains("result") || message.contains("error")))
+            stream.requestIds.remove(static_cast<qint64>(message.value("id").toDouble(-1)));
+        handleMessage(message);
+    }
+}
+
+void MCPStreamableHttpClient::resumeStream(const Stream &stream)
+{
+    XLC_LOG_DEBUG("Resuming MCP event stream (url={}, lastEventId={}, attempt={})", m_url.toString(), stream.lastEventId, stream.resumeAttempts + 1);
+    QNetworkRequest request = buildRequest();
+    request.setRawHeader("Accept", "text/event-stream");
+    request.setRawHeader("Last-Event-ID", stream.lastEventId.toUtf8());
+    QNetworkReply *reply = m_networkAccessManager->get(request);
+    std::shared_ptr<Stream> resumedStream = std::make_shared<Stream>();
+    resumedStream->isEventStream = true;
+    resumedStream->isResume = true;
+    resumedStream->requestIds = stream.requestIds;
+    resumedStream->lastEventId = stream.lastEventId;
+    resumedStream->resumeAttempts = stream.resumeAttempts + 1;
+    trackReply(reply, resumedStream);
+}
+
+void MCPStreamableHttpClient::openNotificationStream()
+{
+    if (!m_isConnected || m_notificationReply)
+        return;
+    QNetworkRequest request = buildRequest();
+    request.setRawHeader("Accept", "text/event-stream");
+    if (!m_notificationLastEventId.isEmpty())
+        request.setRawHeader("Last-Event-ID", m_notificationLastEventId.toUtf8());
+    QNetworkReply *reply = m_networkAccessManager->get(request);
+    std::shared_ptr<Stream> stream = std::make_shared<Stream>();
+    stream->isEventStream = true;
+    stream->isNotification = true;
+    stream->lastEventId = m_notificationLastEventId;
+    m_notificationReply = reply;
+    trackReply(reply, stream);
+    // 服务器可能很久才发送第一个事件，收到响应头即认为通知流已建立
+    connect(reply, &QNetworkReply::metaDataChanged, this,
+            [this, reply]()
+            {
+                if (reply != m_notificationReply)
+                    return;
+                int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+                if (statusCode == 200 && reply->header(QNetworkRequest::ContentTypeHeader).toString().startsWith("text/event-stream"))
+                {
+                    m_notificationRetries = 0;
+                    setNotificationChannel(true);
+                }
+            });
+}
+
+void MCPStreamableHttpClient::handleNotificationStreamFinished(Stream &stream, int statusCode, QNetworkReply::NetworkError error)
+{
+    m_notificationReply = nullptr;
+    if (stream.isEventStream)
+        parseEventStream(stream);
+    m_notificationLastEventId = stream.lastEventId;
+    setNotificationChannel(false);
+    if (!m_isConnected || error == QNetworkReply::OperationCanceledError)
+        return;
+    if (statusCode == 404 && !m_sessionId.isEmpty())
+    {
+        disconnectSession(QString("MCP session expired (sessionId=%1)").arg(QString::fromUtf8(m_sessionId)));
+        return;
+    }
+    // 服务器不提供独立的通知流，只能在请求的响应流中收到通知
+    if (statusCode == 405)
+    {
+        XLC_LOG_DEBUG("MCP server does not offer a notification stream (url={})", m_url.toString());
+        return;
+    }
+    if (m_notificationRetries >= MAX_NOTIFICATION_STREAM_RETRIES)
+    {
+        XLC_LOG_WARN("MCP notification stream closed, giving up (url={}, status={}, retries={})", m_url.toString(), statusCode, m_notificationRetries);
+        return;
+    }
+    m_notificationRetries += 1;
+    XLC_LOG_DEBUG("MCP notification stream closed, reopening (url={}, status={}, retry={})", m_url.toString(), statusCode, m_notificationRetries);
+    QTimer::singleShot(NOTIFICATION_STREAM_RETRY_MS, this,
+                       [this]()
+                       {
+                           openNotificationStream();
+                       });
+}
+
+void MCPStreamableHttpClient::setNotificationChannel(bool available)
+{
+    if (m_hasNotificationChannel == available)
+        return;
+    m_hasNotificationChannel = available;
+    XLC_LOG_DEBUG("MCP notification stream {} (url={})", available ? "opened" : "closed", m_url.toString());
+    Q_EMIT sig_notificationChannelChanged(available);
+}
+
+void MCPStreamableHttpClient::disconnectSession(const QString &errorMessage)
+{
+    if (!m_isConnected)
+        return;
+    m_isConnected = false;
+    if (m_notificationReply)
+        m_notificationReply->abort();
+    XLC_LOG_WARN("{} (url={})", errorMessage, m_url.toString());
+    failAllRequests(errorMessage);
+    Q_EMIT sig_disconnected(errorMessage);
+}
@@ -0,0 +1,101 @@
+#include "MCPToolResultCache.h"
+#include <QJsonDocument>
+#include "Logger.hpp"
+
+double MCPToolCacheStats::hitRate() const
+{
+    qint64 total = hits + misses;
+    if (total == 0)
+        return 0.0;
+    return static_cast<double>(hits) / static_cast<double>(total);
+}
+
+MCPToolCacheStats &MCPToolCacheStats::operator+=(const MCPToolCacheStats &other)
+{
+    hits += other.hits;
+    misses += other.misses;
+    timeSavedMs += other.timeSavedMs;
+    return *this;
+}
+
+MCPToolResultCache::MCPToolResultCache(int maxCostBytes)
+    : m_cache(maxCostBytes)
+{
+}
+
+QString MCPToolResultCache::buildKey(const QString &serverUuid, const QString &toolName, const QJsonObject &arguments)
+{
+    return QString("%1\n%2\n%3").arg(serverUuid, toolName, QString::fromUtf8(QJsonDocument(arguments).toJson(QJsonDocument::Compact)));
+}
+
+bool MCPToolResultCache::lookup(const QString &key, const QString &toolId, QJsonObject &jsonObjResult)
+{
+    QMutexLocker locker(&m_mutex);
+    MCPToolCacheStats &stats = m_stats[toolId];
+    m_toolServers.insert(toolId, key.section('\n', 0, 0));
+    Entry *entry = m_cache.object(key);
+    if (entry && entry->insertedTimer.elapsed() >= entry->ttlMs)
+    {
+        m_cache.remove(key);
+        entry = nullptr;
+    }
+    if (!entry)
+    {
+        stats.misses += 1;
+        return false;
+    }
+    stats.hits += 1;
+    stats.timeSavedMs += entry->elapsedMs;
+    jsonObjResult = entry->jsonObjResult;
+    XLC_LOG_DEBUG("Tool result cache hit (tool={}, hitRate={:.2f}, timeSavedMs={})", toolId, stats.hitRate(), stats.timeSavedMs);
+    return true;
+}
+
+void MCPToolResultCache::insert(const QString &key, const QString &toolId, const QJsonObject &jsonObjResult, qint64 elapsedMs, int ttlSeconds)
+{
+    if (ttlSeconds <= 0)
+        return;
+    // 按序列化后的大小计算占用
+    int cost = QJsonDocument(jsonObjResult).toJson(QJsonDocument::Compact).size() + key.size() * 2;
+    QMutexLocker locker(&m_mutex);
+    if (cost > m_cache.maxCost())
+    {
+        XLC_LOG_DEBUG("Tool result too large to cache (tool={}, bytes={}, maxCost={})", toolId, cost, m_cache.maxCost());
+        return;
+    }
+    Entry *entry = new Entry();
+    entry->jsonObjResult = jsonObjResult;
+    entry->insertedTimer.start();
+    entry->ttlMs = static_cast<qint64>(ttlSeconds) * 1000;
+    entry->elapsedMs = elapsedMs;
+    m_cache.insert(key, entry, cost);
+}
+
+void MCPToolResultCache::invalidateServer(const QString &serverUuid)
+{
+    QMutexLocker locker(&m_mutex);
+    const QString prefix = serverUuid + '\n';
+    for (const QString &key : m_cache.keys())
+    {
+        if (key.startsWith(prefix))
+            m_cache.remove(key);
+    }
+}
+
+MCPToolCacheStats MCPToolResultCache::toolStats(const QString &toolId) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats.value(toolId);
+}
+
+MCPToolCacheStats MCPToolResultCache::serverStats(const QString &serverUuid) const
+{
+    QMutexLocker locker(&m_mutex);
+    MCPToolCacheStats stats;
+    for (auto it = m_toolServers.constBegin(); it != m_toolServers.constEnd(); ++it)
+    {
+        if (it.value() == serverUuid)
+            stats += m_stats.value(it.key());
+    }
+    return stats;
+}
@@ -0,0 +1,31 @@
+#include "Message.h"
+
+QString Message::roleToString(Role role)
+{
+    switch (role)
+    {
+    case Role::USER:
+        return "USER";
+    case Role::ASSISTANT:
+        return "ASSISTANT";
+    case Role::TOOL:
+        return "TOOL";
+    case Role::SYSTEM:
+        return "SYSTEM";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+Message::Role Message::roleFromString(const QString &role)
+{
+    if (role == "USER")
+        return Role::USER;
+    if (role == "ASSISTANT")
+        return Role::ASSISTANT;
+    if (role == "TOOL")
+        return Role::TOOL;
+    if (role == "SYSTEM")
+        return Role::SYSTEM;
+    return Role::UNKNOWN;
+}
@@ -10,6 +10,11 @@
 #include "LLMService.h"
 #include "ToastManager.h"
 #include "QJsonDocument"
+#include <QPointer>
+#include <QFileDialog>
+#if ENABLE_MCP_BENCHMARK
+#include "MCPBenchmark.h"
+#endif
 
 PageChat::PageChat(QWidget *parent)
     : BaseWidget(parent)
@@ -19,12 +24,14 @@ PageChat::PageChat(QWidget *parent)
     connect(DataManager::getInstance(), &DataManager::sig_agentUpdate, this, &PageChat::slot_onAgentUpdated);
     connect(DataManager::getInstance(), &DataManager::sig_conversationsLoaded, this, &PageChat::slot_onConversationsLoaded);
     connect(DataManager::getInstance(), &DataManager::sig_messagesLoaded, this, &PageChat::slot_onMessagesLoaded);
+    connect(DataManager::getInstance(), &DataManager::sig_olderMessagesLoaded, this, &PageChat::slot_onOlderMessagesLoaded);
     connect(EventBus::getInstance().get(), &EventBus::sig_pageSwitched, this, &PageChat::slot_handlePageSwitched);
     connect(EventBus::getInstance().get(), &EventBus::sig_stateChanged, this, &PageChat::slot_handleStateChanged);
     connect(LLMService::getInstance(), &LLMService::sig_responseReady, this, &PageChat::slot_handleResponse);
     connect(LLMService::getInstance(), &LLMService::sig_toolCalled, this, &PageChat::slot_handleToolCalled);
     connect(m_widgetChat, &WidgetChat::sig_messageSent, this, &PageChat::slot_onMessageSent);
     connect(m_widgetChat, &WidgetChat::sig_btnClickedCreateNewConversation, this, &PageChat::slot_onBtnClickedCreateNewConversation);
+    connect(DataBaseManager::getInstance()->getWorkerPtr(), &DataBaseWorker::sig_searchFinished, this, &PageChat::slot_onSearchFinished, Qt::QueuedConnection);
 }
 
 void PageChat::initWidget()
@@ -60,10 +67,68 @@ void PageChat::initItems()
         m_listWidgetConversations->setCurrentRow(0);
     }
 
+    // m_timerSearch
+    m_timerSearch = new QTimer(this);
+    m_timerSearch->setSingleShot(true);
+    m_timerSearch->setInterval(SEARCH_DEBOUNCE_MS);
+    connect(m_timerSearch, &QTimer::timeout, this,
+            [this]()
+            {
+                QString keywords = m_lineEditSearch->text().trimmed();
+                if (keywords.isEmpty())
+                    return;
+                m_labelSearchStatus->setText("搜索中...");
+                Q_EMIT DataBaseManager::getInstance()->sig_search(keywords, SEARCH_RESULT_LIMIT);
+            });
+    // m_lineEditSearch
+    m_lineEditSearch = new QLineEdit(this);
+    m_lineEditSearch->setPlaceholderText("搜索所有对话(空格分隔多个关键词)");
+    m_lineEditSearch->setClearButtonEnabled(true);
+    connect(m_lineEditSearch, &QLineEdit::textChanged, this,
+            [this](const QString &text)
+            {
+                if (text.trimmed().isEmpty())
+                {
+                    m_timerSearch->stop();
+                    m_listWidgetSearchResults->clear();
+                    m_labelSearchStatus->clear();
+                    return;
+                }
+                m_timerSearch->start();
+            });
+    // m_labelSearchStatus
+    m_labelSearchStatus = new QLabel(this);
+    // m_listWidgetSearchResults
+    m_listWidgetSearchResults = new QListWidget(this);
+    m_listWidgetSearchResults->setWordWrap(true);
+    connect(m_listWidgetSearchResults, &QListWidget::itemClicked, this,
+            [](QListWidgetItem *item)
+            {
+                QString conversationUuid = item->data(Qt::UserRole).toString();
+                std::shared_ptr<Conversation> conversation = DataManager::getInstance()->getConversation(conversationUuid);
+                if (!conversation)
+                {
+                    ToastManager::showMessage(Toast::Type::Warning, "对话已被删除");
+                    return;
+                }
+                XLC_LOG_TRACE("Search result selected (conversationUuid={}, messageUuid={})", conversationUuid, item->data(Qt::UserRole + 1).toString());
+                // 跳转至对话并定位消息
+                QJsonObject objPageInfo;
+                objPageInfo["id"] = static_cast<int>(EventBus::Pages::CONVERSATION);
+                objPageInfo["agentUuid"] = conversation->agentUuid;
+                objPageInfo["conversationUuid"] = conversationUuid;
+                objPageInfo["messageUuid"] = item->data(Qt::UserRole + 1).toString();
+                objPageInfo["messageSeq"] = item->data(Qt::UserRole + 2).toLongLong();
+                EventBus::getInstance()->publish(EventBus::EventType::PageSwitched, QVariant(objPageInfo));
+            });
+    // m_widgetSearch
+    m_widgetSearch = new QWidget(this);
+
     // m_tabWidgetSiderBar
     m_tabWidgetSiderBar = new QTabWidget(this);
     m_tabWidgetSiderBar->addTab(m_agentListWidget, "智能体");
     m_tabWidgetSiderBar->addTab(m_listWidgetConversations, "话题");
+    m_tabWidgetSiderBar->addTab(m_widgetSearch, "搜索");
     // 默认选中 话题
     m_tabWidgetSiderBar->setCurrentWidget(m_listWidgetConversations);
     connect(m_tabWidgetSiderBar, &QTabWidget::currentChanged, this,
@@ -81,6 +146,12 @@ void PageChat::initItems()
 
 void PageChat::initLayout()
 {
+    // vLayoutSearch
+    QVBoxLayout *vLayoutSearch = new QVBoxLayout(m_widgetSearch);
+    vLayoutSearch->setContentsMargins(0, 5, 0, 0);
+    vLayoutSearch->addWidget(m_lineEditSearch);
+    vLayoutSearch->addWidget(m_labelSearchStatus);
+    vLayoutSearch->addWidget(m_listWidgetSearchResults, 1);
     // splitter
     QSplitter *splitter = new QSplitter(this);
     splitter->setContentsMargins(0, 0, 0, 0);
@@ -141,6 +212,12 @@ void PageChat::slot_onMessagesLoaded(const QString &conversationUuid)
         m_widgetChat->refreshHistoryMessageList(conversationUuid);
 }
 
+void PageChat::slot_onOlderMessagesLoaded(const QString &conversationUuid, int count)
+{
+    if (m_widgetChat->getConversationUuid() == conversationUuid)
+        m_widgetChat->prependHistoryMessages(conversationUuid, count);
+}
+
 void PageChat::slot_onMessageSent(const QString &message)
 {
     if (!m_agentListWidget->hasAgentSelected())
@@ -174,6 +251,13 @@ void PageChat::slot_onMessageSent(const QString &message)
                                                           .arg(conversationUuid));
         return;
     }
+    // 上下文与消息列表分别加载，上下文未加载完时发送会丢失之前的对话
+    if (!conversation->isContextLoaded())
+    {
+        conversation->getMessages();
+        ToastManager::showMessage(Toast::Type::Warning, "正在加载对话上下文，请稍后...");
+        return;
+    }
     // 检查 MCP 服务器是否初始化
     bool allMcpServersReady = true;
     for (const QString &mcpServerUuid : agent->mcpServers)
@@ -210,6 +294,7 @@ void PageChat::slot_handlePageSwitched(const QVariant &data)
         int id = objPageInfo["id"].toInt();
         QString agentUuid = objPageInfo["agentUuid"].toString();
         QString conversationUuid = objPageInfo["conversationUuid"].toString();
+        QString messageUuid = objPageInfo["messageUuid"].toString();
 
         switch (static_cast<EventBus::Pages>(id))
         {
@@ -220,8 +305,9 @@ void PageChat::slot_handlePageSwitched(const QVariant &data)
                 XLC_LOG_ERROR("Switch failed(agentUuid={}, conversationUuid={}): agent or conversation UUID is empty ", agentUuid, conversationUuid);
                 return;
             }
-            // 选中对话列表
-            m_tabWidgetSiderBar->setCurrentWidget(m_listWidgetConversations);
+            // 选中对话列表(从搜索结果跳转时保留搜索结果)
+            if (m_tabWidgetSiderBar->currentWidget() != m_widgetSearch)
+                m_tabWidgetSiderBar->setCurrentWidget(m_listWidgetConversations);
 
             // 选中agent
             m_agentListWidget->setCurrentAgent(agentUuid);
@@ -232,6 +318,9 @@ void PageChat::slot_handlePageSwitched(const QVariant &data)
                 if (m_listWidgetConversations->item(j)->data(Qt::UserRole).toString() == conversationUuid)
                 {
                     m_listWidgetConversations->setCurrentRow(j);
+                    // 定位到搜索结果中的消息
+                    if (!messageUuid.isEmpty())
+                        m_widgetChat->locateMessage(messageUuid, static_cast<qint64>(objPageInfo["messageSeq"].toDouble()));
                     return;
                 }
             }
@@ -334,6 +423,47 @@ void PageChat::slot_onBtnClickedCreateNewConversation()
     }
 }
 
+void PageChat::slot_onSearchFinished(const QString &keywords, bool success, QVector<SearchResult> results, qint64 elapsedUs, bool truncated)
+{
+    // 忽略过期的结果(输入已改变)
+    if (keywords != m_lineEditSearch->text().trimmed())
+        return;
+    m_listWidgetSearchResults->clear();
+    if (!success)
+    {
+        m_labelSearchStatus->setText("搜索失败");
+        return;
+    }
+    int count = 0;
+    for (const SearchResult &result : results)
+    {
+        // 跳过已删除的对话
+        std::shared_ptr<Conversation> conversation = DataManager::getInstance()->getConversation(result.conversationUuid);
+        if (!conversation)
+            continue;
+        QString title = result.messageUuid.isEmpty()
+                            ? QString("<b>[标题]</b> %1").arg(formatSnippet(result.snippet))
+                            : QString("<b>%1</b> <span style=\"color:gray\">%2 %3</span><br>%4")
+                                  .arg(conversation->summary.toHtmlEscaped())
+                                  .arg(Message::roleToString(static_cast<Message::Role>(result.role)))
+                                  .arg(result.createdTime)
+                                  .arg(formatSnippet(result.snippet));
+        QListWidgetItem *item = new QListWidgetItem(m_listWidgetSearchResults);
+        item->setData(Qt::UserRole, result.conversationUuid);
+        item->setData(Qt::UserRole + 1, result.messageUuid);
+        item->setData(Qt::UserRole + 2, result.seq);
+        QLabel *labelResult = new QLabel(title, m_listWidgetSearchResults);
+        labelResult->setTextFormat(Qt::RichText);
+        labelResult->setWordWrap(true);
+        labelResult->setContentsMargins(5, 5, 5, 5);
+        labelResult->setAttribute(Qt::WA_TransparentForMouseEvents);
+        item->setSizeHint(labelResult->sizeHint());
+        m_listWidgetSearchResults->setItemWidget(item, labelResult);
+        count += 1;
+    }
+    m_labelSearchStatus->setText(QString("%1 条结果 (%2 ms)%3").arg(count).arg(elapsedUs / 1000.0, 0, 'f', 1).arg(truncated ? QString("，部分压缩保存的消息未搜索，请输入更长的关键词") : QString()));
+}
+
 void PageChat::refreshAgentList()
 {
     // 保留当前选中agent的uuid，用于再次选中
@@ -382,6 +512,7 @@ void PageChat::refreshConversationList()
             continue;
         QListWidgetItem *itemConversation = new QListWidgetItem();
         itemConversation->setText(conversation->summary);
+        itemConversation->setToolTip(conversation->lastMessagePreview);
         itemConversation->setData(Qt::UserRole, QVariant::fromValue(uuid));
         m_listWidgetConversations->addItem(itemConversation);
     }
@@ -406,6 +537,14 @@ void PageChat::refreshConversationList()
     m_listWidgetConversations->setCurrentRow(0);
 }
 
+QString PageChat::formatSnippet(const QString &snippet)
+{
+    QString html = snippet.toHtmlEscaped();
+    html.replace(SearchResult::HIGHLIGHT_BEGIN, "<b>").replace(SearchResult::HIGHLIGHT_END, "</b>");
+    html.replace('\n', ' ');
+    return html;
+}
+
 /**
  * WidgetChat
  */
@@ -413,6 +552,15 @@ WidgetChat::WidgetChat(const QString &conversationUuid, QWidget *parent)
     : BaseWidget(parent), m_conversationUuid(conversationUuid)
 {
     initUI();
+    connect(DataBaseManager::getInstance()->getWorkerPtr(), &DataBaseWorker::sig_messageContentExported, this,
+            [](const QString &messageUuid, const QString &filePath, bool success, qint64 bytes)
+            {
+                if (success)
+                    ToastManager::showMessage(Toast::Type::Success, QString("已导出 %1 字节到 %2").arg(bytes).arg(filePath));
+                else
+                    ToastManager::showMessage(Toast::Type::Error, QString("导出消息失败 (messageUuid=%1)").arg(messageUuid));
+            },
+            Qt::QueuedConnection);
 }
 
 void WidgetChat::initWidget()
@@ -423,6 +571,36 @@ void WidgetChat::initItems()
 {
     // m_historyMessageList
     m_historyMessageList = new HistoryMessageListWidget(this);
+    connect(m_historyMessageList, &HistoryMessageListWidget::sig_reachedTop, this,
+            [this]()
+            {
+                std::shared_ptr<Conversation> conversation = DataManager::getInstance()->getConversation(m_conversationUuid);
+                if (conversation)
+                    conversation->loadOlderMessages();
+            });
+    // 右键导出消息内容(较大的内容从数据库逐块写入文件)
+    m_historyMessageList->setContextMenuPolicy(Qt::CustomContextMenu);
+    // m_contextMenuMessages
+    m_contextMenuMessages = new QMenu(m_historyMessageList);
+    QAction *actionExportMessage = new QAction("导出消息内容", m_historyMessageList);
+    m_contextMenuMessages->addAction(actionExportMessage);
+    connect(m_historyMessageList, &HistoryMessageListWidget::customContextMenuRequested, this,
+            [this, actionExportMessage](const QPoint &pos)
+            {
+                QString messageUuid = m_historyMessageList->messageIdAt(pos);
+                if (messageUuid.isEmpty())
+                    return;
+                actionExportMessage->setData(messageUuid);
+                m_contextMenuMessages->exec(m_historyMessageList->viewport()->mapToGlobal(pos));
+            });
+    connect(actionExportMessage, &QAction::triggered, this,
+            [this, actionExportMessage]()
+            {
+                QString filePath = QFileDialog::getSaveFileName(this, "导出消息内容", actionExportMessage->data().toString() + ".txt", "Text Files (*.txt);;All Files (*)");
+                if (filePath.isEmpty())
+                    return;
+                Q_EMIT DataBaseManager::getInstance()->sig_exportMessageContent(actionExportMessage->data().toString(), filePath);
+            });
     // m_plainTextEdit
     m_plainTextEdit = new QPlainTextEdit(this);
     // m_pushButtonSend
@@ -431,10 +609,12 @@ void WidgetChat::initItems()
     connect(m_pushButtonSend, &QPushButton::clicked, this,
             [this]()
             {
-                const QString userInput = this->m_plainTextEdit->toPlainText();
-                if (!userInput.isEmpty())
+                QString userInput = this->m_plainTextEdit->toPlainText();
+                if (!userInput.isEmpty() || !m_attachments.isEmpty())
                 {
                     XLC_LOG_DEBUG("发送消息: {}", userInput);
+                    for (const auto &attachment : m_attachments)
+                        userInput += (userInput.isEmpty() ? "" : "\n\n") + attachment.second;
                     Q_EMIT sig_messageSent(userInput);
                 }
             });
@@ -462,6 +642,17 @@ void WidgetChat::initItems()
     m_pushButtonCreateNewConversation = new QPushButton(this);
     m_pushButtonCreateNewConversation->setText("新建对话");
     connect(m_pushButtonCreateNewConversation, &QPushButton::clicked, this, &WidgetChat::sig_btnClickedCreateNewConversation);
+    // m_pushButtonAttachResource
+    m_pushButtonAttachResource = new QPushButton("附加资源", this);
+    m_pushButtonAttachResource->setToolTip("从智能体挂载的MCP服务器中选择资源附加到消息，或选择提示词插入输入框");
+    connect(m_pushButtonAttachResource, &QPushButton::clicked, this, &WidgetChat::pickMcpResource);
+    // m_pushButtonClearAttachments
+    m_pushButtonClearAttachments = new QPushButton("清除附件", this);
+    m_pushButtonClearAttachments->setVisible(false);
+    connect(m_pushButtonClearAttachments, &QPushButton::clicked, this, &WidgetChat::clearAttachments);
+    // m_labelAttachments
+    m_labelAttachments = new QLabel(this);
+    m_labelAttachments->setVisible(false);
 }
 
 void WidgetChat::initLayout()
@@ -478,6 +669,9 @@ void WidgetChat::initLayout()
     flowLayoutTools->setContentsMargins(0, 0, 0, 0);
     flowLayoutTools->addWidget(m_pushButtonClearContext);
     flowLayoutTools->addWidget(m_pushButtonCreateNewConversation);
+    flowLayoutTools->addWidget(m_pushButtonAttachResource);
+    flowLayoutTools->addWidget(m_pushButtonClearAttachments);
+    flowLayoutTools->addWidget(m_labelAttachments);
 #ifdef QT_DEBUG
     for (int i = 0; i < 10; ++i)
     {
@@ -489,6 +683,25 @@ void WidgetChat::initLayout()
                 });
         flowLayoutTools->addWidget(button);
     }
+#endif
+#if ENABLE_MCP_BENCHMARK
+    // 需要先添加并连接模拟MCP服务器(output/MockMcpServer)
+    QPushButton *pushButtonBenchmark = new QPushButton("MCP基准测试", this);
+    connect(pushButtonBenchmark, &QPushButton::clicked, this,
+            [this, pushButtonBenchmark]()
+            {
+                pushButtonBenchmark->setEnabled(false);
+                MCPBenchmark *benchmark = new MCPBenchmark(this);
+                connect(benchmark, &MCPBenchmark::sig_finished, this,
+                        [benchmark, pushButtonBenchmark](const QString &report)
+                        {
+                            pushButtonBenchmark->setEnabled(true);
+                            ToastManager::showMessage(Toast::Type::Success, report);
+                            benchmark->deleteLater();
+                        });
+                benchmark->start();
+            });
+    flowLayoutTools->addWidget(pushButtonBenchmark);
 #endif
     // hLayoutTools
     QHBoxLayout *hLayoutTools = new QHBoxLayout();
@@ -537,6 +750,69 @@ void WidgetChat::refreshHistoryMessageList(const QString &conversationUuid)
     m_historyMessageList->clearAllMessage();
     QVector<Message> messages = conversation->getMessages();
     // 刷新历史消息列表m_listWidgetMessages
+    for (const HistoryMessage &historyMessage : toHistoryMessages(messages))
+        m_historyMessageList->addMessage(historyMessage);
+    // 最新的消息在底部，向上滚动时再加载更早的消息
+    m_historyMessageList->scrollToBottom();
+    if (locatePendingMessage() && !m_historyMessageList->isScrollable())
+        conversation->loadOlderMessages();
+    XLC_LOG_DEBUG("Refresh history message list (conversationUuid={}, messageCount={})", conversationUuid, messages.size());
+}
+
+void WidgetChat::prependHistoryMessages(const QString &conversationUuid, int count)
+{
+    std::shared_ptr<Conversation> conversation = DataManager::getInstance()->getConversation(conversationUuid);
+    if (!conversation || count <= 0)
+        return;
+    m_historyMessageList->prependMessages(toHistoryMessages(conversation->getMessages().mid(0, count)));
+    if (locatePendingMessage() && !m_historyMessageList->isScrollable())
+        conversation->loadOlderMessages();
+    XLC_LOG_DEBUG("Prepend history messages (conversationUuid={}, count={})", conversationUuid, count);
+}
+
+void WidgetChat::locateMessage(const QString &messageUuid, qint64 seq)
+{
+    m_pendingLocateConversationUuid = m_conversationUuid;
+    m_pendingLocateMessageUuid = messageUuid;
+    m_pendingLocateSeq = seq;
+    locatePendingMessage();
+}
+
+bool WidgetChat::locatePendingMessage()
+{
+    if (m_pendingLocateMessageUuid.isEmpty())
+        return true;
+    // 已切换到其他对话
+    if (m_pendingLocateConversationUuid != m_conversationUuid)
+    {
+        m_pendingLocateMessageUuid.clear();
+        return true;
+    }
+    std::shared_ptr<Conversation> conversation = DataManager::getInstance()->getConversation(m_conversationUuid);
+    // 等待消息加载完成后再次刷新
+    if (!conversation || !conversation->isMessagesLoaded())
+        return false;
+    if (m_historyMessageList->scrollToMessage(m_pendingLocateMessageUuid))
+    {
+        m_pendingLocateMessageUuid.clear();
+        return true;
+    }
+    QVector<Message> messages = conversation->getMessages();
+    if (conversation->hasOlderMessages() && !messages.isEmpty() && messages.first().seq > m_pendingLocateSeq)
+    {
+        conversation->loadOlderMessages(m_pendingLocateSeq);
+        return false;
+    }
+    XLC_LOG_WARN("Locate message failed (conversationUuid={}, messageUuid={}): message not found", m_conversationUuid, m_pendingLocateMessageUuid);
+    ToastManager::showMessage(Toast::Type::Warning, "未找到该消息，可能已被删除");
+    m_pendingLocateMessageUuid.clear();
+    return true;
+}
+
+QVector<HistoryMessage> WidgetChat::toHistoryMessages(const QVector<Message> &messages)
+{
+    QVector<HistoryMessage> historyMessages;
+    historyMessages.reserve(messages.size());
     for (const Message &message : messages)
     {
         QString displayContent = message.content;
@@ -548,18 +824,319 @@ void WidgetChat::refreshHistoryMessageList(const QString &conversationUuid)
         else if (message.role == Message::TOOL)
         {
             // 插入一条拼凑的系统调用工具的消息，保持一致性（数据库没有存储）
-            m_historyMessageList->addMessage(HistoryMessage(message.id, QString("Calling tool (callId=%1)").arg(message.toolCallId), Message::TOOL, message.createdTime, message.toolCalls, message.toolCallId, message.avatarFilePath));
+            historyMessages.append(HistoryMessage(message.id, QString("Calling tool (callId=%1)").arg(message.toolCallId), Message::TOOL, message.createdTime, message.toolCalls, message.toolCallId, message.avatarFilePath));
             displayContent = QString("Result of call tool (success=%1, callId=%2, formattedContent=%3)")
                                  .arg(1)
                                  .arg(message.toolCallId)
                                  .arg(message.content);
         }
-        m_historyMessageList->addMessage(HistoryMessage(message.id, displayContent, message.role, message.createdTime, message.toolCalls, message.toolCallId, message.avatarFilePath));
+        historyMessages.append(HistoryMessage(message.id, displayContent, message.role, message.createdTime, message.toolCalls, message.toolCallId, message.avatarFilePath));
     }
-    XLC_LOG_DEBUG("Refresh history message list (conversationUuid={}, messageCount={})", conversationUuid, messages.size());
+    return historyMessages;
 }
 
 void WidgetChat::clearPlainTextEdit()
 {
     m_plainTextEdit->clear();
+    clearAttachments();
+}
+
+void WidgetChat::pickMcpResource()
+{
+    std::shared_ptr<Conversation> conversation = DataManager::getInstance()->getConversation(m_conversationUuid);
+    if (!conversation)
+    {
+        ToastManager::showMessage(Toast::Type::Warning, "请先选择或新建一个对话");
+        return;
+    }
+    std::shared_ptr<Agent> agent = DataManager::getInstance()->getAgent(conversation->agentUuid);
+    if (!agent)
+    {
+        XLC_LOG_WARN("Pick MCP resource failed (agentUuid={}): agent not found", conversation->agentUuid);
+        ToastManager::showMessage(Toast::Type::Error, QString("选择资源失败 (agentUuid=%1): agent not found").arg(conversation->agentUuid));
+        return;
+    }
+    DialogMcpResourcePicker *dialog = new DialogMcpResourcePicker(agent->mcpServers, this);
+    if (dialog->exec() != QDialog::Accepted)
+    {
+        dialog->deleteLater();
+        return;
+    }
+    const QString serverUuid = dialog->getServerUuid();
+    QPointer<WidgetChat> guard(this);
+    if (dialog->isPromptSelected())
+    {
+        const QString promptName = dialog->getSelectedPrompt();
+        if (!promptName.isEmpty())
+        {
+            MCPService::getInstance()->getPrompt(
+                serverUuid, promptName, dialog->getPromptArguments(),
+                [guard, promptName](bool success, const QJsonObject &result, const QString &errorMessage)
+                {
+                    if (!guard)
+                        return;
+                    if (!success)
+                    {
+                        XLC_LOG_WARN("Get prompt failed (prompt={}): {}", promptName, errorMessage);
+                        ToastManager::showMessage(Toast::Type::Error, QString("获取提示词失败 (prompt=%1): %2").arg(promptName).arg(errorMessage));
+                        return;
+                    }
+                    // 只插入文本内容，多条消息之间空一行
+                    QStringList texts;
+                    for (const QJsonValue &jsonValueMessage : result.value("messages").toArray())
+                    {
+                        QJsonObject jsonObjContent = jsonValueMessage.toObject().value("content").toObject();
+                        if (jsonObjContent.value("type").toString() == "text")
+                            texts.append(jsonObjContent.value("text").toString());
+                        else if (jsonObjContent.value("type").toString() == "resource")
+                            texts.append(jsonObjContent.value("resource").toObject().value("text").toString());
+                    }
+                    guard->m_plainTextEdit->insertPlainText(texts.join("\n\n"));
+                });
+        }
+    }
+    else
+    {
+        for (const auto &resource : dialog->getSelectedResources())
+        {
+            const QString uri = resource.first;
+            const QString name = resource.second;
+            MCPService::getInstance()->readResource(
+                serverUuid, uri,
+                [guard, uri, name](bool success, const QVector<MCPResourceContent> &contents, const QString &errorMessage)
+                {
+                    if (!guard)
+                        return;
+                    if (!success)
+                    {
+                        XLC_LOG_WARN("Read resource failed (uri={}): {}", uri, errorMessage);
+                        ToastManager::showMessage(Toast::Type::Error, QString("读取资源失败 (uri=%1): %2").arg(uri).arg(errorMessage));
+                        return;
+                    }
+                    guard->addAttachment(name, contents);
+                });
+        }
+    }
+    dialog->deleteLater();
+}
+
+void WidgetChat::addAttachment(const QString &name, const QVector<MCPResourceContent> &contents)
+{
+    m_attachments.append(qMakePair(name, formatAttachment(contents)));
+    QStringList names;
+    for (const auto &attachment : m_attachments)
+        names.append(attachment.first);
+    m_labelAttachments->setText(QString("已附加: %1").arg(names.join(", ")));
+    m_labelAttachments->setVisible(true);
+    m_pushButtonClearAttachments->setVisible(true);
+}
+
+void WidgetChat::clearAttachments()
+{
+    m_attachments.clear();
+    m_labelAttachments->clear();
+    m_labelAttachments->setVisible(false);
+    m_pushButtonClearAttachments->setVisible(false);
+}
+
+QString WidgetChat::formatAttachment(const QVector<MCPResourceContent> &contents)
+{
+    QStringList parts;
+    for (const MCPResourceContent &content : contents)
+    {
+        if (content.isBlob())
+        {
+            parts.append(QString("<resource uri=\"%1\" mimeType=\"%2\" blobId=\"%3\" size=\"%4\" />")
+                             .arg(content.uri)
+                             .arg(content.mimeType)
+                             .arg(content.blobId)
+                             .arg(content.size));
+            continue;
+        }
+        QString text = content.text;
+        if (text.size() > MAX_ATTACHMENT_CHARS)
+            text = text.left(MAX_ATTACHMENT_CHARS) + QString("\n[truncated: showing %1 of %2 characters]").arg(MAX_ATTACHMENT_CHARS).arg(content.text.size());
+        parts.append(QString("<resource uri=\"%1\" mimeType=\"%2\">\n%3\n</resource>").arg(content.uri).arg(content.mimeType).arg(text));
+    }
+    return parts.join("\n");
+}
+
+/**
+ * DialogMcpResourcePicker
+ */
+DialogMcpResourcePicker::DialogMcpResourcePicker(const QSet<QString> &mcpServerUuids, QWidget *parent, Qt::WindowFlags f)
+    : BaseDialog(parent, f), m_mcpServerUuids(mcpServerUuids)
+{
+    initUI();
+    if (m_comboBoxServers->count() > 0)
+        loadServer(m_comboBoxServers->currentData().toString());
+}
+
+void DialogMcpResourcePicker::initWidget()
+{
+    setWindowTitle("附加MCP资源");
+    resize(480, 400);
+}
+
+void DialogMcpResourcePicker::initItems()
+{
+    // m_comboBoxServers
+    m_comboBoxServers = new QComboBox(this);
+    for (const QString &uuid : m_mcpServerUuids)
+    {
+        // 仅展示已启用且已连接的服务器
+        std::shared_ptr<McpServer> mcpServer = DataManager::getInstance()->getMcpServer(uuid);
+        if (!mcpServer || !mcpServer->isActive || !MCPService::getInstance()->isInitialized(uuid))
+            continue;
+        m_comboBoxServers->addItem(mcpServer->name, uuid);
+    }
+    connect(m_comboBoxServers, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            [this](int index)
+            {
+                if (index >= 0)
+                    loadServer(m_comboBoxServers->itemData(index).toString());
+            });
+    // m_listWidgetResources
+    m_listWidgetResources = new QListWidget(this);
+    // m_listWidgetPrompts
+    m_listWidgetPrompts = new QListWidget(this);
+    // m_plainTextEditPromptArguments
+    m_plainTextEditPromptArguments = new QPlainTextEdit(this);
+    m_plainTextEditPromptArguments->setPlaceholderText("提示词参数，每行一个: key=value");
+    connect(m_listWidgetPrompts, &QListWidget::currentItemChanged, this,
+            [this](QListWidgetItem *current, QListWidgetItem *)
+            {
+                if (!current)
+                    return;
+                // 根据提示词声明的参数生成模板
+                QStringList lines;
+                for (const QJsonValue &jsonValueArgument : current->data(Qt::UserRole + 1).toJsonArray())
+                    lines.append(jsonValueArgument.toObject().value("name").toString() + "=");
+                m_plainTextEditPromptArguments->setPlainText(lines.join("\n"));
+            });
+    // m_tabWidget
+    m_tabWidget = new QTabWidget(this);
+    m_tabWidget->addTab(m_listWidgetResources, "资源");
+    QWidget *widgetPrompts = new QWidget(this);
+    QVBoxLayout *vLayoutPrompts = new QVBoxLayout(widgetPrompts);
+    vLayoutPrompts->setContentsMargins(0, 0, 0, 0);
+    vLayoutPrompts->addWidget(m_listWidgetPrompts, 3);
+    vLayoutPrompts->addWidget(m_plainTextEditPromptArguments, 1);
+    m_tabWidget->addTab(widgetPrompts, "提示词");
+    // m_pushButtonOk
+    m_pushButtonOk = new QPushButton("确定", this);
+    connect(m_pushButtonOk, &QPushButton::clicked, this, &DialogMcpResourcePicker::accept);
+    // m_pushButtonCancel
+    m_pushButtonCancel = new QPushButton("取消", this);
+    connect(m_pushButtonCancel, &QPushButton::clicked, this, &DialogMcpResourcePicker::reject);
+}
+
+void DialogMcpResourcePicker::initLayout()
+{
+    // hLayoutButtons
+    QHBoxLayout *hLayoutButtons = new QHBoxLayout();
+    hLayoutButtons->addStretch();
+    hLayoutButtons->addWidget(m_pushButtonOk);
+    hLayoutButtons->addWidget(m_pushButtonCancel);
+    // vLayout
+    QVBoxLayout *vLayout = new QVBoxLayout(this);
+    vLayout->addWidget(m_comboBoxServers);
+    vLayout->addWidget(m_tabWidget);
+    vLayout->addLayout(hLayoutButtons);
+}
+
+void DialogMcpResourcePicker::loadServer(const QString &serverUuid)
+{
+    m_listWidgetResources->clear();
+    m_listWidgetPrompts->clear();
+    m_plainTextEditPromptArguments->clear();
+    QPointer<DialogMcpResourcePicker> guard(this);
+    MCPService::getInstance()->listResources(
+        serverUuid,
+        [guard, serverUuid](bool success, const QJsonArray &jsonArrayResources, const QString &errorMessage)
+        {
+            // 切换服务器后忽略之前的结果
+            if (!guard || guard->getServerUuid() != serverUuid)
+                return;
+            if (!success)
+            {
+                XLC_LOG_WARN("List resources failed (serverUuid={}): {}", serverUuid, errorMessage);
+                ToastManager::showMessage(Toast::Type::Error, QString("获取资源列表失败: %1").arg(errorMessage));
+                return;
+            }
+            for (const QJsonValue &jsonValueResource : jsonArrayResources)
+            {
+                QJsonObject jsonObjResource = jsonValueResource.toObject();
+                const QString uri = jsonObjResource.value("uri").toString();
+                const QString name = jsonObjResource.value("name").toString(uri);
+                QListWidgetItem *item = new QListWidgetItem(name, guard->m_listWidgetResources);
+                item->setToolTip(jsonObjResource.value("description").toString(uri));
+                item->setData(Qt::UserRole, uri);
+                item->setCheckState(Qt::Unchecked);
+            }
+        });
+    MCPService::getInstance()->listPrompts(
+        serverUuid,
+        [guard, serverUuid](bool success, const QJsonArray &jsonArrayPrompts, const QString &errorMessage)
+        {
+            if (!guard || guard->getServerUuid() != serverUuid)
+                return;
+            if (!success)
+            {
+                XLC_LOG_WARN("List prompts failed (serverUuid={}): {}", serverUuid, errorMessage);
+                return;
+            }
+            for (const QJsonValue &jsonValuePrompt : jsonArrayPrompts)
+            {
+                QJsonObject jsonObjPrompt = jsonValuePrompt.toObject();
+                QListWidgetItem *item = new QListWidgetItem(jsonObjPrompt.value("name").toString(), guard->m_listWidgetPrompts);
+                item->setToolTip(jsonObjPrompt.value("description").toString());
+                item->setData(Qt::UserRole, jsonObjPrompt.value("name").toString());
+                item->setData(Qt::UserRole + 1, jsonObjPrompt.value("arguments").toArray());
+            }
+        });
+}
+
+QString DialogMcpResourcePicker::getServerUuid() const
+{
+    return m_comboBoxServers->currentData().toString();
+}
+
+bool DialogMcpResourcePicker::isPromptSelected() const
+{
+    return m_tabWidget->currentIndex() == 1;
+}
+
+QVector<QPair<QString, QString>> DialogMcpResourcePicker::getSelectedResources() const
+{
+    QVector<QPair<QString, QString>> resources;
+    for (int i = 0; i < m_listWidgetResources->count(); ++i)
+    {
+        QListWidgetItem *item = m_listWidgetResources->item(i);
+        if (item->checkState() == Qt::Checked)
+            resources.append(qMakePair(item->data(Qt::UserRole).toString(), item->text()));
+    }
+    return resources;
+}
+
+QString DialogMcpResourcePicker::getSelectedPrompt() const
+{
+    QListWidgetItem *item = m_listWidgetPrompts->currentItem();
+    return item ? item->data(Qt::UserRole).toString() : QString();
+}
+
+QJsonObject DialogMcpResourcePicker::getPromptArguments() const
+{
+    QJsonObject jsonObjArguments;
+    for (const QString &line : m_plainTextEditPromptArguments->toPlainText().split('\n', Qt::SkipEmptyParts))
+    {
+        int index = line.indexOf('=');
+        if (index <= 0)
+            continue;
+        // 未填写的参数不发送
+        QString value = line.mid(index + 1).trimmed();
+        if (!value.isEmpty())
+            jsonObjArguments.insert(line.left(index).trimmed(), value);
+    }
+    return jsonObjArguments;
 }
\ No newline at end of file
@@ -11,6 +11,11 @@
 #include <QJsonObject>
 #include <QMessageBox>
 #include "ColorRepository.h"
+#include "MCPService.h"
+#include "LLMService.h"
+#include <QTimer>
+#include <QTime>
+#include "Executor.h"
 
 // PageSettings
 PageSettings::PageSettings(QWidget *parent)
@@ -134,6 +139,8 @@ void WidgetAgentInfo::initItems()
     // m_spinBoxContext
     m_spinBoxContext = new QSpinBox(this);
     m_spinBoxContext->setRange(0, 9999999);
+    // 发送给LLM的最近消息数量(不包括系统提示词)
+    m_spinBoxContext->setSpecialValueText(QString("默认(%1)").arg(Conversation::DEFAULT_CONTEXT_MESSAGES));
     // m_doubleSpinBoxTemperature
     m_doubleSpinBoxTemperature = new QDoubleSpinBox(this);
     m_doubleSpinBoxTemperature->setRange(0, 1);
@@ -143,6 +150,20 @@ void WidgetAgentInfo::initItems()
     // m_spinBoxMaxTokens
     m_spinBoxMaxTokens = new QSpinBox(this);
     m_spinBoxMaxTokens->setRange(0, 9999999);
+    // m_spinBoxMaxToolResultChars
+    m_spinBoxMaxToolResultChars = new QSpinBox(this);
+    m_spinBoxMaxToolResultChars->setRange(0, 9999999);
+    m_spinBoxMaxToolResultChars->setSuffix(" 字符");
+    m_spinBoxMaxToolResultChars->setSpecialValueText("不限制");
+    m_spinBoxMaxToolResultChars->setToolTip("单个工具结果写入上下文的最大字符数，超出时保留开头和结尾并截断中间部分");
+    // m_checkBoxSpillToolResultBlobs
+    m_checkBoxSpillToolResultBlobs = new QCheckBox("保存到磁盘，上下文中只保留引用", this);
+    m_checkBoxSpillToolResultBlobs->setToolTip("工具结果中的图片、音频等二进制数据以及截断前的完整结果保存到 tool_results 目录");
+    // m_spinBoxMaxToolsPerRequest
+    m_spinBoxMaxToolsPerRequest = new QSpinBox(this);
+    m_spinBoxMaxToolsPerRequest->setRange(0, 1024);
+    m_spinBoxMaxToolsPerRequest->setSpecialValueText("发送全部");
+    m_spinBoxMaxToolsPerRequest->setToolTip("每次请求只发送与最新消息最相关的工具(对话中调用过的工具始终发送)，减少提示词大小");
     // m_plainTextEditSystemPrompt
     m_plainTextEditSystemPrompt = new QPlainTextEdit(this);
     m_plainTextEditSystemPrompt->setPlaceholderText("系统提示词");
@@ -293,12 +314,18 @@ void WidgetAgentInfo::initLayout()
     gLayout->addWidget(m_doubleSpinBoxTopP, 6, 1);
     gLayout->addWidget(new QLabel("最大Token数", this), 7, 0);
     gLayout->addWidget(m_spinBoxMaxTokens, 7, 1);
-    gLayout->addWidget(new QLabel("系统提示词", this), 8, 0);
-    gLayout->addWidget(m_plainTextEditSystemPrompt, 8, 1);
-    gLayout->addWidget(new QLabel("MCP服务器", this), 9, 0);
-    gLayout->addWidget(m_listWidgetMcpServers, 9, 1);
-    gLayout->addWidget(new QLabel("对话列表", this), 10, 0);
-    gLayout->addWidget(m_listWidgetConversations, 10, 1);
+    gLayout->addWidget(new QLabel("工具结果上限", this), 8, 0);
+    gLayout->addWidget(m_spinBoxMaxToolResultChars, 8, 1);
+    gLayout->addWidget(new QLabel("二进制结果", this), 9, 0);
+    gLayout->addWidget(m_checkBoxSpillToolResultBlobs, 9, 1);
+    gLayout->addWidget(new QLabel("工具数量上限", this), 10, 0);
+    gLayout->addWidget(m_spinBoxMaxToolsPerRequest, 10, 1);
+    gLayout->addWidget(new QLabel("系统提示词", this), 11, 0);
+    gLayout->addWidget(m_plainTextEditSystemPrompt, 11, 1);
+    gLayout->addWidget(new QLabel("MCP服务器", this), 12, 0);
+    gLayout->addWidget(m_listWidgetMcpServers, 12, 1);
+    gLayout->addWidget(new QLabel("对话列表", this), 13, 0);
+    gLayout->addWidget(m_listWidgetConversations, 13, 1);
 }
 
 void WidgetAgentInfo::updateFormData(std::shared_ptr<Agent> agent)
@@ -323,6 +350,13 @@ void WidgetAgentInfo::updateFormData(std::shared_ptr<Agent> agent)
     m_doubleSpinBoxTemperature->setValue(agent->temperature);
     m_doubleSpinBoxTopP->setValue(agent->topP);
     m_spinBoxMaxTokens->setValue(agent->maxTokens);
+    m_spinBoxMaxToolResultChars->setValue(agent->maxToolResultChars);
+    m_checkBoxSpillToolResultBlobs->setChecked(agent->spillToolResultBlobs);
+    m_spinBoxMaxToolsPerRequest->setValue(agent->maxToolsPerRequest);
+    ToolSelectionStats toolSelectionStats = LLMService::getInstance()->getToolSelectionStats();
+    m_spinBoxMaxToolsPerRequest->setToolTip(QString("每次请求只发送与最新消息最相关的工具(对话中调用过的工具始终发送)，减少提示词大小\n本次运行已筛选 %1 次请求，节省 %2 KB")
+                                                .arg(toolSelectionStats.requests)
+                                                .arg(toolSelectionStats.savedBytes() / 1024.0, 0, 'f', 1));
     m_plainTextEditSystemPrompt->setPlainText(agent->systemPrompt);
 
     // 更新MCP服务器列表
@@ -369,6 +403,9 @@ void WidgetAgentInfo::clearFormData()
     m_doubleSpinBoxTemperature->setValue(0);
     m_doubleSpinBoxTopP->setValue(0);
     m_spinBoxMaxTokens->setValue(0);
+    m_spinBoxMaxToolResultChars->setValue(20000);
+    m_checkBoxSpillToolResultBlobs->setChecked(true);
+    m_spinBoxMaxToolsPerRequest->setValue(0);
     m_plainTextEditSystemPrompt->setPlainText("");
     m_listWidgetMcpServers->clear();
     m_listWidgetConversations->clear();
@@ -385,6 +422,9 @@ std::shared_ptr<Agent> WidgetAgentInfo::getCurrentData()
     agent->temperature = m_doubleSpinBoxTemperature->value();
     agent->topP = m_doubleSpinBoxTopP->value();
     agent->maxTokens = m_spinBoxMaxTokens->value();
+    agent->maxToolResultChars = m_spinBoxMaxToolResultChars->value();
+    agent->spillToolResultBlobs = m_checkBoxSpillToolResultBlobs->isChecked();
+    agent->maxToolsPerRequest = m_spinBoxMaxToolsPerRequest->value();
     agent->systemPrompt = m_plainTextEditSystemPrompt->toPlainText();
     agent->mcpServers.clear();
     for (int i = 0; i < m_listWidgetMcpServers->count(); ++i)
@@ -771,6 +811,12 @@ void PageSettingsMcp::connectDataManagerDataLoadedSignals()
 WidgetMcpServerInfo::WidgetMcpServerInfo(QWidget *parent)
 {
     initUI();
+    connect(MCPService::getInstance(), &MCPService::sig_serverHealthChanged, this, &WidgetMcpServerInfo::slot_onServerHealthChanged);
+    // 定时刷新资源使用情况
+    QTimer *timerResourceUsage = new QTimer(this);
+    timerResourceUsage->setInterval(2000);
+    connect(timerResourceUsage, &QTimer::timeout, this, &WidgetMcpServerInfo::updateResourceUsage);
+    timerResourceUsage->start();
 }
 
 void WidgetMcpServerInfo::initWidget()
@@ -801,6 +847,24 @@ void WidgetMcpServerInfo::initItems()
     // m_spinBoxTimeout
     m_spinBoxTimeout = new QSpinBox(this);
     m_spinBoxTimeout->setRange(0, 9999999);
+    // m_spinBoxMaxConcurrentCalls
+    m_spinBoxMaxConcurrentCalls = new QSpinBox(this);
+    m_spinBoxMaxConcurrentCalls->setRange(1, 64);
+    m_spinBoxMaxConcurrentCalls->setToolTip("同时执行的最大工具调用数量(启用进程池时为所有进程的总数)，超出的调用将排队等待");
+    // m_spinBoxResultCacheTtl
+    m_spinBoxResultCacheTtl = new QSpinBox(this);
+    m_spinBoxResultCacheTtl->setRange(0, 86400);
+    m_spinBoxResultCacheTtl->setSuffix(" s");
+    m_spinBoxResultCacheTtl->setSpecialValueText("不缓存");
+    m_spinBoxResultCacheTtl->setToolTip("只读/幂等工具以相同参数调用时，在该时间内直接返回缓存的结果");
+    // m_lineEditCacheableTools
+    m_lineEditCacheableTools = new QLineEdit(this);
+    m_lineEditCacheableTools->setPlaceholderText("list_directory, get_schema");
+    m_lineEditCacheableTools->setToolTip("额外标记为可缓存的工具(原始工具名，以逗号分隔)，注解声明 readOnlyHint/idempotentHint 的工具会自动缓存");
+    // m_lineEditHealth
+    m_lineEditHealth = new QLineEdit(this);
+    m_lineEditHealth->setReadOnly(true);
+    m_lineEditHealth->setPlaceholderText("未连接");
     // m_labelCommand
     m_labelCommand = new QLabel("命令", this);
     // m_lineEditCommand
@@ -816,6 +880,64 @@ void WidgetMcpServerInfo::initItems()
     // m_plainTextEditEnvVars
     m_plainTextEditEnvVars = new QPlainTextEdit(this);
     m_plainTextEditEnvVars->setPlaceholderText("KEY1=value1\nKEY2=value2");
+    // m_labelMinReplicas
+    m_labelMinReplicas = new QLabel("最少进程数", this);
+    // m_spinBoxMinReplicas
+    m_spinBoxMinReplicas = new QSpinBox(this);
+    m_spinBoxMinReplicas->setRange(1, 32);
+    m_spinBoxMinReplicas->setToolTip("常驻的服务器进程数量");
+    // m_labelMaxReplicas
+    m_labelMaxReplicas = new QLabel("最多进程数", this);
+    // m_spinBoxMaxReplicas
+    m_spinBoxMaxReplicas = new QSpinBox(this);
+    m_spinBoxMaxReplicas->setRange(1, 32);
+    m_spinBoxMaxReplicas->setToolTip("大于1时启用进程池：调用繁忙时按需启动新进程，空闲的进程自动回收，仅适用于无状态的服务器");
+    // m_labelIdleTimeout
+    m_labelIdleTimeout = new QLabel("空闲关闭", this);
+    // m_spinBoxIdleTimeout
+    m_spinBoxIdleTimeout = new QSpinBox(this);
+    m_spinBoxIdleTimeout->setRange(0, 86400);
+    m_spinBoxIdleTimeout->setSuffix(" s");
+    m_spinBoxIdleTimeout->setSpecialValueText("不关闭");
+    m_spinBoxIdleTimeout->setToolTip("空闲超过该时间后关闭服务器进程以释放内存，下次调用时自动重新启动");
+    // m_labelResourceLimits
+    m_labelResourceLimits = new QLabel("资源限制", this);
+    m_labelResourceLimits->setToolTip("仅Linux生效；CPU配额与内存上限需要当前cgroup(v2)可写且可委派 cpu/memory 控制器，不可用时CPU配额不生效、内存上限改用 rlimit，原因显示在资源占用中");
+    // m_widgetResourceLimits
+    m_widgetResourceLimits = new QWidget(this);
+    // m_spinBoxCpuQuota
+    m_spinBoxCpuQuota = new QSpinBox(m_widgetResourceLimits);
+    m_spinBoxCpuQuota->setRange(0, 6400);
+    m_spinBoxCpuQuota->setSuffix(" %");
+    m_spinBoxCpuQuota->setSpecialValueText("CPU不限");
+    m_spinBoxCpuQuota->setToolTip("CPU配额，100% 代表一个核心");
+    // m_spinBoxMemoryLimit
+    m_spinBoxMemoryLimit = new QSpinBox(m_widgetResourceLimits);
+    m_spinBoxMemoryLimit->setRange(0, 1048576);
+    m_spinBoxMemoryLimit->setSuffix(" MB");
+    m_spinBoxMemoryLimit->setSpecialValueText("内存不限");
+    m_spinBoxMemoryLimit->setToolTip("内存上限");
+    // m_spinBoxNice
+    m_spinBoxNice = new QSpinBox(m_widgetResourceLimits);
+    m_spinBoxNice->setRange(0, 19);
+    m_spinBoxNice->setPrefix("nice ");
+    m_spinBoxNice->setToolTip("调度优先级，越大优先级越低");
+    // m_comboBoxIoPriority
+    m_comboBoxIoPriority = new QComboBox(m_widgetResourceLimits);
+    m_comboBoxIoPriority->addItem("IO默认", 0);
+    m_comboBoxIoPriority->addItem("IO低优先级", 2);
+    m_comboBoxIoPriority->addItem("IO空闲时", 3);
+    // m_spinBoxMaxOpenFiles
+    m_spinBoxMaxOpenFiles = new QSpinBox(m_widgetResourceLimits);
+    m_spinBoxMaxOpenFiles->setRange(0, 1048576);
+    m_spinBoxMaxOpenFiles->setSpecialValueText("文件数不限");
+    m_spinBoxMaxOpenFiles->setToolTip("最大打开文件数");
+    // m_labelResourceUsage
+    m_labelResourceUsage = new QLabel("资源使用", this);
+    // m_lineEditResourceUsage
+    m_lineEditResourceUsage = new QLineEdit(this);
+    m_lineEditResourceUsage->setReadOnly(true);
+    m_lineEditResourceUsage->setPlaceholderText("未运行");
     // m_labelHost
     m_labelHost = new QLabel("Host", this);
     // m_lineEditHost
@@ -860,22 +982,47 @@ void WidgetMcpServerInfo::initLayout()
     gLayout->addWidget(m_comboBoxType, 4, 1);
     gLayout->addWidget(new QLabel("超时", this), 5, 0);
     gLayout->addWidget(m_spinBoxTimeout, 5, 1);
-    gLayout->addWidget(m_labelCommand, 6, 0);
-    gLayout->addWidget(m_lineEditCommand, 6, 1);
-    gLayout->addWidget(m_labelArgs, 7, 0);
-    gLayout->addWidget(m_plainTextEditArgs, 7, 1);
-    gLayout->addWidget(m_labelEnvVars, 8, 0);
-    gLayout->addWidget(m_plainTextEditEnvVars, 8, 1);
-    gLayout->addWidget(m_labelHost, 9, 0);
-    gLayout->addWidget(m_lineEditHost, 9, 1);
-    gLayout->addWidget(m_labelPort, 10, 0);
-    gLayout->addWidget(m_lineEditPort, 10, 1);
-    gLayout->addWidget(m_labelBaseUrl, 11, 0);
-    gLayout->addWidget(m_lineEditBaseUrl, 11, 1);
-    gLayout->addWidget(m_labelEndpoint, 12, 0);
-    gLayout->addWidget(m_lineEditEndpoint, 12, 1);
-    gLayout->addWidget(m_labelRequestHeaders, 13, 0);
-    gLayout->addWidget(m_plainTextEditRequestHeaders, 13, 1);
+    gLayout->addWidget(new QLabel("最大并发调用", this), 6, 0);
+    gLayout->addWidget(m_spinBoxMaxConcurrentCalls, 6, 1);
+    gLayout->addWidget(new QLabel("结果缓存", this), 7, 0);
+    gLayout->addWidget(m_spinBoxResultCacheTtl, 7, 1);
+    gLayout->addWidget(new QLabel("可缓存工具", this), 8, 0);
+    gLayout->addWidget(m_lineEditCacheableTools, 8, 1);
+    gLayout->addWidget(new QLabel("连接状态", this), 9, 0);
+    gLayout->addWidget(m_lineEditHealth, 9, 1);
+    gLayout->addWidget(m_labelCommand, 10, 0);
+    gLayout->addWidget(m_lineEditCommand, 10, 1);
+    gLayout->addWidget(m_labelArgs, 11, 0);
+    gLayout->addWidget(m_plainTextEditArgs, 11, 1);
+    gLayout->addWidget(m_labelEnvVars, 12, 0);
+    gLayout->addWidget(m_plainTextEditEnvVars, 12, 1);
+    gLayout->addWidget(m_labelMinReplicas, 13, 0);
+    gLayout->addWidget(m_spinBoxMinReplicas, 13, 1);
+    gLayout->addWidget(m_labelMaxReplicas, 14, 0);
+    gLayout->addWidget(m_spinBoxMaxReplicas, 14, 1);
+    gLayout->addWidget(m_labelIdleTimeout, 15, 0);
+    gLayout->addWidget(m_spinBoxIdleTimeout, 15, 1);
+    QHBoxLayout *hLayoutResourceLimits = new QHBoxLayout(m_widgetResourceLimits);
+    hLayoutResourceLimits->setContentsMargins(0, 0, 0, 0);
+    hLayoutResourceLimits->addWidget(m_spinBoxCpuQuota);
+    hLayoutResourceLimits->addWidget(m_spinBoxMemoryLimit);
+    hLayoutResourceLimits->addWidget(m_spinBoxNice);
+    hLayoutResourceLimits->addWidget(m_comboBoxIoPriority);
+    hLayoutResourceLimits->addWidget(m_spinBoxMaxOpenFiles);
+    gLayout->addWidget(m_labelResourceLimits, 16, 0);
+    gLayout->addWidget(m_widgetResourceLimits, 16, 1);
+    gLayout->addWidget(m_labelResourceUsage, 17, 0);
+    gLayout->addWidget(m_lineEditResourceUsage, 17, 1);
+    gLayout->addWidget(m_labelHost, 18, 0);
+    gLayout->addWidget(m_lineEditHost, 18, 1);
+    gLayout->addWidget(m_labelPort, 19, 0);
+    gLayout->addWidget(m_lineEditPort, 19, 1);
+    gLayout->addWidget(m_labelBaseUrl, 20, 0);
+    gLayout->addWidget(m_lineEditBaseUrl, 20, 1);
+    gLayout->addWidget(m_labelEndpoint, 21, 0);
+    gLayout->addWidget(m_lineEditEndpoint, 21, 1);
+    gLayout->addWidget(m_labelRequestHeaders, 22, 0);
+    gLayout->addWidget(m_plainTextEditRequestHeaders, 22, 1);
 }
 
 void WidgetMcpServerInfo::updateFormData(std::shared_ptr<McpServer> mcpServer)
@@ -888,6 +1035,9 @@ void WidgetMcpServerInfo::updateFormData(std::shared_ptr<McpServer> mcpServer)
     m_plainTextEditDescription->setPlainText(mcpServer->description);
     m_comboBoxType->setCurrentIndex(mcpServer->type);
     m_spinBoxTimeout->setValue(mcpServer->timeout);
+    m_spinBoxMaxConcurrentCalls->setValue(mcpServer->maxConcurrentCalls);
+    m_spinBoxResultCacheTtl->setValue(mcpServer->resultCacheTtl);
+    m_lineEditCacheableTools->setText(QStringList(mcpServer->cacheableTools.begin(), mcpServer->cacheableTools.end()).join(", "));
     m_lineEditCommand->setText(mcpServer->command);
     QString strAgrs;
     for (const QString &arg : mcpServer->args)
@@ -901,11 +1051,20 @@ void WidgetMcpServerInfo::updateFormData(std::shared_ptr<McpServer> mcpServer)
         strEnvVars.append(it.key()).append("=").append(it.value()).append("\n");
     }
     m_plainTextEditEnvVars->setPlainText(strEnvVars);
+    m_spinBoxMinReplicas->setValue(mcpServer->minReplicas);
+    m_spinBoxMaxReplicas->setValue(mcpServer->maxReplicas);
+    m_spinBoxIdleTimeout->setValue(mcpServer->idleTimeout);
+    m_spinBoxCpuQuota->setValue(mcpServer->cpuQuotaPercent);
+    m_spinBoxMemoryLimit->setValue(mcpServer->memoryLimitMB);
+    m_spinBoxNice->setValue(mcpServer->niceValue);
+    m_comboBoxIoPriority->setCurrentIndex(qMax(0, m_comboBoxIoPriority->findData(mcpServer->ioPriorityClass)));
+    m_spinBoxMaxOpenFiles->setValue(mcpServer->maxOpenFiles);
     m_lineEditHost->setText(mcpServer->host);
     m_lineEditPort->setText(QString::number(mcpServer->port));
     m_lineEditBaseUrl->setText(mcpServer->baseUrl);
     m_lineEditEndpoint->setText(mcpServer->endpoint);
     m_plainTextEditRequestHeaders->setPlainText(mcpServer->requestHeaders);
+    updateHealthInfo();
 }
 
 void WidgetMcpServerInfo::clearFormData()
@@ -916,9 +1075,23 @@ void WidgetMcpServerInfo::clearFormData()
     m_plainTextEditDescription->setPlainText("");
     m_comboBoxType->setCurrentIndex(0);
     m_spinBoxTimeout->setValue(0);
+    m_spinBoxMaxConcurrentCalls->setValue(4);
+    m_spinBoxResultCacheTtl->setValue(60);
+    m_lineEditCacheableTools->setText("");
+    m_lineEditHealth->setText("");
+    m_lineEditHealth->setToolTip("");
     m_lineEditCommand->setText("");
     m_plainTextEditArgs->setPlainText("");
     m_plainTextEditEnvVars->setPlainText("");
+    m_spinBoxMinReplicas->setValue(1);
+    m_spinBoxMaxReplicas->setValue(1);
+    m_spinBoxIdleTimeout->setValue(0);
+    m_spinBoxCpuQuota->setValue(0);
+    m_spinBoxMemoryLimit->setValue(0);
+    m_spinBoxNice->setValue(0);
+    m_comboBoxIoPriority->setCurrentIndex(0);
+    m_spinBoxMaxOpenFiles->setValue(0);
+    m_lineEditResourceUsage->setText("");
     m_lineEditHost->setText("");
     m_lineEditPort->setText("");
     m_lineEditBaseUrl->setText("");
@@ -935,6 +1108,15 @@ std::shared_ptr<McpServer> WidgetMcpServerInfo::getCurrentData()
     mcpServer->description = m_plainTextEditDescription->toPlainText();
     mcpServer->type = static_cast<McpServer::Type>(m_comboBoxType->currentIndex());
     mcpServer->timeout = m_spinBoxTimeout->value();
+    mcpServer->maxConcurrentCalls = m_spinBoxMaxConcurrentCalls->value();
+    mcpServer->resultCacheTtl = m_spinBoxResultCacheTtl->value();
+    mcpServer->cacheableTools.clear();
+    QStringList cacheableToolList = m_lineEditCacheableTools->text().split(',', Qt::SkipEmptyParts);
+    for (const QString &toolName : cacheableToolList)
+    {
+        if (!toolName.trimmed().isEmpty())
+            mcpServer->cacheableTools.append(toolName.trimmed());
+    }
     mcpServer->command = m_lineEditCommand->text();
 
     // 解析参数
@@ -963,6 +1145,15 @@ std::shared_ptr<McpServer> WidgetMcpServerInfo::getCurrentData()
         }
     }
 
+    mcpServer->minReplicas = m_spinBoxMinReplicas->value();
+    mcpServer->maxReplicas = qMax(mcpServer->minReplicas, m_spinBoxMaxReplicas->value());
+    mcpServer->idleTimeout = m_spinBoxIdleTimeout->value();
+    mcpServer->cpuQuotaPercent = m_spinBoxCpuQuota->value();
+    mcpServer->memoryLimitMB = m_spinBoxMemoryLimit->value();
+    mcpServer->niceValue = m_spinBoxNice->value();
+    mcpServer->ioPriorityClass = m_comboBoxIoPriority->currentData().toInt();
+    mcpServer->maxOpenFiles = m_spinBoxMaxOpenFiles->value();
+
     mcpServer->host = m_lineEditHost->text();
     mcpServer->port = m_lineEditPort->text().toInt();
     mcpServer->baseUrl = m_lineEditBaseUrl->text();
@@ -992,6 +1183,16 @@ void WidgetMcpServerInfo::slot_onComboBoxCurrentIndexChanged(int index)
         m_plainTextEditArgs->show();
         m_labelEnvVars->show();
         m_plainTextEditEnvVars->show();
+        m_labelMinReplicas->show();
+        m_spinBoxMinReplicas->show();
+        m_labelMaxReplicas->show();
+        m_spinBoxMaxReplicas->show();
+        m_labelIdleTimeout->show();
+        m_spinBoxIdleTimeout->show();
+        m_labelResourceLimits->show();
+        m_widgetResourceLimits->show();
+        m_labelResourceUsage->show();
+        m_lineEditResourceUsage->show();
         m_labelHost->hide();
         m_lineEditHost->hide();
         m_labelPort->hide();
@@ -1016,6 +1217,16 @@ void WidgetMcpServerInfo::slot_onComboBoxCurrentIndexChanged(int index)
         m_plainTextEditArgs->hide();
         m_labelEnvVars->hide();
         m_plainTextEditEnvVars->hide();
+        m_labelMinReplicas->hide();
+        m_spinBoxMinReplicas->hide();
+        m_labelMaxReplicas->hide();
+        m_spinBoxMaxReplicas->hide();
+        m_labelIdleTimeout->hide();
+        m_spinBoxIdleTimeout->hide();
+        m_labelResourceLimits->hide();
+        m_widgetResourceLimits->hide();
+        m_labelResourceUsage->hide();
+        m_lineEditResourceUsage->hide();
         m_labelHost->show();
         m_lineEditHost->show();
         m_labelPort->show();
@@ -1032,6 +1243,102 @@ void WidgetMcpServerInfo::slot_onComboBoxCurrentIndexChanged(int index)
     ToastManager::showMessage(Toast::Type::Error, QString("不存在的MCP服务器类型 (type=%1)").arg(m_comboBoxType->currentText()));
 }
 
+void WidgetMcpServerInfo::slot_onServerHealthChanged(const QString &serverUuid)
+{
+    if (serverUuid == m_lineEditUuid->text())
+        updateHealthInfo();
+}
+
+void WidgetMcpServerInfo::updateHealthInfo()
+{
+    QString serverUuid = m_lineEditUuid->text();
+    if (serverUuid.isEmpty() || !MCPService::getInstance()->isInitialized(serverUuid))
+    {
+        m_lineEditHealth->setText("");
+        m_lineEditHealth->setToolTip("");
+        return;
+    }
+    MCPServerHealth health = MCPService::getInstance()->getServerHealth(serverUuid);
+    QString text;
+    switch (health.state)
+    {
+    case MCPServerHealth::Healthy:
+        text = "正常";
+        if (health.latencyMs >= 0)
+            text.append(QString(" | 延迟: %1ms").arg(health.latencyMs));
+        break;
+    case MCPServerHealth::Unhealthy:
+        text = QString("不可用 | 重连时间: %1").arg(health.nextReconnectTime.toString("hh:mm:ss"));
+        break;
+    case MCPServerHealth::Reconnecting:
+        text = "正在重连";
+        break;
+    case MCPServerHealth::Suspended:
+        text = "已休眠(空闲关闭)";
+        break;
+    default:
+        text = "未检测";
+        break;
+    }
+    if (health.consecutiveFailures > 0)
+        text.append(QString(" | 连续失败: %1").arg(health.consecutiveFailures));
+    text.append(QString(" | 重连次数: %1").arg(health.reconnectCount));
+    if (m_spinBoxMaxReplicas->value() > 1)
+        text.append(QString(" | 进程数: %1").arg(MCPService::getInstance()->getReplicaCount(serverUuid)));
+    if (health.idleShutdownCount > 0)
+        text.append(QString(" | 空闲关闭: %1次, 回收内存: %2MB").arg(health.idleShutdownCount).arg(health.reclaimedMemoryBytes / 1048576.0, 0, 'f', 1));
+    if (health.relaunchCount > 0)
+        text.append(QString(" | 平均重启耗时: %1ms").arg(health.totalRelaunchLatencyMs / health.relaunchCount));
+    if (health.rejectedToolCalls > 0)
+        text.append(QString(" | 参数校验拦截: %1次").arg(health.rejectedToolCalls));
+    MCPCallQueueMetrics queueMetrics = MCPService::getInstance()->getCallQueueMetrics(serverUuid);
+    if (queueMetrics.dispatchedCalls > 0 || queueMetrics.queueLength > 0)
+        text.append(QString(" | 调用: %1/%2, 排队: %3, 平均等待: %4ms(最长%5ms)")
+                        .arg(queueMetrics.inFlight)
+                        .arg(queueMetrics.maxInFlight)
+                        .arg(queueMetrics.queueLength)
+                        .arg(queueMetrics.averageWaitMs(), 0, 'f', 1)
+                        .arg(queueMetrics.maxWaitMs));
+    MCPToolCacheStats cacheStats = MCPService::getInstance()->getToolCacheStats(serverUuid);
+    if (cacheStats.hits + cacheStats.misses > 0)
+        text.append(QString(" | 缓存命中率: %1%, 节省: %2ms").arg(cacheStats.hitRate() * 100, 0, 'f', 1).arg(cacheStats.timeSavedMs));
+    m_lineEditHealth->setText(text);
+    m_lineEditHealth->setToolTip(health.lastError);
+}
+
+void WidgetMcpServerInfo::updateResourceUsage()
+{
+    if (!isVisible() || !m_lineEditResourceUsage->isVisible())
+        return;
+    QString serverUuid = m_lineEditUuid->text();
+    MCPProcessUsage usage = serverUuid.isEmpty() ? MCPProcessUsage() : MCPService::getInstance()->getResourceUsage(serverUuid);
+    if (usage.processCount == 0)
+    {
+        m_lineEditResourceUsage->setText("");
+        m_lineEditResourceUsage->setToolTip("");
+        return;
+    }
+    // CPU占用率根据两次采样之间的CPU时间计算
+    QString cpuText("-");
+    if (m_resourceUsageServerUuid == serverUuid && m_resourceUsageTimer.isValid() && m_resourceUsageTimer.elapsed() > 0)
+    {
+        double cpuPercent = qMax<qint64>(0, usage.cpuTimeMs - m_lastCpuTimeMs) * 100.0 / m_resourceUsageTimer.elapsed();
+        cpuText = QString("%1%").arg(cpuPercent, 0, 'f', 1);
+    }
+    m_resourceUsageServerUuid = serverUuid;
+    m_lastCpuTimeMs = usage.cpuTimeMs;
+    m_resourceUsageTimer.restart();
+    m_lineEditResourceUsage->setText(QString("CPU: %1 | CPU时间: %2s | 内存: %3MB | 峰值: %4MB | 进程: %5%6")
+                                         .arg(cpuText)
+                                         .arg(usage.cpuTimeMs / 1000.0, 0, 'f', 1)
+                                         .arg(usage.residentMemoryBytes / 1048576.0, 0, 'f', 1)
+                                         .arg(usage.peakResidentMemoryBytes / 1048576.0, 0, 'f', 1)
+                                         .arg(usage.processCount)
+                                         .arg(usage.cgroupCount > 0 ? QString(" (cgroup: %1)").arg(usage.cgroupCount) : QString()) +
+                                     (usage.limitsError.isEmpty() ? QString() : QString(" | 限制未完全生效: %1").arg(usage.limitsError)));
+    m_lineEditResourceUsage->setToolTip(usage.limitsError);
+}
+
 // DialogMountMcpServer
 DialogMountMcpServer::DialogMountMcpServer(std::shared_ptr<QSet<QString>> mountedMCPServerUuidsPtr, QWidget *parent, Qt::WindowFlags f)
     : BaseDialog(parent, f), m_mountedMCPServerUuidsPtr(mountedMCPServerUuidsPtr)
@@ -1168,6 +1475,14 @@ PageSettingsStorage::PageSettingsStorage(QWidget *parent)
     connect(DataManager::getInstance(), &DataManager::sig_LLMsFilePathChange, this, &PageSettingsStorage::slot_onFilePathChangedLLMs);
     connect(DataManager::getInstance(), &DataManager::sig_agentsFilePathChange, this, &PageSettingsStorage::slot_onFilePathChangedAgents);
     connect(DataManager::getInstance(), &DataManager::sig_mcpServersFilePathChange, this, &PageSettingsStorage::slot_onFilePathChangedMcpServers);
+    connect(DataBaseManager::getInstance()->getWorkerPtr(), &DataBaseWorker::sig_maintenanceFinished, this, &PageSettingsStorage::slot_onMaintenanceFinished, Qt::QueuedConnection);
+    connect(DataBaseManager::getInstance()->getWorkerPtr(), &DataBaseWorker::sig_incrementalVacuumEnabled, this, &PageSettingsStorage::slot_onIncrementalVacuumEnabled, Qt::QueuedConnection);
+    // 定时刷新后台线程池与数据库写入状态
+    QTimer *timerMetrics = new QTimer(this);
+    timerMetrics->setInterval(2000);
+    connect(timerMetrics, &QTimer::timeout, this, &PageSettingsStorage::updateExecutorMetrics);
+    connect(timerMetrics, &QTimer::timeout, this, &PageSettingsStorage::updateWriteStats);
+    timerMetrics->start();
 }
 
 void PageSettingsStorage::initWidget()
@@ -1221,6 +1536,37 @@ void PageSettingsStorage::initItems()
                     XLC_LOG_DEBUG("Setting MCP server file path (fileName={})", fileName);
                 }
             });
+    // m_lineEditMaintenance
+    m_lineEditMaintenance = new QLineEdit(this);
+    m_lineEditMaintenance->setReadOnly(true);
+    m_lineEditMaintenance->setPlaceholderText("尚未执行维护(启动后自动执行，之后每30分钟一次)");
+    // m_pushButtonRunMaintenance
+    m_pushButtonRunMaintenance = new QPushButton("立即维护", this);
+    connect(m_pushButtonRunMaintenance, &QPushButton::clicked, DataBaseManager::getInstance(), &DataBaseManager::sig_runMaintenance);
+    // m_pushButtonEnableIncrementalVacuum
+    m_pushButtonEnableIncrementalVacuum = new QPushButton("开启空间回收", this);
+    m_pushButtonEnableIncrementalVacuum->setToolTip("将数据库转换为增量 auto_vacuum，之后维护时会把空闲页归还给文件系统");
+    connect(m_pushButtonEnableIncrementalVacuum, &QPushButton::clicked, this,
+            [this]()
+            {
+                if (QMessageBox::question(this, "开启空间回收", "需要重写整个数据库文件(约需要数据库两倍大小的磁盘空间)，期间无法保存新消息。是否继续？") != QMessageBox::Yes)
+                    return;
+                m_pushButtonEnableIncrementalVacuum->setEnabled(false);
+                Q_EMIT DataBaseManager::getInstance()->sig_enableIncrementalVacuum();
+            });
+    // m_lineEditExecutor
+    m_lineEditExecutor = new QLineEdit(this);
+    m_lineEditExecutor->setReadOnly(true);
+    m_lineEditExecutor->setToolTip("加载与保存配置、MCP工具调用等后台任务所在线程池的 执行中/最大线程数、排队任务数与平均排队等待时间");
+    // m_lineEditWriteStats
+    m_lineEditWriteStats = new QLineEdit(this);
+    m_lineEditWriteStats->setReadOnly(true);
+    m_lineEditWriteStats->setToolTip("本次运行中等待写入的消息数、事务提交次数与提交耗时");
+    // m_lineEditContentSavings
+    m_lineEditContentSavings = new QLineEdit(this);
+    m_lineEditContentSavings->setReadOnly(true);
+    m_lineEditContentSavings->setPlaceholderText("本次运行尚未写入消息");
+    m_lineEditContentSavings->setToolTip("本次运行写入的消息内容原始大小(UTF-8)与压缩、去重后实际保存的大小；去重为与已保存内容相同、只增加引用的消息数");
 }
 
 void PageSettingsStorage::initLayout()
@@ -1236,6 +1582,16 @@ void PageSettingsStorage::initLayout()
     gLayoutStorage->addWidget(new QLabel("McpServers", this), 2, 0);
     gLayoutStorage->addWidget(m_lineEditFilePathMcpServers, 2, 1);
     gLayoutStorage->addWidget(m_pushButtonSelectFileMcpServers, 2, 2);
+    gLayoutStorage->addWidget(new QLabel("数据库维护", this), 3, 0);
+    gLayoutStorage->addWidget(m_lineEditMaintenance, 3, 1);
+    gLayoutStorage->addWidget(m_pushButtonRunMaintenance, 3, 2);
+    gLayoutStorage->addWidget(new QLabel("压缩与去重", this), 4, 0);
+    gLayoutStorage->addWidget(m_lineEditContentSavings, 4, 1);
+    gLayoutStorage->addWidget(m_pushButtonEnableIncrementalVacuum, 4, 2);
+    gLayoutStorage->addWidget(new QLabel("后台线程池", this), 5, 0);
+    gLayoutStorage->addWidget(m_lineEditExecutor, 5, 1, 1, 2);
+    gLayoutStorage->addWidget(new QLabel("数据库写入", this), 6, 0);
+    gLayoutStorage->addWidget(m_lineEditWriteStats, 6, 1, 1, 2);
     // groupBoxStorage
     QGroupBox *groupBoxStorage = new QGroupBox("存储设置", this);
     groupBoxStorage->setLayout(gLayoutStorage);
@@ -1245,6 +1601,50 @@ void PageSettingsStorage::initLayout()
     vLayout->addStretch();
 }
 
+void PageSettingsStorage::updateExecutorMetrics()
+{
+    if (!isVisible())
+        return;
+    const QPair<Executor::Pool, QString> pools[] = {{Executor::Pool::Interactive, "交互"},
+                                                    {Executor::Pool::IoBlocking, "阻塞"},
+                                                    {Executor::Pool::Background, "后台"}};
+    QStringList texts;
+    for (const QPair<Executor::Pool, QString> &pool : pools)
+    {
+        ExecutorPoolMetrics metrics = Executor::getInstance()->metrics(pool.first);
+        texts << QString("%1: %2/%3, 排队: %4(峰值%5), 平均等待: %6ms(最长%7ms)")
+                     .arg(pool.second)
+                     .arg(metrics.activeThreadCount)
+                     .arg(metrics.maxThreadCount)
+                     .arg(metrics.queuedTasks)
+                     .arg(metrics.peakQueuedTasks)
+                     .arg(metrics.averageQueueWaitMs(), 0, 'f', 1)
+                     .arg(metrics.maxQueueWaitMs);
+    }
+    m_lineEditExecutor->setText(texts.join(" | "));
+}
+
+void PageSettingsStorage::updateWriteStats()
+{
+    if (!isVisible())
+        return;
+    DataBaseWriteStats stats = DataBaseManager::getInstance()->getWriteStats();
+    m_lineEditWriteStats->setText(QString("排队: %1(峰值%2) | 提交: %3次, %4条消息 | 提交耗时: 最近%5ms, 平均%6ms")
+                                      .arg(stats.queueDepth)
+                                      .arg(stats.maxQueueDepth)
+                                      .arg(stats.commits)
+                                      .arg(stats.messagesWritten)
+                                      .arg(stats.lastCommitUs / 1000.0, 0, 'f', 1)
+                                      .arg(stats.commits > 0 ? stats.totalCommitUs / 1000.0 / stats.commits : 0.0, 0, 'f', 1));
+    if (stats.contentBytes > 0)
+        m_lineEditContentSavings->setText(QString("原始: %1MB | 实际保存: %2MB | 节省: %3MB(%4%) | 去重: %5条")
+                                              .arg(stats.contentBytes / 1048576.0, 0, 'f', 2)
+                                              .arg(stats.storedContentBytes / 1048576.0, 0, 'f', 2)
+                                              .arg((stats.contentBytes - stats.storedContentBytes) / 1048576.0, 0, 'f', 2)
+                                              .arg((stats.contentBytes - stats.storedContentBytes) * 100.0 / stats.contentBytes, 0, 'f', 1)
+                                              .arg(stats.deduplicatedBlobs));
+}
+
 void PageSettingsStorage::slot_onFilePathChangedLLMs(const QString &filePath)
 {
     if (filePath.isEmpty())
@@ -1266,6 +1666,30 @@ void PageSettingsStorage::slot_onFilePathChangedMcpServers(const QString &filePa
     m_lineEditFilePathMcpServers->setText(QFileInfo(filePath).absoluteFilePath());
 }
 
+void PageSettingsStorage::slot_onMaintenanceFinished(DataBaseMaintenanceReport report)
+{
+    QString text = QString("%1 | 孤立消息: %2 | 未引用blobs: %3 | 释放: %4KB | 空闲: %5KB | 最长一批: %6ms")
+                       .arg(QTime::currentTime().toString("hh:mm:ss"))
+                       .arg(report.orphanMessages)
+                       .arg(report.collectedBlobs)
+                       .arg((report.fileBytesBefore - report.fileBytesAfter) / 1024)
+                       .arg(report.freeBytesAfter / 1024)
+                       .arg(report.longestStepMs);
+    if (!report.incrementalVacuum)
+        text.append(" | 未开启空间回收");
+    m_lineEditMaintenance->setText(text);
+    m_pushButtonEnableIncrementalVacuum->setEnabled(!report.incrementalVacuum);
+}
+
+void PageSettingsStorage::slot_onIncrementalVacuumEnabled(bool success, qint64 bytesBefore, qint64 bytesAfter)
+{
+    m_pushButtonEnableIncrementalVacuum->setEnabled(!success);
+    if (success)
+        ToastManager::showMessage(Toast::Type::Success, QString("已开启空间回收，数据库大小: %1KB -> %2KB").arg(bytesBefore / 1024).arg(bytesAfter / 1024));
+    else
+        ToastManager::showMessage(Toast::Type::Warning, "开启空间回收失败，详见日志");
+}
+
 // PageSettingsDisplay
 
 PageSettingsDisplay::PageSettingsDisplay(QWidget *parent)
@@ -0,0 +1,66 @@
+#include "ToolResultStore.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include "Logger.hpp"
+
+QString ToolResultStore::put(const QByteArray &data, const QString &suffix)
+{
+    QString id = QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex());
+    QMutexLocker locker(&m_mutex);
+    QDir dir(directoryOf(id));
+    // 内容相同的数据已经保存过
+    if (!dir.entryList(QStringList(id + "*"), QDir::Files).isEmpty())
+        return id;
+    if (!dir.mkpath("."))
+    {
+        XLC_LOG_WARN("Store tool result failed (id={}): cannot create directory {}", id, dir.absolutePath());
+        return QString();
+    }
+    QString fileName = suffix.isEmpty() ? id : id + "." + suffix;
+    QSaveFile file(dir.filePath(fileName));
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit())
+    {
+        XLC_LOG_WARN("Store tool result failed (id={}): {}", id, file.errorString());
+        return QString();
+    }
+    XLC_LOG_DEBUG("Stored tool result (id={}, bytes={})", id, data.size());
+    return id;
+}
+
+QByteArray ToolResultStore::get(const QString &id) const
+{
+    QString path = filePath(id);
+    if (path.isEmpty())
+        return QByteArray();
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        XLC_LOG_WARN("Read tool result failed (id={}): {}", id, file.errorString());
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+bool ToolResultStore::contains(const QString &id) const
+{
+    return !filePath(id).isEmpty();
+}
+
+QString ToolResultStore::filePath(const QString &id) const
+{
+    if (id.size() < 2)
+        return QString();
+    QMutexLocker locker(&m_mutex);
+    QDir dir(directoryOf(id));
+    QStringList files = dir.entryList(QStringList(id + "*"), QDir::Files);
+    if (files.isEmpty())
+        return QString();
+    return dir.filePath(files.first());
+}
+
+QString ToolResultStore::directoryOf(const QString &id) const
+{
+    return STORE_DIRECTORY + "/" + id.left(2);
+}
@@ -0,0 +1,174 @@
+#include "ToolRetriever.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QHash>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const QSet<QString> STOP_WORDS = {"the", "an", "to", "of", "and", "or", "for", "in", "is", "on", "with", "this", "that",
+                                      "be", "by", "it", "as", "are", "from", "at", "if", "not", "can", "will", "you", "me"};
+
+    bool isHan(QChar ch)
+    {
+        return ch.script() == QChar::Script_Han;
+    }
+} // namespace
+
+qint64 ToolSelectionStats::savedBytes() const
+{
+    return fullBytes - selectedBytes;
+}
+
+ToolSelectionStats &ToolSelectionStats::operator+=(const ToolSelectionStats &other)
+{
+    requests += other.requests;
+    totalTools += other.totalTools;
+    selectedTools += other.selectedTools;
+    fullBytes += other.fullBytes;
+    selectedBytes += other.selectedBytes;
+    return *this;
+}
+
+QStringList ToolRetriever::tokenize(const QString &text)
+{
+    QStringList tokens;
+    QString word;
+    auto flushWord = [&tokens, &word]()
+    {
+        if (word.size() >= 2 && !STOP_WORDS.contains(word))
+            tokens.append(word);
+        word.clear();
+    };
+    QChar previousHan;
+    for (int i = 0; i < text.size(); ++i)
+    {
+        QChar ch = text.at(i);
+        if (isHan(ch))
+        {
+            flushWord();
+            // 中文没有分隔符，同时使用单字和相邻两字
+            tokens.append(QString(ch));
+            if (!previousHan.isNull())
+                tokens.append(QString(previousHan) + ch);
+            previousHan = ch;
+            continue;
+        }
+        previousHan = QChar();
+        if (!ch.isLetterOrNumber())
+        {
+            flushWord();
+            continue;
+        }
+        // 驼峰命名: listDirectory -> list directory
+        if (ch.isUpper() && !word.isEmpty() && i > 0 && text.at(i - 1).isLower())
+            flushWord();
+        word.append(ch.toLower());
+    }
+    flushWord();
+    return tokens;
+}
+
+QStringList ToolRetriever::toolTerms(const QJsonObject &jsonObjTool)
+{
+    QJsonObject jsonObjFunction = jsonObjTool.value("function").toObject();
+    QStringList nameTerms = tokenize(jsonObjFunction.value("name").toString());
+    QStringList terms = nameTerms + nameTerms;
+    terms += tokenize(jsonObjFunction.value("description").toString());
+    QJsonObject jsonObjProperties = jsonObjFunction.value("parameters").toObject().value("properties").toObject();
+    for (auto it = jsonObjProperties.constBegin(); it != jsonObjProperties.constEnd(); ++it)
+    {
+        terms += tokenize(it.key());
+        terms += tokenize(it.value().toObject().value("description").toString());
+    }
+    return terms;
+}
+
+QJsonArray ToolRetriever::selectTools(const QJsonArray &jsonArrayTools,
+                                      const QString &query,
+                                      const QString &context,
+                                      const QSet<QString> &pinnedToolNames,
+                                      int topK,
+                                      ToolSelectionStats *stats)
+{
+    const int toolCount = jsonArrayTools.size();
+
+    // 查询词权重，同一个词取最高权重
+    QHash<QString, double> queryWeights;
+    for (const QString &term : tokenize(context))
+        queryWeights.insert(term, CONTEXT_WEIGHT);
+    for (const QString &term : tokenize(query))
+        queryWeights.insert(term, 1.0);
+
+    // 统计词频与文档频率
+    QVector<QHash<QString, int>> termFrequencies(toolCount);
+    QVector<int> documentLengths(toolCount, 0);
+    QHash<QString, int> documentFrequencies;
+    qint64 totalLength = 0;
+    for (int i = 0; i < toolCount; ++i)
+    {
+        QStringList terms = toolTerms(jsonArrayTools.at(i).toObject());
+        documentLengths[i] = terms.size();
+        totalLength += terms.size();
+        for (const QString &term : terms)
+            termFrequencies[i][term] += 1;
+        for (auto it = termFrequencies[i].constBegin(); it != termFrequencies[i].constEnd(); ++it)
+        {
+            if (queryWeights.contains(it.key()))
+                documentFrequencies[it.key()] += 1;
+        }
+    }
+    const double averageLength = toolCount > 0 ? qMax(1.0, static_cast<double>(totalLength) / toolCount) : 1.0;
+
+    // BM25 打分
+    QVector<QPair<double, int>> scores;
+    QVector<bool> selected(toolCount, false);
+    for (int i = 0; i < toolCount; ++i)
+    {
+        QString name = jsonArrayTools.at(i).toObject().value("function").toObject().value("name").toString();
+        if (pinnedToolNames.contains(name))
+        {
+            selected[i] = true;
+            continue;
+        }
+        double score = 0.0;
+        for (auto it = queryWeights.constBegin(); it != queryWeights.constEnd(); ++it)
+        {
+            int tf = termFrequencies[i].value(it.key());
+            if (tf == 0)
+                continue;
+            int df = documentFrequencies.value(it.key());
+            double idf = std::log(1.0 + (toolCount - df + 0.5) / (df + 0.5));
+            double norm = tf + BM25_K1 * (1.0 - BM25_B + BM25_B * documentLengths[i] / averageLength);
+            score += it.value() * idf * (tf * (BM25_K1 + 1.0)) / norm;
+        }
+        scores.append(qMakePair(score, i));
+    }
+    // 分数相同时保持原顺序
+    std::stable_sort(scores.begin(), scores.end(),
+                     [](const QPair<double, int> &a, const QPair<double, int> &b)
+                     {
+                         return a.first > b.first;
+                     });
+    for (int i = 0; i < scores.size() && i < topK; ++i)
+        selected[scores.at(i).second] = true;
+
+    QJsonArray jsonArraySelected;
+    for (int i = 0; i < toolCount; ++i)
+    {
+        if (selected.at(i))
+            jsonArraySelected.append(jsonArrayTools.at(i));
+    }
+
+    if (stats)
+    {
+        stats->requests = 1;
+        stats->totalTools = toolCount;
+        stats->selectedTools = jsonArraySelected.size();
+        stats->fullBytes = QJsonDocument(jsonArrayTools).toJson(QJsonDocument::Compact).size();
+        stats->selectedBytes = QJsonDocument(jsonArraySelected).toJson(QJsonDocument::Compact).size();
+    }
+    return jsonArraySelected;
+}
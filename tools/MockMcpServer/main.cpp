@@ -0,0 +1,471 @@
+/**
+ * 用于基准测试的模拟 MCP 服务器(stdio / streamable HTTP)
+ *
+ * 工具数量、schema 大小、调用延迟分布、返回内容的类型与大小、失败方式均可配置，
+ * 相同的 --seed 下每次运行的行为一致，便于区分 MCPService 自身的开销与真实工具的耗时。
+ *
+ * 示例:
+ *     stdio:  MockMcpServer --tools 1000 --schema-props 8 --latency fixed:0
+ *     http:   MockMcpServer --transport http --port 8931 --latency normal:20,5 --payload image:65536
+ *     失败:   MockMcpServer --failure-rate 0.1 --failure-mode tool-error
+ *
+ * 在设置页面添加 stdio 服务器时，命令填写 MockMcpServer 的路径，参数填写上面的选项(每行一个)。
+ * 所有工具名称都以 mock_tool_ 开头，基准测试(MCPBenchmark)按此前缀识别模拟服务器。
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QTimer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QHash>
+#include <QPointer>
+#include <QUuid>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+static const char *PROTOCOL_VERSION = "2025-03-26";
+static const char *TOOL_NAME_PREFIX = "mock_tool_";
+
+struct MockOptions
+{
+    int tools = 10;              // 工具数量
+    int pageSize = 0;            // tools/list 每页工具数量，0 代表不分页
+    int schemaProps = 4;         // 每个工具 inputSchema 中的参数数量
+    int descriptionChars = 80;   // 工具与参数描述的字符数
+    QString latency = "fixed:0"; // 调用延迟分布(毫秒)
+    QString payload = "text:256"; // 返回内容(字节)
+    double failureRate = 0;      // 失败概率 0-1
+    QString failureMode = "error";
+    quint32 seed = 0;
+};
+
+class MockMcpServer
+{
+public:
+    // 写出一条响应(由传输层实现)
+    using Responder = std::function<void(const QByteArray &response)>;
+
+    explicit MockMcpServer(const MockOptions &options)
+        : m_options(options), m_rng(options.seed)
+    {
+    }
+
+    // 解析延迟分布与返回内容，预先生成工具列表与返回数据，参数错误时返回 false
+    bool initialize(QString *errorMessage)
+    {
+        QStringList latency = m_options.latency.split(':');
+        m_latencyKind = latency.value(0);
+        for (const QString &value : latency.value(1).split(',', Qt::SkipEmptyParts))
+            m_latencyValues.append(value.toDouble());
+        const QStringList latencyKinds = {"fixed", "uniform", "normal", "exponential"};
+        const int requiredValues = m_latencyKind == "fixed" || m_latencyKind == "exponential" ? 1 : 2;
+        if (!latencyKinds.contains(m_latencyKind) || (m_latencyKind != "fixed" && m_latencyValues.size() < requiredValues))
+        {
+            *errorMessage = QString("unknown latency distribution: %1").arg(m_options.latency);
+            return false;
+        }
+        // 预先生成返回内容，调用时不计入生成数据的耗时
+        std::mt19937 dataRng(m_options.seed + 1);
+        for (const QString &part : m_options.payload.split('+'))
+        {
+            Payload payload;
+            payload.kind = part.section(':', 0, 0);
+            if (payload.kind != "text" && payload.kind != "image" && payload.kind != "audio" && payload.kind != "mixed")
+            {
+                *errorMessage = QString("unknown payload type: %1").arg(part);
+                return false;
+            }
+            QByteArray raw(part.section(':', 1, 1).toInt(), Qt::Uninitialized);
+            for (int i = 0; i < raw.size(); ++i)
+                raw[i] = static_cast<char>(dataRng() & 0xFF);
+            payload.text.reserve(raw.size());
+            for (char byte : raw)
+                payload.text.append(QChar('a' + static_cast<uchar>(byte) % 26));
+            payload.data = QString::fromLatin1(raw.toBase64());
+            m_payloads.append(payload);
+        }
+        for (int i = 0; i < m_options.tools; ++i)
+            m_tools.append(buildTool(i));
+        return true;
+    }
+
+    // 处理一条 JSON-RPC 消息，响应通过 respond 返回(有延迟时在延迟结束后)，通知不响应；返回是否会调用 respond
+    bool handle(const QByteArray &body, Responder respond)
+    {
+        QJsonParseError parseError;
+        QJsonDocument document = QJsonDocument::fromJson(body, &parseError);
+        if (parseError.error != QJsonParseError::NoError || !document.isObject())
+        {
+            respond(encode(error(QJsonValue::Null, -32700, "Parse error")));
+            return true;
+        }
+        QJsonObject message = document.object();
+        const QString method = message.value("method").toString();
+        const QJsonValue id = message.value("id");
+        const QJsonObject params = message.value("params").toObject();
+        if (id.isUndefined() || id.isNull())
+            return false;
+        if (method == "initialize")
+        {
+            respond(encode(result(id, QJsonObject({{"protocolVersion", PROTOCOL_VERSION},
+                                                   {"capabilities", QJsonObject({{"tools", QJsonObject({{"listChanged", false}})}})},
+                                                   {"serverInfo", QJsonObject({{"name", "xlc-mock-mcp-server"}, {"version", "1.0.0"}})}}))));
+            return true;
+        }
+        if (method == "ping")
+        {
+            respond(encode(result(id, QJsonObject())));
+            return true;
+        }
+        if (method == "tools/list")
+        {
+            respond(encode(result(id, listTools(params))));
+            return true;
+        }
+        if (method == "tools/call")
+            return callTool(id, params, respond);
+        respond(encode(error(id, -32601, QString("Method not found: %1").arg(method))));
+        return true;
+    }
+
+private:
+    struct Payload
+    {
+        QString kind;
+        QString text; // text 类型的内容
+        QString data; // image、audio 类型的内容(base64)
+    };
+
+    QJsonObject buildTool(int index) const
+    {
+        QJsonObject jsonObjProperties;
+        for (int p = 0; p < m_options.schemaProps; ++p)
+        {
+            jsonObjProperties.insert(QString("arg%1").arg(p),
+                                     QJsonObject({{"type", p % 2 == 0 ? "string" : "integer"},
+                                                  {"description", QString("Argument %1. ").arg(p).leftJustified(m_options.descriptionChars, 'y')}}));
+        }
+        return QJsonObject({{"name", QString("%1%2").arg(TOOL_NAME_PREFIX).arg(index)},
+                            {"description", QString("Mock tool %1 for benchmarks. ").arg(index).leftJustified(m_options.descriptionChars, 'x')},
+                            {"inputSchema", QJsonObject({{"type", "object"}, {"properties", jsonObjProperties}, {"required", QJsonArray()}})}});
+    }
+
+    QJsonObject listTools(const QJsonObject &params) const
+    {
+        if (m_options.pageSize <= 0)
+            return QJsonObject({{"tools", m_tools}});
+        const int start = params.value("cursor").toString().toInt();
+        const int end = start + m_options.pageSize;
+        QJsonArray jsonArrayTools;
+        for (int i = start; i < end && i < m_tools.size(); ++i)
+            jsonArrayTools.append(m_tools.at(i));
+        QJsonObject jsonObjResult({{"tools", jsonArrayTools}});
+        if (end < m_tools.size())
+            jsonObjResult.insert("nextCursor", QString::number(end));
+        return jsonObjResult;
+    }
+
+    bool callTool(const QJsonValue &id, const QJsonObject &params, Responder respond)
+    {
+        const QString name = params.value("name").toString();
+        bool isNumber = false;
+        const int index = name.mid(static_cast<int>(strlen(TOOL_NAME_PREFIX))).toInt(&isNumber);
+        if (!name.startsWith(TOOL_NAME_PREFIX) || !isNumber || index < 0 || index >= m_tools.size())
+        {
+            respond(encode(error(id, -32602, QString("Unknown tool: %1").arg(name))));
+            return true;
+        }
+        m_callCount += 1;
+        const double failure = std::uniform_real_distribution<double>(0, 1)(m_rng);
+        const int delayMs = static_cast<int>(nextLatencyMs());
+        QByteArray response;
+        if (failure < m_options.failureRate)
+        {
+            if (m_options.failureMode == "timeout")
+                return false;
+            if (m_options.failureMode == "crash")
+            {
+                std::fputs("mock server crashing on purpose\n", stderr);
+                std::fflush(stderr);
+                std::_Exit(1);
+            }
+            if (m_options.failureMode == "malformed")
+            {
+                // 截断的响应，id 按 JSON 格式写出(去掉数组的方括号)
+                QByteArray jsonId = QJsonDocument(QJsonArray({id})).toJson(QJsonDocument::Compact);
+                response = "{\"jsonrpc\": \"2.0\", \"id\": " + jsonId.mid(1, jsonId.size() - 2) + ", \"result\": ";
+            }
+            else if (m_options.failureMode == "tool-error")
+                response = encode(result(id, QJsonObject({{"content", QJsonArray({QJsonObject({{"type", "text"}, {"text", "mock tool failed"}})})}, {"isError", true}})));
+            else
+                response = encode(error(id, -32000, "mock server error"));
+        }
+        else
+        {
+            response = encode(result(id, QJsonObject({{"content", buildContent()}, {"isError", false}})));
+        }
+        // 有延迟的调用由定时器返回，并发调用互不阻塞
+        if (delayMs > 0)
+            QTimer::singleShot(delayMs, [respond, response]() { respond(response); });
+        else
+            respond(response);
+        return true;
+    }
+
+    QJsonArray buildContent() const
+    {
+        QJsonArray content;
+        for (const Payload &payload : m_payloads)
+        {
+            QString kind = payload.kind;
+            if (kind == "mixed")
+                kind = QStringList({"text", "image", "audio"}).at(m_callCount % 3);
+            if (kind == "text")
+                content.append(QJsonObject({{"type", "text"}, {"text", payload.text}}));
+            else if (kind == "image")
+                content.append(QJsonObject({{"type", "image"}, {"data", payload.data}, {"mimeType", "image/png"}}));
+            else
+                content.append(QJsonObject({{"type", "audio"}, {"data", payload.data}, {"mimeType", "audio/wav"}}));
+        }
+        return content;
+    }
+
+    // 按 --latency 指定的分布生成一次调用的延迟，单位: 毫秒(ms)
+    double nextLatencyMs()
+    {
+        if (m_latencyKind == "uniform")
+            return std::uniform_real_distribution<double>(m_latencyValues.at(0), m_latencyValues.at(1))(m_rng);
+        if (m_latencyKind == "normal")
+            return qMax(0.0, std::normal_distribution<double>(m_latencyValues.at(0), m_latencyValues.at(1))(m_rng));
+        if (m_latencyKind == "exponential")
+            return m_latencyValues.at(0) > 0 ? std::exponential_distribution<double>(1.0 / m_latencyValues.at(0))(m_rng) : 0.0;
+        return m_latencyValues.value(0, 0);
+    }
+
+    static QJsonObject result(const QJsonValue &id, const QJsonObject &result)
+    {
+        return QJsonObject({{"jsonrpc", "2.0"}, {"id", id}, {"result", result}});
+    }
+
+    static QJsonObject error(const QJsonValue &id, int code, const QString &message)
+    {
+        return QJsonObject({{"jsonrpc", "2.0"}, {"id", id}, {"error", QJsonObject({{"code", code}, {"message", message}})}});
+    }
+
+    static QByteArray encode(const QJsonObject &jsonObject)
+    {
+        return QJsonDocument(jsonObject).toJson(QJsonDocument::Compact);
+    }
+
+private:
+    MockOptions m_options;
+    std::mt19937 m_rng;
+    QString m_latencyKind;
+    QVector<double> m_latencyValues;
+    QVector<Payload> m_payloads;
+    QJsonArray m_tools;
+    int m_callCount = 0;
+};
+
+// 标准输入在单独的线程中按行读取，在主线程处理；标准输入关闭后写出尚未完成的调用结果再退出
+static void serveStdio(QCoreApplication &app, MockMcpServer &server)
+{
+    auto pendingResponses = std::make_shared<int>(0);
+    auto inputClosed = std::make_shared<bool>(false);
+    auto quitIfDone = [&app, pendingResponses, inputClosed]()
+    {
+        if (*inputClosed && *pendingResponses == 0)
+            app.quit();
+    };
+    auto write = [pendingResponses, quitIfDone](const QByteArray &response)
+    {
+        std::fwrite(response.constData(), 1, static_cast<size_t>(response.size()), stdout);
+        std::fputc('\n', stdout);
+        std::fflush(stdout);
+        *pendingResponses -= 1;
+        quitIfDone();
+    };
+    std::thread reader(
+        [&app, &server, pendingResponses, inputClosed, quitIfDone, write]()
+        {
+            std::string line;
+            while (std::getline(std::cin, line))
+            {
+                QByteArray body = QByteArray::fromStdString(line).trimmed();
+                if (body.isEmpty())
+                    continue;
+                QMetaObject::invokeMethod(
+                    &app,
+                    [&server, pendingResponses, write, body]()
+                    {
+                        *pendingResponses += 1;
+                        if (!server.handle(body, write))
+                            *pendingResponses -= 1;
+                    },
+                    Qt::QueuedConnection);
+            }
+            QMetaObject::invokeMethod(
+                &app,
+                [inputClosed, quitIfDone]()
+                {
+                    *inputClosed = true;
+                    quitIfDone();
+                },
+                Qt::QueuedConnection);
+        });
+    reader.detach();
+}
+
+// 每个连接按顺序处理 HTTP/1.1 请求(保持连接)，只支持 Content-Length 形式的请求体
+static QTcpServer *serveHttp(QCoreApplication &app, MockMcpServer &server, const QString &host, quint16 port, const QString &endpoint)
+{
+    const QByteArray sessionId = QUuid::createUuid().toByteArray(QUuid::Id128);
+    QTcpServer *tcpServer = new QTcpServer(&app);
+    auto sendBody = [sessionId](QPointer<QTcpSocket> socket, int status, const QByteArray &body)
+    {
+        if (!socket)
+            return;
+        static const QHash<int, QByteArray> reasons = {{200, "OK"}, {202, "Accepted"}, {400, "Bad Request"}, {404, "Not Found"}, {405, "Method Not Allowed"}};
+        QByteArray header = "HTTP/1.1 " + QByteArray::number(status) + " " + reasons.value(status) + "\r\n";
+        header += "Content-Type: application/json\r\n";
+        header += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+        header += "Mcp-Session-Id: " + sessionId + "\r\n\r\n";
+        socket->write(header + body);
+    };
+    QObject::connect(tcpServer, &QTcpServer::newConnection, tcpServer,
+                     [tcpServer, &server, endpoint, sendBody]()
+                     {
+                         while (QTcpSocket *socket = tcpServer->nextPendingConnection())
+                         {
+                             auto buffer = std::make_shared<QByteArray>();
+                             QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+                             QObject::connect(socket, &QTcpSocket::readyRead, socket,
+                                              [socket, buffer, &server, endpoint, sendBody]()
+                                              {
+                                                  buffer->append(socket->readAll());
+                                                  while (true)
+                                                  {
+                                                      const int headerEnd = buffer->indexOf("\r\n\r\n");
+                                                      if (headerEnd < 0)
+                                                          return;
+                                                      const QList<QByteArray> lines = buffer->left(headerEnd).split('\n');
+                                                      const QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+                                                      int contentLength = 0;
+                                                      for (const QByteArray &line : lines)
+                                                      {
+                                                          if (line.toLower().startsWith("content-length:"))
+                                                              contentLength = line.mid(static_cast<int>(strlen("content-length:"))).trimmed().toInt();
+                                                      }
+                                                      if (buffer->size() < headerEnd + 4 + contentLength)
+                                                          return;
+                                                      const QByteArray body = buffer->mid(headerEnd + 4, contentLength);
+                                                      buffer->remove(0, headerEnd + 4 + contentLength);
+                                                      const QByteArray method = requestLine.value(0);
+                                                      const QString path = QString::fromUtf8(requestLine.value(1));
+                                                      QPointer<QTcpSocket> guard(socket);
+                                                      if (method == "GET")
+                                                      {
+                                                          // 不提供服务器主动推送的事件流
+                                                          sendBody(guard, 405, QByteArray());
+                                                      }
+                                                      else if (method == "DELETE")
+                                                      {
+                                                          sendBody(guard, 200, QByteArray());
+                                                      }
+                                                      else if (method != "POST" || path != endpoint)
+                                                      {
+                                                          sendBody(guard, 404, QByteArray());
+                                                      }
+                                                      else
+                                                      {
+                                                          QJsonObject message = QJsonDocument::fromJson(body).object();
+                                                          const bool isNotification = message.value("id").isUndefined() || message.value("id").isNull();
+                                                          // 通知返回 202；模拟超时时保持连接不响应
+                                                          if (!server.handle(body, [guard, sendBody](const QByteArray &response) { sendBody(guard, 200, response); }) && isNotification)
+                                                              sendBody(guard, 202, QByteArray());
+                                                      }
+                                                  }
+                                              });
+                         }
+                     });
+    if (!tcpServer->listen(QHostAddress(host), port))
+    {
+        std::fprintf(stderr, "Listen on %s:%u failed: %s\n", qPrintable(host), port, qPrintable(tcpServer->errorString()));
+        return nullptr;
+    }
+    std::fprintf(stderr, "Mock MCP server listening on http://%s:%u%s\n", qPrintable(host), port, qPrintable(endpoint));
+    return tcpServer;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("MockMcpServer");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("模拟 MCP 服务器");
+    parser.addHelpOption();
+    QCommandLineOption optionTransport("transport", "stdio | http", "transport", "stdio");
+    QCommandLineOption optionHost("host", "HTTP 监听地址", "host", "127.0.0.1");
+    QCommandLineOption optionPort("port", "HTTP 监听端口", "port", "8931");
+    QCommandLineOption optionEndpoint("endpoint", "HTTP 路径", "endpoint", "/mcp");
+    QCommandLineOption optionTools("tools", "工具数量", "count", "10");
+    QCommandLineOption optionPageSize("page-size", "tools/list 每页工具数量，0 代表不分页", "count", "0");
+    QCommandLineOption optionSchemaProps("schema-props", "每个工具 inputSchema 中的参数数量", "count", "4");
+    QCommandLineOption optionDescriptionChars("description-chars", "工具与参数描述的字符数", "count", "80");
+    QCommandLineOption optionLatency("latency", "调用延迟分布(毫秒): fixed:MS | uniform:MIN,MAX | normal:MEAN,STDDEV | exponential:MEAN", "spec", "fixed:0");
+    QCommandLineOption optionPayload("payload", "返回内容(字节): text:N | image:N | audio:N | mixed:N，可用 + 组合多项，如 text:1024+image:4096", "spec", "text:256");
+    QCommandLineOption optionFailureRate("failure-rate", "失败概率 0-1", "rate", "0");
+    QCommandLineOption optionFailureMode("failure-mode",
+                                         "error: JSON-RPC error; tool-error: isError=true; timeout: 不响应; malformed: 返回非法JSON; crash: 退出进程",
+                                         "mode", "error");
+    QCommandLineOption optionSeed("seed", "随机种子", "seed", "0");
+    parser.addOptions({optionTransport, optionHost, optionPort, optionEndpoint, optionTools, optionPageSize, optionSchemaProps,
+                       optionDescriptionChars, optionLatency, optionPayload, optionFailureRate, optionFailureMode, optionSeed});
+    parser.process(app);
+
+    MockOptions options;
+    options.tools = parser.value(optionTools).toInt();
+    options.pageSize = parser.value(optionPageSize).toInt();
+    options.schemaProps = parser.value(optionSchemaProps).toInt();
+    options.descriptionChars = parser.value(optionDescriptionChars).toInt();
+    options.latency = parser.value(optionLatency);
+    options.payload = parser.value(optionPayload);
+    options.failureRate = parser.value(optionFailureRate).toDouble();
+    options.failureMode = parser.value(optionFailureMode);
+    options.seed = parser.value(optionSeed).toUInt();
+    const QStringList failureModes = {"error", "tool-error", "timeout", "malformed", "crash"};
+    if (!failureModes.contains(options.failureMode))
+    {
+        std::fprintf(stderr, "unknown failure mode: %s\n", qPrintable(options.failureMode));
+        return 2;
+    }
+
+    MockMcpServer server(options);
+    QString errorMessage;
+    if (!server.initialize(&errorMessage))
+    {
+        std::fprintf(stderr, "%s\n", qPrintable(errorMessage));
+        return 2;
+    }
+    if (parser.value(optionTransport) == "http")
+    {
+        if (!serveHttp(app, server, parser.value(optionHost), static_cast<quint16>(parser.value(optionPort).toUInt()), parser.value(optionEndpoint)))
+            return 1;
+    }
+    else
+    {
+        serveStdio(app, server);
+    }
+    return app.exec();
+}